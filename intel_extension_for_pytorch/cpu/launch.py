@@ -454,6 +454,14 @@ class MultiInstanceLauncher(Launcher):
                                             args.enable_tcmalloc,
                                             args.enable_jemalloc,
                                             args.use_default_allocator)
+        if args.weight_sharing_dir:
+            # all the instances map the prepacked weights from the same files
+            os.makedirs(args.weight_sharing_dir, exist_ok=True)
+            self.set_env("IPEX_WEIGHT_SHARING_DIR", args.weight_sharing_dir)
+            if args.weight_sharing_hugepage:
+                self.set_env("IPEX_WEIGHT_SHARING_HUGEPAGE", "1")
+            if args.weight_sharing_numa_replica:
+                self.set_env("IPEX_WEIGHT_SHARING_NUMA_REPLICA", "1")
         os.environ["LAUNCH_CMD"] = "#"
         for i in range(args.ninstances):
             cmd = []
@@ -737,6 +745,14 @@ def add_multi_instance_params(parser):
                        help="The log file directory. Default path is '', which means disable logging to files.")
     group.add_argument("--log_file_prefix", metavar='\b', default="run", type=str,
                        help="log file prefix")
+    group.add_argument("--weight_sharing_dir", metavar='\b', default="", type=str,
+                       help="Directory of the files the instances map their prepacked weights from, so that they share "
+                       "one copy of the weights. A tmpfs directory such as /dev/shm is recommended. Default is '', "
+                       "which means each instance keeps its own copy.")
+    group.add_argument("--weight_sharing_hugepage", action='store_true', default=False,
+                       help="Map the shared weights at 2MB-aligned addresses with transparent huge pages advised")
+    group.add_argument("--weight_sharing_numa_replica", action='store_true', default=False,
+                       help="Keep one copy of the shared weights per NUMA node")
 
 def add_kmp_iomp_params(parser):
 
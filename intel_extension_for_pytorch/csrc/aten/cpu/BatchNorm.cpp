@@ -3,10 +3,15 @@
 #include "BatchNorm.h"
 #include "csrc/autocast/autocast_mode.h"
 #include "csrc/cpu/ideep/IDeepConversions.h"
+#include "csrc/utils/library.h"
 
 namespace torch_ipex {
 namespace cpu {
 
+DEFINE_DISPATCH(batch_norm_cl_stats_kernel_stub);
+DEFINE_DISPATCH(batch_norm_cl_apply_kernel_stub);
+DEFINE_DISPATCH(batch_norm_cl_backward_kernel_stub);
+
 std::tuple<at::Tensor, at::Tensor, at::Tensor> batch_norm_forward(
     const at::Tensor& input,
     const at::Tensor& weight,
@@ -246,6 +251,273 @@ torch::autograd::variable_list IPEXBatchNormOp::backward(
       at::Tensor()};
 }
 
+namespace {
+
+// View of a channels last tensor as [N * spatial, C]
+at::Tensor channels_last_rows(const at::Tensor& t) {
+  std::vector<int64_t> perm(t.dim());
+  perm[0] = 0;
+  for (int64_t d = 2; d < t.dim(); d++) {
+    perm[d - 1] = d;
+  }
+  perm[t.dim() - 1] = 1;
+  return t.permute(perm).view({-1, t.size(1)});
+}
+
+// FP32 weight and bias, ones and zeros if undefined
+std::tuple<at::Tensor, at::Tensor> batch_norm_affine(
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    int64_t C) {
+  auto options = at::TensorOptions().dtype(at::kFloat);
+  return std::make_tuple(
+      weight.defined() ? weight.to(at::kFloat).contiguous()
+                       : at::ones({C}, options),
+      bias.defined() ? bias.to(at::kFloat).contiguous()
+                     : at::zeros({C}, options));
+}
+
+} // namespace
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> batch_norm_cl_train_forward(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    const c10::optional<at::Tensor>& running_mean_opt,
+    const c10::optional<at::Tensor>& running_var_opt,
+    double momentum,
+    double eps,
+    bool relu) {
+  const at::Tensor& weight =
+      c10::value_or_else(weight_opt, [] { return at::Tensor(); });
+  const at::Tensor& bias =
+      c10::value_or_else(bias_opt, [] { return at::Tensor(); });
+  const at::Tensor& running_mean =
+      c10::value_or_else(running_mean_opt, [] { return at::Tensor(); });
+  const at::Tensor& running_var =
+      c10::value_or_else(running_var_opt, [] { return at::Tensor(); });
+
+  const int64_t C = input.size(1);
+  const int64_t M = input.numel() / C;
+  auto input_ = input.contiguous(input.suggest_memory_format());
+  auto output = at::empty_like(input_);
+  auto input_rows = channels_last_rows(input_);
+  auto output_rows = channels_last_rows(output);
+
+  auto options = at::TensorOptions().dtype(at::kFloat);
+  auto save_mean = at::empty({C}, options);
+  auto var = at::empty({C}, options);
+  batch_norm_cl_stats_kernel_stub(kCPU, input_rows, save_mean, var);
+  auto save_invstd = var.add(eps).rsqrt_();
+
+  at::Tensor w, b;
+  std::tie(w, b) = batch_norm_affine(weight, bias, C);
+  auto scale = w.mul(save_invstd);
+  auto shift = b.sub(save_mean.mul(scale));
+  batch_norm_cl_apply_kernel_stub(
+      kCPU, input_rows, scale, shift, relu, output_rows);
+
+  if (running_mean.defined()) {
+    running_mean.mul_(1 - momentum).add_(save_mean, momentum);
+  }
+  if (running_var.defined()) {
+    // the running variance is unbiased
+    running_var.mul_(1 - momentum)
+        .add_(var, momentum * M / std::max<int64_t>(M - 1, 1));
+  }
+  return std::make_tuple(output, save_mean, save_invstd);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> batch_norm_cl_train_backward(
+    const at::Tensor& grad_output,
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    const at::Tensor& save_mean,
+    const at::Tensor& save_invstd,
+    bool relu,
+    std::array<bool, 3> grad_input_mask) {
+  const at::Tensor& weight =
+      c10::value_or_else(weight_opt, [] { return at::Tensor(); });
+  const at::Tensor& bias =
+      c10::value_or_else(bias_opt, [] { return at::Tensor(); });
+
+  const int64_t C = input.size(1);
+  const auto memory_format = input.suggest_memory_format();
+  auto input_ = input.contiguous(memory_format);
+  auto grad_output_ = grad_output.to(input.scalar_type())
+                          .contiguous(memory_format);
+
+  at::Tensor w, b;
+  std::tie(w, b) = batch_norm_affine(weight, bias, C);
+  auto scale = w.mul(save_invstd);
+  auto shift = b.sub(save_mean.mul(scale));
+
+  auto options = at::TensorOptions().dtype(at::kFloat);
+  at::Tensor grad_input = grad_input_mask[0] ? at::empty_like(input_)
+                                             : at::Tensor();
+  at::Tensor grad_weight = grad_input_mask[1] && weight.defined()
+      ? at::empty({C}, options)
+      : at::Tensor();
+  at::Tensor grad_bias = grad_input_mask[2] && bias.defined()
+      ? at::empty({C}, options)
+      : at::Tensor();
+  at::Tensor grad_input_rows =
+      grad_input.defined() ? channels_last_rows(grad_input) : at::Tensor();
+  batch_norm_cl_backward_kernel_stub(
+      kCPU,
+      channels_last_rows(grad_output_),
+      channels_last_rows(input_),
+      save_mean,
+      save_invstd,
+      w,
+      scale,
+      shift,
+      relu,
+      grad_input_rows,
+      grad_weight,
+      grad_bias);
+
+  return std::make_tuple(
+      grad_input,
+      grad_weight.defined() ? grad_weight.to(weight.scalar_type())
+                            : grad_weight,
+      grad_bias.defined() ? grad_bias.to(bias.scalar_type()) : grad_bias);
+}
+
+at::Tensor IPEXBatchNormTrainOp::forward(
+    torch::autograd::AutogradContext* ctx,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    const c10::optional<at::Tensor>& running_mean_opt,
+    const c10::optional<at::Tensor>& running_var_opt,
+    double momentum,
+    double eps,
+    bool relu) {
+  RECORD_FUNCTION(
+      "IPEXBatchNormTrainOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+  ctx->saved_data["relu"] = relu;
+  ctx->saved_data["input_requires_grad"] = input.requires_grad();
+  ctx->saved_data["weight_requires_grad"] =
+      weight.defined() && weight.requires_grad();
+  ctx->saved_data["bias_requires_grad"] =
+      bias.defined() && bias.requires_grad();
+  at::Tensor output, save_mean, save_invstd;
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::batch_norm_cl_train_forward", "")
+          .typed<decltype(batch_norm_cl_train_forward)>();
+  std::tie(output, save_mean, save_invstd) = op.call(
+      input,
+      weight,
+      bias,
+      running_mean_opt,
+      running_var_opt,
+      momentum,
+      eps,
+      relu);
+  ctx->save_for_backward({input, weight, bias, save_mean, save_invstd});
+  return output;
+}
+
+torch::autograd::variable_list IPEXBatchNormTrainOp::backward(
+    torch::autograd::AutogradContext* ctx,
+    torch::autograd::variable_list grad_outputs) {
+  RECORD_FUNCTION(
+      "IPEXBatchNormTrainOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+  std::array<bool, 3> output_mask;
+  output_mask[0] = ctx->saved_data["input_requires_grad"].toBool();
+  output_mask[1] = ctx->saved_data["weight_requires_grad"].toBool();
+  output_mask[2] = ctx->saved_data["bias_requires_grad"].toBool();
+  auto saved = ctx->get_saved_variables();
+  at::Tensor grad_input, grad_weight, grad_bias;
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::batch_norm_cl_train_backward", "")
+          .typed<decltype(batch_norm_cl_train_backward)>();
+  std::tie(grad_input, grad_weight, grad_bias) = op.call(
+      grad_outputs[0],
+      saved[0],
+      saved[1],
+      saved[2],
+      saved[3],
+      saved[4],
+      ctx->saved_data["relu"].toBool(),
+      output_mask);
+  return {
+      grad_input,
+      grad_weight,
+      grad_bias,
+      at::Tensor(),
+      at::Tensor(),
+      at::Tensor(),
+      at::Tensor(),
+      at::Tensor()};
+}
+
+bool batch_norm_train_eligible(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    bool train) {
+  auto is_fp32_param = [](const c10::optional<at::Tensor>& t) {
+    return !t.has_value() || !t.value().defined() ||
+        t.value().scalar_type() == at::kFloat;
+  };
+  if (!train || torch::jit::tracer::isTracing() ||
+      !(input.scalar_type() == at::kFloat ||
+        input.scalar_type() == at::kBFloat16) ||
+      !is_fp32_param(weight_opt) || !is_fp32_param(bias_opt)) {
+    return false;
+  }
+  const auto memory_format = input.suggest_memory_format();
+  if (!(input.dim() == 4 && memory_format == at::MemoryFormat::ChannelsLast) &&
+      !(input.dim() == 5 &&
+        memory_format == at::MemoryFormat::ChannelsLast3d)) {
+    return false;
+  }
+  // ATen reports a single value per channel as an error
+  return input.size(1) > 0 && input.numel() / input.size(1) > 1;
+}
+
+at::Tensor batch_norm_relu(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    const c10::optional<at::Tensor>& running_mean_opt,
+    const c10::optional<at::Tensor>& running_var_opt,
+    bool train,
+    double momentum,
+    double eps) {
+  RECORD_FUNCTION(
+      "torch_ipex::batch_norm_relu", c10::ArrayRef<c10::IValue>({}));
+
+  if (batch_norm_train_eligible(input, weight_opt, bias_opt, train)) {
+    return IPEXBatchNormTrainOp::apply(
+        input,
+        weight_opt.value_or(at::Tensor()),
+        bias_opt.value_or(at::Tensor()),
+        running_mean_opt,
+        running_var_opt,
+        momentum,
+        eps,
+        true);
+  }
+  return at::relu(at::batch_norm(
+      input,
+      weight_opt,
+      bias_opt,
+      running_mean_opt,
+      running_var_opt,
+      train,
+      momentum,
+      eps,
+      false));
+}
+
 /*
 at::Tensor batch_norm(
     const at::Tensor& input,
@@ -325,6 +597,42 @@ at::Tensor frozen_batch_norm(
   return op.call(input, weight, bias, running_mean, running_var, eps);
 }
 
+// Channels last training takes the IPEX BatchNorm engine, the input keeps
+// its dtype and the statistics are computed in FP32 as for the FP32 weight
+at::Tensor batch_norm(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    const c10::optional<at::Tensor>& running_mean_opt,
+    const c10::optional<at::Tensor>& running_var_opt,
+    bool train,
+    double momentum,
+    double eps,
+    bool cudnn_enabled) {
+  c10::impl::ExcludeDispatchKeyGuard no_autocastCPU(DispatchKey::AutocastCPU);
+  if (cpu::batch_norm_train_eligible(input, weight_opt, bias_opt, train)) {
+    return cpu::IPEXBatchNormTrainOp::apply(
+        input,
+        weight_opt.value_or(at::Tensor()),
+        bias_opt.value_or(at::Tensor()),
+        running_mean_opt,
+        running_var_opt,
+        momentum,
+        eps,
+        false);
+  }
+  return at::batch_norm(
+      input,
+      weight_opt,
+      bias_opt,
+      running_mean_opt,
+      running_var_opt,
+      train,
+      momentum,
+      eps,
+      cudnn_enabled);
+}
+
 } // namespace autocast
 } // namespace torch_ipex
 
@@ -358,6 +666,36 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "batch_norm_backward",
       c10::DispatchKey::CPU,
       torch_ipex::cpu::batch_norm_backward);
+  m.def(
+      "batch_norm_cl_train_forward(Tensor input, Tensor? weight, Tensor? "
+      "bias, Tensor? running_mean, Tensor? running_var, float momentum, "
+      "float eps, bool relu) -> (Tensor, Tensor, Tensor)");
+  m.impl(
+      "batch_norm_cl_train_forward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::batch_norm_cl_train_forward);
+  m.def(
+      "batch_norm_cl_train_backward(Tensor grad_output, Tensor input, "
+      "Tensor? weight, Tensor? bias, Tensor save_mean, Tensor save_invstd, "
+      "bool relu, bool[3] grad_input_mask) -> (Tensor, Tensor, Tensor)");
+  m.impl(
+      "batch_norm_cl_train_backward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::batch_norm_cl_train_backward);
+  m.def(
+      "batch_norm_relu(Tensor input, Tensor? weight, Tensor? bias, Tensor? "
+      "running_mean, Tensor? running_var, bool train, float momentum, float "
+      "eps) -> Tensor");
+  m.impl(
+      "batch_norm_relu",
+      c10::DispatchKey::AutogradCPU,
+      torch_ipex::cpu::batch_norm_relu);
+}
+
+IPEX_TORCH_LIBRARY_IMPL(aten, AutocastCPU, m) {
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::batch_norm"),
+      TORCH_FN((&torch_ipex::autocast::batch_norm)));
 }
 
 } // namespace
@@ -3,13 +3,13 @@
 #include <ATen/ATen.h>
 #include <ATen/Tensor.h>
 #include <torch/csrc/autograd/custom_function.h>
+#include <csrc/dyndisp/DispatchStub.h>
 
 #include "csrc/cpu/ideep/ideep.hpp"
 
 namespace torch_ipex {
 namespace cpu {
 
-
 class IPEXBatchNormOp : public torch::autograd::Function<IPEXBatchNormOp> {
  public:
   static at::Tensor forward(
@@ -28,5 +28,112 @@ class IPEXBatchNormOp : public torch::autograd::Function<IPEXBatchNormOp> {
       torch::autograd::variable_list grad_outputs);
 };
 
+// Training BatchNorm over channels last FP32 or BF16 inputs, with an optional
+// fused ReLU. The statistics and the gradients are computed in FP32, weight
+// and bias are FP32.
+class IPEXBatchNormTrainOp
+    : public torch::autograd::Function<IPEXBatchNormTrainOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& input,
+      const at::Tensor& weight,
+      const at::Tensor& bias,
+      const c10::optional<at::Tensor>& running_mean_opt,
+      const c10::optional<at::Tensor>& running_var_opt,
+      double momentum,
+      double eps,
+      bool relu);
+
+  static torch::autograd::variable_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::variable_list grad_outputs);
+};
+
+// Returns true if the training BatchNorm engine handles these arguments
+bool batch_norm_train_eligible(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    bool train);
+
+at::Tensor batch_norm_relu(
+    const at::Tensor& input,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    const c10::optional<at::Tensor>& running_mean_opt,
+    const c10::optional<at::Tensor>& running_var_opt,
+    bool train,
+    double momentum,
+    double eps);
+
+namespace {
+
+void batch_norm_cl_stats_kernel_impl(
+    const at::Tensor& input,
+    at::Tensor& mean,
+    at::Tensor& var);
+
+void batch_norm_cl_apply_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    bool relu,
+    at::Tensor& output);
+
+void batch_norm_cl_backward_kernel_impl(
+    const at::Tensor& grad_output,
+    const at::Tensor& input,
+    const at::Tensor& mean,
+    const at::Tensor& invstd,
+    const at::Tensor& weight,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    bool relu,
+    at::Tensor& grad_input,
+    at::Tensor& grad_weight,
+    at::Tensor& grad_bias);
+
+} // namespace
+
+// The kernels take the input as [M, C], M being the batch and spatial
+// dimensions of a channels last tensor. Writes the per channel mean and
+// biased variance of input in FP32.
+using batch_norm_cl_stats_kernel_fn =
+    void (*)(const at::Tensor&, at::Tensor&, at::Tensor&);
+DECLARE_DISPATCH(
+    batch_norm_cl_stats_kernel_fn,
+    batch_norm_cl_stats_kernel_stub);
+
+// output = input * scale + shift per channel, followed by ReLU if relu is set
+using batch_norm_cl_apply_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    bool,
+    at::Tensor&);
+DECLARE_DISPATCH(
+    batch_norm_cl_apply_kernel_fn,
+    batch_norm_cl_apply_kernel_stub);
+
+// Gradients of the apply kernel with the batch statistics. scale and shift
+// are those of the forward, used to recompute the ReLU mask. The gradients
+// left undefined aren't computed.
+using batch_norm_cl_backward_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    bool,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(
+    batch_norm_cl_backward_kernel_fn,
+    batch_norm_cl_backward_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
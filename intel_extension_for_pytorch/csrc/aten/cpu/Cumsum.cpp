@@ -11,6 +11,7 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(cumsum_kernel_stub);
+DEFINE_DISPATCH(segment_cumsum_kernel_stub);
 
 at::Tensor cumsum(
     const at::Tensor& self,
@@ -45,6 +46,49 @@ at::Tensor& cumsum_out(
   return result;
 }
 
+// Cumsum of each segment of a jagged tensor along dim 0. Segments are given
+// either by offsets (num_segments + 1 entries, from 0 to self.size(0)) or by
+// lengths (num_segments entries summing to self.size(0)).
+at::Tensor segment_cumsum(
+    const at::Tensor& self,
+    const c10::optional<at::Tensor>& offsets,
+    const c10::optional<at::Tensor>& lengths,
+    bool exclusive) {
+  RECORD_FUNCTION("torch_ipex::segment_cumsum", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      offsets.has_value() != lengths.has_value(),
+      "segment_cumsum: exactly one of offsets and lengths should be given");
+  TORCH_CHECK(self.dim() >= 1, "segment_cumsum: self should be at least 1D");
+  at::Tensor offsets_;
+  if (offsets.has_value()) {
+    TORCH_CHECK(
+        offsets->dim() == 1 && offsets->numel() >= 1,
+        "segment_cumsum: offsets should be a non-empty 1D tensor");
+    offsets_ = offsets->to(at::kLong).contiguous();
+  } else {
+    TORCH_CHECK(
+        lengths->dim() == 1, "segment_cumsum: lengths should be a 1D tensor");
+    offsets_ = at::zeros({lengths->numel() + 1}, at::kLong);
+    offsets_.slice(0, 1).copy_(lengths->to(at::kLong).cumsum(0));
+  }
+  auto offsets_data = offsets_.data_ptr<int64_t>();
+  auto num_segments = offsets_.numel() - 1;
+  TORCH_CHECK(
+      offsets_data[0] == 0 && offsets_data[num_segments] == self.size(0),
+      "segment_cumsum: segments should cover all the ",
+      self.size(0),
+      " rows of self");
+  for (int64_t s = 0; s < num_segments; s++) {
+    TORCH_CHECK(
+        offsets_data[s] <= offsets_data[s + 1],
+        "segment_cumsum: offsets should be non-decreasing");
+  }
+
+  // pointer to segment_cumsum_kernel_impl(self, offsets_, exclusive);
+  return segment_cumsum_kernel_stub(kCPU, self, offsets_, exclusive);
+}
+
 } // namespace cpu
 
 namespace {
@@ -61,6 +105,10 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "cumsum.out(Tensor self, int dim, *, ScalarType? dtype=None, "
       "Tensor(a!) out) -> Tensor(a!)",
       torch_ipex::cpu::cumsum_out);
+  m.def(
+      "segment_cumsum(Tensor self, Tensor? offsets=None, Tensor? lengths=None, "
+      "bool exclusive=False) -> Tensor",
+      torch_ipex::cpu::segment_cumsum);
 }
 
 } // namespace
@@ -13,6 +13,11 @@ at::Tensor cumsum_kernel_impl(
     int64_t dim,
     c10::optional<at::ScalarType> dtype);
 
+at::Tensor segment_cumsum_kernel_impl(
+    const at::Tensor& self,
+    const at::Tensor& offsets,
+    bool exclusive);
+
 }
 
 using cumsum_kernel_fn = at::Tensor (*)(
@@ -22,5 +27,9 @@ using cumsum_kernel_fn = at::Tensor (*)(
     c10::optional<at::ScalarType>);
 DECLARE_DISPATCH(cumsum_kernel_fn, cumsum_kernel_stub);
 
+using segment_cumsum_kernel_fn =
+    at::Tensor (*)(const at::Tensor&, const at::Tensor&, bool);
+DECLARE_DISPATCH(segment_cumsum_kernel_fn, segment_cumsum_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
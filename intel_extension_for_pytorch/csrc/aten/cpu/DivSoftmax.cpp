@@ -1,9 +1,13 @@
 #include "DivSoftmax.h"
 
+#include <ATen/record_function.h>
+#include <torch/all.h>
+
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(div_maskedfill_softmax_kernel_stub);
+DEFINE_DISPATCH(div_causal_softmax_kernel_stub);
 
 at::Tensor DivMaskedfillSoftmax(
     at::Tensor& a,
@@ -19,5 +23,41 @@ at::Tensor DivMaskedfillSoftmax(
       kCPU, a, b, mask_shape, fill, dim_per_head);
 }
 
+at::Tensor DivCausalSoftmax(const at::Tensor& a, const float& dim_per_head) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::div_causal_softmax\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::div_causal_softmax", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      a.dim() >= 2,
+      "div_causal_softmax: expected an input with at least 2 dims, got ",
+      a.dim());
+  if (a.numel() == 0) {
+    return at::empty_like(a);
+  }
+  /*
+  pointer to div_causal_softmax_kernel_impl(a, dim_per_head);
+  */
+  return div_causal_softmax_kernel_stub(kCPU, a.contiguous(), dim_per_head);
+}
+
+at::Tensor div_causal_softmax(const at::Tensor& a, double dim_per_head) {
+  return DivCausalSoftmax(a, static_cast<float>(dim_per_head));
+}
+
 } // namespace cpu
 } // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def("div_causal_softmax(Tensor a, float dim_per_head) -> Tensor");
+  m.impl(
+      "div_causal_softmax",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::div_causal_softmax);
+}
+
+} // namespace
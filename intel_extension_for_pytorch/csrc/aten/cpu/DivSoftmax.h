@@ -15,6 +15,11 @@ at::Tensor DivMaskedfillSoftmax(
     const float& fill,
     const float& dim_per_head);
 
+// softmax(a / dim_per_head) over the last dimension with a causal mask: key j
+// is masked for query i (the -2th dimension) when j > i + keys - queries. The
+// mask is generated on the fly instead of being read from a tensor.
+at::Tensor DivCausalSoftmax(const at::Tensor& a, const float& dim_per_head);
+
 namespace {
 
 at::Tensor div_maskedfill_softmax_kernel_impl(
@@ -24,6 +29,10 @@ at::Tensor div_maskedfill_softmax_kernel_impl(
     const float& fill,
     const float& dim_per_head);
 
+at::Tensor div_causal_softmax_kernel_impl(
+    const at::Tensor& a,
+    const float& dim_per_head);
+
 }
 
 using div_maskedfill_softmax_kernel_fn = at::Tensor (*)(
@@ -36,5 +45,9 @@ DECLARE_DISPATCH(
     div_maskedfill_softmax_kernel_fn,
     div_maskedfill_softmax_kernel_stub);
 
+using div_causal_softmax_kernel_fn =
+    at::Tensor (*)(const at::Tensor&, const float&);
+DECLARE_DISPATCH(div_causal_softmax_kernel_fn, div_causal_softmax_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
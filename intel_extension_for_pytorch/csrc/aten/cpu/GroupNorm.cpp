@@ -22,28 +22,18 @@ namespace cpu {
 DEFINE_DISPATCH(GroupNormKernel);
 DEFINE_DISPATCH(GroupNormBackwardKernel);
 
-std::tuple<at::Tensor, at::Tensor, at::Tensor> native_group_norm(
+namespace {
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> group_norm_forward(
     const at::Tensor& X,
-    const c10::optional<at::Tensor>& gamma_opt /* optional */,
-    const c10::optional<at::Tensor>& beta_opt /* optional */,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
     int64_t N,
     int64_t C,
     int64_t HxW,
     int64_t group,
-    double eps) {
-#if defined(IPEX_DISP_OP)
-  printf("torch_ipex::native_group_norm\n");
-#endif
-  RECORD_FUNCTION(
-      "torch_ipex::native_group_norm", c10::ArrayRef<c10::IValue>({}));
-
-  // See [Note: hacky wrapper removal for optional tensor]
-  c10::MaybeOwned<at::Tensor> gamma_maybe_owned =
-      at::borrow_from_optional_tensor(gamma_opt);
-  const at::Tensor& gamma = *gamma_maybe_owned;
-  const at::Tensor& beta =
-      c10::value_or_else(beta_opt, [] { return at::Tensor(); });
-
+    double eps,
+    bool silu) {
   auto memory_format = X.device().is_cpu() ? X.suggest_memory_format()
                                            : at::MemoryFormat::Contiguous;
 
@@ -63,10 +53,101 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> native_group_norm(
   at::Tensor mean = at::empty({N, group}, X.options());
   at::Tensor rstd = at::empty({N, group}, X.options());
   GroupNormKernel(
-      X.device().type(), X, gamma, beta, N, C, HxW, group, eps, Y, mean, rstd);
+      X.device().type(),
+      X,
+      gamma,
+      beta,
+      N,
+      C,
+      HxW,
+      group,
+      eps,
+      silu,
+      Y,
+      mean,
+      rstd);
   return std::make_tuple(Y, mean, rstd);
 }
 
+// Checks the arguments of group_norm, returns the input, weight and bias laid
+// out for the kernels and HxW
+std::tuple<at::Tensor, at::Tensor, at::Tensor, int64_t> group_norm_inputs(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const at::Tensor& weight,
+    const at::Tensor& bias) {
+  const int64_t C = input.size(1);
+  TORCH_CHECK(
+      C % num_groups == 0,
+      "Expected number of channels in input to be divisible by ",
+      "num_groups, but got input of shape ",
+      input.sizes(),
+      " and "
+      "num_groups=",
+      num_groups);
+  TORCH_CHECK(
+      !weight.defined() || (weight.dim() == 1 && weight.numel() == C),
+      "Expected weight to be a vector of size equal to the number of ",
+      "channels in input, but got weight of shape ",
+      weight.sizes(),
+      " and input of shape ",
+      input.sizes());
+  TORCH_CHECK(
+      !bias.defined() || (bias.dim() == 1 && bias.numel() == C),
+      "Expected bias to be a vector of size equal to the number of ",
+      "channels in input, but got bias of shape ",
+      weight.sizes(),
+      " and input of shape ",
+      input.sizes());
+
+  const auto input_shape = input.sizes();
+  const int64_t HxW =
+      c10::multiply_integers(input_shape.cbegin() + 2, input_shape.cend());
+
+  const at::Tensor kEmpty;
+  // Add channels last 1d input support
+  auto memory_format = input.suggest_memory_format();
+  const auto& X = input.device().is_cpu()
+      ? (is_channels_last_1d(input) ? input : input.contiguous(memory_format))
+      : input.contiguous();
+  const auto& gamma = weight.defined()
+      ? (is_channels_last_1d(weight) ? weight : weight.contiguous())
+      : kEmpty;
+  const auto& beta = bias.defined()
+      ? (is_channels_last_1d(bias) ? bias : bias.contiguous())
+      : kEmpty;
+  TORCH_CHECK(!gamma.defined() || gamma.numel() == C);
+  TORCH_CHECK(!beta.defined() || beta.numel() == C);
+  return std::make_tuple(X, gamma, beta, HxW);
+}
+
+} // namespace
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> native_group_norm(
+    const at::Tensor& X,
+    const c10::optional<at::Tensor>& gamma_opt /* optional */,
+    const c10::optional<at::Tensor>& beta_opt /* optional */,
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    double eps) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::native_group_norm\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::native_group_norm", c10::ArrayRef<c10::IValue>({}));
+
+  // See [Note: hacky wrapper removal for optional tensor]
+  c10::MaybeOwned<at::Tensor> gamma_maybe_owned =
+      at::borrow_from_optional_tensor(gamma_opt);
+  const at::Tensor& gamma = *gamma_maybe_owned;
+  const at::Tensor& beta =
+      c10::value_or_else(beta_opt, [] { return at::Tensor(); });
+
+  return group_norm_forward(X, gamma, beta, N, C, HxW, group, eps, false);
+}
+
 std::tuple<at::Tensor, at::Tensor, at::Tensor> native_group_norm_backward(
     const at::Tensor& dY,
     const at::Tensor& X,
@@ -157,51 +238,92 @@ at::Tensor group_norm(
 
   const int64_t N = input.size(0);
   const int64_t C = input.size(1);
-  TORCH_CHECK(
-      C % num_groups == 0,
-      "Expected number of channels in input to be divisible by ",
-      "num_groups, but got input of shape ",
-      input.sizes(),
-      " and "
-      "num_groups=",
-      num_groups);
-  TORCH_CHECK(
-      !weight.defined() || (weight.dim() == 1 && weight.numel() == C),
-      "Expected weight to be a vector of size equal to the number of ",
-      "channels in input, but got weight of shape ",
-      weight.sizes(),
-      " and input of shape ",
-      input.sizes());
-  TORCH_CHECK(
-      !bias.defined() || (bias.dim() == 1 && bias.numel() == C),
-      "Expected bias to be a vector of size equal to the number of ",
-      "channels in input, but got bias of shape ",
-      weight.sizes(),
-      " and input of shape ",
-      input.sizes());
-
-  const auto input_shape = input.sizes();
-  const int64_t HxW =
-      c10::multiply_integers(input_shape.cbegin() + 2, input_shape.cend());
-
-  const at::Tensor kEmpty;
-  // Add channels last 1d input support
-  auto memory_format = input.suggest_memory_format();
-  const auto& X = input.device().is_cpu()
-      ? (is_channels_last_1d(input) ? input : input.contiguous(memory_format))
-      : input.contiguous();
-  const auto& gamma = weight.defined()
-      ? (is_channels_last_1d(weight) ? weight : weight.contiguous())
-      : kEmpty;
-  const auto& beta = bias.defined()
-      ? (is_channels_last_1d(bias) ? bias : bias.contiguous())
-      : kEmpty;
-  TORCH_CHECK(!gamma.defined() || gamma.numel() == C);
-  TORCH_CHECK(!beta.defined() || beta.numel() == C);
+  at::Tensor X, gamma, beta;
+  int64_t HxW;
+  std::tie(X, gamma, beta, HxW) =
+      group_norm_inputs(input, num_groups, weight, bias);
   return std::get<0>(
       at::native_group_norm(X, gamma, beta, N, C, HxW, num_groups, eps));
 }
 
+at::Tensor group_norm_silu(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::group_norm_silu\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::group_norm_silu", c10::ArrayRef<c10::IValue>({}));
+
+  c10::MaybeOwned<at::Tensor> weight_maybe_owned =
+      at::borrow_from_optional_tensor(weight_opt);
+  const at::Tensor& weight = *weight_maybe_owned;
+  const at::Tensor& bias =
+      c10::value_or_else(bias_opt, [] { return at::Tensor(); });
+
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  at::Tensor X, gamma, beta;
+  int64_t HxW;
+  std::tie(X, gamma, beta, HxW) =
+      group_norm_inputs(input, num_groups, weight, bias);
+  return std::get<0>(group_norm_forward(
+      X, gamma, beta, N, C, HxW, num_groups, eps, /*silu=*/true));
+}
+
+at::Tensor group_norm_silu_(
+    at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::group_norm_silu_\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::group_norm_silu_", c10::ArrayRef<c10::IValue>({}));
+
+  c10::MaybeOwned<at::Tensor> weight_maybe_owned =
+      at::borrow_from_optional_tensor(weight_opt);
+  const at::Tensor& weight = *weight_maybe_owned;
+  const at::Tensor& bias =
+      c10::value_or_else(bias_opt, [] { return at::Tensor(); });
+
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  at::Tensor X, gamma, beta;
+  int64_t HxW;
+  std::tie(X, gamma, beta, HxW) =
+      group_norm_inputs(input, num_groups, weight, bias);
+  if (!X.is_same(input)) {
+    // the input had to be copied to a dense layout, normalize the copy
+    return std::get<0>(group_norm_forward(
+        X, gamma, beta, N, C, HxW, num_groups, eps, /*silu=*/true));
+  }
+  // every element is read before it is overwritten: all the kernels compute
+  // the statistics of a group before they normalize it
+  at::Tensor mean = at::empty({N, num_groups}, X.options());
+  at::Tensor rstd = at::empty({N, num_groups}, X.options());
+  GroupNormKernel(
+      X.device().type(),
+      X,
+      gamma,
+      beta,
+      N,
+      C,
+      HxW,
+      num_groups,
+      eps,
+      /*silu=*/true,
+      input,
+      mean,
+      rstd);
+  return input;
+}
+
 IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
   m.impl(
       TORCH_SELECTIVE_NAME("aten::group_norm"),
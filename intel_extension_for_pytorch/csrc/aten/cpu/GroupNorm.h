@@ -8,6 +8,29 @@ namespace torch_ipex {
 
 namespace cpu {
 
+/**
+ * GroupNorm followed by SiLU, fused into the normalization epilogue. It's the
+ * inference-only target of the JIT GroupNorm + SiLU fusion.
+ */
+at::Tensor group_norm_silu(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps);
+
+/**
+ * In-place GroupNorm + SiLU, for the conv output of the JIT conv + GroupNorm +
+ * SiLU fusion which is owned by the fused op. Falls back to group_norm_silu
+ * when the input is not dense in its suggested memory format.
+ */
+at::Tensor group_norm_silu_(
+    at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps);
+
 using forward_fn = void (*)(
     const at::Tensor& /* X */,
     const at::Tensor& /* gamma */,
@@ -17,6 +40,7 @@ using forward_fn = void (*)(
     int64_t /* HxW */,
     int64_t /* group */,
     double /* eps */,
+    bool /* silu */,
     at::Tensor& /* Y */,
     at::Tensor& /* mean */,
     at::Tensor& /* rstd */);
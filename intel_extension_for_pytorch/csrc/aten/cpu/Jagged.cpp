@@ -0,0 +1,213 @@
+#include "Jagged.h"
+#include <ATen/Parallel.h>
+#include <c10/util/Exception.h>
+#include <torch/csrc/autograd/function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(jagged_to_padded_dense_kernel_stub);
+DEFINE_DISPATCH(padded_dense_to_jagged_kernel_stub);
+DEFINE_DISPATCH(jagged_dense_elementwise_kernel_stub);
+
+namespace {
+
+// Returns offsets as a contiguous long tensor after checking that it is a
+// non-decreasing sequence starting at 0 and ending at total.
+at::Tensor check_jagged_offsets(
+    const at::Tensor& offsets,
+    int64_t total,
+    const char* op_name) {
+  TORCH_CHECK(
+      offsets.dim() == 1 && offsets.numel() >= 1,
+      op_name,
+      ": offsets should be a non-empty 1D tensor");
+  auto offsets_ = offsets.to(at::kLong).contiguous();
+  auto offsets_data = offsets_.data_ptr<int64_t>();
+  auto batch_size = offsets_.numel() - 1;
+  TORCH_CHECK(
+      offsets_data[0] == 0 && offsets_data[batch_size] == total,
+      op_name,
+      ": offsets should start at 0 and end at ",
+      total);
+  for (int64_t b = 0; b < batch_size; b++) {
+    TORCH_CHECK(
+        offsets_data[b] <= offsets_data[b + 1],
+        op_name,
+        ": offsets should be non-decreasing");
+  }
+  return offsets_;
+}
+
+void check_jagged_dense(
+    const at::Tensor& values,
+    const at::Tensor& dense,
+    int64_t batch_size,
+    const char* op_name) {
+  TORCH_CHECK(
+      dense.dim() == values.dim() + 1 && dense.size(0) == batch_size,
+      op_name,
+      ": dense should be of shape [B, max_length] + values.shape[1:]");
+  for (int64_t d = 1; d < values.dim(); d++) {
+    TORCH_CHECK(
+        dense.size(d + 1) == values.size(d),
+        op_name,
+        ": dense should be of shape [B, max_length] + values.shape[1:]");
+  }
+  TORCH_CHECK(
+      dense.scalar_type() == values.scalar_type(),
+      op_name,
+      ": values and dense should have the same dtype");
+}
+
+} // namespace
+
+at::Tensor jagged_to_padded_dense(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    int64_t max_length,
+    double padding_value) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_to_padded_dense\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::jagged_to_padded_dense", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      values.dim() >= 1,
+      "jagged_to_padded_dense: values should be at least 1D");
+  TORCH_CHECK(
+      max_length >= 0,
+      "jagged_to_padded_dense: max_length should be non-negative");
+  auto offsets_ =
+      check_jagged_offsets(offsets, values.size(0), "jagged_to_padded_dense");
+  auto sizes = values.sizes().vec();
+  sizes[0] = max_length;
+  sizes.insert(sizes.begin(), offsets_.numel() - 1);
+  auto dense = at::empty(sizes, values.options());
+
+  // pointer to jagged_to_padded_dense_kernel_impl(
+  //     dense, values, offsets_, padding_value);
+  jagged_to_padded_dense_kernel_stub(
+      kCPU, dense, values.contiguous(), offsets_, padding_value);
+  return dense;
+}
+
+at::Tensor padded_dense_to_jagged(
+    const at::Tensor& dense,
+    const at::Tensor& offsets,
+    c10::optional<int64_t> total_length) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::padded_dense_to_jagged\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::padded_dense_to_jagged", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      dense.dim() >= 2,
+      "padded_dense_to_jagged: dense should be at least 2D");
+  TORCH_CHECK(
+      offsets.dim() == 1 && offsets.numel() >= 1,
+      "padded_dense_to_jagged: offsets should be a non-empty 1D tensor");
+  // total_length is only a hint of offsets[-1] kept for API symmetry with
+  // the other jagged ops, it is still validated against offsets
+  int64_t total = total_length.has_value()
+      ? total_length.value()
+      : offsets[offsets.numel() - 1].item<int64_t>();
+  auto offsets_ =
+      check_jagged_offsets(offsets, total, "padded_dense_to_jagged");
+  TORCH_CHECK(
+      dense.size(0) == offsets_.numel() - 1,
+      "padded_dense_to_jagged: dense.size(0) should match the batch size "
+      "of offsets");
+  auto sizes = dense.sizes().slice(1).vec();
+  sizes[0] = total;
+  auto values = at::empty(sizes, dense.options());
+
+  // pointer to padded_dense_to_jagged_kernel_impl(values, dense, offsets_);
+  padded_dense_to_jagged_kernel_stub(
+      kCPU, values, dense.contiguous(), offsets_);
+  return values;
+}
+
+static at::Tensor jagged_dense_elementwise(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense,
+    JaggedElementwiseOp op,
+    const char* op_name) {
+  TORCH_CHECK(values.dim() >= 1, op_name, ": values should be at least 1D");
+  auto offsets_ = check_jagged_offsets(offsets, values.size(0), op_name);
+  check_jagged_dense(values, dense, offsets_.numel() - 1, op_name);
+  auto output = at::empty_like(values, at::MemoryFormat::Contiguous);
+
+  // pointer to jagged_dense_elementwise_kernel_impl(
+  //     output, values, offsets_, dense, op);
+  jagged_dense_elementwise_kernel_stub(
+      kCPU, output, values.contiguous(), offsets_, dense.contiguous(), op);
+  return output;
+}
+
+at::Tensor jagged_dense_elementwise_add(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_dense_elementwise_add\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::jagged_dense_elementwise_add",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return jagged_dense_elementwise(
+      values,
+      offsets,
+      dense,
+      JaggedElementwiseOp::Add,
+      "jagged_dense_elementwise_add");
+}
+
+at::Tensor jagged_dense_elementwise_mul(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_dense_elementwise_mul\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::jagged_dense_elementwise_mul",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return jagged_dense_elementwise(
+      values,
+      offsets,
+      dense,
+      JaggedElementwiseOp::Mul,
+      "jagged_dense_elementwise_mul");
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "jagged_to_padded_dense(Tensor values, Tensor offsets, int max_length, "
+      "float padding_value=0.) -> Tensor",
+      torch_ipex::cpu::jagged_to_padded_dense);
+  m.def(
+      "padded_dense_to_jagged(Tensor dense, Tensor offsets, "
+      "int? total_length=None) -> Tensor",
+      torch_ipex::cpu::padded_dense_to_jagged);
+  m.def(
+      "jagged_dense_elementwise_add(Tensor values, Tensor offsets, "
+      "Tensor dense) -> Tensor",
+      torch_ipex::cpu::jagged_dense_elementwise_add);
+  m.def(
+      "jagged_dense_elementwise_mul(Tensor values, Tensor offsets, "
+      "Tensor dense) -> Tensor",
+      torch_ipex::cpu::jagged_dense_elementwise_mul);
+}
+
+} // namespace
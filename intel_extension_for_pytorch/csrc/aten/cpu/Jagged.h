@@ -0,0 +1,85 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <csrc/dyndisp/DispatchStub.h>
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+/*
+  A jagged tensor is stored as a compact 2D values tensor [total, D] and an
+  offsets tensor [B + 1], rows offsets[b]..offsets[b + 1] of values belong to
+  the b-th sequence of the batch. Trailing dims of values are flattened into
+  D. The padded dense layout of the same batch is [B, max_length, D].
+*/
+
+enum class JaggedElementwiseOp { Add, Mul };
+
+at::Tensor jagged_to_padded_dense(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    int64_t max_length,
+    double padding_value);
+
+at::Tensor padded_dense_to_jagged(
+    const at::Tensor& dense,
+    const at::Tensor& offsets,
+    c10::optional<int64_t> total_length);
+
+at::Tensor jagged_dense_elementwise_add(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense);
+
+at::Tensor jagged_dense_elementwise_mul(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense);
+
+namespace {
+
+void jagged_to_padded_dense_kernel_impl(
+    at::Tensor& dense,
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    double padding_value);
+
+void padded_dense_to_jagged_kernel_impl(
+    at::Tensor& values,
+    const at::Tensor& dense,
+    const at::Tensor& offsets);
+
+void jagged_dense_elementwise_kernel_impl(
+    at::Tensor& output,
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense,
+    JaggedElementwiseOp op);
+
+} // namespace
+
+using jagged_to_padded_dense_kernel_fn =
+    void (*)(at::Tensor&, const at::Tensor&, const at::Tensor&, double);
+DECLARE_DISPATCH(
+    jagged_to_padded_dense_kernel_fn,
+    jagged_to_padded_dense_kernel_stub);
+
+using padded_dense_to_jagged_kernel_fn =
+    void (*)(at::Tensor&, const at::Tensor&, const at::Tensor&);
+DECLARE_DISPATCH(
+    padded_dense_to_jagged_kernel_fn,
+    padded_dense_to_jagged_kernel_stub);
+
+using jagged_dense_elementwise_kernel_fn = void (*)(
+    at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    JaggedElementwiseOp);
+DECLARE_DISPATCH(
+    jagged_dense_elementwise_kernel_fn,
+    jagged_dense_elementwise_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -2,39 +2,272 @@
 #include <ATen/NamedTensorUtils.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
+#include <ATen/WrapDimUtilsMulti.h>
 #include <ATen/cpu/vec/vec.h>
+#include <ATen/native/ReduceOpsUtils.h>
 #include <ATen/native/cpu/utils.h>
 #include <ATen/record_function.h>
+#include <c10/util/irange.h>
+
+#include <limits>
+#include <numeric>
 
 #include "Mean.h"
+#include "Sum.h"
 #include "csrc/utils/library.h"
 
 namespace torch_ipex {
 namespace cpu {
 
+DEFINE_DISPATCH(mean_kernel_stub);
+DEFINE_DISPATCH(var_mean_kernel_stub);
+
 at::Tensor mean_dim_impl(
     const at::Tensor& input,
     c10::OptionalIntArrayRef dim_opt,
     bool keepdim,
     c10::optional<c10::ScalarType> dtype) {
-  int64_t dim_prod = 1;
-  if (dim_opt.has_value()) {
-    auto dim = dim_opt.value();
-    if (dim.size() == 0 || input.ndimension() == 0) {
-      dim_prod = input.numel();
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::mean_dim_impl\n");
+#endif
+  RECORD_FUNCTION("torch_ipex::mean_dim_impl", c10::ArrayRef<c10::IValue>({}));
+
+  const auto out_dtype =
+      dtype.has_value() ? dtype.value() : input.scalar_type();
+  TORCH_CHECK(
+      at::isFloatingType(out_dtype) || at::isComplexType(out_dtype),
+      "mean(): could not infer output dtype. ",
+      (dtype.has_value() ? "Optional" : "Input"),
+      " dtype must be either a floating point or complex dtype. ",
+      "Got: ",
+      out_dtype);
+
+  at::DimVector dims_ = at::native::make_dim_vector(dim_opt, input.dim());
+  at::maybe_wrap_dims(dims_, input.dim());
+  auto shape = at::meta::get_reduction_shape(input, dims_, keepdim);
+  at::Tensor output = at::empty(shape, input.options().dtype(out_dtype));
+  if (output.numel() == 0) {
+    return output;
+  }
+  if (input.numel() == 0) {
+    return output.fill_(std::numeric_limits<double>::quiet_NaN());
+  }
+
+  auto iter = at::meta::make_reduction_from_out_ty(
+      input, output, dims_, keepdim, output.scalar_type());
+  if (reduce_prefers_contiguous_input(iter, input)) {
+    auto input_ = input.contiguous();
+    return at::mean(input_, dims_, keepdim, dtype);
+  }
+
+  const int64_t dim_prod = input.numel() / output.numel();
+  if (output.numel() == 1) {
+    // A full reduction is split between the threads and their partial results
+    // are reduced again by the same kernel, which would scale them twice
+    sum_kernel_stub(kCPU, iter);
+    return output.div_(dim_prod);
+  }
+  // The sum is divided by dim_prod as it's stored, in the same pass
+  mean_kernel_stub(kCPU, iter, 1.0 / dim_prod);
+  return output;
+}
+
+namespace {
+
+// Views self as [O, R, I] contiguous, R being the product of the reduced
+// dimensions. This works when the reduced dimensions are next to each other
+// in the memory order of self and the order of the kept ones matches that of
+// the output. Returns false otherwise.
+bool view_as_outer_reduced_inner(
+    const at::Tensor& self,
+    at::IntArrayRef dims,
+    at::Tensor& self_3d,
+    int64_t& O,
+    int64_t& R,
+    int64_t& I) {
+  const int64_t ndim = self.dim();
+  if (ndim == 0 || self.numel() == 0) {
+    return false;
+  }
+  std::vector<int64_t> perm(ndim);
+  std::iota(perm.begin(), perm.end(), 0);
+  if (!self.is_contiguous()) {
+    if (ndim == 4 && self.is_contiguous(at::MemoryFormat::ChannelsLast)) {
+      perm = {0, 2, 3, 1};
+    } else if (
+        ndim == 5 && self.is_contiguous(at::MemoryFormat::ChannelsLast3d)) {
+      perm = {0, 2, 3, 4, 1};
+    } else {
+      return false;
+    }
+  }
+
+  auto reduced = at::dim_list_to_bitset(dims, ndim);
+  if (dims.empty()) {
+    reduced.set();
+  }
+  // walk the dimensions with more than one element in memory order: kept
+  // ones before the reduced ones go to O and kept ones after them to I
+  O = 1;
+  R = 1;
+  I = 1;
+  bool after_reduced = false;
+  int64_t last_kept = -1;
+  for (const auto p : c10::irange(ndim)) {
+    const int64_t d = perm[p];
+    const int64_t size = self.size(d);
+    if (size == 1) {
+      continue;
+    }
+    if (reduced[d]) {
+      if (after_reduced) {
+        // a kept dimension between reduced ones
+        return false;
+      }
+      R *= size;
     } else {
-      for (auto d : dim) {
-        dim_prod *= input.size(d);
+      if (d < last_kept) {
+        return false;
+      }
+      last_kept = d;
+      if (R == 1 && !after_reduced) {
+        O *= size;
+      } else {
+        after_reduced = true;
+        I *= size;
       }
     }
   }
-  return at::sum(input, dim_opt, keepdim, dtype).div_(dim_prod);
+  self_3d = self.permute(perm).view({O, R, I});
+  return true;
+}
+
+std::tuple<at::Tensor, at::Tensor> var_mean_impl(
+    const at::Tensor& self,
+    at::OptionalIntArrayRef dim,
+    c10::optional<int64_t> correction,
+    bool keepdim,
+    bool take_sqrt,
+    bool with_mean) {
+  const auto dtype = self.scalar_type();
+  at::DimVector dims_ = at::native::make_dim_vector(dim, self.dim());
+  at::maybe_wrap_dims(dims_, self.dim());
+  at::Tensor self_3d;
+  int64_t O = 0;
+  int64_t R = 0;
+  int64_t I = 0;
+  if ((dtype != at::kFloat && dtype != at::kBFloat16 &&
+       dtype != at::kDouble) ||
+      !view_as_outer_reduced_inner(self, dims_, self_3d, O, R, I)) {
+    return std::make_tuple(at::Tensor(), at::Tensor());
+  }
+
+  auto shape = at::meta::get_reduction_shape(self, dims_, keepdim);
+  at::Tensor var = at::empty(shape, self.options());
+  at::Tensor mean = with_mean ? at::empty(shape, self.options()) : at::Tensor();
+  var_mean_kernel_stub(
+      kCPU,
+      self_3d,
+      O,
+      R,
+      I,
+      correction.value_or(1),
+      take_sqrt,
+      var,
+      mean);
+  return std::make_tuple(var, mean);
+}
+
+} // namespace
+
+at::Tensor var_correction_impl(
+    const at::Tensor& self,
+    at::OptionalIntArrayRef dim,
+    c10::optional<int64_t> correction,
+    bool keepdim) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::var_correction_impl\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::var_correction_impl", c10::ArrayRef<c10::IValue>({}));
+
+  auto result = var_mean_impl(self, dim, correction, keepdim, false, false);
+  if (!std::get<0>(result).defined()) {
+    return at::native::var(self, dim, correction, keepdim);
+  }
+  return std::get<0>(result);
+}
+
+at::Tensor std_correction_impl(
+    const at::Tensor& self,
+    at::OptionalIntArrayRef dim,
+    c10::optional<int64_t> correction,
+    bool keepdim) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::std_correction_impl\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::std_correction_impl", c10::ArrayRef<c10::IValue>({}));
+
+  auto result = var_mean_impl(self, dim, correction, keepdim, true, false);
+  if (!std::get<0>(result).defined()) {
+    return at::native::std(self, dim, correction, keepdim);
+  }
+  return std::get<0>(result);
+}
+
+std::tuple<at::Tensor, at::Tensor> var_mean_correction_impl(
+    const at::Tensor& self,
+    at::OptionalIntArrayRef dim,
+    c10::optional<int64_t> correction,
+    bool keepdim) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::var_mean_correction_impl\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::var_mean_correction_impl", c10::ArrayRef<c10::IValue>({}));
+
+  auto result = var_mean_impl(self, dim, correction, keepdim, false, true);
+  if (!std::get<0>(result).defined()) {
+    return at::native::var_mean(self, dim, correction, keepdim);
+  }
+  return result;
+}
+
+std::tuple<at::Tensor, at::Tensor> std_mean_correction_impl(
+    const at::Tensor& self,
+    at::OptionalIntArrayRef dim,
+    c10::optional<int64_t> correction,
+    bool keepdim) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::std_mean_correction_impl\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::std_mean_correction_impl", c10::ArrayRef<c10::IValue>({}));
+
+  auto result = var_mean_impl(self, dim, correction, keepdim, true, true);
+  if (!std::get<0>(result).defined()) {
+    return at::native::std_mean(self, dim, correction, keepdim);
+  }
+  return result;
 }
 
 IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
   m.impl(
       TORCH_SELECTIVE_NAME("aten::mean.dim"),
       TORCH_FN((&torch_ipex::cpu::mean_dim_impl)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::var.correction"),
+      TORCH_FN((&torch_ipex::cpu::var_correction_impl)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::std.correction"),
+      TORCH_FN((&torch_ipex::cpu::std_correction_impl)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::var_mean.correction"),
+      TORCH_FN((&torch_ipex::cpu::var_mean_correction_impl)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::std_mean.correction"),
+      TORCH_FN((&torch_ipex::cpu::std_mean_correction_impl)));
 }
 
 } // namespace cpu
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <ATen/Tensor.h>
+#include <ATen/native/TensorIterator.h>
+#include <csrc/dyndisp/DispatchStub.h>
 
 #include <vector>
 
@@ -13,5 +15,63 @@ at::Tensor mean_dim_impl(
     bool keepdim,
     c10::optional<at::ScalarType> dtype);
 
+at::Tensor var_correction_impl(
+    const at::Tensor& self,
+    at::OptionalIntArrayRef dim,
+    c10::optional<int64_t> correction,
+    bool keepdim);
+
+at::Tensor std_correction_impl(
+    const at::Tensor& self,
+    at::OptionalIntArrayRef dim,
+    c10::optional<int64_t> correction,
+    bool keepdim);
+
+std::tuple<at::Tensor, at::Tensor> var_mean_correction_impl(
+    const at::Tensor& self,
+    at::OptionalIntArrayRef dim,
+    c10::optional<int64_t> correction,
+    bool keepdim);
+
+std::tuple<at::Tensor, at::Tensor> std_mean_correction_impl(
+    const at::Tensor& self,
+    at::OptionalIntArrayRef dim,
+    c10::optional<int64_t> correction,
+    bool keepdim);
+
+namespace {
+
+void mean_kernel_impl(at::TensorIterator& iter, double scale);
+
+void var_mean_kernel_impl(
+    const at::Tensor& self,
+    int64_t O,
+    int64_t R,
+    int64_t I,
+    int64_t correction,
+    bool take_sqrt,
+    at::Tensor& var,
+    at::Tensor& mean);
+
+} // namespace
+
+// Sums the reduction of iter scaled by scale, in one pass over the input
+using mean_kernel_fn = void (*)(at::TensorIterator&, double);
+DECLARE_DISPATCH(mean_kernel_fn, mean_kernel_stub);
+
+// Reduces the contiguous self viewed as [O, R, I] over R. Writes the
+// variance, or the standard deviation when take_sqrt is set, of [O, I] to
+// var and the mean to mean unless it's undefined.
+using var_mean_kernel_fn = void (*)(
+    const at::Tensor&,
+    int64_t,
+    int64_t,
+    int64_t,
+    int64_t,
+    bool,
+    at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(var_mean_kernel_fn, var_mean_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
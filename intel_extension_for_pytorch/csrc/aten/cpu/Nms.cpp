@@ -13,6 +13,7 @@ namespace cpu {
 
 DEFINE_DISPATCH(nms_cpu_kernel_stub);
 DEFINE_DISPATCH(batch_score_nms_cpu_kernel_stub);
+DEFINE_DISPATCH(batch_decode_score_nms_cpu_kernel_stub);
 DEFINE_DISPATCH(rpn_nms_cpu_kernel_stub);
 DEFINE_DISPATCH(box_head_nms_cpu_kernel_stub);
 
@@ -67,6 +68,56 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> batch_score_nms(
   return result;
 }
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+batch_decode_score_nms(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const double scale_xy,
+    const double scale_wh,
+    const double score_threshold,
+    const double threshold,
+    const int64_t max_output) {
+#if defined(IPEX_DISP_OP)
+  printf("IpexExternal::batch_decode_score_nms\n");
+#endif
+  RECORD_FUNCTION(
+      "IpexExternal::batch_decode_score_nms", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_INTERNAL_ASSERT_DEBUG_ONLY(bboxes_in.layout() == c10::kStrided);
+  TORCH_INTERNAL_ASSERT_DEBUG_ONLY(scores_in.layout() == c10::kStrided);
+  TORCH_CHECK(
+      bboxes_in.dim() == 3 && bboxes_in.size(2) == 4,
+      "batch_decode_score_nms: bboxes_in should be [BS, number_boxes, 4]");
+  TORCH_CHECK(
+      scores_in.dim() == 3 && scores_in.size(0) == bboxes_in.size(0) &&
+          scores_in.size(1) == bboxes_in.size(1),
+      "batch_decode_score_nms: scores_in should be [BS, number_boxes, class_number]");
+  TORCH_CHECK(
+      dboxes_xywh.numel() == bboxes_in.size(1) * 4,
+      "batch_decode_score_nms: dboxes_xywh should be [1, number_boxes, 4]");
+  TORCH_CHECK(
+      max_output > 0, "batch_decode_score_nms: max_output should be positive");
+
+  /*
+  pointer to cpu::batch_decode_score_nms_cpu_kernel_impl(bboxes_in, scores_in,
+  dboxes_xywh, scale_xy, scale_wh, score_threshold, threshold, max_output);
+  */
+  auto&& result = cpu::batch_decode_score_nms_cpu_kernel_stub(
+      kCPU,
+      bboxes_in,
+      scores_in,
+      dboxes_xywh,
+      scale_xy,
+      scale_wh,
+      score_threshold,
+      threshold,
+      max_output);
+
+  static_cast<void>(result); // Avoid warnings in case not used
+  return result;
+}
+
 std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>> rpn_nms(
     const at::Tensor& batch_dets,
     const at::Tensor& batch_scores,
@@ -259,6 +310,8 @@ static auto dispatch =
     torch::RegisterOperators()
         .op("torch_ipex::nms", &torch_ipex::nms)
         .op("torch_ipex::batch_score_nms", &torch_ipex::batch_score_nms)
+        .op("torch_ipex::batch_decode_score_nms",
+            &torch_ipex::batch_decode_score_nms)
         .op("torch_ipex::rpn_nms", &torch_ipex::rpn_nms)
         .op("torch_ipex::box_head_nms", &torch_ipex::box_head_nms)
         .op("torch_ipex::parallel_scale_back_batch",
@@ -299,6 +352,32 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> batch_score_nms(
       max_output);
 }
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+batch_decode_score_nms(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const double scale_xy,
+    const double scale_wh,
+    const double score_threshold,
+    const double threshold,
+    const int64_t max_output) {
+  c10::impl::ExcludeDispatchKeyGuard no_autocastCPU(DispatchKey::AutocastCPU);
+  static auto op =
+      torch::Dispatcher::singleton()
+          .findSchemaOrThrow("torch_ipex::batch_decode_score_nms", "")
+          .typed<decltype(batch_decode_score_nms)>();
+  return op.call(
+      cpu_cached_cast(at::kFloat, bboxes_in),
+      cpu_cached_cast(at::kFloat, scores_in),
+      cpu_cached_cast(at::kFloat, dboxes_xywh),
+      scale_xy,
+      scale_wh,
+      score_threshold,
+      threshold,
+      max_output);
+}
+
 std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>> rpn_nms(
     const at::Tensor& batch_dets,
     const at::Tensor& batch_scores,
@@ -367,6 +446,8 @@ std::tuple<at::Tensor, at::Tensor> parallel_scale_back_batch(
 TORCH_LIBRARY_IMPL(torch_ipex, AutocastCPU, m) {
   m.impl("nms", torch_ipex::autocast::nms);
   m.impl("batch_score_nms", torch_ipex::autocast::batch_score_nms);
+  m.impl(
+      "batch_decode_score_nms", torch_ipex::autocast::batch_decode_score_nms);
   m.impl("rpn_nms", torch_ipex::autocast::rpn_nms);
   m.impl("box_head_nms", torch_ipex::autocast::box_head_nms);
   m.impl(
@@ -20,6 +20,17 @@ batch_score_nms_cpu_kernel_impl(
     const float threshold,
     const int max_output);
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+batch_decode_score_nms_cpu_kernel_impl(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const float scale_xy,
+    const float scale_wh,
+    const float score_threshold,
+    const float threshold,
+    const int max_output);
+
 std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>>
 rpn_nms_cpu_kernel_impl(
     const at::Tensor& batch_dets,
@@ -61,6 +72,20 @@ DECLARE_DISPATCH(
     batch_score_nms_cpu_kernel_fn,
     batch_score_nms_cpu_kernel_stub);
 
+using batch_decode_score_nms_cpu_kernel_fn =
+    std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> (*)(
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const float,
+        const float,
+        const float,
+        const float,
+        const int);
+DECLARE_DISPATCH(
+    batch_decode_score_nms_cpu_kernel_fn,
+    batch_decode_score_nms_cpu_kernel_stub);
+
 using rpn_nms_cpu_kernel_fn =
     std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>> (*)(
         const at::Tensor&,
@@ -130,6 +155,37 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> batch_score_nms(
     const double threshold,
     const int64_t max_output);
 
+/// \brief Perform the fused SSD post-processing: Softmax, score threshold,
+/// top-k, box decode and batch non-maximum suppression.
+///
+/// Fused version of parallel_scale_back_batch followed by batch_score_nms,
+/// each (image, class) is processed in a streaming fashion inside a single
+/// parallel region and only the boxes surviving the score threshold and top-k
+/// are decoded.
+///
+/// \param bboxes_in: predicted loc in xywh format, size [BS, number_boxes,
+/// 4], for example: [1, 15130, 4]. \param scores_in: predicted score before
+/// Softmax, size [BS, number_boxes, class_number], for example: [1, 15130,
+/// 81]. \param dboxes_xywh: default boxes (anchors) in xywh format, size [1,
+/// number_boxes, 4]. \param scale_xy: scale factor(scalar) of xy dimention
+/// for bboxes_in. \param scale_wh: scale factor(scalar) of wh dimention for
+/// bboxes_in. \param score_threshold: boxes with a score not larger than it
+/// are dropped before NMS. \param threshold: IOU threshold(scalar) to
+/// suppress bboxs which has the IOU val larger than the threshold. \param
+/// max_output: the max number of output bbox, also the top-k of each class.
+///
+/// \return the same as batch_score_nms.
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+batch_decode_score_nms(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const double scale_xy,
+    const double scale_wh,
+    const double score_threshold,
+    const double threshold,
+    const int64_t max_output);
+
 /// \brief Perform batch non-maximum suppression (NMS) for MaskRCNN RPN part.
 ///
 /// C++ version of batch NMS for MaskRCNN RPN part.
@@ -0,0 +1,155 @@
+#include "Pooling.h"
+
+#include <ATen/native/Pool.h>
+#include <ATen/record_function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(pooling_channels_last_kernel_stub);
+
+namespace {
+
+// Expands a 1 or `dims` element window parameter to {D, H, W}
+std::array<int64_t, 3> expand_window_param(
+    at::IntArrayRef param,
+    const char* name,
+    int64_t dims,
+    int64_t fill) {
+  TORCH_CHECK(
+      param.size() == 1 || static_cast<int64_t>(param.size()) == dims,
+      "pooling_channels_last: ",
+      name,
+      " must either be a single int, or a tuple of ",
+      dims,
+      " ints");
+  std::array<int64_t, 3> expanded = {fill, fill, fill};
+  for (int64_t i = 0; i < dims; i++) {
+    expanded[3 - dims + i] = param.size() == 1 ? param[0] : param[i];
+  }
+  return expanded;
+}
+
+} // namespace
+
+bool pooling_channels_last_supported(const at::Tensor& input) {
+  auto dtype = input.scalar_type();
+  return dtype == at::kFloat || dtype == at::kBFloat16 ||
+      dtype == at::kQUInt8 || dtype == at::kQInt8;
+}
+
+at::Tensor pooling_channels_last(
+    const at::Tensor& input,
+    at::IntArrayRef kernel_size,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    bool ceil_mode,
+    bool is_max,
+    bool count_include_pad,
+    c10::optional<int64_t> divisor_override,
+    bool fuse_relu,
+    c10::optional<at::ScalarType> output_qtype,
+    double output_scale,
+    int64_t output_zero_point) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::pooling_channels_last\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::pooling_channels_last", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      input.dim() == 4 || input.dim() == 5,
+      "pooling_channels_last: expected a 4D or 5D input, got ",
+      input.dim(),
+      "D");
+  TORCH_CHECK(
+      pooling_channels_last_supported(input),
+      "pooling_channels_last: unsupported dtype ",
+      input.scalar_type());
+  TORCH_CHECK(
+      !output_qtype.has_value() ||
+          (!input.is_quantized() &&
+           (*output_qtype == at::kQUInt8 || *output_qtype == at::kQInt8)),
+      "pooling_channels_last: only FP32 or BF16 inputs can be quantized to a ",
+      "QUInt8 or QInt8 output");
+  TORCH_CHECK(
+      !input.is_quantized() ||
+          input.qscheme() == at::kPerTensorAffine,
+      "pooling_channels_last: quantized inputs should be per tensor affine");
+  const int64_t dims = input.dim() - 2;
+
+  PoolingParams params;
+  params.kernel = expand_window_param(kernel_size, "kernel_size", dims, 1);
+  params.stride = stride.empty()
+      ? params.kernel
+      : expand_window_param(stride, "stride", dims, 1);
+  params.padding = expand_window_param(padding, "padding", dims, 0);
+  params.dilation = expand_window_param(dilation, "dilation", dims, 1);
+  params.is_max = is_max;
+  params.count_include_pad = count_include_pad;
+  params.divisor_override = divisor_override;
+  params.fuse_relu = fuse_relu;
+  TORCH_CHECK(
+      is_max ||
+          std::all_of(
+              params.dilation.cbegin(),
+              params.dilation.cend(),
+              [](int64_t i) { return 1 == i; }),
+      "pooling_channels_last: avg pooling does not support dilation");
+  TORCH_CHECK(
+      !divisor_override.has_value() || divisor_override.value() != 0,
+      "pooling_channels_last: divisor must be not zero");
+
+  std::vector<int64_t> output_size = {input.size(0), input.size(1)};
+  for (int64_t d = 3 - dims; d < 3; d++) {
+    const int64_t k = params.kernel[d];
+    const int64_t s = params.stride[d];
+    const int64_t p = params.padding[d];
+    const int64_t dil = params.dilation[d];
+    TORCH_CHECK(
+        k > 0 && s > 0 && dil > 0,
+        "pooling_channels_last: kernel_size, stride and dilation should be ",
+        "greater than zero");
+    TORCH_CHECK(
+        p <= ((k - 1) * dil + 1) / 2,
+        "pooling_channels_last: pad should be at most half of effective ",
+        "kernel size");
+    const int64_t output_dim = at::native::pooling_output_shape<int64_t>(
+        input.size(d - 1 + dims), k, p, s, dil, ceil_mode);
+    TORCH_CHECK(
+        output_dim > 0,
+        "pooling_channels_last: output size is too small for input ",
+        input.sizes());
+    output_size.push_back(output_dim);
+  }
+
+  auto memory_format = dims == 3 ? at::MemoryFormat::ChannelsLast3d
+                                 : at::MemoryFormat::ChannelsLast;
+  auto input_ = input.contiguous(memory_format);
+  at::Tensor output;
+  if (input_.is_quantized()) {
+    output = at::_empty_affine_quantized(
+        output_size,
+        input_.options().memory_format(memory_format),
+        input_.q_scale(),
+        input_.q_zero_point());
+  } else if (output_qtype.has_value()) {
+    output = at::_empty_affine_quantized(
+        output_size,
+        input_.options().dtype(*output_qtype).memory_format(memory_format),
+        output_scale,
+        output_zero_point);
+  } else {
+    output =
+        at::empty(output_size, input_.options().memory_format(memory_format));
+  }
+  if (output.numel() == 0) {
+    return output;
+  }
+  pooling_channels_last_kernel_stub(kCPU, output, input_, params);
+  return output;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <csrc/dyndisp/DispatchStub.h>
+
+#include <array>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Window of a channels last pooling, in {D, H, W} order. 2d pooling has a
+// depth of 1.
+struct PoolingParams {
+  std::array<int64_t, 3> kernel;
+  std::array<int64_t, 3> stride;
+  std::array<int64_t, 3> padding;
+  std::array<int64_t, 3> dilation;
+  bool is_max;
+  // avg pooling only
+  bool count_include_pad;
+  c10::optional<int64_t> divisor_override;
+  // applies the ReLU preceding the pooling to the input
+  bool fuse_relu;
+};
+
+// Max or avg pooling of an NHWC (2d) or NDHWC (3d) input into an output of
+// the same memory format, whose channels are reduced with vector loads.
+// Supports FP32, BF16, QUInt8 and QInt8 inputs:
+//  - a quantized input gives an output with the same quantization
+//    parameters, the window is reduced on the integer values;
+//  - an FP32 or BF16 input may be quantized per tensor into a QUInt8 or
+//    QInt8 output, fusing the quantize_per_tensor following the pooling.
+// Other inputs are made contiguous in the channels last format first.
+at::Tensor pooling_channels_last(
+    const at::Tensor& input,
+    at::IntArrayRef kernel_size,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    bool ceil_mode,
+    bool is_max,
+    bool count_include_pad = true,
+    c10::optional<int64_t> divisor_override = c10::nullopt,
+    bool fuse_relu = false,
+    c10::optional<at::ScalarType> output_qtype = c10::nullopt,
+    double output_scale = 1.0,
+    int64_t output_zero_point = 0);
+
+// Whether pooling_channels_last supports the dtype of input
+bool pooling_channels_last_supported(const at::Tensor& input);
+
+namespace {
+
+void pooling_channels_last_kernel_impl(
+    const at::Tensor& output,
+    const at::Tensor& input,
+    const PoolingParams& params);
+
+} // namespace
+
+using pooling_channels_last_kernel_fn =
+    void (*)(const at::Tensor&, const at::Tensor&, const PoolingParams&);
+DECLARE_DISPATCH(
+    pooling_channels_last_kernel_fn,
+    pooling_channels_last_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -63,13 +63,15 @@ inline void roi_align_single_framework_forward(
     const T* input,
     const ACC_T count,
     int channels,
+    int c_begin,
+    int c_end,
     int height,
     int width,
     int pooled_height,
     int pooled_width,
     int roi_bin_grid_h,
     int roi_bin_grid_w,
-    const std::vector<PreCalc<ACC_T>>& pre_calc,
+    const PreCalc<ACC_T>* pre_calc,
     T* output);
 
 template <typename T, typename ACC_T>
@@ -77,13 +79,15 @@ inline void roi_align_single_framework_channels_last_forward(
     const T* input,
     const ACC_T count,
     int channels,
+    int c_begin,
+    int c_end,
     int height,
     int width,
     int pooled_height,
     int pooled_width,
     int roi_bin_grid_h,
     int roi_bin_grid_w,
-    const std::vector<PreCalc<ACC_T>>& pre_calc,
+    const PreCalc<ACC_T>* pre_calc,
     T* output);
 
 template <>
@@ -93,13 +97,15 @@ inline void roi_align_single_framework_channels_last_forward<
     const at::BFloat16* input,
     const float count,
     int channels,
+    int c_begin,
+    int c_end,
     int height,
     int width,
     int pooled_height,
     int pooled_width,
     int roi_bin_grid_h,
     int roi_bin_grid_w,
-    const std::vector<PreCalc<float>>& pre_calc,
+    const PreCalc<float>* pre_calc,
     at::BFloat16* output);
 
 template <class T>
@@ -0,0 +1,160 @@
+#include "SparseLinear.h"
+
+#include <torch/csrc/autograd/function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(sparse_linear_kernel_stub);
+
+SparseLinearWeight sparse_linear_pack(const at::Tensor& weight) {
+  TORCH_CHECK(
+      weight.dim() == 2 && weight.scalar_type() == at::kFloat,
+      "sparse_linear_pack: expected a 2D FP32 weight");
+  auto weight_ = weight.contiguous();
+  const int64_t N = weight_.size(0);
+  const int64_t K = weight_.size(1);
+  const int64_t num_groups = (K + 3) / 4;
+  const float* w = weight_.data_ptr<float>();
+
+  // A group of 4 consecutive weights of a row is both a block of the block
+  // CSR layout and a group of the 2:4 layout
+  int64_t nnz_blocks = 0;
+  bool two_four = K % 4 == 0;
+  for (int64_t n = 0; n < N; n++) {
+    for (int64_t g = 0; g < num_groups; g++) {
+      int nnz = 0;
+      for (int64_t k = g * 4; k < std::min(g * 4 + 4, K); k++) {
+        nnz += w[n * K + k] != 0.f;
+      }
+      nnz_blocks += nnz > 0;
+      two_four = two_four && nnz <= 2;
+    }
+  }
+
+  SparseLinearWeight packed;
+  packed.out_features = N;
+  packed.in_features = K;
+  if (two_four && N * K / 2 < nnz_blocks * 4) {
+    packed.format = kTwoFour;
+    packed.values = at::zeros({N, K / 2}, at::kFloat);
+    packed.indices = at::zeros({N, K / 2}, at::kByte);
+    auto values = packed.values.data_ptr<float>();
+    auto indices = packed.indices.data_ptr<uint8_t>();
+    for (int64_t n = 0; n < N; n++) {
+      for (int64_t g = 0; g < num_groups; g++) {
+        // a group with less than 2 nonzeros is completed with zeros at
+        // the first positions
+        int64_t slot = n * K / 2 + g * 2;
+        int64_t num_slots = 0;
+        for (int64_t i = 0; i < 4 && num_slots < 2; i++) {
+          int64_t remaining_slots = 2 - num_slots;
+          int64_t remaining_weights = 4 - i;
+          if (w[n * K + g * 4 + i] != 0.f ||
+              remaining_weights == remaining_slots) {
+            values[slot + num_slots] = w[n * K + g * 4 + i];
+            indices[slot + num_slots] = i;
+            num_slots++;
+          }
+        }
+      }
+    }
+  } else {
+    packed.format = kBlockCSR;
+    packed.values = at::zeros({nnz_blocks, 4}, at::kFloat);
+    packed.indices = at::empty({nnz_blocks}, at::kInt);
+    packed.row_ptr = at::empty({N + 1}, at::kInt);
+    auto values = packed.values.data_ptr<float>();
+    auto indices = packed.indices.data_ptr<int32_t>();
+    auto row_ptr = packed.row_ptr.data_ptr<int32_t>();
+    int32_t b = 0;
+    for (int64_t n = 0; n < N; n++) {
+      row_ptr[n] = b;
+      for (int64_t g = 0; g < num_groups; g++) {
+        bool nonzero = false;
+        for (int64_t k = g * 4; k < std::min(g * 4 + 4, K); k++) {
+          nonzero = nonzero || w[n * K + k] != 0.f;
+        }
+        if (!nonzero) {
+          continue;
+        }
+        for (int64_t k = g * 4; k < std::min(g * 4 + 4, K); k++) {
+          values[b * 4 + k - g * 4] = w[n * K + k];
+        }
+        indices[b++] = g;
+      }
+    }
+    row_ptr[N] = b;
+  }
+  return packed;
+}
+
+at::Tensor sparse_linear_unpack(const SparseLinearWeight& weight) {
+  const int64_t N = weight.out_features;
+  const int64_t K = weight.in_features;
+  auto dense = at::zeros({N, K}, at::kFloat);
+  auto w = dense.data_ptr<float>();
+  auto values = weight.values.data_ptr<float>();
+  if (weight.format == kTwoFour) {
+    auto indices = weight.indices.data_ptr<uint8_t>();
+    for (int64_t n = 0; n < N; n++) {
+      for (int64_t i = 0; i < K / 2; i++) {
+        int64_t slot = n * K / 2 + i;
+        w[n * K + i / 2 * 4 + indices[slot]] = values[slot];
+      }
+    }
+  } else {
+    auto indices = weight.indices.data_ptr<int32_t>();
+    auto row_ptr = weight.row_ptr.data_ptr<int32_t>();
+    for (int64_t n = 0; n < N; n++) {
+      for (int32_t b = row_ptr[n]; b < row_ptr[n + 1]; b++) {
+        int64_t k0 = static_cast<int64_t>(indices[b]) * 4;
+        for (int64_t k = k0; k < std::min(k0 + 4, K); k++) {
+          w[n * K + k] = values[b * 4 + k - k0];
+        }
+      }
+    }
+  }
+  return dense;
+}
+
+double sparse_linear_work_ratio(const SparseLinearWeight& weight) {
+  auto dense_work = weight.out_features * weight.in_features;
+  return dense_work == 0
+      ? 1.0
+      : static_cast<double>(weight.values.numel()) / dense_work;
+}
+
+at::Tensor sparse_linear_kernel(
+    const at::Tensor& input,
+    const SparseLinearWeight& weight,
+    const at::Tensor& bias,
+    int64_t post_op) {
+  const int64_t K = weight.in_features;
+  TORCH_CHECK(
+      input.dim() >= 1 && input.size(-1) == K,
+      "Check the shapes of mat1 and mat2, they cannot be multiplied!");
+  TORCH_CHECK(
+      input.scalar_type() == at::kFloat,
+      "sparse_linear: expected an FP32 input");
+  auto input_ = input.contiguous();
+  auto output_size = input_.sizes().vec();
+  output_size.back() = weight.out_features;
+  auto output = at::empty(output_size, input_.options());
+  if (output.numel() == 0) {
+    return output;
+  }
+  auto input_2d = input_.view({-1, K});
+  auto output_2d = output.view({-1, weight.out_features});
+  sparse_linear_kernel_stub(
+      kCPU,
+      input_2d,
+      weight,
+      bias.defined() ? bias.contiguous() : bias,
+      post_op,
+      output_2d);
+  return output;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <csrc/dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// The compressed layouts of a sparse linear weight of [N, K].
+enum SparseLinearFormat : int64_t {
+  // CSR over blocks of 4 consecutive weights of a row. values holds the
+  // blocks with at least one nonzero [nnz_blocks, 4], indices their block
+  // column (int32) and row_ptr the first block of each row (int32, N + 1).
+  // The last block of a row is zero-padded when K is not a multiple of 4.
+  kBlockCSR = 0,
+  // At most 2 nonzeros in every group of 4 consecutive weights of a row.
+  // values holds 2 weights per group [N, K / 2] and indices their position
+  // in the group (uint8).
+  kTwoFour = 1,
+};
+
+// The eltwise ops fused into the sparse linear kernel
+enum SparseLinearPostOp : int64_t {
+  kSparseLinearNone = 0,
+  kSparseLinearRelu = 1,
+  kSparseLinearGelu = 2,
+};
+
+struct SparseLinearWeight {
+  int64_t format;
+  int64_t out_features;
+  int64_t in_features;
+  at::Tensor values;
+  at::Tensor indices;
+  at::Tensor row_ptr;
+};
+
+/**
+ * Compresses a 2D FP32 linear weight. The 2:4 layout is used when the
+ * weight fits it and it does less work than the block CSR one.
+ */
+SparseLinearWeight sparse_linear_pack(const at::Tensor& weight);
+
+// Returns the dense weight of a compressed one
+at::Tensor sparse_linear_unpack(const SparseLinearWeight& weight);
+
+// The fraction of the dense multiply-adds the compressed weight does
+double sparse_linear_work_ratio(const SparseLinearWeight& weight);
+
+/**
+ * FP32 linear with a compressed weight, the bias and the post op are applied
+ * in the kernel epilogue.
+ *
+ *@param input Activation input of [*, in_features]
+ *@param weight Compressed weight
+ *@param bias Bias of [out_features], undefined for no bias
+ *@param post_op One of SparseLinearPostOp
+ */
+at::Tensor sparse_linear_kernel(
+    const at::Tensor& input,
+    const SparseLinearWeight& weight,
+    const at::Tensor& bias,
+    int64_t post_op);
+
+namespace {
+
+void sparse_linear_kernel_impl(
+    const at::Tensor& input,
+    const SparseLinearWeight& weight,
+    const at::Tensor& bias,
+    int64_t post_op,
+    at::Tensor& output);
+
+} // namespace
+
+using sparse_linear_kernel_fn = void (*)(
+    const at::Tensor&,
+    const SparseLinearWeight&,
+    const at::Tensor&,
+    int64_t,
+    at::Tensor&);
+DECLARE_DISPATCH(sparse_linear_kernel_fn, sparse_linear_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -15,6 +15,35 @@ namespace cpu {
 
 DEFINE_DISPATCH(sum_kernel_stub);
 
+bool reduce_prefers_contiguous_input(
+    at::TensorIterator& iter,
+    const at::Tensor& input) {
+  // These non-contiguous shapes cannot go through vectorized path directly,
+  // but can enter the existing vectorized path after converting to contiguous
+  // and the contiguous overhead is less than the benefits of vectorized
+  // computation.
+  auto indtype = iter.dtype();
+  if (c10::isFloatingType(indtype) && !input.is_contiguous()) {
+    auto in_shapes = iter.shape();
+    auto in_strides = iter.strides(1);
+    int typesize = iter.input_base().element_size();
+    // We assume it will run on isa supporting AVX512. 64 = 512 / 8
+    int vecsize = 64 / typesize;
+    // To enter the vectorized path, the strides and shapes should satisfy:
+    // (in_strides[0] == typesize && in_shapes[0] >= vecsize) or
+    // (in_strides[1] == typesize && in_shapes[1] >= vecsize).
+    // If we can find an i(i>=2) that satisfies the condition
+    // "in_strides[i] == typesize && in_shapes[i] >= vecsize", it will
+    // enter the vectorized path after converting the inputs to contiguous.
+    for (int i = 2; i < in_shapes.size(); i++) {
+      if (in_strides[i] == typesize && in_shapes[i] >= vecsize) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 at::Tensor sum_out_cpu(
     const at::Tensor& input,
     c10::OptionalIntArrayRef opt_dims,
@@ -43,31 +72,12 @@ at::Tensor sum_out_cpu(
       input, output, dims_, keepdim, output.scalar_type());
 
   // This is a workaround for poor performance on some non-contiguous shapes.
-  // These non-contiguous shapes cannot go through vectorized path directly,
-  // but can enter the existing vectorized path after converting to contiguous
-  // and the contiguous overhead is less than the benefits of vectorized
-  // computation. In the future, we need to break the assumption that the output
-  // of reduce_sum is always contiguous to improve the sum kernel for these
+  // In the future, we need to break the assumption that the output of
+  // reduce_sum is always contiguous to improve the sum kernel for these
   // cases.
-  auto indtype = iter.dtype();
-  if (c10::isFloatingType(indtype) && !input.is_contiguous()) {
-    auto in_shapes = iter.shape();
-    auto in_strides = iter.strides(1);
-    int typesize = iter.input_base().element_size();
-    // We assume it will run on isa supporting AVX512. 64 = 512 / 8
-    int vecsize = 64 / typesize;
-    // To enter the vectorized path, the strides and shapes should satisfy:
-    // (in_strides[0] == typesize && in_shapes[0] >= vecsize) or
-    // (in_strides[1] == typesize && in_shapes[1] >= vecsize).
-    // If we can find an i(i>=2) that satisfies the condition
-    // "in_strides[i] == typesize && in_shapes[i] >= vecsize", it will
-    // enter the vectorized path after converting the inputs to contiguous.
-    for (int i = 2; i < in_shapes.size(); i++) {
-      if (in_strides[i] == typesize && in_shapes[i] >= vecsize) {
-        auto input_ = input.contiguous();
-        return at::sum(input_, dims_, keepdim, dtype);
-      }
-    }
+  if (reduce_prefers_contiguous_input(iter, input)) {
+    auto input_ = input.contiguous();
+    return at::sum(input_, dims_, keepdim, dtype);
   }
 
   if (iter.numel() == 0) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ATen/Tensor.h>
+#include <ATen/native/TensorIterator.h>
 #include <csrc/dyndisp/DispatchStub.h>
 
 namespace torch_ipex {
@@ -15,6 +16,14 @@ void sum_kernel_impl(at::TensorIterator& iter);
 using sum_kernel_fn = void (*)(at::TensorIterator&);
 DECLARE_DISPATCH(sum_kernel_fn, sum_kernel_stub);
 
+// The vectorized reduction paths need the reduced or the kept dimensions to
+// be contiguous. Returns true when a non-contiguous floating input would only
+// reach them once converted to contiguous, which costs less than reducing it
+// with the scalar paths.
+bool reduce_prefers_contiguous_input(
+    at::TensorIterator& iter,
+    const at::Tensor& input);
+
 at::Tensor sum_out_cpu(
     const at::Tensor& input,
     c10::OptionalIntArrayRef dim,
@@ -1,4 +1,5 @@
 #include <ATen/ATen.h>
+#include <ATen/CPUFunctions.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/MemoryOverlap.h>
 #include <ATen/NativeFunctions.h>
@@ -28,6 +29,7 @@ namespace cpu {
 
 DEFINE_DISPATCH(index_select_contig_stub);
 DEFINE_DISPATCH(copy_stub);
+DEFINE_DISPATCH(index_add_kernel_stub);
 
 at::Tensor& index_select_out_cpu_(
     const at::Tensor& self,
@@ -252,6 +254,225 @@ at::Tensor index_select_cpu_(
   return index_select_out_cpu_(self, dim, index, result);
 }
 
+namespace {
+
+bool no_overlap(const at::Tensor& a, const at::Tensor& b) {
+  return at::get_overlap_status(a, b) == at::MemOverlapStatus::No;
+}
+
+// Whether accumulating source into self along dim can go to
+// index_add_kernel_stub, which handles FP32 and BF16 with a 1D index and
+// expects a contiguous self. The other cases, including the invalid ones,
+// are left to the ATen kernels.
+bool use_index_add_kernel(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source) {
+  const auto st = self.scalar_type();
+  if ((st != at::kFloat && st != at::kBFloat16) ||
+      source.scalar_type() != st || self.dim() == 0 ||
+      source.dim() != self.dim() || index.dim() > 1 ||
+      (index.scalar_type() != at::kLong && index.scalar_type() != at::kInt)) {
+    return false;
+  }
+  for (const auto d : c10::irange(self.dim())) {
+    if (source.size(d) != (d == dim ? index.numel() : self.size(d))) {
+      return false;
+    }
+  }
+  // the engine sorts 32 bits keys and positions
+  const int64_t max_value = std::numeric_limits<int32_t>::max();
+  return self.size(dim) < max_value && index.numel() < max_value &&
+      no_overlap(self, source) && no_overlap(self, index);
+}
+
+// A scatter_add whose index is a vector along dim broadcast to the shape of
+// src, i.e. index.expand_as(src) with src matching self outside of dim, adds
+// whole slices like index_add. Returns that vector, or an undefined tensor
+// for the other indices.
+at::Tensor scatter_index_as_vector(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src) {
+  if (self.dim() == 0 || index.dim() != self.dim() ||
+      src.sizes() != index.sizes()) {
+    return at::Tensor();
+  }
+  for (const auto d : c10::irange(self.dim())) {
+    if (d != dim &&
+        (index.size(d) != self.size(d) ||
+         (index.size(d) != 1 && index.stride(d) != 0))) {
+      return at::Tensor();
+    }
+  }
+  return index.as_strided({index.size(dim)}, {index.stride(dim)});
+}
+
+} // namespace
+
+at::Tensor& index_add_out_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha,
+    at::Tensor& result) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::index_add_out_cpu_\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::index_add_out_cpu_", c10::ArrayRef<c10::IValue>({}));
+
+  dim = at::maybe_wrap_dim(dim, self.dim());
+  if (!use_index_add_kernel(self, dim, index, source) ||
+      result.scalar_type() != self.scalar_type()) {
+    return at::cpu::index_add_outf(self, dim, index, source, alpha, result);
+  }
+  at::native::resize_output(result, self.sizes());
+  if (!result.is_contiguous() ||
+      !(result.is_same(self) || no_overlap(result, self)) ||
+      !no_overlap(result, source) || !no_overlap(result, index)) {
+    return at::cpu::index_add_outf(self, dim, index, source, alpha, result);
+  }
+  if (!result.is_same(self)) {
+    result.copy_(self);
+  }
+  index_add_kernel_stub(
+      kCPU, result, dim, index.contiguous(), source, alpha.to<float>(), false);
+  return result;
+}
+
+at::Tensor& index_add_cpu__(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::index_add_cpu__\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::index_add_cpu__", c10::ArrayRef<c10::IValue>({}));
+
+  dim = at::maybe_wrap_dim(dim, self.dim());
+  if (!self.is_contiguous() ||
+      !use_index_add_kernel(self, dim, index, source)) {
+    return at::cpu::index_add_(self, dim, index, source, alpha);
+  }
+  index_add_kernel_stub(
+      kCPU, self, dim, index.contiguous(), source, alpha.to<float>(), false);
+  return self;
+}
+
+at::Tensor index_add_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::index_add_cpu_\n");
+#endif
+  RECORD_FUNCTION("torch_ipex::index_add_cpu_", c10::ArrayRef<c10::IValue>({}));
+
+  dim = at::maybe_wrap_dim(dim, self.dim());
+  if (!use_index_add_kernel(self, dim, index, source)) {
+    return at::cpu::index_add(self, dim, index, source, alpha);
+  }
+  auto result = self.clone(at::MemoryFormat::Contiguous);
+  index_add_kernel_stub(
+      kCPU, result, dim, index.contiguous(), source, alpha.to<float>(), false);
+  return result;
+}
+
+at::Tensor& scatter_add_out_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src,
+    at::Tensor& result) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::scatter_add_out_cpu_\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::scatter_add_out_cpu_", c10::ArrayRef<c10::IValue>({}));
+
+  dim = at::maybe_wrap_dim(dim, self.dim());
+  auto index_vector = scatter_index_as_vector(self, dim, index, src);
+  if (!index_vector.defined() || index.scalar_type() != at::kLong) {
+    return at::cpu::scatter_add_outf(self, dim, index, src, result);
+  }
+  return index_add_out_cpu_(self, dim, index_vector, src, 1, result);
+}
+
+at::Tensor& scatter_add_cpu__(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::scatter_add_cpu__\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::scatter_add_cpu__", c10::ArrayRef<c10::IValue>({}));
+
+  dim = at::maybe_wrap_dim(dim, self.dim());
+  auto index_vector = scatter_index_as_vector(self, dim, index, src);
+  if (!index_vector.defined() || index.scalar_type() != at::kLong) {
+    return at::cpu::scatter_add_(self, dim, index, src);
+  }
+  return index_add_cpu__(self, dim, index_vector, src, 1);
+}
+
+at::Tensor scatter_add_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::scatter_add_cpu_\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::scatter_add_cpu_", c10::ArrayRef<c10::IValue>({}));
+
+  dim = at::maybe_wrap_dim(dim, self.dim());
+  auto index_vector = scatter_index_as_vector(self, dim, index, src);
+  if (!index_vector.defined() || index.scalar_type() != at::kLong) {
+    return at::cpu::scatter_add(self, dim, index, src);
+  }
+  return index_add_cpu_(self, dim, index_vector, src, 1);
+}
+
+at::Tensor& index_put_impl_cpu_(
+    at::Tensor& self,
+    const c10::List<c10::optional<at::Tensor>>& indices,
+    const at::Tensor& values,
+    bool accumulate,
+    bool unsafe) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::index_put_impl_cpu_\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::index_put_impl_cpu_", c10::ArrayRef<c10::IValue>({}));
+
+  // self[index] += values with a single integer index on the first dim and
+  // values of [index.numel(), *self.shape[1:]] is an index_add along dim 0
+  if (accumulate && indices.size() == 1) {
+    c10::optional<at::Tensor> index = indices.get(0);
+    if (index.has_value() && index->defined() && index->dim() == 1 &&
+        index->scalar_type() == at::kLong && self.is_contiguous() &&
+        use_index_add_kernel(self, 0, *index, values)) {
+      index_add_kernel_stub(
+          kCPU, self, 0, index->contiguous(), values, 1.f, true);
+      return self;
+    }
+  }
+  return at::native::_index_put_impl_(
+      self, indices, values, accumulate, unsafe);
+}
+
 IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
   m.impl(
       TORCH_SELECTIVE_NAME("aten::index_select"),
@@ -259,6 +480,27 @@ IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
   m.impl(
       TORCH_SELECTIVE_NAME("aten::index_select.out"),
       TORCH_FN((&torch_ipex::cpu::index_select_out_cpu_)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::index_add"),
+      TORCH_FN((&torch_ipex::cpu::index_add_cpu_)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::index_add_"),
+      TORCH_FN((&torch_ipex::cpu::index_add_cpu__)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::index_add.out"),
+      TORCH_FN((&torch_ipex::cpu::index_add_out_cpu_)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::scatter_add"),
+      TORCH_FN((&torch_ipex::cpu::scatter_add_cpu_)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::scatter_add_"),
+      TORCH_FN((&torch_ipex::cpu::scatter_add_cpu__)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::scatter_add.out"),
+      TORCH_FN((&torch_ipex::cpu::scatter_add_out_cpu_)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::_index_put_impl_"),
+      TORCH_FN((&torch_ipex::cpu::index_put_impl_cpu_)));
 }
 
 } // namespace cpu
@@ -18,6 +18,54 @@ at::Tensor index_select_cpu_(
     int64_t dim,
     const at::Tensor& index);
 
+at::Tensor& index_add_out_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha,
+    at::Tensor& result);
+
+at::Tensor& index_add_cpu__(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha);
+
+at::Tensor index_add_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha);
+
+at::Tensor& scatter_add_out_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src,
+    at::Tensor& result);
+
+at::Tensor& scatter_add_cpu__(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src);
+
+at::Tensor scatter_add_cpu_(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& src);
+
+at::Tensor& index_put_impl_cpu_(
+    at::Tensor& self,
+    const c10::List<c10::optional<at::Tensor>>& indices,
+    const at::Tensor& values,
+    bool accumulate,
+    bool unsafe);
+
 namespace {
 
 void index_select_contig_kernel(
@@ -28,6 +76,14 @@ void index_select_contig_kernel(
 
 void copy_kernel(at::TensorIterator& iter, bool /*non_blocking*/);
 
+void index_add_kernel_impl(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    float alpha,
+    bool wrap_negative);
+
 } // namespace
 
 using index_select_fn =
@@ -37,5 +93,18 @@ DECLARE_DISPATCH(index_select_fn, index_select_contig_stub);
 using copy_fn = void (*)(at::TensorIterator&, bool non_blocking);
 DECLARE_DISPATCH(copy_fn, copy_stub);
 
+// self[O, D, I] contiguous FP32 or BF16, index 1D contiguous int32 or int64
+// of N entries, source[O, N, I] of the dtype of self. Accumulates
+// alpha * source along dim into self, negative indices are wrapped when
+// wrap_negative is set.
+using index_add_fn = void (*)(
+    at::Tensor&,
+    int64_t,
+    const at::Tensor&,
+    const at::Tensor&,
+    float,
+    bool);
+DECLARE_DISPATCH(index_add_fn, index_add_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
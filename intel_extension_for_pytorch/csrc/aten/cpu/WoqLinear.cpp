@@ -0,0 +1,151 @@
+#include "WoqLinear.h"
+
+#include <torch/all.h>
+
+#include "csrc/jit/cpu/kernels/OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(woq_linear_gemv_kernel_stub);
+
+WoqLinearWeight woq_linear_pack(
+    const at::Tensor& weight,
+    int64_t bits,
+    int64_t group_size) {
+  TORCH_CHECK(
+      weight.dim() == 2 &&
+          (weight.scalar_type() == at::kFloat ||
+           weight.scalar_type() == at::kBFloat16),
+      "woq_linear_pack: expected a 2D FP32 or BF16 weight");
+  TORCH_CHECK(
+      bits == 8 || bits == 4,
+      "woq_linear_pack: bits should be 8 or 4, got ",
+      bits);
+  const int64_t N = weight.size(0);
+  const int64_t K = weight.size(1);
+  if (group_size <= 0 || group_size > K) {
+    group_size = K;
+  }
+  TORCH_CHECK(
+      K > 0 && K % group_size == 0,
+      "woq_linear_pack: group_size ",
+      group_size,
+      " should divide in_features ",
+      K);
+  const int64_t num_groups = K / group_size;
+
+  // symmetric quantization to [-qmax, qmax]
+  const double qmax = bits == 8 ? 127. : 7.;
+  auto w = weight.to(at::kFloat).contiguous().view({N, num_groups, group_size});
+  auto scales = w.abs().amax(-1, true).div_(qmax);
+  // all-zero groups keep a scale of 0 and quantize to 0
+  auto q = w.div(scales.masked_fill(scales == 0, 1))
+               .round_()
+               .clamp_(-qmax, qmax)
+               .view({N, K});
+
+  WoqLinearWeight packed;
+  packed.bits = bits;
+  packed.group_size = group_size;
+  packed.out_features = N;
+  packed.in_features = K;
+  packed.scales = scales.view({N, num_groups}).contiguous();
+  if (bits == 8) {
+    packed.qweight = q.to(at::kChar).contiguous();
+  } else {
+    auto q_offset = q.add(8).to(at::kByte);
+    if (K % 2 != 0) {
+      // padded with a zero weight
+      q_offset =
+          at::cat({q_offset, at::full({N, 1}, 8, q_offset.options())}, 1);
+    }
+    auto low = q_offset.slice(1, 0, q_offset.size(1), 2);
+    auto high = q_offset.slice(1, 1, q_offset.size(1), 2);
+    packed.qweight = low.add(high.mul(16)).contiguous();
+  }
+  return packed;
+}
+
+at::Tensor woq_linear_unpack(const WoqLinearWeight& weight) {
+  const int64_t N = weight.out_features;
+  const int64_t K = weight.in_features;
+  at::Tensor q;
+  if (weight.bits == 8) {
+    q = weight.qweight.to(at::kFloat);
+  } else {
+    auto low = weight.qweight.bitwise_and(0xf);
+    auto high = weight.qweight.__rshift__(4);
+    q = at::stack({low, high}, -1)
+            .view({N, -1})
+            .narrow(1, 0, K)
+            .to(at::kFloat)
+            .sub_(8);
+  }
+  return q.reshape({N, K / weight.group_size, weight.group_size})
+      .mul_(weight.scales.unsqueeze(-1))
+      .view({N, K});
+}
+
+at::Tensor woq_linear_kernel(
+    const at::Tensor& input,
+    const WoqLinearWeight& weight,
+    const at::Tensor& bias) {
+  const int64_t K = weight.in_features;
+  TORCH_CHECK(
+      input.dim() >= 1 && input.size(-1) == K,
+      "Check the shapes of mat1 and mat2, they cannot be multiplied!");
+  TORCH_CHECK(
+      input.scalar_type() == at::kFloat ||
+          input.scalar_type() == at::kBFloat16,
+      "woq_linear: expected an FP32 or BF16 input");
+  auto input_ = input.contiguous();
+  auto output_size = input_.sizes().vec();
+  output_size.back() = weight.out_features;
+  const int64_t M = input_.numel() / K;
+  if (M == 0) {
+    return at::empty(output_size, input_.options());
+  }
+
+  if (M > kWoqGemvMaxRows) {
+    // compute bound, the weight is dequantized once for all the rows and the
+    // dense GEMM does the work
+    auto dense_weight = woq_linear_unpack(weight).to(input.scalar_type());
+    return at::linear(
+        input_,
+        dense_weight,
+        bias.defined() ? bias.to(input.scalar_type()) : bias);
+  }
+
+  // the few activation rows are converted to FP32 up front, the kernel reads
+  // them once per output feature
+  auto input_2d = input_.view({M, K}).to(at::kFloat);
+  auto output = at::empty({M, weight.out_features}, input_2d.options());
+  woq_linear_gemv_kernel_stub(kCPU, input_2d, weight, bias, output);
+  return output.to(input.scalar_type()).view(output_size);
+}
+
+at::Tensor ipex_woq_linear(
+    const at::Tensor& input,
+    const at::Tensor& op_context) {
+  RECORD_FUNCTION("ipex_woq_linear", c10::ArrayRef<c10::IValue>({}));
+
+  return reinterpret_cast<IpexWoqLinearOpContext*>(
+             op_context.data_ptr<int64_t>()[0])
+      ->run(input);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def("ipex_woq_linear(Tensor input, Tensor W_prepack) -> Tensor");
+  m.impl(
+      "ipex_woq_linear",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::ipex_woq_linear);
+}
+
+} // namespace
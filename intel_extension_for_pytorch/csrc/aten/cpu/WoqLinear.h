@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <csrc/dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Inputs with up to this many rows take the fused dequantize GEMV kernel,
+// larger ones dequantize the weight once and run the dense GEMM.
+constexpr int64_t kWoqGemvMaxRows = 16;
+
+// A linear weight of [N, K] quantized symmetrically to int8 or int4, with
+// one FP32 scale per group of group_size consecutive weights of a row.
+// group_size is K for per-channel quantization.
+struct WoqLinearWeight {
+  int64_t bits;
+  int64_t group_size;
+  int64_t out_features;
+  int64_t in_features;
+  // int8: [N, K] of int8. int4: [N, (K + 1) / 2] of uint8, weight k of a row
+  // in the low nibble of byte k / 2 when k is even and in the high one when
+  // it's odd, stored with an offset of 8.
+  at::Tensor qweight;
+  // [N, K / group_size] of FP32
+  at::Tensor scales;
+};
+
+/**
+ * Quantizes a 2D FP32 or BF16 linear weight.
+ *
+ *@param weight Weight of [out_features, in_features]
+ *@param bits 8 or 4
+ *@param group_size Number of weights of a row sharing a scale, it has to
+ * divide in_features. 0 or less for per-channel quantization.
+ */
+WoqLinearWeight woq_linear_pack(
+    const at::Tensor& weight,
+    int64_t bits,
+    int64_t group_size);
+
+// Returns the dequantized FP32 weight of a quantized one
+at::Tensor woq_linear_unpack(const WoqLinearWeight& weight);
+
+/**
+ * Linear with a weight-only quantized weight. The activations and the output
+ * are FP32 or BF16, the accumulation is done in FP32.
+ *
+ *@param input Activation input of [*, in_features]
+ *@param weight Quantized weight
+ *@param bias FP32 bias of [out_features], undefined for no bias
+ */
+at::Tensor woq_linear_kernel(
+    const at::Tensor& input,
+    const WoqLinearWeight& weight,
+    const at::Tensor& bias);
+
+namespace {
+
+void woq_linear_gemv_kernel_impl(
+    const at::Tensor& input,
+    const WoqLinearWeight& weight,
+    const at::Tensor& bias,
+    at::Tensor& output);
+
+} // namespace
+
+using woq_linear_gemv_kernel_fn = void (*)(
+    const at::Tensor&,
+    const WoqLinearWeight&,
+    const at::Tensor&,
+    at::Tensor&);
+DECLARE_DISPATCH(woq_linear_gemv_kernel_fn, woq_linear_gemv_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -56,6 +56,10 @@ inline std::vector<int64_t> _adjust_strides(
  * @brief Fuse the div (div scalar or mul 1/scalar) add operator and softmax
  * operator. softmax(alpah * a + b)
  *
+ * Each row is read twice and written once: an online softmax pass computes
+ * its max and sum of exp, then the normalization pass recomputes a + b while
+ * the rows are still in cache and writes the output.
+ *
  * @attention
  * There are some assumptions for this operator.
  * - The reduce dimension for softmax is the last dimension
@@ -111,10 +115,9 @@ at::Tensor dil_div_add_softmax(
 
   int64_t outer_dims_num = outer_size_per_dim.size();
   at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
-    float val = 0.0;
+    float max = 0.0;
+    float sum = 0.0;
     int64_t b_offset = 0;
-    at::Tensor tmp_out = at::empty({dim_size});
-    float* tmp_out_ptr = tmp_out.data_ptr<float>();
     for (int64_t i = begin; i < end; i++) {
       if (need_broadcast) {
         b_offset =
@@ -122,26 +125,13 @@ at::Tensor dil_div_add_softmax(
       } else {
         b_offset = i * dim_size;
       }
-      // Add a and b and get the maximum value:
-      //    output_data = a + b
-      //    val = max(output_data)
-      _dil_div_add_reduce_max_fusion_kernel<scalar_t>(
-          a_data_base + i * dim_size,
-          b_data_base + b_offset,
-          dim_per_head,
-          dim_size,
-          tmp_out_ptr,
-          val);
-      // Calculate the e^x and get the sum value:
-      //    output_data = output_data - max(output_data)
-      //    output_data = e^(output_data)
-      //    val = sum(output_data)
-      _dil_exp_reduce_sum_fusion_kernel(
-          tmp_out_ptr, dim_size, tmp_out_ptr, val);
-      // Calculat the normalization [e^x / sum(e^x)]:
-      //    output_data = output_data / sum(output_data)
-      _dil_normalization_kernel<scalar_t>(
-          tmp_out_ptr, val, dim_size, output_data_base + i * dim_size);
+      _DivAddScore<scalar_t> score(
+          a_data_base + i * dim_size, b_data_base + b_offset, dim_per_head);
+      // max and sum of e^(x - max) of x = a / dim_per_head + b
+      _dil_online_softmax_reduce_kernel(score, dim_size, max, sum);
+      // output_data = e^(x - max) / sum
+      _dil_online_softmax_normalize_kernel(
+          score, dim_size, max, sum, output_data_base + i * dim_size);
     }
   });
   return output;
@@ -199,7 +189,8 @@ at::Tensor& dil_add_softmax_(at::Tensor& a, const at::Tensor& b) {
 
   int64_t outer_dims_num = outer_size_per_dim.size();
   at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
-    float val = 0.0;
+    float max = 0.0;
+    float sum = 0.0;
     int64_t b_offset = 0;
     for (int64_t i = begin; i < end; i++) {
       if (need_broadcast) {
@@ -208,33 +199,14 @@ at::Tensor& dil_add_softmax_(at::Tensor& a, const at::Tensor& b) {
       } else {
         b_offset = i * dim_size;
       }
-      // Add a and b and get the maximum value:
-      //    output_data = a + b
-      //    val = max(output_data)
-      _dil_add_reduce_max_fusion_kernel(
-          a_data_base + i * dim_size,
-          b_data_base + b_offset,
-          dim_size,
-          a_data_base + i * dim_size,
-          val);
-      // Calculate the e^x and get the sum value:
-      //    output_data = output_data - max(output_data)
-      //    output_data = e^(output_data)
-      //    val = sum(output_data)
-
-      _dil_exp_reduce_sum_fusion_kernel(
-          a_data_base + i * dim_size,
-          dim_size,
-          a_data_base + i * dim_size,
-          val);
-      // Calculat the normalization [e^x / sum(e^x)]:
-      //  output_data = output_data / sum(output_data)
-
-      _dil_normalization_kernel<float>(
-          a_data_base + i * dim_size,
-          val,
-          dim_size,
-          a_data_base + i * dim_size);
+      _DivAddScore<float> score(
+          a_data_base + i * dim_size, b_data_base + b_offset, 1.0f);
+      // max and sum of e^(x - max) of x = a + b
+      _dil_online_softmax_reduce_kernel(score, dim_size, max, sum);
+      // a = e^(x - max) / sum, each chunk of a is read before it is
+      // overwritten
+      _dil_online_softmax_normalize_kernel(
+          score, dim_size, max, sum, a_data_base + i * dim_size);
     }
   });
   return a;
@@ -0,0 +1,399 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
+
+#include <csrc/aten/cpu/BatchNorm.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using Vec = at::vec::Vectorized<float>;
+
+// Rows of [M, C] reduced by a task of the statistics and the backward
+// reductions
+constexpr int64_t kBlockRows = 256;
+
+// Reads and writes rows of T as FP32, converting BF16 through a buffer
+template <typename T>
+struct BatchNormRowIO {
+  static const float* load(const T* src, int64_t size, float* buffer) {
+    at::vec::convert(src, buffer, size);
+    return buffer;
+  }
+  static float* output(T* dst, float* buffer) {
+    return buffer;
+  }
+  static void store(const float* src, T* dst, int64_t size) {
+    at::vec::convert(src, dst, size);
+  }
+};
+
+template <>
+struct BatchNormRowIO<float> {
+  static const float* load(const float* src, int64_t size, float* buffer) {
+    return src;
+  }
+  static float* output(float* dst, float* buffer) {
+    return dst;
+  }
+  static void store(const float* src, float* dst, int64_t size) {}
+};
+
+inline int64_t num_row_blocks(int64_t M) {
+  return std::min(
+      at::divup(M, kBlockRows), static_cast<int64_t>(at::get_num_threads()));
+}
+
+// y = max(x * scale + shift, 0) when relu is set, for a row of C channels
+inline void apply_row(
+    const float* x,
+    const float* scale,
+    const float* shift,
+    bool relu,
+    int64_t C,
+    float* y) {
+  int64_t c = 0;
+  for (; c + Vec::size() <= C; c += Vec::size()) {
+    Vec out = at::vec::fmadd(
+        Vec::loadu(x + c), Vec::loadu(scale + c), Vec::loadu(shift + c));
+    if (relu) {
+      out = at::vec::clamp_min(out, Vec(0.f));
+    }
+    out.store(y + c);
+  }
+  for (; c < C; c++) {
+    const float out = x[c] * scale[c] + shift[c];
+    y[c] = relu ? std::max(out, 0.f) : out;
+  }
+}
+
+// The statistics of a channel are reduced in a single pass with Welford's
+// algorithm. The rows are split into blocks reduced in parallel, each keeping
+// a running mean and m2 for all the channels, and the blocks are merged with
+// Chan's formula.
+template <typename T>
+void batch_norm_cl_stats_kernel(
+    const at::Tensor& input,
+    at::Tensor& mean,
+    at::Tensor& var) {
+  using IO = BatchNormRowIO<T>;
+  const int64_t M = input.size(0);
+  const int64_t C = input.size(1);
+  const T* input_data = input.data_ptr<T>();
+  float* mean_data = mean.data_ptr<float>();
+  float* var_data = var.data_ptr<float>();
+
+  const int64_t num_blocks = num_row_blocks(M);
+  const int64_t block_rows = at::divup(M, num_blocks);
+  std::vector<float> block_mean(num_blocks * C, 0.f);
+  std::vector<float> block_m2(num_blocks * C, 0.f);
+  at::parallel_for(0, num_blocks, 1, [&](int64_t begin, int64_t end) {
+    std::vector<float> buffer(C);
+    for (const auto b : c10::irange(begin, end)) {
+      float* m = block_mean.data() + b * C;
+      float* m2 = block_m2.data() + b * C;
+      const int64_t row_begin = b * block_rows;
+      const int64_t row_end = std::min(row_begin + block_rows, M);
+      for (int64_t r = row_begin; r < row_end; r++) {
+        const float* x = IO::load(input_data + r * C, C, buffer.data());
+        const float rcount = 1.f / (r - row_begin + 1);
+        int64_t c = 0;
+        for (; c + Vec::size() <= C; c += Vec::size()) {
+          const Vec x_vec = Vec::loadu(x + c);
+          Vec m_vec = Vec::loadu(m + c);
+          const Vec delta = x_vec - m_vec;
+          m_vec = at::vec::fmadd(delta, Vec(rcount), m_vec);
+          const Vec m2_vec =
+              at::vec::fmadd(delta, x_vec - m_vec, Vec::loadu(m2 + c));
+          m_vec.store(m + c);
+          m2_vec.store(m2 + c);
+        }
+        for (; c < C; c++) {
+          const float delta = x[c] - m[c];
+          m[c] += delta * rcount;
+          m2[c] += delta * (x[c] - m[c]);
+        }
+      }
+    }
+  });
+
+  at::parallel_for(0, C, 1, [&](int64_t begin, int64_t end) {
+    for (const auto c : c10::irange(begin, end)) {
+      int64_t count = 0;
+      float m = 0.f;
+      float m2 = 0.f;
+      for (const auto b : c10::irange(num_blocks)) {
+        const int64_t b_count = std::min(block_rows, M - b * block_rows);
+        if (b_count <= 0) {
+          continue;
+        }
+        const float delta = block_mean[b * C + c] - m;
+        const float b_ratio = static_cast<float>(b_count) / (count + b_count);
+        m += delta * b_ratio;
+        m2 += block_m2[b * C + c] + delta * delta * count * b_ratio;
+        count += b_count;
+      }
+      mean_data[c] = m;
+      var_data[c] = m2 / M;
+    }
+  });
+}
+
+template <typename T>
+void batch_norm_cl_apply_kernel(
+    const at::Tensor& input,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    bool relu,
+    at::Tensor& output) {
+  using IO = BatchNormRowIO<T>;
+  const int64_t M = input.size(0);
+  const int64_t C = input.size(1);
+  const T* input_data = input.data_ptr<T>();
+  const float* scale_data = scale.data_ptr<float>();
+  const float* shift_data = shift.data_ptr<float>();
+  T* output_data = output.data_ptr<T>();
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(C, 1));
+  at::parallel_for(0, M, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<float> in_buffer(C);
+    std::vector<float> out_buffer(C);
+    for (const auto r : c10::irange(begin, end)) {
+      const float* x = IO::load(input_data + r * C, C, in_buffer.data());
+      float* y = IO::output(output_data + r * C, out_buffer.data());
+      apply_row(x, scale_data, shift_data, relu, C, y);
+      IO::store(y, output_data + r * C, C);
+    }
+  });
+}
+
+// Two passes over the inputs. The first reduces sum(dy) and
+// sum(dy * (x - mean)) per channel, which give dbeta and dgamma. The second
+// computes dx = gamma * invstd * (dy - dbeta / M - xhat * dgamma / M), as
+// dx = a * dy + b * x + c with per channel coefficients. With relu, dy is
+// masked where the recomputed forward output isn't positive.
+template <typename T>
+void batch_norm_cl_backward_kernel(
+    const at::Tensor& grad_output,
+    const at::Tensor& input,
+    const at::Tensor& mean,
+    const at::Tensor& invstd,
+    const at::Tensor& weight,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    bool relu,
+    at::Tensor& grad_input,
+    at::Tensor& grad_weight,
+    at::Tensor& grad_bias) {
+  using IO = BatchNormRowIO<T>;
+  const int64_t M = input.size(0);
+  const int64_t C = input.size(1);
+  const T* dy_data = grad_output.data_ptr<T>();
+  const T* x_data = input.data_ptr<T>();
+  const float* mean_data = mean.data_ptr<float>();
+  const float* invstd_data = invstd.data_ptr<float>();
+  const float* weight_data =
+      weight.defined() ? weight.data_ptr<float>() : nullptr;
+  const float* scale_data = scale.data_ptr<float>();
+  const float* shift_data = shift.data_ptr<float>();
+
+  // dy with the relu mask applied, in FP32
+  auto masked_dy = [&](int64_t r, float* dy_buffer, float* x_buffer) {
+    const float* dy = IO::load(dy_data + r * C, C, dy_buffer);
+    if (!relu) {
+      return dy;
+    }
+    const float* x = IO::load(x_data + r * C, C, x_buffer);
+    int64_t c = 0;
+    for (; c + Vec::size() <= C; c += Vec::size()) {
+      const Vec y = at::vec::fmadd(
+          Vec::loadu(x + c),
+          Vec::loadu(scale_data + c),
+          Vec::loadu(shift_data + c));
+      Vec::blendv(Vec(0.f), Vec::loadu(dy + c), y > Vec(0.f))
+          .store(dy_buffer + c);
+    }
+    for (; c < C; c++) {
+      const float y = x[c] * scale_data[c] + shift_data[c];
+      dy_buffer[c] = y > 0.f ? dy[c] : 0.f;
+    }
+    return static_cast<const float*>(dy_buffer);
+  };
+
+  const int64_t num_blocks = num_row_blocks(M);
+  const int64_t block_rows = at::divup(M, num_blocks);
+  std::vector<float> block_sum_dy(num_blocks * C, 0.f);
+  std::vector<float> block_sum_dy_xmu(num_blocks * C, 0.f);
+  at::parallel_for(0, num_blocks, 1, [&](int64_t begin, int64_t end) {
+    std::vector<float> dy_buffer(C);
+    std::vector<float> x_buffer(C);
+    for (const auto b : c10::irange(begin, end)) {
+      float* sum_dy = block_sum_dy.data() + b * C;
+      float* sum_dy_xmu = block_sum_dy_xmu.data() + b * C;
+      const int64_t row_end = std::min((b + 1) * block_rows, M);
+      for (int64_t r = b * block_rows; r < row_end; r++) {
+        const float* dy = masked_dy(r, dy_buffer.data(), x_buffer.data());
+        const float* x = IO::load(x_data + r * C, C, x_buffer.data());
+        int64_t c = 0;
+        for (; c + Vec::size() <= C; c += Vec::size()) {
+          const Vec dy_vec = Vec::loadu(dy + c);
+          const Vec xmu = Vec::loadu(x + c) - Vec::loadu(mean_data + c);
+          (Vec::loadu(sum_dy + c) + dy_vec).store(sum_dy + c);
+          at::vec::fmadd(dy_vec, xmu, Vec::loadu(sum_dy_xmu + c))
+              .store(sum_dy_xmu + c);
+        }
+        for (; c < C; c++) {
+          sum_dy[c] += dy[c];
+          sum_dy_xmu[c] += dy[c] * (x[c] - mean_data[c]);
+        }
+      }
+    }
+  });
+
+  // per channel sums, then the coefficients of dx
+  std::vector<float> dgamma(C);
+  std::vector<float> dbeta(C);
+  std::vector<float> coef_a(C);
+  std::vector<float> coef_b(C);
+  std::vector<float> coef_c(C);
+  for (const auto c : c10::irange(C)) {
+    float sum_dy = 0.f;
+    float sum_dy_xmu = 0.f;
+    for (const auto b : c10::irange(num_blocks)) {
+      sum_dy += block_sum_dy[b * C + c];
+      sum_dy_xmu += block_sum_dy_xmu[b * C + c];
+    }
+    const float inv = invstd_data[c];
+    const float gamma = weight_data != nullptr ? weight_data[c] : 1.f;
+    dgamma[c] = sum_dy_xmu * inv;
+    dbeta[c] = sum_dy;
+    coef_a[c] = gamma * inv;
+    coef_b[c] = -coef_a[c] * inv * dgamma[c] / M;
+    coef_c[c] = -coef_a[c] * dbeta[c] / M - coef_b[c] * mean_data[c];
+  }
+  if (grad_weight.defined()) {
+    std::copy(dgamma.begin(), dgamma.end(), grad_weight.data_ptr<float>());
+  }
+  if (grad_bias.defined()) {
+    std::copy(dbeta.begin(), dbeta.end(), grad_bias.data_ptr<float>());
+  }
+  if (!grad_input.defined()) {
+    return;
+  }
+
+  T* dx_data = grad_input.data_ptr<T>();
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(C, 1));
+  at::parallel_for(0, M, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<float> dy_buffer(C);
+    std::vector<float> x_buffer(C);
+    std::vector<float> dx_buffer(C);
+    for (const auto r : c10::irange(begin, end)) {
+      const float* dy = masked_dy(r, dy_buffer.data(), x_buffer.data());
+      const float* x = IO::load(x_data + r * C, C, x_buffer.data());
+      float* dx = IO::output(dx_data + r * C, dx_buffer.data());
+      int64_t c = 0;
+      for (; c + Vec::size() <= C; c += Vec::size()) {
+        const Vec out = at::vec::fmadd(
+            Vec::loadu(coef_a.data() + c),
+            Vec::loadu(dy + c),
+            at::vec::fmadd(
+                Vec::loadu(coef_b.data() + c),
+                Vec::loadu(x + c),
+                Vec::loadu(coef_c.data() + c)));
+        out.store(dx + c);
+      }
+      for (; c < C; c++) {
+        dx[c] = coef_a[c] * dy[c] + coef_b[c] * x[c] + coef_c[c];
+      }
+      IO::store(dx, dx_data + r * C, C);
+    }
+  });
+}
+
+void batch_norm_cl_stats_kernel_impl(
+    const at::Tensor& input,
+    at::Tensor& mean,
+    at::Tensor& var) {
+  if (input.scalar_type() == at::kBFloat16) {
+    batch_norm_cl_stats_kernel<at::BFloat16>(input, mean, var);
+  } else {
+    batch_norm_cl_stats_kernel<float>(input, mean, var);
+  }
+}
+
+void batch_norm_cl_apply_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    bool relu,
+    at::Tensor& output) {
+  if (input.scalar_type() == at::kBFloat16) {
+    batch_norm_cl_apply_kernel<at::BFloat16>(
+        input, scale, shift, relu, output);
+  } else {
+    batch_norm_cl_apply_kernel<float>(input, scale, shift, relu, output);
+  }
+}
+
+void batch_norm_cl_backward_kernel_impl(
+    const at::Tensor& grad_output,
+    const at::Tensor& input,
+    const at::Tensor& mean,
+    const at::Tensor& invstd,
+    const at::Tensor& weight,
+    const at::Tensor& scale,
+    const at::Tensor& shift,
+    bool relu,
+    at::Tensor& grad_input,
+    at::Tensor& grad_weight,
+    at::Tensor& grad_bias) {
+  if (input.scalar_type() == at::kBFloat16) {
+    batch_norm_cl_backward_kernel<at::BFloat16>(
+        grad_output,
+        input,
+        mean,
+        invstd,
+        weight,
+        scale,
+        shift,
+        relu,
+        grad_input,
+        grad_weight,
+        grad_bias);
+  } else {
+    batch_norm_cl_backward_kernel<float>(
+        grad_output,
+        input,
+        mean,
+        invstd,
+        weight,
+        scale,
+        shift,
+        relu,
+        grad_input,
+        grad_weight,
+        grad_bias);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    batch_norm_cl_stats_kernel_stub,
+    &batch_norm_cl_stats_kernel_impl);
+REGISTER_DISPATCH(
+    batch_norm_cl_apply_kernel_stub,
+    &batch_norm_cl_apply_kernel_impl);
+REGISTER_DISPATCH(
+    batch_norm_cl_backward_kernel_stub,
+    &batch_norm_cl_backward_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -8,6 +8,7 @@
 #include <csrc/aten/cpu/Cumsum.h>
 
 #include <immintrin.h>
+#include <algorithm>
 #include "csrc/cpu/vec/vec.h"
 
 namespace torch_ipex {
@@ -212,9 +213,256 @@ at::Tensor cumsum_kernel_impl(
   return NewCumSumOp::_forward(result, self, dim, dtype);
 }
 
+// Scan rows [0, n) of one segment, the running sum starts from carry (size D,
+// updated in place).
+template <typename scalar_t, typename acc_t>
+inline void segment_scan_rows(
+    const scalar_t* src,
+    scalar_t* dst,
+    acc_t* carry,
+    int64_t n,
+    int64_t D,
+    bool exclusive) {
+  if (D == 1) {
+    if (exclusive) {
+      if (n > 0) {
+        dst[0] = carry[0];
+        prefix_sum<scalar_t>(src, dst + 1, carry[0], n - 1);
+        carry[0] = dst[n - 1] + src[n - 1];
+      }
+    } else {
+      prefix_sum<scalar_t>(src, dst, carry[0], n);
+      carry[0] = n > 0 ? dst[n - 1] : carry[0];
+    }
+    return;
+  }
+  using Vec = Vectorized<acc_t>;
+  for (int64_t r = 0; r < n; r++) {
+    const scalar_t* src_row = src + r * D;
+    scalar_t* dst_row = dst + r * D;
+    int64_t d = 0;
+    for (; d < D - (D % Vec::size()); d += Vec::size()) {
+      Vec carry_vec = Vec::loadu(carry + d);
+      Vec sum_vec = carry_vec + Vec::loadu(src_row + d);
+      (exclusive ? carry_vec : sum_vec).store(dst_row + d);
+      sum_vec.store(carry + d);
+    }
+    for (; d < D; d++) {
+      acc_t sum = carry[d] + src_row[d];
+      dst_row[d] = exclusive ? carry[d] : sum;
+      carry[d] = sum;
+    }
+  }
+}
+
+// BFloat16 is scanned in float, in blocks converted to a float buffer.
+template <>
+inline void segment_scan_rows<at::BFloat16, float>(
+    const at::BFloat16* src,
+    at::BFloat16* dst,
+    float* carry,
+    int64_t n,
+    int64_t D,
+    bool exclusive) {
+  constexpr int64_t BLOCK_SIZE = 1024;
+  float src_buf[BLOCK_SIZE];
+  float dst_buf[BLOCK_SIZE];
+  if (D == 1) {
+    for (int64_t b = 0; b < n; b += BLOCK_SIZE) {
+      int64_t len = std::min(BLOCK_SIZE, n - b);
+      cvt_bf16_to_fp32(src_buf, src + b, len);
+      if (exclusive) {
+        dst_buf[0] = carry[0];
+        prefix_sum<float>(src_buf, dst_buf + 1, carry[0], len - 1);
+        carry[0] = dst_buf[len - 1] + src_buf[len - 1];
+      } else {
+        prefix_sum<float>(src_buf, dst_buf, carry[0], len);
+        carry[0] = dst_buf[len - 1];
+      }
+      cvt_fp32_to_bf16(dst + b, dst_buf, len);
+    }
+    return;
+  }
+  using Vec = Vectorized<float>;
+  for (int64_t r = 0; r < n; r++) {
+    for (int64_t b = 0; b < D; b += BLOCK_SIZE) {
+      int64_t len = std::min(BLOCK_SIZE, D - b);
+      cvt_bf16_to_fp32(src_buf, src + r * D + b, len);
+      float* carry_blk = carry + b;
+      int64_t d = 0;
+      for (; d < len - (len % Vec::size()); d += Vec::size()) {
+        Vec carry_vec = Vec::loadu(carry_blk + d);
+        Vec sum_vec = carry_vec + Vec::loadu(src_buf + d);
+        (exclusive ? carry_vec : sum_vec).store(dst_buf + d);
+        sum_vec.store(carry_blk + d);
+      }
+      for (; d < len; d++) {
+        float sum = carry_blk[d] + src_buf[d];
+        dst_buf[d] = exclusive ? carry_blk[d] : sum;
+        carry_blk[d] = sum;
+      }
+      cvt_fp32_to_bf16(dst + r * D + b, dst_buf, len);
+    }
+  }
+}
+
+// Sum of rows [0, n), accumulated into sum (size D).
+template <typename scalar_t, typename acc_t>
+inline void segment_reduce_rows(
+    const scalar_t* src,
+    acc_t* sum,
+    int64_t n,
+    int64_t D) {
+  for (int64_t r = 0; r < n; r++) {
+    for (int64_t d = 0; d < D; d++) {
+      sum[d] += static_cast<acc_t>(src[r * D + d]);
+    }
+  }
+}
+
+/*
+ Segmented scan along dim 0 of values [total, D], segment s covers rows
+ [offsets[s], offsets[s + 1]). Rows are split into equal chunks regardless of
+ the segment boundaries so that one long segment does not serialize the scan:
+  Pass I:  each chunk reduces the rows of the segment it ends in (only needed
+           when that segment continues into the next chunk);
+  Carry:   the carry-in of each chunk is accumulated sequentially over chunks;
+  Pass II: each chunk scans its rows, starting from its carry-in for the
+           segment it begins in and from zero for the others.
+*/
+template <typename scalar_t, typename acc_t>
+void segment_cumsum_kernel(
+    at::Tensor& result,
+    const at::Tensor& self,
+    const int64_t* offsets,
+    int64_t num_segments,
+    bool exclusive) {
+  const scalar_t* self_data = self.data_ptr<scalar_t>();
+  scalar_t* result_data = result.data_ptr<scalar_t>();
+  const int64_t total = self.size(0);
+  const int64_t D = self.numel() / std::max(total, int64_t(1));
+  if (total == 0 || D == 0) {
+    return;
+  }
+
+  // segment containing row, empty segments are skipped
+  auto segment_of = [&](int64_t row) {
+    return std::upper_bound(offsets, offsets + num_segments + 1, row) -
+        offsets - 1;
+  };
+
+  // rows per chunk, at least 4K elements per chunk
+  constexpr int64_t MIN_CHUNK_ELEMENTS = 4096;
+  const int64_t min_chunk_rows = std::max(int64_t(1), MIN_CHUNK_ELEMENTS / D);
+  const int64_t num_chunks = std::max(
+      int64_t(1),
+      std::min<int64_t>(at::get_num_threads(), total / min_chunk_rows));
+  const int64_t chunk_rows = divup(total, num_chunks);
+
+  std::vector<acc_t> tail_sums(num_chunks * D, acc_t(0));
+  std::vector<acc_t> carries(num_chunks * D, acc_t(0));
+
+  // Pass I: reduce the last (partial) segment of each chunk
+  at::parallel_for(0, num_chunks - 1, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t row_begin = c * chunk_rows;
+      int64_t row_end = std::min(total, row_begin + chunk_rows);
+      int64_t s = segment_of(row_end - 1);
+      if (offsets[s + 1] <= row_end) {
+        // the segment is closed in this chunk, nothing to carry
+        continue;
+      }
+      int64_t tail_begin = std::max(row_begin, offsets[s]);
+      segment_reduce_rows<scalar_t, acc_t>(
+          self_data + tail_begin * D,
+          tail_sums.data() + c * D,
+          row_end - tail_begin,
+          D);
+    }
+  });
+
+  // carry-in of chunk c is the sum of its first segment over previous chunks
+  for (int64_t c = 1; c < num_chunks; c++) {
+    int64_t row_begin = c * chunk_rows;
+    if (row_begin >= total) {
+      break;
+    }
+    int64_t s = segment_of(row_begin);
+    if (offsets[s] == row_begin) {
+      continue;
+    }
+    bool prev_in_segment = offsets[s] <= (c - 1) * chunk_rows;
+    for (int64_t d = 0; d < D; d++) {
+      carries[c * D + d] = tail_sums[(c - 1) * D + d] +
+          (prev_in_segment ? carries[(c - 1) * D + d] : acc_t(0));
+    }
+  }
+
+  // Pass II: scan each chunk segment by segment
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    std::vector<acc_t> carry(D);
+    for (int64_t c = begin; c < end; c++) {
+      int64_t row_begin = c * chunk_rows;
+      int64_t row_end = std::min(total, row_begin + chunk_rows);
+      if (row_begin >= row_end) {
+        continue;
+      }
+      int64_t s = segment_of(row_begin);
+      std::copy_n(carries.data() + c * D, D, carry.data());
+      int64_t row = row_begin;
+      while (row < row_end) {
+        int64_t seg_end = std::min(row_end, offsets[s + 1]);
+        segment_scan_rows<scalar_t, acc_t>(
+            self_data + row * D,
+            result_data + row * D,
+            carry.data(),
+            seg_end - row,
+            D,
+            exclusive);
+        row = seg_end;
+        std::fill(carry.begin(), carry.end(), acc_t(0));
+        s = segment_of(row);
+      }
+    }
+  });
+}
+
+at::Tensor segment_cumsum_kernel_impl(
+    const at::Tensor& self,
+    const at::Tensor& offsets,
+    bool exclusive) {
+  auto self_ = self.contiguous();
+  auto offsets_ = offsets.to(at::kLong).contiguous();
+  at::Tensor result = at::empty_like(self_, at::MemoryFormat::Contiguous);
+  const int64_t* offsets_data = offsets_.data_ptr<int64_t>();
+  const int64_t num_segments = offsets_.numel() - 1;
+
+  if (self_.scalar_type() == at::kFloat) {
+    segment_cumsum_kernel<float, float>(
+        result, self_, offsets_data, num_segments, exclusive);
+  } else if (self_.scalar_type() == at::kBFloat16) {
+    segment_cumsum_kernel<at::BFloat16, float>(
+        result, self_, offsets_data, num_segments, exclusive);
+  } else if (self_.scalar_type() == at::kInt) {
+    segment_cumsum_kernel<int32_t, int32_t>(
+        result, self_, offsets_data, num_segments, exclusive);
+  } else if (self_.scalar_type() == at::kLong) {
+    segment_cumsum_kernel<int64_t, int64_t>(
+        result, self_, offsets_data, num_segments, exclusive);
+  } else {
+    TORCH_CHECK(
+        false,
+        "segment_cumsum: unsupported dtype ",
+        self_.scalar_type(),
+        ", only float, bfloat16, int and long are supported");
+  }
+  return result;
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(cumsum_kernel_stub, &cumsum_kernel_impl);
+REGISTER_DISPATCH(segment_cumsum_kernel_stub, &segment_cumsum_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
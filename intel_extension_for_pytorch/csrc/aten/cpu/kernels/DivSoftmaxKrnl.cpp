@@ -2,6 +2,8 @@
 
 #include "csrc/cpu/vec/vec.h"
 
+#include <limits>
+
 namespace torch_ipex {
 namespace cpu {
 
@@ -14,6 +16,11 @@ using namespace torch_ipex::cpu::kernel;
  * @brief Fuse the div (div scalar or mul 1/scalar), masked_fill operator and
  * softmax operator. softmax(mask? a/dim_per_head : fill value)
  *
+ * Each row is read twice and written once: an online softmax pass computes
+ * its max and sum of exp, then the normalization pass recomputes the masked
+ * scores while the row is still in cache and writes the output. No FP32 copy
+ * of the row is written.
+ *
  * @attention
  * There are some assumptions for this operator.
  * - The reduce dimension for softmax is the last dimension
@@ -22,6 +29,8 @@ using namespace torch_ipex::cpu::kernel;
  * - The number of the input tensor dimension should be >=2
  * - The mask b can be expand_as a with the mask_reshape (bs :: seq_length),
  * i.e., from mid dims
+ * - The mask b is either a bool mask or a float mask with 1 for the filled
+ * elements
  * - The datatype for inpust a and output are same.
  *
  * @param[in] a a contiguous tensor to do div and softmax
@@ -30,14 +39,14 @@ using namespace torch_ipex::cpu::kernel;
  * @return The tensor stores the result of @code softmax(mask? a/dim_per_head :
  * fill value) @endcode
  */
-template <typename scalar_t>
+template <typename scalar_t, typename mask_t>
 at::Tensor dil_div_maskfill_softmax(
     const at::Tensor& a, // qk scores
     const at::Tensor& b, // mask
     const float& fill_value,
     const float& dim_per_head) {
   scalar_t* a_data_base = a.data_ptr<scalar_t>();
-  float* b_data_base = b.data_ptr<float>();
+  mask_t* b_data_base = b.data_ptr<mask_t>();
 
   auto infered_size = a.sizes().vec();
 
@@ -45,61 +54,91 @@ at::Tensor dil_div_maskfill_softmax(
   at::Tensor output = at::empty_like(a);
   scalar_t* output_data_base = output.data_ptr<scalar_t>();
 
-  std::vector<int64_t> outer_size_per_dim;
   int64_t dim_size = infered_size[infered_size.size() - 1];
   TORCH_INTERNAL_ASSERT_DEBUG_ONLY(dim_size != 1);
 
-  int64_t outer_size = 1;
-  // The last dim is the loop unit. We need to minus 2 to exclude the last dim.
-  // infered_size.size() - 2 is the -2th dimension.
-  for (int64_t i = infered_size.size() - 2; i >= 0; i--) {
-    // Record outer dimensions
-    outer_size_per_dim.insert(outer_size_per_dim.begin(), outer_size);
-    // Calculate outer loop number;
-    outer_size *= infered_size[i];
-  }
-
+  int64_t outer_size = a.numel() / dim_size;
   auto mask_offset = outer_size / infered_size[0];
 
   int64_t grain_size = at::internal::GRAIN_SIZE / (16 * dim_size);
   if (grain_size < 1)
     grain_size = 1;
-  int64_t outer_dims_num = outer_size_per_dim.size();
   at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
-    float val = 0.0;
-    at::Tensor tmp_out = at::empty({dim_size});
-    float* tmp_out_ptr = tmp_out.data_ptr<float>();
+    float max = 0.0;
+    float sum = 0.0;
     for (int64_t i = begin; i < end; i++) {
-      // mask fill and do div on a and get the maximum value:
-      //    output_data = mask? a/dim_per_head : fill value
-      //    val = max(output_data)
-      int b_offset = (i / mask_offset);
       // b_offset takes mid dims because the mask is
       // expand_as a with the mid dims (bs :: seq_length)
-      _dil_maskedfill_div_max_fusion_kernel<scalar_t>(
+      int64_t b_offset = (i / mask_offset);
+      _DivMaskedFillScore<scalar_t, mask_t> score(
           a_data_base + i * dim_size,
           b_data_base + b_offset * dim_size,
           fill_value,
-          dim_per_head,
-          dim_size,
-          tmp_out_ptr,
-          val);
-      // Calculate the e^x and get the sum value:
-      //    output_data = output_data - max(output_data)
-      //    output_data = e^(output_data)
-      //    val = sum(output_data)
-
-      _dil_exp_reduce_sum_fusion_kernel(
-          tmp_out_ptr, dim_size, tmp_out_ptr, val);
-      // Calculat the normalization [e^x / sum(e^x)]:
-      //    output_data = output_data / sum(output_data)
-
-      _dil_normalization_kernel<scalar_t>(
-          tmp_out_ptr, val, dim_size, output_data_base + i * dim_size);
+          dim_per_head);
+      // max and sum of e^(x - max) of x = mask? a/dim_per_head : fill value
+      _dil_online_softmax_reduce_kernel(score, dim_size, max, sum);
+      // output_data = e^(x - max) / sum
+      _dil_online_softmax_normalize_kernel(
+          score, dim_size, max, sum, output_data_base + i * dim_size);
     }
   });
   return output;
 } // dil_div_maskfill_softmax
+
+/**
+ * @brief Fuse the div operator, a causal mask and softmax operator.
+ * softmax(j > i + offset ? -inf : a/dim_per_head), with offset the number
+ * of keys minus the number of queries.
+ *
+ * The mask is generated from the row index instead of being read from a
+ * tensor: the masked tail of each row is neither read nor reduced, it is
+ * written with zeros.
+ *
+ * @attention
+ * - The reduce dimension for softmax is the last dimension, the -2th
+ * dimension is the query dimension
+ * - The input tensor is contiguous
+ */
+template <typename scalar_t>
+at::Tensor dil_div_causal_softmax(
+    const at::Tensor& a,
+    const float& dim_per_head) {
+  scalar_t* a_data_base = a.data_ptr<scalar_t>();
+  at::Tensor output = at::empty_like(a);
+  scalar_t* output_data_base = output.data_ptr<scalar_t>();
+
+  int64_t dim_size = a.size(-1);
+  int64_t query_size = a.size(-2);
+  int64_t offset = dim_size - query_size;
+  int64_t outer_size = a.numel() / dim_size;
+
+  int64_t grain_size = at::internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+  at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
+    float max = 0.0;
+    float sum = 0.0;
+    for (int64_t i = begin; i < end; i++) {
+      scalar_t* out = output_data_base + i * dim_size;
+      // the keys visible from this query
+      int64_t length = std::min(i % query_size + offset + 1, dim_size);
+      if (length <= 0) {
+        // every key is masked, as masked_fill with -inf followed by softmax
+        std::fill(
+            out,
+            out + dim_size,
+            static_cast<scalar_t>(std::numeric_limits<float>::quiet_NaN()));
+        continue;
+      }
+      _ScaleScore<scalar_t> score(
+          a_data_base + i * dim_size, 1.0f / dim_per_head);
+      _dil_online_softmax_reduce_kernel(score, length, max, sum);
+      _dil_online_softmax_normalize_kernel(score, length, max, sum, out);
+      std::fill(out + length, out + dim_size, static_cast<scalar_t>(0));
+    }
+  });
+  return output;
+} // dil_div_causal_softmax
 #endif
 
 at::Tensor div_maskedfill_softmax_kernel_impl(
@@ -109,10 +148,20 @@ at::Tensor div_maskedfill_softmax_kernel_impl(
     const float& fill,
     const float& dim_per_head) {
 #if defined(CPU_CAPABILITY_AVX512)
-  if (a.scalar_type() == at::kFloat) {
-    return dil_div_maskfill_softmax<float>(a, b, fill, dim_per_head);
-  } else if (a.scalar_type() == at::kBFloat16) {
-    return dil_div_maskfill_softmax<at::BFloat16>(a, b, fill, dim_per_head);
+  if (b.scalar_type() == at::kBool) {
+    if (a.scalar_type() == at::kFloat) {
+      return dil_div_maskfill_softmax<float, bool>(a, b, fill, dim_per_head);
+    } else if (a.scalar_type() == at::kBFloat16) {
+      return dil_div_maskfill_softmax<at::BFloat16, bool>(
+          a, b, fill, dim_per_head);
+    }
+  } else if (b.scalar_type() == at::kFloat) {
+    if (a.scalar_type() == at::kFloat) {
+      return dil_div_maskfill_softmax<float, float>(a, b, fill, dim_per_head);
+    } else if (a.scalar_type() == at::kBFloat16) {
+      return dil_div_maskfill_softmax<at::BFloat16, float>(
+          a, b, fill, dim_per_head);
+    }
   }
 #endif
   // convert the mask back to bool for fallback path
@@ -123,11 +172,35 @@ at::Tensor div_maskedfill_softmax_kernel_impl(
   return at::softmax(a_fill, -1);
 }
 
+at::Tensor div_causal_softmax_kernel_impl(
+    const at::Tensor& a,
+    const float& dim_per_head) {
+#if defined(CPU_CAPABILITY_AVX512)
+  if (a.scalar_type() == at::kFloat) {
+    return dil_div_causal_softmax<float>(a, dim_per_head);
+  } else if (a.scalar_type() == at::kBFloat16) {
+    return dil_div_causal_softmax<at::BFloat16>(a, dim_per_head);
+  }
+#endif
+  int64_t dim_size = a.size(-1);
+  int64_t query_size = a.size(-2);
+  auto causal_mask =
+      at::ones({query_size, dim_size}, a.options().dtype(at::kBool))
+          .triu_(dim_size - query_size + 1);
+  return at::softmax(
+      at::div(a, dim_per_head)
+          .masked_fill_(causal_mask, -std::numeric_limits<float>::infinity()),
+      -1);
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(
     div_maskedfill_softmax_kernel_stub,
     &div_maskedfill_softmax_kernel_impl);
+REGISTER_DISPATCH(
+    div_causal_softmax_kernel_stub,
+    &div_causal_softmax_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
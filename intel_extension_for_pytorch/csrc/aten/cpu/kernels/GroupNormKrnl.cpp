@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <numeric>
+#include <vector>
 
 #include <csrc/aten/cpu/GroupNorm.h>
 
@@ -18,6 +20,7 @@
 #include <ATen/Functions.h>
 #else
 #include <ATen/ops/empty.h>
+#include <ATen/ops/silu.h>
 #endif
 
 #include "csrc/aten/cpu/utils/utils.h"
@@ -163,6 +166,223 @@ void GroupNormKernelImplInternal(
   });
 }
 
+// Elements of a group reduced or normalized at a time. The moments of a
+// chunk are computed in two passes over it while it stays in cache, and the
+// chunks are merged with Chan's parallel algorithm.
+constexpr int64_t kGroupNormChunkSize = 4096;
+
+struct GroupMoments {
+  int64_t count;
+  float mean;
+  // sum of the squared deviations from mean
+  float m2;
+};
+
+inline GroupMoments MergeMoments(const GroupMoments& a, const GroupMoments& b) {
+  if (a.count == 0) {
+    return b;
+  }
+  if (b.count == 0) {
+    return a;
+  }
+  const int64_t count = a.count + b.count;
+  const float delta = b.mean - a.mean;
+  const float b_ratio = static_cast<float>(b.count) / count;
+  return {
+      count,
+      a.mean + delta * b_ratio,
+      a.m2 + b.m2 + delta * delta * a.count * b_ratio};
+}
+
+inline GroupMoments ChunkMoments(const float* X_ptr, int64_t size) {
+  using Vec = at::vec::Vectorized<float>;
+  const float mean = at::vec::reduce_all<float>(
+                         [](Vec& x, Vec& y) { return x + y; }, X_ptr, size) /
+      size;
+  const float m2 = at::vec::map_reduce_all<float>(
+      [mean](Vec x) {
+        Vec d = x - Vec(mean);
+        return d * d;
+      },
+      [](Vec& x, Vec& y) { return x + y; },
+      X_ptr,
+      size);
+  return {size, mean, m2};
+}
+
+// Reads and writes chunks of T as FP32, converting BF16 through a buffer
+template <typename T>
+struct GroupNormChunkIO {
+  static const float* load(const T* src, int64_t size, float* buffer) {
+    at::vec::convert(src, buffer, size);
+    return buffer;
+  }
+  static float* output(T* dst, float* buffer) {
+    return buffer;
+  }
+  static void store(const float* src, T* dst, int64_t size) {
+    at::vec::convert(src, dst, size);
+  }
+};
+
+template <>
+struct GroupNormChunkIO<float> {
+  static const float* load(const float* src, int64_t size, float* buffer) {
+    return src;
+  }
+  static float* output(float* dst, float* buffer) {
+    return dst;
+  }
+  static void store(const float* src, float* dst, int64_t size) {}
+};
+
+// Y = X * scale + bias, followed by SiLU when silu is set
+inline void ApplyScaleBias(
+    const float* X_ptr,
+    float* Y_ptr,
+    float scale,
+    float bias,
+    bool silu,
+    int64_t size) {
+  using Vec = at::vec::Vectorized<float>;
+  const Vec scale_vec(scale);
+  const Vec bias_vec(bias);
+  if (silu) {
+    at::vec::map(
+        [scale_vec, bias_vec](Vec x) {
+          Vec y = at::vec::fmadd(x, scale_vec, bias_vec);
+          return y / (Vec(1.f) + y.neg().exp());
+        },
+        Y_ptr,
+        X_ptr,
+        size);
+  } else {
+    at::vec::map(
+        [scale_vec, bias_vec](Vec x) {
+          return at::vec::fmadd(x, scale_vec, bias_vec);
+        },
+        Y_ptr,
+        X_ptr,
+        size);
+  }
+}
+
+// GroupNorm over contiguous NCHW FP32 or BF16 inputs, accumulated in FP32.
+//
+// With at least as many groups as threads, each thread normalizes whole
+// groups. Otherwise, e.g. UNets at batch 1 with 32 groups, the groups are
+// split into chunks: the chunk moments are computed in parallel and merged
+// per group, and the normalization is parallelized over the channels.
+template <typename T>
+void GroupNormKernelImplContiguous(
+    const at::Tensor& X,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    double eps,
+    bool silu,
+    at::Tensor& Y,
+    at::Tensor& mean,
+    at::Tensor& rstd) {
+  TORCH_CHECK(X.numel() == N * C * HxW);
+  TORCH_CHECK(!gamma.defined() || gamma.numel() == C);
+  TORCH_CHECK(!beta.defined() || beta.numel() == C);
+  using IO = GroupNormChunkIO<T>;
+  const int64_t G = group;
+  const int64_t D = C / G;
+  const T* X_data = X.data_ptr<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
+  const T* beta_data = beta.defined() ? beta.data_ptr<T>() : nullptr;
+  T* Y_data = Y.data_ptr<T>();
+  T* mean_data = mean.data_ptr<T>();
+  T* rstd_data = rstd.data_ptr<T>();
+  const int64_t inner_size = D * HxW;
+  const int64_t num_chunks =
+      (inner_size + kGroupNormChunkSize - 1) / kGroupNormChunkSize;
+
+  // FP32 statistics of the groups, the outputs get them rounded to T
+  std::vector<float> group_mean(N * G);
+  std::vector<float> group_rstd(N * G);
+
+  auto chunk_moments = [&](int64_t i, int64_t chunk, float* buffer) {
+    const int64_t begin = chunk * kGroupNormChunkSize;
+    const int64_t size = std::min(kGroupNormChunkSize, inner_size - begin);
+    return ChunkMoments(
+        IO::load(X_data + i * inner_size + begin, size, buffer), size);
+  };
+  auto set_moments = [&](int64_t i, const GroupMoments& moments) {
+    const float var = std::max(moments.m2 / moments.count, 0.f);
+    group_mean[i] = moments.mean;
+    group_rstd[i] = 1.f / std::sqrt(var + static_cast<float>(eps));
+    mean_data[i] = static_cast<T>(group_mean[i]);
+    rstd_data[i] = static_cast<T>(group_rstd[i]);
+  };
+  // normalizes channel c of sample n
+  auto apply_channel = [&](int64_t n, int64_t c, float* buffer) {
+    const int64_t i = n * G + c / D;
+    const float scale =
+        group_rstd[i] * (gamma_data == nullptr ? 1.f : float(gamma_data[c]));
+    const float bias = -scale * group_mean[i] +
+        (beta_data == nullptr ? 0.f : float(beta_data[c]));
+    const T* X_ptr = X_data + (n * C + c) * HxW;
+    T* Y_ptr = Y_data + (n * C + c) * HxW;
+    for (int64_t begin = 0; begin < HxW; begin += kGroupNormChunkSize) {
+      const int64_t size = std::min(kGroupNormChunkSize, HxW - begin);
+      float* out = IO::output(Y_ptr + begin, buffer);
+      ApplyScaleBias(
+          IO::load(X_ptr + begin, size, buffer), out, scale, bias, silu, size);
+      IO::store(out, Y_ptr + begin, size);
+    }
+  };
+
+  if (N * G >= at::get_num_threads() || num_chunks == 1) {
+    at::parallel_for(0, N * G, 1, [&](int64_t begin, int64_t end) {
+      std::vector<float> buffer(kGroupNormChunkSize);
+      for (const auto i : c10::irange(begin, end)) {
+        GroupMoments moments{0, 0.f, 0.f};
+        for (const auto chunk : c10::irange(num_chunks)) {
+          moments =
+              MergeMoments(moments, chunk_moments(i, chunk, buffer.data()));
+        }
+        set_moments(i, moments);
+        const int64_t n = i / G;
+        const int64_t g = i % G;
+        for (const auto d : c10::irange(D)) {
+          apply_channel(n, g * D + d, buffer.data());
+        }
+      }
+    });
+    return;
+  }
+
+  // two-level reduction: chunk moments in parallel, merged per group
+  std::vector<GroupMoments> chunk_moments_data(N * G * num_chunks);
+  at::parallel_for(0, N * G * num_chunks, 1, [&](int64_t begin, int64_t end) {
+    std::vector<float> buffer(kGroupNormChunkSize);
+    for (const auto t : c10::irange(begin, end)) {
+      chunk_moments_data[t] =
+          chunk_moments(t / num_chunks, t % num_chunks, buffer.data());
+    }
+  });
+  for (const auto i : c10::irange(N * G)) {
+    GroupMoments moments{0, 0.f, 0.f};
+    for (const auto chunk : c10::irange(num_chunks)) {
+      moments =
+          MergeMoments(moments, chunk_moments_data[i * num_chunks + chunk]);
+    }
+    set_moments(i, moments);
+  }
+  at::parallel_for(0, N * C, 1, [&](int64_t begin, int64_t end) {
+    std::vector<float> buffer(kGroupNormChunkSize);
+    for (const auto i : c10::irange(begin, end)) {
+      apply_channel(i / C, i % C, buffer.data());
+    }
+  });
+}
+
 template <typename T>
 std::tuple<T, T> ColumnwiseMoments(
     const T* X_data,
@@ -469,9 +689,24 @@ void GroupNormKernelImpl(
     int64_t HxW,
     int64_t group,
     double eps,
+    bool silu,
     at::Tensor& Y,
     at::Tensor& mean,
     at::Tensor& rstd) {
+  const bool contiguous =
+      X.suggest_memory_format() == at::MemoryFormat::Contiguous &&
+      !is_channels_last_1d(X);
+  if (contiguous && X.scalar_type() == at::kFloat) {
+    GroupNormKernelImplContiguous<float>(
+        X, gamma, beta, N, C, HxW, group, eps, silu, Y, mean, rstd);
+    return;
+  }
+  if (contiguous && X.scalar_type() == at::kBFloat16) {
+    GroupNormKernelImplContiguous<at::BFloat16>(
+        X, gamma, beta, N, C, HxW, group, eps, silu, Y, mean, rstd);
+    return;
+  }
+
   switch (X.suggest_memory_format()) {
     case at::MemoryFormat::Contiguous: {
       if (!is_channels_last_1d(X)) {
@@ -541,6 +776,9 @@ void GroupNormKernelImpl(
           false,
           "Unsupported memory format. Supports only ChannelsLast, ChannelsLast3d, Contiguous");
   }
+  if (silu) {
+    at::silu_(Y);
+  }
 }
 
 template <typename T>
@@ -0,0 +1,291 @@
+#include <ATen/ATen.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <ATen/record_function.h>
+#include <c10/util/irange.h>
+
+#include <csrc/aten/cpu/TensorAdvancedIndexing.h>
+#include <csrc/aten/cpu/utils/radix_sort.h>
+
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using Vec = at::vec::Vectorized<float>;
+using iVec = at::vec::Vectorized<int32_t>;
+
+// The destination rows of a scatter grouped by a stable sort of the index:
+// the source rows accumulated into rows[u] are
+// positions[offsets[u]:offsets[u + 1]], in ascending order. Each destination
+// row is then owned by a single task, so the rows are accumulated in parallel
+// without atomics and in the same order as a sequential loop.
+struct ScatterPlan {
+  std::vector<int32_t> rows;
+  std::vector<int32_t> offsets;
+  std::vector<int32_t> positions;
+};
+
+template <typename index_t>
+ScatterPlan make_scatter_plan(
+    const index_t* index,
+    int64_t N,
+    int64_t D,
+    bool wrap_negative) {
+  std::vector<Key_Value_Weight_Tuple<int32_t>> pairs(N);
+  std::vector<Key_Value_Weight_Tuple<int32_t>> tmp(N);
+  at::parallel_for(
+      0, N, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        for (const auto i : c10::irange(begin, end)) {
+          int64_t row = index[i];
+          if (wrap_negative && row < 0) {
+            row += D;
+          }
+          TORCH_CHECK_INDEX(
+              row >= 0 && row < D,
+              "index ",
+              index[i],
+              " is out of bounds for dimension with size ",
+              D);
+          pairs[i] = std::make_tuple(
+              static_cast<int32_t>(row), static_cast<int32_t>(i), 0.f);
+        }
+      });
+  auto* sorted = radix_sort_parallel<int32_t>(
+      pairs.data(), tmp.data(), N, static_cast<int32_t>(D - 1));
+
+  ScatterPlan plan;
+  plan.positions.resize(N);
+  for (const auto i : c10::irange(N)) {
+    const int32_t row = std::get<0>(sorted[i]);
+    if (i == 0 || row != plan.rows.back()) {
+      plan.rows.push_back(row);
+      plan.offsets.push_back(static_cast<int32_t>(i));
+    }
+    plan.positions[i] = std::get<1>(sorted[i]);
+  }
+  plan.offsets.push_back(static_cast<int32_t>(N));
+  return plan;
+}
+
+// acc[0:I] += src[0:I]
+inline void accumulate_row(float* acc, const float* src, int64_t I) {
+  at::vec::map2([](Vec a, Vec b) { return a + b; }, acc, acc, src, I);
+}
+
+template <typename scalar_t>
+inline void accumulate_row(
+    float* acc,
+    const scalar_t* src,
+    int64_t I,
+    float* buffer) {
+  at::vec::convert(src, buffer, I);
+  accumulate_row(acc, buffer, I);
+}
+
+inline void accumulate_row(
+    float* acc,
+    const float* src,
+    int64_t I,
+    float* /* buffer */) {
+  accumulate_row(acc, src, I);
+}
+
+// dst[0:I] += alpha * acc[0:I]
+inline void add_row(float* dst, const float* acc, float alpha, int64_t I) {
+  const Vec alpha_vec(alpha);
+  at::vec::map2(
+      [alpha_vec](Vec x, Vec a) { return at::vec::fmadd(a, alpha_vec, x); },
+      dst,
+      dst,
+      acc,
+      I);
+}
+
+template <typename scalar_t>
+inline void add_row(
+    scalar_t* dst,
+    const float* acc,
+    float alpha,
+    int64_t I,
+    float* buffer) {
+  at::vec::convert(dst, buffer, I);
+  add_row(buffer, acc, alpha, I);
+  at::vec::convert(buffer, dst, I);
+}
+
+inline void add_row(
+    float* dst,
+    const float* acc,
+    float alpha,
+    int64_t I,
+    float* /* buffer */) {
+  add_row(dst, acc, alpha, I);
+}
+
+// Sums the elements of a single column source at the given positions. The
+// positions of a destination row are scattered over the source, they are
+// loaded with vector gathers.
+inline float gather_sum(
+    const float* src,
+    const int32_t* positions,
+    int64_t count) {
+  Vec acc(0.f);
+  int64_t k = 0;
+  for (; k + Vec::size() <= count; k += Vec::size()) {
+    acc = acc +
+        at::vec::gather<sizeof(float)>(src, iVec::loadu(positions + k));
+  }
+  float acc_arr[Vec::size()];
+  acc.store(acc_arr);
+  float sum = 0.f;
+  for (const auto i : c10::irange(Vec::size())) {
+    sum += acc_arr[i];
+  }
+  for (; k < count; k++) {
+    sum += src[positions[k]];
+  }
+  return sum;
+}
+
+// self: [O, D, I] contiguous, source: [O, N, I] contiguous
+template <typename scalar_t>
+void index_add_sorted(
+    scalar_t* self_data,
+    const scalar_t* source_data,
+    const ScatterPlan& plan,
+    float alpha,
+    int64_t O,
+    int64_t D,
+    int64_t N,
+    int64_t I) {
+  const int64_t U = plan.rows.size();
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE * U / (N * I));
+  at::parallel_for(0, O * U, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<float> acc(I);
+    std::vector<float> buffer(I);
+    for (const auto task : c10::irange(begin, end)) {
+      const int64_t o = task / U;
+      const int64_t u = task % U;
+      const int32_t* positions = plan.positions.data() + plan.offsets[u];
+      const int64_t count = plan.offsets[u + 1] - plan.offsets[u];
+      const scalar_t* src = source_data + o * N * I;
+      scalar_t* dst = self_data + (o * D + plan.rows[u]) * I;
+      if (I == 1 && std::is_same<scalar_t, float>::value) {
+        const float sum = gather_sum(
+            reinterpret_cast<const float*>(src), positions, count);
+        *dst = static_cast<float>(*dst) + alpha * sum;
+        continue;
+      }
+      std::fill(acc.begin(), acc.end(), 0.f);
+      for (const auto k : c10::irange(count)) {
+        accumulate_row(acc.data(), src + positions[k] * I, I, buffer.data());
+      }
+      add_row(dst, acc.data(), alpha, I, buffer.data());
+    }
+  });
+}
+
+// Too little work to pay for the sort, the rows are added one by one
+template <typename scalar_t, typename index_t>
+void index_add_sequential(
+    scalar_t* self_data,
+    const scalar_t* source_data,
+    const index_t* index,
+    float alpha,
+    bool wrap_negative,
+    int64_t O,
+    int64_t D,
+    int64_t N,
+    int64_t I) {
+  for (const auto i : c10::irange(N)) {
+    int64_t row = index[i];
+    if (wrap_negative && row < 0) {
+      row += D;
+    }
+    TORCH_CHECK_INDEX(
+        row >= 0 && row < D,
+        "index ",
+        index[i],
+        " is out of bounds for dimension with size ",
+        D);
+    for (const auto o : c10::irange(O)) {
+      scalar_t* dst = self_data + (o * D + row) * I;
+      const scalar_t* src = source_data + (o * N + i) * I;
+      for (const auto k : c10::irange(I)) {
+        dst[k] =
+            static_cast<float>(dst[k]) + alpha * static_cast<float>(src[k]);
+      }
+    }
+  }
+}
+
+template <typename scalar_t>
+void index_add_typed(
+    at::Tensor& self,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    float alpha,
+    bool wrap_negative,
+    int64_t O,
+    int64_t D,
+    int64_t N,
+    int64_t I) {
+  scalar_t* self_data = self.data_ptr<scalar_t>();
+  const scalar_t* source_data = source.data_ptr<scalar_t>();
+  AT_DISPATCH_INDEX_TYPES(index.scalar_type(), "index_add", [&] {
+    const index_t* index_data = index.data_ptr<index_t>();
+    if (O * N * I < at::internal::GRAIN_SIZE) {
+      index_add_sequential(
+          self_data,
+          source_data,
+          index_data,
+          alpha,
+          wrap_negative,
+          O,
+          D,
+          N,
+          I);
+      return;
+    }
+    auto plan = make_scatter_plan(index_data, N, D, wrap_negative);
+    index_add_sorted(self_data, source_data, plan, alpha, O, D, N, I);
+  });
+}
+
+void index_add_kernel_impl(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    float alpha,
+    bool wrap_negative) {
+  const int64_t O = c10::size_to_dim_(dim, self.sizes());
+  const int64_t D = self.size(dim);
+  const int64_t I = c10::size_from_dim_(dim + 1, self.sizes());
+  const int64_t N = index.numel();
+  if (O * I == 0 || N == 0) {
+    return;
+  }
+  auto source_ = source.contiguous();
+  if (self.scalar_type() == at::kFloat) {
+    index_add_typed<float>(
+        self, index, source_, alpha, wrap_negative, O, D, N, I);
+  } else {
+    index_add_typed<at::BFloat16>(
+        self, index, source_, alpha, wrap_negative, O, D, N, I);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(index_add_kernel_stub, &index_add_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,294 @@
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+
+#include <csrc/aten/cpu/Jagged.h>
+
+#include <algorithm>
+#include "csrc/cpu/vec/vec.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace torch_ipex::cpu::kernel;
+
+// Product of the trailing dims which are flattened into one row.
+inline int64_t jagged_row_size(const at::Tensor& t, int64_t first_dim) {
+  int64_t row_size = 1;
+  for (int64_t d = first_dim; d < t.dim(); d++) {
+    row_size *= t.size(d);
+  }
+  return row_size;
+}
+
+// Rows per task so that each task moves at least GRAIN_SIZE elements.
+inline int64_t jagged_grain_size(int64_t row_size) {
+  return std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / std::max<int64_t>(row_size, 1));
+}
+
+// The tail masks of the 1-byte move_ker and zero_ker are built with an int
+// shift, which breaks for tails of 32 bytes or more.
+template <typename scalar_t>
+inline void copy_rows(scalar_t* out, const scalar_t* in, int64_t len) {
+  if (sizeof(scalar_t) == 1) {
+    std::copy_n(in, len, out);
+  } else {
+    move_ker(out, in, len);
+  }
+}
+
+template <typename scalar_t>
+inline void zero_rows(scalar_t* out, int64_t len) {
+  if (sizeof(scalar_t) == 1) {
+    std::fill_n(out, len, static_cast<scalar_t>(0));
+  } else {
+    zero_ker(out, len);
+  }
+}
+
+template <typename scalar_t>
+inline void fill_rows(scalar_t* out, int64_t len, scalar_t value) {
+  if (value == static_cast<scalar_t>(0)) {
+    zero_rows(out, len);
+  } else {
+    std::fill_n(out, len, value);
+  }
+}
+
+/*
+  Walk the rows [begin, end) of the jagged values and call
+  f(b, j, n) for each run of n rows which belong to the b-th sequence and
+  start at its j-th row. Runs never cross a sequence boundary, so the rows of
+  a run are contiguous in both the jagged and the padded dense layout.
+*/
+template <typename F>
+inline void for_each_jagged_run(
+    const int64_t* offsets,
+    int64_t batch_size,
+    int64_t begin,
+    int64_t end,
+    const F& f) {
+  // first sequence whose end is after begin, empty sequences are skipped
+  int64_t b =
+      std::upper_bound(offsets, offsets + batch_size + 1, begin) - offsets - 1;
+  int64_t pos = begin;
+  while (pos < end) {
+    int64_t run_end = std::min(offsets[b + 1], end);
+    if (run_end > pos) {
+      f(b, pos - offsets[b], run_end - pos);
+    }
+    pos = run_end;
+    b++;
+  }
+}
+
+template <typename scalar_t>
+void jagged_to_padded_dense_kernel_body(
+    at::Tensor& dense,
+    const at::Tensor& values,
+    const int64_t* offsets,
+    scalar_t padding_value) {
+  const int64_t batch_size = dense.size(0);
+  const int64_t max_length = dense.size(1);
+  const int64_t D = jagged_row_size(values, 1);
+  const scalar_t* values_data = values.data_ptr<scalar_t>();
+  scalar_t* dense_data = dense.data_ptr<scalar_t>();
+
+  // Parallel over the padded rows so that a few long sequences are still
+  // split over all the threads. Inside a sequence the valid rows are a
+  // single contiguous copy and the padded rows a single contiguous fill.
+  at::parallel_for(
+      0,
+      batch_size * max_length,
+      jagged_grain_size(D),
+      [&](int64_t begin, int64_t end) {
+        int64_t pos = begin;
+        while (pos < end) {
+          int64_t b = pos / max_length;
+          int64_t j = pos % max_length;
+          int64_t run_end = std::min(end - pos + j, max_length);
+          int64_t length = offsets[b + 1] - offsets[b];
+          int64_t copy_end = std::max(std::min(length, run_end), j);
+          scalar_t* out = dense_data + pos * D;
+          if (copy_end > j) {
+            copy_rows(
+                out,
+                values_data + (offsets[b] + j) * D,
+                (copy_end - j) * D);
+          }
+          if (run_end > copy_end) {
+            fill_rows(
+                out + (copy_end - j) * D,
+                (run_end - copy_end) * D,
+                padding_value);
+          }
+          pos += run_end - j;
+        }
+      });
+}
+
+template <typename scalar_t>
+void padded_dense_to_jagged_kernel_body(
+    at::Tensor& values,
+    const at::Tensor& dense,
+    const int64_t* offsets) {
+  const int64_t batch_size = dense.size(0);
+  const int64_t max_length = dense.size(1);
+  const int64_t D = jagged_row_size(dense, 2);
+  const scalar_t* dense_data = dense.data_ptr<scalar_t>();
+  scalar_t* values_data = values.data_ptr<scalar_t>();
+
+  // rows of a sequence beyond max_length have no dense source and are zeros
+  at::parallel_for(
+      0,
+      values.size(0),
+      jagged_grain_size(D),
+      [&](int64_t begin, int64_t end) {
+        auto run_fn = [&](int64_t b, int64_t j, int64_t n) {
+          scalar_t* out = values_data + (offsets[b] + j) * D;
+          int64_t n_copy =
+              std::max<int64_t>(std::min<int64_t>(max_length - j, n), 0);
+          if (n_copy > 0) {
+            copy_rows(out, dense_data + (b * max_length + j) * D, n_copy * D);
+          }
+          if (n > n_copy) {
+            zero_rows(out + n_copy * D, (n - n_copy) * D);
+          }
+        };
+        for_each_jagged_run(offsets, batch_size, begin, end, run_fn);
+      });
+}
+
+/*
+  output = values op dense[b, j] for each jagged row, computed directly on the
+  compact layout so no FLOPs are spent on the padding. Rows beyond max_length
+  see a zero dense operand: they are copied for Add and zeroed for Mul.
+*/
+template <typename scalar_t, typename vec_func_t>
+void jagged_dense_elementwise_kernel_body(
+    at::Tensor& output,
+    const at::Tensor& values,
+    const int64_t* offsets,
+    const at::Tensor& dense,
+    const vec_func_t& vec_fun,
+    bool zero_beyond_dense) {
+  const int64_t batch_size = dense.size(0);
+  const int64_t max_length = dense.size(1);
+  const int64_t D = jagged_row_size(values, 1);
+  const scalar_t* values_data = values.data_ptr<scalar_t>();
+  const scalar_t* dense_data = dense.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  at::parallel_for(
+      0,
+      values.size(0),
+      jagged_grain_size(D),
+      [&](int64_t begin, int64_t end) {
+        auto run_fn = [&](int64_t b, int64_t j, int64_t n) {
+          int64_t row = offsets[b] + j;
+          int64_t n_dense =
+              std::max<int64_t>(std::min<int64_t>(max_length - j, n), 0);
+          if (n_dense > 0) {
+            at::vec::map2(
+                vec_fun,
+                output_data + row * D,
+                values_data + row * D,
+                dense_data + (b * max_length + j) * D,
+                n_dense * D);
+          }
+          if (n > n_dense) {
+            int64_t tail = (row + n_dense) * D;
+            if (zero_beyond_dense) {
+              zero_rows(output_data + tail, (n - n_dense) * D);
+            } else {
+              copy_rows(
+                  output_data + tail, values_data + tail, (n - n_dense) * D);
+            }
+          }
+        };
+        for_each_jagged_run(offsets, batch_size, begin, end, run_fn);
+      });
+}
+
+void jagged_to_padded_dense_kernel_impl(
+    at::Tensor& dense,
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    double padding_value) {
+  AT_DISPATCH_ALL_TYPES_AND(
+      at::ScalarType::BFloat16,
+      values.scalar_type(),
+      "jagged_to_padded_dense",
+      [&] {
+        jagged_to_padded_dense_kernel_body<scalar_t>(
+            dense,
+            values,
+            offsets.data_ptr<int64_t>(),
+            static_cast<scalar_t>(padding_value));
+      });
+}
+
+void padded_dense_to_jagged_kernel_impl(
+    at::Tensor& values,
+    const at::Tensor& dense,
+    const at::Tensor& offsets) {
+  AT_DISPATCH_ALL_TYPES_AND(
+      at::ScalarType::BFloat16,
+      dense.scalar_type(),
+      "padded_dense_to_jagged",
+      [&] {
+        padded_dense_to_jagged_kernel_body<scalar_t>(
+            values, dense, offsets.data_ptr<int64_t>());
+      });
+}
+
+void jagged_dense_elementwise_kernel_impl(
+    at::Tensor& output,
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense,
+    JaggedElementwiseOp op) {
+  AT_DISPATCH_ALL_TYPES_AND(
+      at::ScalarType::BFloat16,
+      values.scalar_type(),
+      "jagged_dense_elementwise",
+      [&] {
+        const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+        if (op == JaggedElementwiseOp::Add) {
+          jagged_dense_elementwise_kernel_body<scalar_t>(
+              output,
+              values,
+              offsets_data,
+              dense,
+              [](auto x, auto y) { return x + y; },
+              /* zero_beyond_dense */ false);
+        } else {
+          jagged_dense_elementwise_kernel_body<scalar_t>(
+              output,
+              values,
+              offsets_data,
+              dense,
+              [](auto x, auto y) { return x * y; },
+              /* zero_beyond_dense */ true);
+        }
+      });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    jagged_to_padded_dense_kernel_stub,
+    &jagged_to_padded_dense_kernel_impl);
+REGISTER_DISPATCH(
+    padded_dense_to_jagged_kernel_stub,
+    &padded_dense_to_jagged_kernel_impl);
+REGISTER_DISPATCH(
+    jagged_dense_elementwise_kernel_stub,
+    &jagged_dense_elementwise_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
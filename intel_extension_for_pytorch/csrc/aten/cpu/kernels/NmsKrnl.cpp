@@ -1,5 +1,7 @@
 // Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
 #include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
 #include <c10/util/Exception.h>
 #include <immintrin.h>
 #include <torch/csrc/autograd/function.h>
@@ -14,358 +16,288 @@ namespace cpu {
 
 namespace {
 
+// Boxes are grouped by 64 into the words of the suppression bitmask.
+constexpr int64_t kNmsMaskWordBits = 64;
+// The bitmask needs ndets * ndets bits, above this size the greedy pass
+// computes IoU on the fly instead.
+constexpr int64_t kNmsMaskBytesLimit = 256 * 1024 * 1024;
+
 /*
- When calculating the Intersection over Union:
-  MaskRCNN: bias = 1
-  SSD-Resnet34: bias = 0
+ Compute the suppression bits of box i: bit j of mask_row is set if j > i and
+ IoU(i, j) >= threshold. Boxes are in descending score order, so the words of
+ mask_row before (i + 1) / 64 hold no bits and are left untouched, they stay
+ zero from the initialization of the mask.
 */
-template <typename scalar_t, bool sorted>
-at::Tensor nms_cpu_kernel(
-    const at::Tensor& dets,
-    const at::Tensor& scores,
-    const float threshold,
-    float bias = 1.0);
+template <typename scalar_t>
+inline void nms_mask_row(
+    const scalar_t* x1,
+    const scalar_t* y1,
+    const scalar_t* x2,
+    const scalar_t* y2,
+    const scalar_t* areas,
+    int64_t ndets,
+    int64_t i,
+    float threshold,
+    float bias,
+    uint64_t* mask_row) {
+  const int64_t word_begin = (i + 1) / kNmsMaskWordBits;
+  const int64_t nwords = at::divup(ndets, kNmsMaskWordBits);
+  std::fill(mask_row + word_begin, mask_row + nwords, 0);
+
+  auto ix1 = x1[i];
+  auto iy1 = y1[i];
+  auto ix2 = x2[i];
+  auto iy2 = y2[i];
+  auto iarea = areas[i];
+  for (int64_t j = i + 1; j < ndets; j++) {
+    auto xx1 = std::max(ix1, x1[j]);
+    auto yy1 = std::max(iy1, y1[j]);
+    auto xx2 = std::min(ix2, x2[j]);
+    auto yy2 = std::min(iy2, y2[j]);
+
+    auto w = std::max(static_cast<scalar_t>(0), xx2 - xx1 + bias);
+    auto h = std::max(static_cast<scalar_t>(0), yy2 - yy1 + bias);
+    auto inter = w * h;
+    auto ovr = inter / (iarea + areas[j] - inter);
+    if (ovr >= threshold) {
+      mask_row[j / kNmsMaskWordBits] |= uint64_t(1) << (j % kNmsMaskWordBits);
+    }
+  }
+}
 
-template <typename scalar_t, bool sorted>
-at::Tensor nms_cpu_kernel(
-    const at::Tensor& dets,
-    const at::Tensor& scores,
-    const float threshold,
-    float bias) {
-  AT_ASSERTM(!dets.is_cuda(), "dets must be a CPU tensor");
-  AT_ASSERTM(!scores.is_cuda(), "scores must be a CPU tensor");
-  AT_ASSERTM(
-      dets.scalar_type() == scores.scalar_type(),
-      "dets should have the same type as scores");
+#ifdef CPU_CAPABILITY_AVX512
+// IoU of box i against 16 boxes at a time, the compare masks of 4 blocks
+// form one 64-bit word of the suppression bitmask.
+template <>
+inline void nms_mask_row<float>(
+    const float* x1,
+    const float* y1,
+    const float* x2,
+    const float* y2,
+    const float* areas,
+    int64_t ndets,
+    int64_t i,
+    float threshold,
+    float bias,
+    uint64_t* mask_row) {
+  const int64_t word_begin = (i + 1) / kNmsMaskWordBits;
+  const int64_t nwords = at::divup(ndets, kNmsMaskWordBits);
+  if (word_begin >= nwords) {
+    return;
+  }
 
-  if (dets.numel() == 0) {
-    return at::empty({0}, dets.options().dtype(at::kLong).device(at::kCPU));
+  __m512 m512_zero = _mm512_setzero_ps();
+  __m512 m512_bias = _mm512_set1_ps(bias);
+  __m512 m512_threshold = _mm512_set1_ps(threshold);
+  __m512 m512_ix1 = _mm512_set1_ps(x1[i]);
+  __m512 m512_iy1 = _mm512_set1_ps(y1[i]);
+  __m512 m512_ix2 = _mm512_set1_ps(x2[i]);
+  __m512 m512_iy2 = _mm512_set1_ps(y2[i]);
+  __m512 m512_iarea = _mm512_set1_ps(areas[i]);
+
+  for (int64_t w = word_begin; w < nwords; w++) {
+    uint64_t bits = 0;
+    for (int64_t k = 0; k < kNmsMaskWordBits; k += 16) {
+      int64_t j = w * kNmsMaskWordBits + k;
+      if (j >= ndets) {
+        break;
+      }
+      int64_t idx_left = ndets - j;
+      __mmask16 load_mask = idx_left >= 16 ? 0xFFFF : (1 << idx_left) - 1;
+
+      __m512 m512_x1 = _mm512_maskz_loadu_ps(load_mask, x1 + j);
+      __m512 m512_y1 = _mm512_maskz_loadu_ps(load_mask, y1 + j);
+      __m512 m512_x2 = _mm512_maskz_loadu_ps(load_mask, x2 + j);
+      __m512 m512_y2 = _mm512_maskz_loadu_ps(load_mask, y2 + j);
+      __m512 m512_areas = _mm512_maskz_loadu_ps(load_mask, areas + j);
+
+      __m512 m512_xx1 = _mm512_max_ps(m512_ix1, m512_x1);
+      __m512 m512_yy1 = _mm512_max_ps(m512_iy1, m512_y1);
+      __m512 m512_xx2 = _mm512_min_ps(m512_ix2, m512_x2);
+      __m512 m512_yy2 = _mm512_min_ps(m512_iy2, m512_y2);
+
+      __m512 m512_w = _mm512_max_ps(
+          m512_zero,
+          _mm512_add_ps(_mm512_sub_ps(m512_xx2, m512_xx1), m512_bias));
+      __m512 m512_h = _mm512_max_ps(
+          m512_zero,
+          _mm512_add_ps(_mm512_sub_ps(m512_yy2, m512_yy1), m512_bias));
+
+      __m512 m512_inter = _mm512_mul_ps(m512_w, m512_h);
+      __m512 m512_over = _mm512_div_ps(
+          m512_inter,
+          _mm512_sub_ps(_mm512_add_ps(m512_iarea, m512_areas), m512_inter));
+      __mmask16 mask_sus = _mm512_mask_cmp_ps_mask(
+          load_mask, m512_over, m512_threshold, _CMP_GE_OS);
+      bits |= static_cast<uint64_t>(mask_sus) << k;
+    }
+    mask_row[w] = bits;
   }
+  // boxes with higher scores than box i are never suppressed by it
+  mask_row[word_begin] &=
+      ~((uint64_t(1) << ((i + 1) % kNmsMaskWordBits)) - 1);
+}
+#endif
 
-  auto x1_t = dets.select(1, 0).contiguous();
-  auto y1_t = dets.select(1, 1).contiguous();
-  auto x2_t = dets.select(1, 2).contiguous();
-  auto y2_t = dets.select(1, 3).contiguous();
+/*
+ Greedy NMS over boxes already in descending score order, resolved on a
+ suppression bitmask:
+  Step1: compute the bitmask rows in parallel, row i and row ndets - 1 - i are
+         processed together so that every task has the same amount of IoU;
+  Step2: walk the boxes in order, a box is kept if it is not removed yet and
+         its row is OR-ed into the removed bits.
+ Returns the positions of the kept boxes in ascending order.
+*/
+template <typename scalar_t>
+at::Tensor nms_bitmask_kernel(
+    const scalar_t* x1,
+    const scalar_t* y1,
+    const scalar_t* x2,
+    const scalar_t* y2,
+    const scalar_t* areas,
+    int64_t ndets,
+    float threshold,
+    float bias) {
+  const int64_t nwords = at::divup(ndets, kNmsMaskWordBits);
+  at::Tensor keep_t = at::empty({ndets}, at::dtype(at::kLong));
+  auto keep = keep_t.data_ptr<int64_t>();
+  int64_t num_to_keep = 0;
+
+  if (ndets * nwords * (int64_t)sizeof(uint64_t) > kNmsMaskBytesLimit) {
+    std::vector<uint8_t> suppressed(ndets, 0);
+    for (int64_t i = 0; i < ndets; i++) {
+      if (suppressed[i] == 1)
+        continue;
+      keep[num_to_keep++] = i;
+      auto ix1 = x1[i];
+      auto iy1 = y1[i];
+      auto ix2 = x2[i];
+      auto iy2 = y2[i];
+      auto iarea = areas[i];
+      at::parallel_for(i + 1, ndets, 2048, [&](int64_t begin, int64_t end) {
+        for (int64_t j = begin; j < end; j++) {
+          auto xx1 = std::max(ix1, x1[j]);
+          auto yy1 = std::max(iy1, y1[j]);
+          auto xx2 = std::min(ix2, x2[j]);
+          auto yy2 = std::min(iy2, y2[j]);
+
+          auto w = std::max(static_cast<scalar_t>(0), xx2 - xx1 + bias);
+          auto h = std::max(static_cast<scalar_t>(0), yy2 - yy1 + bias);
+          auto inter = w * h;
+          auto ovr = inter / (iarea + areas[j] - inter);
+          if (ovr >= threshold)
+            suppressed[j] = 1;
+        }
+      });
+    }
+    return keep_t.resize_({num_to_keep});
+  }
 
-  at::Tensor areas_t = (x2_t - x1_t + bias) * (y2_t - y1_t + bias);
+  // Step1: suppression bitmask, ndets rows of nwords words
+  std::vector<uint64_t> mask(ndets * nwords);
+  at::parallel_for(0, (ndets + 1) / 2, 16, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; p++) {
+      nms_mask_row<scalar_t>(
+          x1,
+          y1,
+          x2,
+          y2,
+          areas,
+          ndets,
+          p,
+          threshold,
+          bias,
+          mask.data() + p * nwords);
+      int64_t q = ndets - 1 - p;
+      if (q != p) {
+        nms_mask_row<scalar_t>(
+            x1,
+            y1,
+            x2,
+            y2,
+            areas,
+            ndets,
+            q,
+            threshold,
+            bias,
+            mask.data() + q * nwords);
+      }
+    }
+  });
 
-  auto ndets = dets.size(0);
-  // If scores and dets are already sorted in descending order, we don't need to
-  // sort it again.
-  auto order_t = sorted
-      ? at::arange(0, ndets, scores.options().dtype(at::kLong))
-      : std::get<1>(scores.sort(0, /* descending=*/true));
-
-  at::Tensor suppressed_t =
-      at::zeros({ndets}, dets.options().dtype(at::kByte).device(at::kCPU));
-
-  auto suppressed = suppressed_t.data_ptr<uint8_t>();
-  auto order = order_t.data_ptr<int64_t>();
-  auto x1 = x1_t.data_ptr<scalar_t>();
-  auto y1 = y1_t.data_ptr<scalar_t>();
-  auto x2 = x2_t.data_ptr<scalar_t>();
-  auto y2 = y2_t.data_ptr<scalar_t>();
-  auto areas = areas_t.data_ptr<scalar_t>();
-  for (int64_t _i = 0; _i < ndets; _i++) {
-    auto i = order[_i];
-    if (suppressed[i] == 1)
+  // Step2: greedy pass with bit operations
+  std::vector<uint64_t> removed(nwords, 0);
+  for (int64_t i = 0; i < ndets; i++) {
+    int64_t word = i / kNmsMaskWordBits;
+    if (removed[word] & (uint64_t(1) << (i % kNmsMaskWordBits)))
       continue;
-    auto ix1 = x1[i];
-    auto iy1 = y1[i];
-    auto ix2 = x2[i];
-    auto iy2 = y2[i];
-    auto iarea = areas[i];
-
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-    for (int64_t _j = _i + 1; _j < ndets; _j++) {
-      auto j = order[_j];
-      if (suppressed[j] == 1)
-        continue;
-      auto xx1 = std::max(ix1, x1[j]);
-      auto yy1 = std::max(iy1, y1[j]);
-      auto xx2 = std::min(ix2, x2[j]);
-      auto yy2 = std::min(iy2, y2[j]);
-
-      auto w = std::max(static_cast<scalar_t>(0), xx2 - xx1 + bias);
-      auto h = std::max(static_cast<scalar_t>(0), yy2 - yy1 + bias);
-      auto inter = w * h;
-      auto ovr = inter / (iarea + areas[j] - inter);
-      if (ovr >= threshold)
-        suppressed[j] = 1;
+    keep[num_to_keep++] = i;
+    const uint64_t* mask_row = mask.data() + i * nwords;
+    for (int64_t w = word; w < nwords; w++) {
+      removed[w] |= mask_row[w];
     }
   }
-  return at::nonzero(suppressed_t == 0).squeeze(1);
+  return keep_t.resize_({num_to_keep});
 }
 
-#ifdef CPU_CAPABILITY_AVX512
-// Optimized nms_cpu_kernel specialized for data type: float32 and sorted_score
-template <>
-at::Tensor nms_cpu_kernel</*scalar_t*/ float, /*sorted*/ true>(
+/*
+ When calculating the Intersection over Union:
+  MaskRCNN: bias = 1
+  SSD-Resnet34: bias = 0
+*/
+template <typename scalar_t, bool sorted>
+at::Tensor nms_cpu_kernel(
     const at::Tensor& dets,
     const at::Tensor& scores,
     const float threshold,
-    float bias) {
+    float bias = 1.0) {
   AT_ASSERTM(!dets.is_cuda(), "dets must be a CPU tensor");
   AT_ASSERTM(!scores.is_cuda(), "scores must be a CPU tensor");
   AT_ASSERTM(
       dets.scalar_type() == scores.scalar_type(),
       "dets should have the same type as scores");
-
   AT_ASSERTM(dets.sizes().size() == 2, "dets should have 2 dimension");
   AT_ASSERTM(scores.sizes().size() == 1, "scores should have 1 dimension");
-
-  at::Tensor dets_bbox_number_in_lastdim = dets.permute({1, 0}).contiguous();
   AT_ASSERTM(
-      dets_bbox_number_in_lastdim.size(1) == scores.size(0),
+      dets.size(0) == scores.size(0),
       "dets should have number of bboxs as scores");
-  AT_ASSERTM(
-      dets_bbox_number_in_lastdim.size(0) == 4,
-      "each bbox in dets should have 4 coordinates");
-
-  if (dets_bbox_number_in_lastdim.numel() == 0) {
-    return at::empty(
-        {0},
-        dets_bbox_number_in_lastdim.options().dtype(at::kLong).device(
-            at::kCPU));
-  }
-
-  auto x1_t = dets_bbox_number_in_lastdim.select(0, 0).contiguous();
-  auto y1_t = dets_bbox_number_in_lastdim.select(0, 1).contiguous();
-  auto x2_t = dets_bbox_number_in_lastdim.select(0, 2).contiguous();
-  auto y2_t = dets_bbox_number_in_lastdim.select(0, 3).contiguous();
-
-  auto ndets = dets_bbox_number_in_lastdim.size(1);
-  auto ndets_up_scale = (ndets / 16 + 1) * 16;
-  auto ndets_down_scale = (ndets / 16) * 16;
-  at::Tensor&& areas_t =
-      at::zeros({ndets}, dets_bbox_number_in_lastdim.options()).contiguous();
-  auto areas = areas_t.data_ptr<float>();
-  auto x1 = x1_t.data_ptr<float>();
-  auto y1 = y1_t.data_ptr<float>();
-  auto x2 = x2_t.data_ptr<float>();
-  auto y2 = y2_t.data_ptr<float>();
-  __m512 m512_zero = _mm512_setzero_ps();
-  __m512 m512_bias = _mm512_set1_ps(bias);
-  __m128i m128_zeroi = _mm_setzero_si128();
 
-  // Step1: Calculate the area of all bbox's
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-  for (int i = 0; i < ndets_up_scale; i += 16) {
-    __m512 m512_x1;
-    __m512 m512_x2;
-    __m512 m512_y1;
-    __m512 m512_y2;
-    __m512 m512_result;
-    if (i < ndets_down_scale) {
-      // vector
-      m512_x1 = _mm512_loadu_ps(x1 + i);
-      m512_x2 = _mm512_loadu_ps(x2 + i);
-      m512_y1 = _mm512_loadu_ps(y1 + i);
-      m512_y2 = _mm512_loadu_ps(y2 + i);
-      if (bias == 0) {
-        m512_result = _mm512_mul_ps(
-            _mm512_sub_ps(m512_x2, m512_x1), _mm512_sub_ps(m512_y2, m512_y1));
-      } else {
-        m512_result = _mm512_mul_ps(
-            _mm512_add_ps(_mm512_sub_ps(m512_x2, m512_x1), m512_bias),
-            _mm512_add_ps(_mm512_sub_ps(m512_y2, m512_y1), m512_bias));
-      }
-      _mm512_storeu_ps(areas + i, m512_result);
-    } else {
-      // tail case
-      unsigned short left_idx = ndets - ndets_down_scale;
-      __mmask16 mask = (1 << left_idx) - 1; // 0x03ff;
-      m512_x1 = _mm512_mask_loadu_ps(m512_zero, mask, x1 + i);
-      m512_x2 = _mm512_mask_loadu_ps(m512_zero, mask, x2 + i);
-      m512_y1 = _mm512_mask_loadu_ps(m512_zero, mask, y1 + i);
-      m512_y2 = _mm512_mask_loadu_ps(m512_zero, mask, y2 + i);
-      if (bias == 0) {
-        m512_result = _mm512_mask_mul_ps(
-            m512_zero,
-            mask,
-            _mm512_mask_sub_ps(m512_zero, mask, m512_x2, m512_x1),
-            _mm512_mask_sub_ps(m512_zero, mask, m512_y2, m512_y1));
-      } else {
-        m512_result = _mm512_mask_mul_ps(
-            m512_zero,
-            mask,
-            _mm512_mask_add_ps(
-                m512_zero,
-                mask,
-                _mm512_mask_sub_ps(m512_zero, mask, m512_x2, m512_x1),
-                m512_bias),
-            _mm512_mask_add_ps(
-                m512_zero,
-                mask,
-                _mm512_mask_sub_ps(m512_zero, mask, m512_y2, m512_y1),
-                m512_bias));
-      }
-      _mm512_mask_storeu_ps(areas + i, mask, m512_result);
-    }
+  if (dets.numel() == 0) {
+    return at::empty({0}, dets.options().dtype(at::kLong).device(at::kCPU));
   }
-  // Step2: Go through the NMS flow
-  at::Tensor suppressed_t = at::zeros(
-      {ndets},
-      dets_bbox_number_in_lastdim.options().dtype(at::kByte).device(at::kCPU));
-  auto suppressed = suppressed_t.data_ptr<uint8_t>();
-  for (int64_t i = 0; i < ndets; i++) {
-    if (suppressed[i] == 1)
-      continue;
-    auto ix1 = x1[i];
-    auto iy1 = y1[i];
-    auto ix2 = x2[i];
-    auto iy2 = y2[i];
-    auto iarea = areas[i];
-
-    __m512 m512_ix1 = _mm512_set1_ps(ix1);
-    __m512 m512_ix2 = _mm512_set1_ps(ix2);
-    __m512 m512_iy1 = _mm512_set1_ps(iy1);
-    __m512 m512_iy2 = _mm512_set1_ps(iy2);
-    __m512 m512_iarea = _mm512_set1_ps(iarea);
-    __m512 m512_threshold = _mm512_set1_ps(threshold);
-
-    auto ndets_i_up_scale = ((ndets - i - 1) / 16 + 1) * 16;
-    auto ndets_i_down_scale = ((ndets - i - 1) / 16) * 16;
+  AT_ASSERTM(dets.size(1) == 4, "each bbox in dets should have 4 coordinates");
 
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-    for (int64_t _j = 0; _j < ndets_i_up_scale; _j += 16) {
-      if (_j < ndets_i_down_scale) {
-        int64_t j = _j + i + 1;
-        __m512 m512_x1 = _mm512_loadu_ps(x1 + j);
-        __m512 m512_x2 = _mm512_loadu_ps(x2 + j);
-        __m512 m512_y1 = _mm512_loadu_ps(y1 + j);
-        __m512 m512_y2 = _mm512_loadu_ps(y2 + j);
-
-        __m512 m512_xx1 = _mm512_max_ps(m512_ix1, m512_x1);
-        __m512 m512_yy1 = _mm512_max_ps(m512_iy1, m512_y1);
-        __m512 m512_xx2 = _mm512_min_ps(m512_ix2, m512_x2);
-        __m512 m512_yy2 = _mm512_min_ps(m512_iy2, m512_y2);
-
-        __m512 m512_w;
-        __m512 m512_h;
-        if (bias == 0) {
-          m512_w = _mm512_max_ps(m512_zero, _mm512_sub_ps(m512_xx2, m512_xx1));
-          m512_h = _mm512_max_ps(m512_zero, _mm512_sub_ps(m512_yy2, m512_yy1));
-        } else {
-          m512_w = _mm512_max_ps(
-              m512_zero,
-              _mm512_add_ps(_mm512_sub_ps(m512_xx2, m512_xx1), m512_bias));
-          m512_h = _mm512_max_ps(
-              m512_zero,
-              _mm512_add_ps(_mm512_sub_ps(m512_yy2, m512_yy1), m512_bias));
-        }
-
-        __m512 m512_inter = _mm512_mul_ps(m512_w, m512_h);
-        __m512 m512_areas = _mm512_loadu_ps(areas + j);
-        __m512 m512_over = _mm512_div_ps(
-            m512_inter,
-            _mm512_sub_ps(_mm512_add_ps(m512_iarea, m512_areas), m512_inter));
-        __mmask16 mask_sus =
-            _mm512_cmp_ps_mask(m512_over, m512_threshold, _CMP_GE_OS);
-        __m128i res_sus = _mm_mask_set1_epi8(m128_zeroi, mask_sus, 1);
-        _mm_mask_storeu_epi8(suppressed + j, mask_sus, res_sus);
+  // If scores and dets are already sorted in descending order, we don't need to
+  // sort it again.
+  at::Tensor order_t;
+  at::Tensor dets_sorted = dets;
+  if (!sorted) {
+    order_t = std::get<1>(scores.sort(0, /* descending=*/true));
+    dets_sorted = dets.index_select(0, order_t);
+  }
+  // put the box coordinates in the lastdim in score order
+  at::Tensor dets_bbox_number_in_lastdim = dets_sorted.t().contiguous();
+  auto x1_t = dets_bbox_number_in_lastdim.select(0, 0);
+  auto y1_t = dets_bbox_number_in_lastdim.select(0, 1);
+  auto x2_t = dets_bbox_number_in_lastdim.select(0, 2);
+  auto y2_t = dets_bbox_number_in_lastdim.select(0, 3);
+  at::Tensor areas_t = (x2_t - x1_t + bias) * (y2_t - y1_t + bias);
 
-      } else {
-        // Tail case
-        int64_t j = _j + i + 1;
-        int64_t idx_left = ndets - j;
-        __mmask16 load_mask = (1 << idx_left) - 1;
-
-        __m512 m512_x1 = _mm512_mask_loadu_ps(m512_zero, load_mask, x1 + j);
-        __m512 m512_x2 = _mm512_mask_loadu_ps(m512_zero, load_mask, x2 + j);
-        __m512 m512_y1 = _mm512_mask_loadu_ps(m512_zero, load_mask, y1 + j);
-        __m512 m512_y2 = _mm512_mask_loadu_ps(m512_zero, load_mask, y2 + j);
-
-        __m512 m512_xx1 =
-            _mm512_mask_max_ps(m512_zero, load_mask, m512_ix1, m512_x1);
-        __m512 m512_yy1 =
-            _mm512_mask_max_ps(m512_zero, load_mask, m512_iy1, m512_y1);
-        __m512 m512_xx2 =
-            _mm512_mask_min_ps(m512_zero, load_mask, m512_ix2, m512_x2);
-        __m512 m512_yy2 =
-            _mm512_mask_min_ps(m512_zero, load_mask, m512_iy2, m512_y2);
-
-        __m512 m512_w;
-        __m512 m512_h;
-        if (bias == 0) {
-          m512_w = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_sub_ps(m512_zero, load_mask, m512_xx2, m512_xx1));
-          m512_h = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_sub_ps(m512_zero, load_mask, m512_yy2, m512_yy1));
-        } else {
-          m512_w = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_add_ps(
-                  m512_zero,
-                  load_mask,
-                  _mm512_mask_sub_ps(m512_zero, load_mask, m512_xx2, m512_xx1),
-                  m512_bias));
-          m512_h = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_add_ps(
-                  m512_zero,
-                  load_mask,
-                  _mm512_mask_sub_ps(m512_zero, load_mask, m512_yy2, m512_yy1),
-                  m512_bias));
-        }
-        __m512 m512_inter =
-            _mm512_mask_mul_ps(m512_zero, load_mask, m512_w, m512_h);
-        __m512 m512_areas =
-            _mm512_mask_loadu_ps(m512_zero, load_mask, areas + j);
-        __m512 m512_over = _mm512_mask_div_ps(
-            m512_zero,
-            load_mask,
-            m512_inter,
-            _mm512_mask_sub_ps(
-                m512_zero,
-                load_mask,
-                _mm512_mask_add_ps(
-                    m512_zero, load_mask, m512_iarea, m512_areas),
-                m512_inter));
-        __mmask16 mask_sus = _mm512_mask_cmp_ps_mask(
-            load_mask, m512_over, m512_threshold, _CMP_GE_OS);
-        __m128i res_sus = _mm_mask_set1_epi8(m128_zeroi, mask_sus, 1);
-        _mm_mask_storeu_epi8(suppressed + j, mask_sus, res_sus);
-      }
-    }
+  at::Tensor keep = nms_bitmask_kernel<scalar_t>(
+      x1_t.data_ptr<scalar_t>(),
+      y1_t.data_ptr<scalar_t>(),
+      x2_t.data_ptr<scalar_t>(),
+      y2_t.data_ptr<scalar_t>(),
+      areas_t.data_ptr<scalar_t>(),
+      dets.size(0),
+      threshold,
+      bias);
+  if (sorted) {
+    return keep;
   }
-  return at::nonzero(suppressed_t == 0).squeeze(1);
+  // kept indices are returned in ascending order of the original boxes
+  return std::get<0>(order_t.index_select(0, keep).sort(0));
 }
-#endif
 
 std::vector<at::Tensor> remove_empty(
     std::vector<at::Tensor>& candidate,
@@ -402,13 +334,16 @@ batch_score_nms_kernel(
   std::vector<at::Tensor> scores_out(nbatch_x_nscore);
   std::vector<at::Tensor> labels_out(nbatch_x_nscore);
 
+  // Only parallelize across (batch x class) when there are enough of them to
+  // occupy all the threads, otherwise leave the threads to the NMS engine.
+  const bool outer_parallel = nbatch_x_nscore >= at::get_num_threads();
 #ifdef _OPENMP
 #if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#pragma omp parallel for simd schedule(static) if ( \
+    outer_parallel && omp_get_max_threads() > 1 && !omp_in_parallel())
 #else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#pragma omp parallel for schedule(static) if ( \
+    outer_parallel && omp_get_max_threads() > 1 && !omp_in_parallel())
 #endif
 #endif
   // skip background (i = 0)
@@ -515,13 +450,16 @@ std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>> rpn_nms_kernel(
   std::vector<at::Tensor> bboxes_out(nbatch);
   std::vector<at::Tensor> scores_out(nbatch);
 
+  // Only parallelize across images when there are enough of them to occupy
+  // all the threads, otherwise leave the threads to the NMS engine.
+  const bool outer_parallel = nbatch >= at::get_num_threads();
 #ifdef _OPENMP
 #if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#pragma omp parallel for simd schedule(static) if ( \
+    outer_parallel && omp_get_max_threads() > 1 && !omp_in_parallel())
 #else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#pragma omp parallel for schedule(static) if ( \
+    outer_parallel && omp_get_max_threads() > 1 && !omp_in_parallel())
 #endif
 #endif
   for (int i = 0; i < nbatch; i++) {
@@ -581,13 +519,16 @@ box_head_nms_kernel(
   std::vector<at::Tensor> scores_out(nbatch_x_nclass);
   std::vector<at::Tensor> labels_out(nbatch_x_nclass);
 
+  // Only parallelize across images when there are enough of them to occupy
+  // all the threads, otherwise leave the threads to the NMS engine.
+  const bool outer_parallel = (int64_t)nbatch >= at::get_num_threads();
 #ifdef _OPENMP
 #if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#pragma omp parallel for simd schedule(static) if ( \
+    outer_parallel && omp_get_max_threads() > 1 && !omp_in_parallel())
 #else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#pragma omp parallel for schedule(static) if ( \
+    outer_parallel && omp_get_max_threads() > 1 && !omp_in_parallel())
 #endif
 #endif
   for (int bs = 0; bs < nbatch; bs++) {
@@ -670,6 +611,226 @@ box_head_nms_kernel(
   return std::make_tuple(bboxes_out_, scores_out_, labels_out_);
 }
 
+template <typename scalar_t>
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+batch_decode_score_nms_kernel(
+    const at::Tensor& batch_bboxes_in,
+    const at::Tensor& batch_scores_in,
+    const at::Tensor& dboxes_xywh,
+    const float scale_xy,
+    const float scale_wh,
+    const float score_threshold,
+    const float threshold,
+    const int max_output) {
+  // batch_bboxes_in: (batchsize, num_bbox, 4) in xywh offsets to the anchors
+  // batch_scores_in: (batchsize, num_bbox, label_num) logits before Softmax
+  // dboxes_xywh: (1, num_bbox, 4) anchors in xywh
+  //
+  // Each (image, class) is streamed in one parallel region:
+  //   score threshold -> partial top-k -> decode from anchors -> NMS,
+  // so only the boxes surviving the threshold and top-k are decoded, and
+  // neither the decoded boxes nor the Softmax output is materialized.
+  auto nbatch = batch_scores_in.size(0); // number of batches
+  auto ndets = batch_scores_in.size(1); // number of boxes
+  auto nscore = batch_scores_in.size(2); // number of labels
+  auto nbatch_x_nscore = nbatch * nscore;
+
+  auto bboxes_in = batch_bboxes_in.contiguous();
+  auto scores_in = batch_scores_in.contiguous();
+  auto dboxes = dboxes_xywh.to(batch_bboxes_in.scalar_type()).contiguous();
+  const scalar_t* bboxes_in_data = bboxes_in.data_ptr<scalar_t>();
+  const scalar_t* scores_in_data = scores_in.data_ptr<scalar_t>();
+  const scalar_t* dboxes_data = dboxes.data_ptr<scalar_t>();
+
+  // Step1: Softmax statistics (max and 1 / sum(exp)) of each box, the
+  // probability of one class is computed on the fly from them.
+  std::vector<scalar_t> box_max(nbatch * ndets);
+  std::vector<scalar_t> box_inv_sum(nbatch * ndets);
+  at::parallel_for(0, nbatch * ndets, 64, [&](int64_t begin, int64_t end) {
+    using Vec = at::vec::Vectorized<scalar_t>;
+    for (int64_t k = begin; k < end; k++) {
+      const scalar_t* logits = scores_in_data + k * nscore;
+      scalar_t max = at::vec::reduce_all<scalar_t>(
+          [](Vec& x, Vec& y) { return at::vec::maximum(x, y); },
+          logits,
+          nscore);
+      scalar_t sum = at::vec::map_reduce_all<scalar_t>(
+          [max](Vec x) { return (x - Vec(max)).exp(); },
+          [](Vec x, Vec y) { return x + y; },
+          logits,
+          nscore);
+      box_max[k] = max;
+      box_inv_sum[k] = scalar_t(1) / sum;
+    }
+  });
+
+  // preallocated slots of the NMS results of each (image, class)
+  std::vector<scalar_t> slot_bboxes(nbatch_x_nscore * max_output * 4);
+  std::vector<scalar_t> slot_scores(nbatch_x_nscore * max_output);
+  std::vector<int64_t> slot_length(nbatch_x_nscore, 0);
+
+  auto process = [&](int64_t index,
+                     std::vector<std::pair<scalar_t, int64_t>>& candidates,
+                     std::vector<scalar_t>& decoded) {
+    auto bs = index / nscore;
+    auto i = index % nscore;
+    // skip background (i = 0)
+    if (i == 0) {
+      return;
+    }
+
+    // Step2: score threshold
+    candidates.clear();
+    const scalar_t* logits = scores_in_data + bs * ndets * nscore;
+    const scalar_t* max = box_max.data() + bs * ndets;
+    const scalar_t* inv_sum = box_inv_sum.data() + bs * ndets;
+    for (int64_t j = 0; j < ndets; j++) {
+      scalar_t prob = std::exp(logits[j * nscore + i] - max[j]) * inv_sum[j];
+      if (prob > score_threshold) {
+        candidates.emplace_back(prob, j);
+      }
+    }
+    if (candidates.empty()) {
+      return;
+    }
+
+    // Step3: partial top-k, higher score first and lower index first on ties
+    auto greater = [](const std::pair<scalar_t, int64_t>& a,
+                      const std::pair<scalar_t, int64_t>& b) {
+      return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+    int64_t k = std::min<int64_t>(max_output, candidates.size());
+    if (k < (int64_t)candidates.size()) {
+      std::nth_element(
+          candidates.begin(),
+          candidates.begin() + k,
+          candidates.end(),
+          greater);
+    }
+    std::sort(candidates.begin(), candidates.begin() + k, greater);
+
+    // Step4: decode the top-k boxes to ltrb, coordinates in the lastdim
+    decoded.resize(k * 5);
+    scalar_t* x1 = decoded.data();
+    scalar_t* y1 = x1 + k;
+    scalar_t* x2 = y1 + k;
+    scalar_t* y2 = x2 + k;
+    scalar_t* areas = y2 + k;
+    for (int64_t t = 0; t < k; t++) {
+      int64_t j = candidates[t].second;
+      const scalar_t* loc = bboxes_in_data + (bs * ndets + j) * 4;
+      const scalar_t* dbox = dboxes_data + j * 4;
+      scalar_t x = loc[0] * scale_xy * dbox[2] + dbox[0];
+      scalar_t y = loc[1] * scale_xy * dbox[3] + dbox[1];
+      scalar_t w = std::exp(loc[2] * scale_wh) * dbox[2];
+      scalar_t h = std::exp(loc[3] * scale_wh) * dbox[3];
+      x1[t] = x - scalar_t(0.5) * w;
+      y1[t] = y - scalar_t(0.5) * h;
+      x2[t] = x + scalar_t(0.5) * w;
+      y2[t] = y + scalar_t(0.5) * h;
+      areas[t] = (x2[t] - x1[t]) * (y2[t] - y1[t]);
+    }
+
+    // Step5: NMS, write the kept boxes into the slot of (image, class)
+    at::Tensor keep = nms_bitmask_kernel<scalar_t>(
+        x1, y1, x2, y2, areas, k, threshold, /*bias*/ 0);
+    auto keep_data = keep.data_ptr<int64_t>();
+    scalar_t* bboxes_out = slot_bboxes.data() + index * max_output * 4;
+    scalar_t* scores_out = slot_scores.data() + index * max_output;
+    for (int64_t t = 0; t < keep.size(0); t++) {
+      int64_t p = keep_data[t];
+      bboxes_out[t * 4] = x1[p];
+      bboxes_out[t * 4 + 1] = y1[p];
+      bboxes_out[t * 4 + 2] = x2[p];
+      bboxes_out[t * 4 + 3] = y2[p];
+      scores_out[t] = candidates[p].first;
+    }
+    slot_length[index] = keep.size(0);
+  };
+
+  // With few (image, class) pairs, leave the threads to the NMS engine.
+  if (nbatch_x_nscore >= at::get_num_threads()) {
+    at::parallel_for(0, nbatch_x_nscore, 1, [&](int64_t begin, int64_t end) {
+      std::vector<std::pair<scalar_t, int64_t>> candidates;
+      std::vector<scalar_t> decoded;
+      candidates.reserve(ndets);
+      for (int64_t index = begin; index < end; index++) {
+        process(index, candidates, decoded);
+      }
+    });
+  } else {
+    std::vector<std::pair<scalar_t, int64_t>> candidates;
+    std::vector<scalar_t> decoded;
+    candidates.reserve(ndets);
+    for (int64_t index = 0; index < nbatch_x_nscore; index++) {
+      process(index, candidates, decoded);
+    }
+  }
+
+  // Step6: keep the top max_output detections of each image, in ascending
+  // order of scores as batch_score_nms does.
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> selected(nbatch);
+  at::parallel_for(0, nbatch, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t bs = begin; bs < end; bs++) {
+      // (slot index, position in slot)
+      std::vector<std::pair<int64_t, int64_t>>& dets = selected[bs];
+      for (int64_t index = bs * nscore; index < (bs + 1) * nscore; index++) {
+        for (int64_t t = 0; t < slot_length[index]; t++) {
+          dets.emplace_back(index, t);
+        }
+      }
+      auto score_of = [&](const std::pair<int64_t, int64_t>& d) {
+        return slot_scores[d.first * max_output + d.second];
+      };
+      auto greater = [&](const std::pair<int64_t, int64_t>& a,
+                         const std::pair<int64_t, int64_t>& b) {
+        return score_of(a) > score_of(b);
+      };
+      if ((int64_t)dets.size() > max_output) {
+        std::nth_element(
+            dets.begin(), dets.begin() + max_output, dets.end(), greater);
+        dets.resize(max_output);
+      }
+      auto less = [&](const std::pair<int64_t, int64_t>& a,
+                      const std::pair<int64_t, int64_t>& b) {
+        return score_of(a) < score_of(b);
+      };
+      std::sort(dets.begin(), dets.end(), less);
+    }
+  });
+
+  std::vector<int64_t> offsets(nbatch + 1, 0);
+  for (int64_t bs = 0; bs < nbatch; bs++) {
+    offsets[bs + 1] = offsets[bs] + selected[bs].size();
+  }
+  at::Tensor bboxes_out_ =
+      at::empty({offsets[nbatch], 4}, batch_bboxes_in.options());
+  at::Tensor labels_out_ = at::empty({offsets[nbatch]}, at::kFloat);
+  at::Tensor scores_out_ =
+      at::empty({offsets[nbatch]}, batch_scores_in.options());
+  at::Tensor length_out_ = at::empty({nbatch}, at::kInt);
+  auto bboxes_out_data = bboxes_out_.data_ptr<scalar_t>();
+  auto labels_out_data = labels_out_.data_ptr<float>();
+  auto scores_out_data = scores_out_.data_ptr<scalar_t>();
+  auto length_out_data = length_out_.data_ptr<int32_t>();
+  at::parallel_for(0, nbatch, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t bs = begin; bs < end; bs++) {
+      const std::vector<std::pair<int64_t, int64_t>>& dets = selected[bs];
+      for (int64_t t = 0; t < (int64_t)dets.size(); t++) {
+        int64_t index = dets[t].first;
+        int64_t pos = index * max_output + dets[t].second;
+        int64_t o = offsets[bs] + t;
+        std::copy_n(slot_bboxes.data() + pos * 4, 4, bboxes_out_data + o * 4);
+        labels_out_data[o] = index % nscore;
+        scores_out_data[o] = slot_scores[pos];
+      }
+      length_out_data[bs] = dets.size();
+    }
+  });
+  return std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>(
+      bboxes_out_, labels_out_, scores_out_, length_out_);
+}
+
 at::Tensor nms_cpu_kernel_impl(
     const at::Tensor& dets,
     const at::Tensor& scores,
@@ -697,6 +858,32 @@ batch_score_nms_cpu_kernel_impl(
   return result;
 }
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+batch_decode_score_nms_cpu_kernel_impl(
+    const at::Tensor& bboxes_in,
+    const at::Tensor& scores_in,
+    const at::Tensor& dboxes_xywh,
+    const float scale_xy,
+    const float scale_wh,
+    const float score_threshold,
+    const float threshold,
+    const int max_output) {
+  std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor> result;
+  AT_DISPATCH_FLOATING_TYPES(
+      bboxes_in.scalar_type(), "batch_decode_score_nms", [&] {
+        result = batch_decode_score_nms_kernel<scalar_t>(
+            bboxes_in,
+            scores_in,
+            dboxes_xywh,
+            scale_xy,
+            scale_wh,
+            score_threshold,
+            threshold,
+            max_output);
+      });
+  return result;
+}
+
 std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>>
 rpn_nms_cpu_kernel_impl(
     const at::Tensor& batch_dets,
@@ -757,6 +944,10 @@ REGISTER_DISPATCH(
     batch_score_nms_cpu_kernel_stub,
     &batch_score_nms_cpu_kernel_impl);
 
+REGISTER_DISPATCH(
+    batch_decode_score_nms_cpu_kernel_stub,
+    &batch_decode_score_nms_cpu_kernel_impl);
+
 REGISTER_DISPATCH(rpn_nms_cpu_kernel_stub, &rpn_nms_cpu_kernel_impl);
 
 REGISTER_DISPATCH(box_head_nms_cpu_kernel_stub, &box_head_nms_cpu_kernel_impl);
@@ -0,0 +1,422 @@
+#include <ATen/ATen.h>
+
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <ATen/native/cpu/utils.h>
+#include <ATen/native/quantized/AffineQuantizerBase.h>
+#include <c10/util/irange.h>
+
+#include <csrc/aten/cpu/Pooling.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using fVec = at::vec::Vectorized<float>;
+
+// The in bounds input indices of a window along one dim:
+// begin, begin + dilation, ... for count indices.
+struct WindowRange {
+  int64_t begin;
+  int64_t count;
+  // the window size clamped to the padded input, for count_include_pad
+  int64_t padded_count;
+};
+
+inline WindowRange window_range(
+    int64_t o,
+    int64_t input_size,
+    int64_t kernel,
+    int64_t stride,
+    int64_t padding,
+    int64_t dilation) {
+  const int64_t start = o * stride - padding;
+  const int64_t first = start < 0 ? (-start + dilation - 1) / dilation : 0;
+  const int64_t last =
+      std::min(kernel, (input_size - start + dilation - 1) / dilation);
+  WindowRange range;
+  range.begin = start + first * dilation;
+  range.count = std::max<int64_t>(last - first, 0);
+  range.padded_count =
+      std::min(start + kernel, input_size + padding) - start;
+  return range;
+}
+
+// NHWC is handled as NDHWC with a depth of 1
+struct PoolingShape {
+  int64_t nbatch;
+  int64_t channels;
+  std::array<int64_t, 3> input_size;
+  std::array<int64_t, 3> output_size;
+
+  PoolingShape(const at::Tensor& input, const at::Tensor& output) {
+    const int64_t dims = input.dim() - 2;
+    nbatch = input.size(0);
+    channels = input.size(1);
+    input_size = {1, 1, 1};
+    output_size = {1, 1, 1};
+    for (int64_t d = 0; d < dims; d++) {
+      input_size[3 - dims + d] = input.size(2 + d);
+      output_size[3 - dims + d] = output.size(2 + d);
+    }
+  }
+
+  int64_t input_image_size() const {
+    return input_size[0] * input_size[1] * input_size[2];
+  }
+
+  int64_t num_outputs() const {
+    return nbatch * output_size[0] * output_size[1] * output_size[2];
+  }
+
+  std::array<WindowRange, 3> window(
+      const std::array<int64_t, 3>& o,
+      const PoolingParams& params) const {
+    std::array<WindowRange, 3> ranges;
+    for (const auto d : c10::irange(3)) {
+      ranges[d] = window_range(
+          o[d],
+          input_size[d],
+          params.kernel[d],
+          params.stride[d],
+          params.padding[d],
+          params.dilation[d]);
+    }
+    return ranges;
+  }
+
+  // Calls f with the offset of each in bounds input pixel of the window,
+  // relative to the start of the image.
+  template <typename func_t>
+  void for_each_pixel(
+      const std::array<WindowRange, 3>& ranges,
+      const PoolingParams& params,
+      const func_t& f) const {
+    for (const auto kd : c10::irange(ranges[0].count)) {
+      const int64_t id = ranges[0].begin + kd * params.dilation[0];
+      for (const auto kh : c10::irange(ranges[1].count)) {
+        const int64_t ih = ranges[1].begin + kh * params.dilation[1];
+        for (const auto kw : c10::irange(ranges[2].count)) {
+          const int64_t iw = ranges[2].begin + kw * params.dilation[2];
+          f((id * input_size[1] + ih) * input_size[2] + iw);
+        }
+      }
+    }
+  }
+};
+
+inline int64_t window_count(const std::array<WindowRange, 3>& ranges) {
+  return ranges[0].count * ranges[1].count * ranges[2].count;
+}
+
+inline int64_t avg_divide_factor(
+    const std::array<WindowRange, 3>& ranges,
+    const PoolingParams& params) {
+  if (params.divisor_override.has_value()) {
+    return params.divisor_override.value();
+  }
+  if (params.count_include_pad) {
+    return ranges[0].padded_count * ranges[1].padded_count *
+        ranges[2].padded_count;
+  }
+  return window_count(ranges);
+}
+
+// Parallel on dim N, {D}, H, W: calls f(i, n, o) for each output pixel i of
+// image n at position o.
+template <typename func_t>
+void parallel_for_output_pixels(const PoolingShape& shape, const func_t& f) {
+  at::parallel_for(0, shape.num_outputs(), 0, [&](int64_t begin, int64_t end) {
+    int64_t n = 0;
+    std::array<int64_t, 3> o = {0, 0, 0};
+    at::native::data_index_init(
+        begin,
+        n,
+        shape.nbatch,
+        o[0],
+        shape.output_size[0],
+        o[1],
+        shape.output_size[1],
+        o[2],
+        shape.output_size[2]);
+    for (const auto i : c10::irange(begin, end)) {
+      f(i, n, o);
+      at::native::data_index_step(
+          n,
+          shape.nbatch,
+          o[0],
+          shape.output_size[0],
+          o[1],
+          shape.output_size[1],
+          o[2],
+          shape.output_size[2]);
+    }
+  });
+}
+
+inline const float* load_row(
+    const float* in,
+    float* /* buffer */,
+    int64_t /* size */) {
+  return in;
+}
+
+inline const float* load_row(
+    const at::BFloat16* in,
+    float* buffer,
+    int64_t size) {
+  at::vec::convert(in, buffer, size);
+  return buffer;
+}
+
+// acc[0:size] = max(acc[0:size], in[0:size]), NaN is propagated
+inline void max_row(float* acc, const float* in, int64_t size) {
+  at::vec::map2(
+      [](fVec a, fVec x) { return at::vec::maximum(a, x); },
+      acc,
+      acc,
+      in,
+      size);
+}
+
+// acc[0:size] += in[0:size], or relu(in[0:size])
+inline void sum_row(float* acc, const float* in, int64_t size, bool relu) {
+  if (relu) {
+    const fVec zero(0.f);
+    at::vec::map2(
+        [zero](fVec a, fVec x) { return a + at::vec::maximum(x, zero); },
+        acc,
+        acc,
+        in,
+        size);
+  } else {
+    at::vec::map2(
+        [](fVec a, fVec x) { return a + x; }, acc, acc, in, size);
+  }
+}
+
+inline void store_row(
+    float* out,
+    const float* acc,
+    int64_t size,
+    double /* scale */,
+    int64_t /* zero_point */) {
+  std::copy(acc, acc + size, out);
+}
+
+inline void store_row(
+    at::BFloat16* out,
+    const float* acc,
+    int64_t size,
+    double /* scale */,
+    int64_t /* zero_point */) {
+  at::vec::convert(acc, out, size);
+}
+
+// the quantize_per_tensor following the pooling
+template <typename qscalar_t>
+inline void store_row(
+    qscalar_t* out,
+    const float* acc,
+    int64_t size,
+    double scale,
+    int64_t zero_point) {
+  for (const auto c : c10::irange(size)) {
+    out[c] = at::native::quantize_val<qscalar_t>(scale, zero_point, acc[c]);
+  }
+}
+
+// FP32 or BF16 input, the window is reduced in FP32
+template <typename scalar_t, typename out_t>
+void pooling_float_channels_last(
+    const at::Tensor& output,
+    const at::Tensor& input,
+    const PoolingParams& params) {
+  const PoolingShape shape(input, output);
+  const int64_t C = shape.channels;
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  out_t* output_data = output.data_ptr<out_t>();
+  const double scale = output.is_quantized() ? output.q_scale() : 1.0;
+  const int64_t zero_point =
+      output.is_quantized() ? output.q_zero_point() : 0;
+  // max(relu(x)) is max(0, max(x))
+  const float init = params.is_max && !params.fuse_relu
+      ? -std::numeric_limits<float>::infinity()
+      : 0.f;
+
+  parallel_for_output_pixels(
+      shape, [&](int64_t i, int64_t n, const std::array<int64_t, 3>& o) {
+        // one row of C channels per output pixel, the buffers are reused by
+        // the following pixels of the task
+        thread_local std::vector<float> acc;
+        thread_local std::vector<float> buffer;
+        acc.assign(C, init);
+        buffer.resize(std::is_same<scalar_t, float>::value ? 0 : C);
+
+        const auto ranges = shape.window(o, params);
+        const scalar_t* image =
+            input_data + n * shape.input_image_size() * C;
+        shape.for_each_pixel(ranges, params, [&](int64_t offset) {
+          const float* in = load_row(image + offset * C, buffer.data(), C);
+          if (params.is_max) {
+            max_row(acc.data(), in, C);
+          } else {
+            sum_row(acc.data(), in, C, params.fuse_relu);
+          }
+        });
+        if (!params.is_max && window_count(ranges) > 0) {
+          const fVec divide_factor(
+              static_cast<float>(avg_divide_factor(ranges, params)));
+          at::vec::map(
+              [divide_factor](fVec a) { return a / divide_factor; },
+              acc.data(),
+              acc.data(),
+              C);
+        }
+        store_row(output_data + i * C, acc.data(), C, scale, zero_point);
+      });
+}
+
+// Quantized input, the output shares its quantization parameters. The window
+// is reduced on the integer values: max directly in the underlying type, avg
+// in int32 with the zero point taken out of the sum.
+template <typename qscalar_t>
+void pooling_quantized_channels_last(
+    const at::Tensor& output,
+    const at::Tensor& input,
+    const PoolingParams& params) {
+  using underlying_t = typename qscalar_t::underlying;
+  using Vec = at::vec::Vectorized<underlying_t>;
+  const PoolingShape shape(input, output);
+  const int64_t C = shape.channels;
+  const underlying_t* input_data =
+      reinterpret_cast<const underlying_t*>(input.data_ptr<qscalar_t>());
+  underlying_t* output_data =
+      reinterpret_cast<underlying_t*>(output.data_ptr<qscalar_t>());
+  const int64_t zero_point = input.q_zero_point();
+  // relu(x) is max(x, zero_point) on the quantized values
+  const underlying_t relu_min = static_cast<underlying_t>(zero_point);
+  constexpr int64_t qmin = std::numeric_limits<underlying_t>::min();
+  constexpr int64_t qmax = std::numeric_limits<underlying_t>::max();
+
+  parallel_for_output_pixels(
+      shape, [&](int64_t i, int64_t n, const std::array<int64_t, 3>& o) {
+        const auto ranges = shape.window(o, params);
+        const underlying_t* image =
+            input_data + n * shape.input_image_size() * C;
+        underlying_t* out = output_data + i * C;
+        const int64_t len = C - (C % Vec::size());
+
+        if (params.is_max) {
+          // the output row is the accumulator
+          const underlying_t init = params.fuse_relu
+              ? relu_min
+              : std::numeric_limits<underlying_t>::lowest();
+          std::fill(out, out + C, init);
+          shape.for_each_pixel(ranges, params, [&](int64_t offset) {
+            const underlying_t* in = image + offset * C;
+            int64_t c = 0;
+            for (; c < len; c += Vec::size()) {
+              at::vec::maximum(Vec::loadu(out + c), Vec::loadu(in + c))
+                  .store(out + c);
+            }
+            for (; c < C; c++) {
+              out[c] = std::max(out[c], in[c]);
+            }
+          });
+          return;
+        }
+
+        thread_local std::vector<int32_t> sum;
+        sum.assign(C, 0);
+        shape.for_each_pixel(ranges, params, [&](int64_t offset) {
+          const underlying_t* in = image + offset * C;
+          if (params.fuse_relu) {
+            for (const auto c : c10::irange(C)) {
+              sum[c] += std::max(in[c], relu_min);
+            }
+          } else {
+            for (const auto c : c10::irange(C)) {
+              sum[c] += in[c];
+            }
+          }
+        });
+        const int64_t count = window_count(ranges);
+        if (count == 0) {
+          std::fill(out, out + C, relu_min);
+          return;
+        }
+        // the padded elements are real zeros: they only count in the divide
+        // factor
+        const int32_t zero_point_sum = zero_point * count;
+        const float inv_divide_factor =
+            1.f / static_cast<float>(avg_divide_factor(ranges, params));
+        for (const auto c : c10::irange(C)) {
+          const int64_t q = zero_point +
+              static_cast<int64_t>(std::nearbyint(
+                  (sum[c] - zero_point_sum) * inv_divide_factor));
+          out[c] = static_cast<underlying_t>(
+              std::min<int64_t>(std::max<int64_t>(q, qmin), qmax));
+        }
+      });
+}
+
+template <typename scalar_t>
+void pooling_float_channels_last_dispatch(
+    const at::Tensor& output,
+    const at::Tensor& input,
+    const PoolingParams& params) {
+  switch (output.scalar_type()) {
+    case at::kQUInt8:
+      pooling_float_channels_last<scalar_t, c10::quint8>(
+          output, input, params);
+      break;
+    case at::kQInt8:
+      pooling_float_channels_last<scalar_t, c10::qint8>(
+          output, input, params);
+      break;
+    default:
+      pooling_float_channels_last<scalar_t, scalar_t>(output, input, params);
+  }
+}
+
+void pooling_channels_last_kernel_impl(
+    const at::Tensor& output,
+    const at::Tensor& input,
+    const PoolingParams& params) {
+  switch (input.scalar_type()) {
+    case at::kFloat:
+      pooling_float_channels_last_dispatch<float>(output, input, params);
+      break;
+    case at::kBFloat16:
+      pooling_float_channels_last_dispatch<at::BFloat16>(
+          output, input, params);
+      break;
+    case at::kQUInt8:
+      pooling_quantized_channels_last<c10::quint8>(output, input, params);
+      break;
+    case at::kQInt8:
+      pooling_quantized_channels_last<c10::qint8>(output, input, params);
+      break;
+    default:
+      TORCH_CHECK(
+          false,
+          "pooling_channels_last: unsupported dtype ",
+          input.scalar_type());
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    pooling_channels_last_kernel_stub,
+    &pooling_channels_last_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
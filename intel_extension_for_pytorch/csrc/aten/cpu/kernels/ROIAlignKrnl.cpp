@@ -4,6 +4,8 @@
 #include <ATen/cpu/vec/vec.h>
 #include <csrc/aten/cpu/ROIAlign.h>
 #include <torch/library.h>
+#include <algorithm>
+#include <numeric>
 #include "csrc/autocast/autocast_mode.h"
 #include "csrc/utils/library.h"
 
@@ -45,7 +47,7 @@ void pre_calc_for_bilinear_interpolate(
     T bin_size_w,
     int roi_bin_grid_h,
     int roi_bin_grid_w,
-    std::vector<PreCalc<T>>& pre_calc) {
+    PreCalc<T>* pre_calc) {
   int pre_calc_index = 0;
   for (int ph = 0; ph < pooled_height; ph++) {
     for (int pw = 0; pw < pooled_width; pw++) {
@@ -132,16 +134,18 @@ inline void roi_align_single_framework_forward(
     const T* input,
     const ACC_T count,
     int channels,
+    int c_begin,
+    int c_end,
     int height,
     int width,
     int pooled_height,
     int pooled_width,
     int roi_bin_grid_h,
     int roi_bin_grid_w,
-    const std::vector<PreCalc<ACC_T>>& pre_calc,
+    const PreCalc<ACC_T>* pre_calc,
     T* output) {
-  for (int c = 0; c < channels; c++) {
-    const T* offset_input = input + c * height * width;
+  for (int c = c_begin; c < c_end; c++) {
+    const T* offset_input = input + (int64_t)c * height * width;
     int pre_calc_index = 0;
 
     for (int ph = 0; ph < pooled_height; ph++) {
@@ -151,7 +155,7 @@ inline void roi_align_single_framework_forward(
         ACC_T output_val = 0.;
         for (int iy = 0; iy < roi_bin_grid_h; iy++) {
           for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-            PreCalc<ACC_T> pc = pre_calc[pre_calc_index];
+            const PreCalc<ACC_T>& pc = pre_calc[pre_calc_index];
             output_val += pc.w1 * static_cast<ACC_T>(offset_input[pc.pos1]) +
                 pc.w2 * static_cast<ACC_T>(offset_input[pc.pos2]) +
                 pc.w3 * static_cast<ACC_T>(offset_input[pc.pos3]) +
@@ -173,77 +177,68 @@ inline void roi_align_single_framework_channels_last_forward(
     const T* input,
     const ACC_T count,
     int channels,
+    int c_begin,
+    int c_end,
     int height,
     int width,
     int pooled_height,
     int pooled_width,
     int roi_bin_grid_h,
     int roi_bin_grid_w,
-    const std::vector<PreCalc<ACC_T>>& pre_calc,
+    const PreCalc<ACC_T>* pre_calc,
     T* output) {
-  // for 'normal' size of channels, should be L1 fit;
-  // otherwise consider blocking on channels.
+  // The channel block [c_begin, c_end) is chosen by the caller so that the
+  // touched feature-map tile stays in L2, so the sum for one output pixel is
+  // kept in registers across all of its sampling points and stored once.
   using Vec = at::vec::Vectorized<T>;
-
-  int pre_calc_index = 0;
-  for (int ph = 0; ph < pooled_height; ph++) {
-    for (int pw = 0; pw < pooled_width; pw++) {
-      T* out = output + (ph * pooled_width + pw) * channels;
-
-      // pass I: zero the out lane
-      int64_t d1 = 0;
-      for (; d1 < channels - (channels % Vec::size()); d1 += Vec::size()) {
-        Vec out_vec = Vec(T(0));
-        out_vec.store(out + d1);
+  const int grid_size = roi_bin_grid_h * roi_bin_grid_w;
+  const int len = c_end - c_begin;
+  const int vec_len = len - (len % Vec::size());
+  const Vec count_vec = Vec(static_cast<T>(count));
+
+  for (int p = 0; p < pooled_height * pooled_width; p++) {
+    const PreCalc<ACC_T>* pc_bin = pre_calc + p * grid_size;
+    const T* in = input + c_begin;
+    T* out = output + (int64_t)p * channels + c_begin;
+
+    int d = 0;
+    for (; d < vec_len; d += Vec::size()) {
+      Vec sum_vec = Vec(T(0));
+      for (int i = 0; i < grid_size; i++) {
+        const PreCalc<ACC_T>& pc = pc_bin[i];
+        sum_vec = at::vec::fmadd(
+            Vec(pc.w1),
+            Vec::loadu(in + (int64_t)pc.pos1 * channels + d),
+            sum_vec);
+        sum_vec = at::vec::fmadd(
+            Vec(pc.w2),
+            Vec::loadu(in + (int64_t)pc.pos2 * channels + d),
+            sum_vec);
+        sum_vec = at::vec::fmadd(
+            Vec(pc.w3),
+            Vec::loadu(in + (int64_t)pc.pos3 * channels + d),
+            sum_vec);
+        sum_vec = at::vec::fmadd(
+            Vec(pc.w4),
+            Vec::loadu(in + (int64_t)pc.pos4 * channels + d),
+            sum_vec);
       }
-      // TODO: optimize with masked intrinsics.
-      for (; d1 < channels; d1++) {
-        out[d1] = T(0);
-      }
-
-      // pass II: do accumulation
-      for (int iy = 0; iy < roi_bin_grid_h; iy++) {
-        for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-          PreCalc<ACC_T> pc = pre_calc[pre_calc_index];
-          const T* in1 = input + pc.pos1 * channels;
-          const T* in2 = input + pc.pos2 * channels;
-          const T* in3 = input + pc.pos3 * channels;
-          const T* in4 = input + pc.pos4 * channels;
-
-          Vec w1_vec = Vec(pc.w1);
-          Vec w2_vec = Vec(pc.w2);
-          Vec w3_vec = Vec(pc.w3);
-          Vec w4_vec = Vec(pc.w4);
-          int64_t d2 = 0;
-          // TODO: optimize with FMA.
-          for (; d2 < channels - (channels % Vec::size()); d2 += Vec::size()) {
-            Vec out_vec = Vec::loadu(out + d2) + w1_vec * Vec::loadu(in1 + d2) +
-                w2_vec * Vec::loadu(in2 + d2) + w3_vec * Vec::loadu(in3 + d2) +
-                w4_vec * Vec::loadu(in4 + d2);
-            out_vec.store(out + d2);
-          }
-          // TODO: optimize with masked intrinsics.
-          for (; d2 < channels; d2++) {
-            out[d2] += pc.w1 * in1[d2] + pc.w2 * in2[d2] + pc.w3 * in3[d2] +
-                pc.w4 * in4[d2];
-          }
-          pre_calc_index += 1;
-        }
-      }
-
-      // pass III: do average
-      int64_t d3 = 0;
-      Vec count_vec = Vec(count);
-      for (; d3 < channels - (channels % Vec::size()); d3 += Vec::size()) {
-        Vec out_vec = Vec::loadu(out + d3) / count_vec;
-        out_vec.store(out + d3);
-      }
-      // TODO: optimize with masked intrinsics.
-      for (; d3 < channels; d3++) {
-        out[d3] /= static_cast<T>(count);
+      Vec out_vec = sum_vec / count_vec;
+      out_vec.store(out + d);
+    }
+    // TODO: optimize with masked intrinsics.
+    for (; d < len; d++) {
+      ACC_T sum = 0;
+      for (int i = 0; i < grid_size; i++) {
+        const PreCalc<ACC_T>& pc = pc_bin[i];
+        sum += pc.w1 * static_cast<ACC_T>(in[(int64_t)pc.pos1 * channels + d]) +
+            pc.w2 * static_cast<ACC_T>(in[(int64_t)pc.pos2 * channels + d]) +
+            pc.w3 * static_cast<ACC_T>(in[(int64_t)pc.pos3 * channels + d]) +
+            pc.w4 * static_cast<ACC_T>(in[(int64_t)pc.pos4 * channels + d]);
       }
-    } // for pw
-  } // for ph
+      out[d] = static_cast<T>(sum / count);
+    }
+  } // for p
 }
 
 template <>
@@ -253,102 +248,98 @@ inline void roi_align_single_framework_channels_last_forward<
     const at::BFloat16* input,
     const float count,
     int channels,
+    int c_begin,
+    int c_end,
     int height,
     int width,
     int pooled_height,
     int pooled_width,
     int roi_bin_grid_h,
     int roi_bin_grid_w,
-    const std::vector<PreCalc<float>>& pre_calc,
+    const PreCalc<float>* pre_calc,
     at::BFloat16* output) {
-  // for 'normal' size of channels, should be L1 fit;
-  // otherwise consider blocking on channels.
+  // use float as accumulation type, the two float halves of one BFloat16
+  // vector are accumulated in registers so no temp sum buffer is needed.
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
-
-  // temp buffer for sum, use float as accumulation type
-  // can't reuse output buffer to store sum since it is BFloat16
-  std::unique_ptr<float[]> sum_arr(new float[channels]);
-  float* sum = sum_arr.get();
-
-  int pre_calc_index = 0;
-  for (int ph = 0; ph < pooled_height; ph++) {
-    for (int pw = 0; pw < pooled_width; pw++) {
-      at::BFloat16* out = output + (ph * pooled_width + pw) * channels;
-
-      // pass I: zero the sum lane
-      int64_t d1 = 0;
-      for (; d1 < channels - (channels % fVec::size()); d1 += fVec::size()) {
-        fVec sum_fvec = fVec(float(0));
-        sum_fvec.store(sum + d1);
-      }
-      // TODO: optimize with masked intrinsics.
-      for (; d1 < channels; d1++) {
-        sum[d1] = float(0);
-      }
-
-      // pass II: do accumulation
-      for (int iy = 0; iy < roi_bin_grid_h; iy++) {
-        for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-          PreCalc<float> pc = pre_calc[pre_calc_index];
-          const at::BFloat16* in1 = input + pc.pos1 * channels;
-          const at::BFloat16* in2 = input + pc.pos2 * channels;
-          const at::BFloat16* in3 = input + pc.pos3 * channels;
-          const at::BFloat16* in4 = input + pc.pos4 * channels;
-
-          fVec w1_fvec = fVec(pc.w1);
-          fVec w2_fvec = fVec(pc.w2);
-          fVec w3_fvec = fVec(pc.w3);
-          fVec w4_fvec = fVec(pc.w4);
-          int64_t d2 = 0;
-          for (; d2 < channels - (channels % bVec::size());
-               d2 += bVec::size()) {
-            bVec in1_bvec = bVec::loadu(in1 + d2);
-            bVec in2_bvec = bVec::loadu(in2 + d2);
-            bVec in3_bvec = bVec::loadu(in3 + d2);
-            bVec in4_bvec = bVec::loadu(in4 + d2);
-            fVec in1_fvec0, in1_fvec1, in2_fvec0, in2_fvec1, in3_fvec0,
-                in3_fvec1, in4_fvec0, in4_fvec1;
-            std::tie(in1_fvec0, in1_fvec1) = convert_bfloat16_float(in1_bvec);
-            std::tie(in2_fvec0, in2_fvec1) = convert_bfloat16_float(in2_bvec);
-            std::tie(in3_fvec0, in3_fvec1) = convert_bfloat16_float(in3_bvec);
-            std::tie(in4_fvec0, in4_fvec1) = convert_bfloat16_float(in4_bvec);
-            // TODO: optimize with FMA.
-            fVec sum_fvec0 = fVec::loadu(sum + d2) + w1_fvec * in1_fvec0 +
-                w2_fvec * in2_fvec0 + w3_fvec * in3_fvec0 + w4_fvec * in4_fvec0;
-            fVec sum_fvec1 = fVec::loadu(sum + d2 + fVec::size()) +
-                w1_fvec * in1_fvec1 + w2_fvec * in2_fvec1 +
-                w3_fvec * in3_fvec1 + w4_fvec * in4_fvec1;
-            sum_fvec0.store(sum + d2);
-            sum_fvec1.store(sum + d2 + fVec::size());
-          }
-          // TODO: optimize with masked intrinsics.
-          for (; d2 < channels; d2++) {
-            sum[d2] += pc.w1 * static_cast<float>(in1[d2]) +
-                pc.w2 * static_cast<float>(in2[d2]) +
-                pc.w3 * static_cast<float>(in3[d2]) +
-                pc.w4 * static_cast<float>(in4[d2]);
-          }
-          pre_calc_index += 1;
+  const int grid_size = roi_bin_grid_h * roi_bin_grid_w;
+  const int len = c_end - c_begin;
+  const int vec_len = len - (len % bVec::size());
+  const fVec count_fvec = fVec(count);
+
+  for (int p = 0; p < pooled_height * pooled_width; p++) {
+    const PreCalc<float>* pc_bin = pre_calc + p * grid_size;
+    const at::BFloat16* in = input + c_begin;
+    at::BFloat16* out = output + (int64_t)p * channels + c_begin;
+
+    int d = 0;
+    for (; d < vec_len; d += bVec::size()) {
+      fVec sum_fvec0 = fVec(float(0));
+      fVec sum_fvec1 = fVec(float(0));
+      for (int i = 0; i < grid_size; i++) {
+        const PreCalc<float>& pc = pc_bin[i];
+        const int64_t pos[4] = {
+            (int64_t)pc.pos1 * channels + d,
+            (int64_t)pc.pos2 * channels + d,
+            (int64_t)pc.pos3 * channels + d,
+            (int64_t)pc.pos4 * channels + d};
+        const float w[4] = {pc.w1, pc.w2, pc.w3, pc.w4};
+        for (int k = 0; k < 4; k++) {
+          fVec in_fvec0, in_fvec1;
+          std::tie(in_fvec0, in_fvec1) =
+              convert_bfloat16_float(bVec::loadu(in + pos[k]));
+          fVec w_fvec = fVec(w[k]);
+          sum_fvec0 = at::vec::fmadd(w_fvec, in_fvec0, sum_fvec0);
+          sum_fvec1 = at::vec::fmadd(w_fvec, in_fvec1, sum_fvec1);
         }
       }
+      bVec out_bvec = convert_float_bfloat16(
+          sum_fvec0 / count_fvec, sum_fvec1 / count_fvec);
+      out_bvec.store(out + d);
+    }
+    // TODO: optimize with masked intrinsics.
+    for (; d < len; d++) {
+      float sum = 0;
+      for (int i = 0; i < grid_size; i++) {
+        const PreCalc<float>& pc = pc_bin[i];
+        sum += pc.w1 * static_cast<float>(in[(int64_t)pc.pos1 * channels + d]) +
+            pc.w2 * static_cast<float>(in[(int64_t)pc.pos2 * channels + d]) +
+            pc.w3 * static_cast<float>(in[(int64_t)pc.pos3 * channels + d]) +
+            pc.w4 * static_cast<float>(in[(int64_t)pc.pos4 * channels + d]);
+      }
+      out[d] = static_cast<at::BFloat16>(sum / count);
+    }
+  } // for p
+}
 
-      // pass III: do average
-      int64_t d3 = 0;
-      fVec count_fvec = fVec(count);
-      for (; d3 < channels - (channels % bVec::size()); d3 += bVec::size()) {
-        fVec out_fvec0 = fVec::loadu(sum + d3) / count_fvec;
-        fVec out_fvec1 = fVec::loadu(sum + d3 + fVec::size()) / count_fvec;
+// Geometry of one ROI. It is computed once per ROI and shared by all the
+// channel blocks of that ROI.
+template <typename ACC_T>
+struct RoiParam {
+  int batch_ind;
+  ACC_T roi_start_h;
+  ACC_T roi_start_w;
+  ACC_T bin_size_h;
+  ACC_T bin_size_w;
+  int roi_bin_grid_h;
+  int roi_bin_grid_w;
+  ACC_T count;
+  // offset of this ROI in the shared interpolation table
+  int64_t pre_calc_offset;
+};
 
-        bVec out_bvec = convert_float_bfloat16(out_fvec0, out_fvec1);
-        out_bvec.store(out + d3);
-      }
-      // TODO: optimize with masked intrinsics.
-      for (; d3 < channels; d3++) {
-        out[d3] = static_cast<at::BFloat16>(sum[d3] / count);
-      }
-    } // for pw
-  } // for ph
+// Interleave the bits of (y, x) to get the Z-order (Morton) code, ROIs which
+// are close in the feature map get close codes.
+inline uint32_t morton_code(uint32_t y, uint32_t x) {
+  auto spread = [](uint32_t v) {
+    v &= 0xFFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+  };
+  return (spread(y) << 1) | spread(x);
 }
 
 template <typename T, typename ACC_T>
@@ -366,12 +357,21 @@ void roi_align_forward_kernel_body(
     const ACC_T* rois,
     T* output,
     bool is_channels_last) {
-  // (n, c, ph, pw) is an element in the pooled output
-  // can be parallelized using omp
-  at::parallel_for(0, n_rois, 1, [&](int begin, int end) {
+  // The ROIs of a batch hit the same few feature maps, so instead of
+  // parallelizing over ROIs only, the work is:
+  //   1. compute the geometry and the interpolation table of every ROI once;
+  //   2. sort ROIs by (image, Z-order of the ROI center) so that neighbouring
+  //      work items touch neighbouring parts of the same feature map;
+  //   3. tile channels into blocks whose feature-map tile fits in L2, and
+  //      parallelize over (channel block, sorted ROI), channel block major, so
+  //      that one thread walks many ROIs over the same tile.
+  std::vector<RoiParam<ACC_T>> params(n_rois);
+  std::vector<uint64_t> sort_keys(n_rois);
+  at::parallel_for(0, n_rois, 16, [&](int begin, int end) {
     for (int n = begin; n < end; n++) {
       const ACC_T* offset_rois = rois + n * 5;
-      int roi_batch_ind = offset_rois[0];
+      RoiParam<ACC_T>& param = params[n];
+      param.batch_ind = offset_rois[0];
 
       // Do not using rounding; this implementation detail is critical
       ACC_T offset = aligned ? (ACC_T)0.5 : (ACC_T)0.0;
@@ -388,70 +388,160 @@ void roi_align_forward_kernel_body(
         roi_height = std::max(roi_height, (ACC_T)1.);
       }
 
-      ACC_T bin_size_h =
+      param.roi_start_h = roi_start_h;
+      param.roi_start_w = roi_start_w;
+      param.bin_size_h =
           static_cast<ACC_T>(roi_height) / static_cast<ACC_T>(pooled_height);
-      ACC_T bin_size_w =
+      param.bin_size_w =
           static_cast<ACC_T>(roi_width) / static_cast<ACC_T>(pooled_width);
 
       // We use roi_bin_grid to sample the grid and mimic integral
-      int roi_bin_grid_h = (sampling_ratio > 0)
+      param.roi_bin_grid_h = (sampling_ratio > 0)
           ? sampling_ratio
           : ceil(roi_height / pooled_height); // e.g., = 2
-      int roi_bin_grid_w = (sampling_ratio > 0)
+      param.roi_bin_grid_w = (sampling_ratio > 0)
           ? sampling_ratio
           : ceil(roi_width / pooled_width);
 
       // We do average (integral) pooling inside a bin
       // When the grid is empty, output zeros.
-      const ACC_T count =
-          std::max(roi_bin_grid_h * roi_bin_grid_w, 1); // e.g. = 4
-
-      // we want to precalculate indices and weights shared by all channels,
-      // this is the key point of optimization
-      std::vector<PreCalc<ACC_T>> pre_calc(
-          roi_bin_grid_h * roi_bin_grid_w * pooled_width * pooled_height);
-      pre_calc_for_bilinear_interpolate(
-          height,
-          width,
-          pooled_height,
-          pooled_width,
-          roi_start_h,
-          roi_start_w,
-          bin_size_h,
-          bin_size_w,
-          roi_bin_grid_h,
-          roi_bin_grid_w,
-          pre_calc);
+      param.count = std::max(
+          param.roi_bin_grid_h * param.roi_bin_grid_w, 1); // e.g. = 4
+
+      ACC_T center_h = roi_start_h + roi_height / 2;
+      ACC_T center_w = roi_start_w + roi_width / 2;
+      uint32_t cy = static_cast<uint32_t>(std::min(
+          std::max(center_h, (ACC_T)0), static_cast<ACC_T>(height - 1)));
+      uint32_t cx = static_cast<uint32_t>(std::min(
+          std::max(center_w, (ACC_T)0), static_cast<ACC_T>(width - 1)));
+      sort_keys[n] =
+          (static_cast<uint64_t>(param.batch_ind) << 32) | morton_code(cy, cx);
+    }
+  });
 
-      if (is_channels_last) {
-        roi_align_single_framework_channels_last_forward<T, ACC_T>(
-            input + roi_batch_ind * height * width * channels,
-            count,
-            channels,
-            height,
-            width,
-            pooled_height,
-            pooled_width,
-            roi_bin_grid_h,
-            roi_bin_grid_w,
-            pre_calc,
-            output + n * pooled_width * pooled_height * channels);
-      } else {
-        roi_align_single_framework_forward<T, ACC_T>(
-            input + roi_batch_ind * channels * height * width,
-            count,
-            channels,
+  // size of the interpolation table of each ROI
+  const int pooled_size = pooled_height * pooled_width;
+  int64_t pre_calc_size = 0;
+  for (int n = 0; n < n_rois; n++) {
+    params[n].pre_calc_offset = pre_calc_size;
+    pre_calc_size += (int64_t)params[n].roi_bin_grid_h *
+        params[n].roi_bin_grid_w * pooled_size;
+  }
+
+  // Share the interpolation tables across channel blocks when they are
+  // reasonably small, otherwise (huge ROIs with adaptive sampling ratio)
+  // compute them per ROI on the fly and do not block on channels.
+  constexpr int64_t PRE_CALC_BYTES_LIMIT = 64 * 1024 * 1024;
+  const bool share_pre_calc =
+      pre_calc_size * (int64_t)sizeof(PreCalc<ACC_T>) <= PRE_CALC_BYTES_LIMIT;
+  std::vector<PreCalc<ACC_T>> pre_calc;
+  if (share_pre_calc) {
+    pre_calc.resize(pre_calc_size);
+    at::parallel_for(0, n_rois, 1, [&](int begin, int end) {
+      for (int n = begin; n < end; n++) {
+        const RoiParam<ACC_T>& param = params[n];
+        pre_calc_for_bilinear_interpolate(
             height,
             width,
             pooled_height,
             pooled_width,
-            roi_bin_grid_h,
-            roi_bin_grid_w,
-            pre_calc,
-            output + n * channels * pooled_width * pooled_height);
+            param.roi_start_h,
+            param.roi_start_w,
+            param.bin_size_h,
+            param.bin_size_w,
+            param.roi_bin_grid_h,
+            param.roi_bin_grid_w,
+            pre_calc.data() + param.pre_calc_offset);
       }
-    } // for n
+    });
+  }
+
+  std::vector<int> order(n_rois);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return sort_keys[a] < sort_keys[b];
   });
+
+  // feature-map tile of one channel block should stay in L2 across ROIs,
+  // the blocks are multiples of the vector width of T so that the channels
+  // last kernels keep vectorizing them
+  constexpr int64_t TILE_BYTES_PER_CORE = 1024 * 1024;
+  const int64_t channel_block_align = at::vec::Vectorized<T>::size();
+  int64_t channel_block = channels;
+  if (share_pre_calc) {
+    int64_t plane_bytes = (int64_t)height * width * sizeof(T);
+    channel_block = TILE_BYTES_PER_CORE / std::max(plane_bytes, (int64_t)1);
+    channel_block = channel_block / channel_block_align * channel_block_align;
+    channel_block = std::min(
+        (int64_t)channels, std::max(channel_block, channel_block_align));
+  }
+  const int64_t n_channel_blocks = at::divup((int64_t)channels, channel_block);
+
+  at::parallel_for(
+      0, n_channel_blocks * n_rois, 1, [&](int64_t begin, int64_t end) {
+        // interpolation table for the non-shared case, reused across ROIs
+        std::vector<PreCalc<ACC_T>> local_pre_calc;
+        for (int64_t i = begin; i < end; i++) {
+          int64_t cb = i / n_rois;
+          int n = order[i % n_rois];
+          int c_begin = cb * channel_block;
+          int c_end = std::min((int64_t)channels, c_begin + channel_block);
+          const RoiParam<ACC_T>& param = params[n];
+
+          const PreCalc<ACC_T>* roi_pre_calc = nullptr;
+          if (share_pre_calc) {
+            roi_pre_calc = pre_calc.data() + param.pre_calc_offset;
+          } else {
+            local_pre_calc.resize(
+                param.roi_bin_grid_h * param.roi_bin_grid_w * pooled_size);
+            pre_calc_for_bilinear_interpolate(
+                height,
+                width,
+                pooled_height,
+                pooled_width,
+                param.roi_start_h,
+                param.roi_start_w,
+                param.bin_size_h,
+                param.bin_size_w,
+                param.roi_bin_grid_h,
+                param.roi_bin_grid_w,
+                local_pre_calc.data());
+            roi_pre_calc = local_pre_calc.data();
+          }
+
+          if (is_channels_last) {
+            roi_align_single_framework_channels_last_forward<T, ACC_T>(
+                input + (int64_t)param.batch_ind * height * width * channels,
+                param.count,
+                channels,
+                c_begin,
+                c_end,
+                height,
+                width,
+                pooled_height,
+                pooled_width,
+                param.roi_bin_grid_h,
+                param.roi_bin_grid_w,
+                roi_pre_calc,
+                output + (int64_t)n * pooled_size * channels);
+          } else {
+            roi_align_single_framework_forward<T, ACC_T>(
+                input + (int64_t)param.batch_ind * channels * height * width,
+                param.count,
+                channels,
+                c_begin,
+                c_end,
+                height,
+                width,
+                pooled_height,
+                pooled_width,
+                param.roi_bin_grid_h,
+                param.roi_bin_grid_w,
+                roi_pre_calc,
+                output + (int64_t)n * channels * pooled_size);
+          }
+        } // for i
+      });
 }
 
 template <class T>
@@ -632,7 +722,7 @@ void roi_align_backward_kernel_body(
         bin_size_w,
         roi_bin_grid_h,
         roi_bin_grid_w,
-        pre_calc);
+        pre_calc.data());
 
     if (is_channels_last) {
       roi_align_single_framework_channels_last_backward<T, ACC_T>(
@@ -0,0 +1,222 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
+
+#include <csrc/aten/cpu/SparseLinear.h>
+
+#include <cmath>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using Vec = at::vec::Vectorized<float>;
+
+// output features computed by a task
+constexpr int64_t kBlockN = 64;
+// maximum number of input rows computed together, in vectors
+constexpr int64_t kMaxTileVecs = 4;
+
+struct SparseWeightView {
+  int64_t format;
+  int64_t K;
+  const float* values;
+  const void* indices;
+  const int32_t* row_ptr;
+};
+
+inline float apply_post_op(float x, int64_t post_op) {
+  switch (post_op) {
+    case kSparseLinearRelu:
+      return std::max(x, 0.f);
+    case kSparseLinearGelu:
+      return 0.5f * x * (1.f + std::erf(x * float(M_SQRT1_2)));
+    default:
+      return x;
+  }
+}
+
+inline Vec apply_post_op(const Vec& x, int64_t post_op) {
+  switch (post_op) {
+    case kSparseLinearRelu:
+      return at::vec::maximum(x, Vec(0.f));
+    case kSparseLinearGelu:
+      return x * Vec(0.5f) * (Vec(1.f) + (x * Vec(float(M_SQRT1_2))).erf());
+    default:
+      return x;
+  }
+}
+
+// Accumulates row n of the weight times kNumVecs * Vec::size() columns of
+// the transposed input xt, whose rows are ldxt apart.
+template <int64_t kNumVecs>
+inline void row_times_xt(
+    const SparseWeightView& w,
+    int64_t n,
+    const float* xt,
+    int64_t ldxt,
+    Vec* acc) {
+  if (w.format == kTwoFour) {
+    const int64_t num_slots = w.K / 2;
+    const float* values = w.values + n * num_slots;
+    const uint8_t* indices =
+        static_cast<const uint8_t*>(w.indices) + n * num_slots;
+    for (int64_t slot = 0; slot < num_slots; slot++) {
+      const Vec weight(values[slot]);
+      const float* x = xt + (slot / 2 * 4 + indices[slot]) * ldxt;
+      for (int64_t i = 0; i < kNumVecs; i++) {
+        acc[i] =
+            at::vec::fmadd(weight, Vec::loadu(x + i * Vec::size()), acc[i]);
+      }
+    }
+  } else {
+    const int32_t* indices = static_cast<const int32_t*>(w.indices);
+    for (int32_t b = w.row_ptr[n]; b < w.row_ptr[n + 1]; b++) {
+      const float* values = w.values + b * 4;
+      const float* x = xt + static_cast<int64_t>(indices[b]) * 4 * ldxt;
+      for (int64_t j = 0; j < 4; j++) {
+        const Vec weight(values[j]);
+        for (int64_t i = 0; i < kNumVecs; i++) {
+          acc[i] = at::vec::fmadd(
+              weight, Vec::loadu(x + j * ldxt + i * Vec::size()), acc[i]);
+        }
+      }
+    }
+  }
+}
+
+// Scalar dot product of row n of the weight and input row x, for inputs with
+// too few rows to fill a vector
+inline float row_times_x(const SparseWeightView& w, int64_t n, const float* x) {
+  float acc = 0.f;
+  if (w.format == kTwoFour) {
+    const int64_t num_slots = w.K / 2;
+    const float* values = w.values + n * num_slots;
+    const uint8_t* indices =
+        static_cast<const uint8_t*>(w.indices) + n * num_slots;
+    for (int64_t slot = 0; slot < num_slots; slot++) {
+      acc += values[slot] * x[slot / 2 * 4 + indices[slot]];
+    }
+  } else {
+    const int32_t* indices = static_cast<const int32_t*>(w.indices);
+    for (int32_t b = w.row_ptr[n]; b < w.row_ptr[n + 1]; b++) {
+      const float* values = w.values + b * 4;
+      const int64_t k0 = static_cast<int64_t>(indices[b]) * 4;
+      const int64_t num_k = std::min<int64_t>(4, w.K - k0);
+      for (int64_t j = 0; j < num_k; j++) {
+        acc += values[j] * x[k0 + j];
+      }
+    }
+  }
+  return acc;
+}
+
+void sparse_linear_small_m(
+    const SparseWeightView& w,
+    const float* input,
+    const float* bias,
+    int64_t post_op,
+    int64_t M,
+    int64_t N,
+    float* output) {
+  at::parallel_for(0, N, kBlockN, [&](int64_t begin, int64_t end) {
+    for (int64_t n = begin; n < end; n++) {
+      const float b = bias != nullptr ? bias[n] : 0.f;
+      for (int64_t m = 0; m < M; m++) {
+        output[m * N + n] =
+            apply_post_op(row_times_x(w, n, input + m * w.K) + b, post_op);
+      }
+    }
+  });
+}
+
+// The inputs are transposed to [K, M] once, so that the weights multiply
+// contiguous vectors of input rows. Each task computes kBlockN outputs for
+// a tile of kNumVecs * Vec::size() input rows.
+template <int64_t kNumVecs>
+void sparse_linear_tiled(
+    const SparseWeightView& w,
+    const at::Tensor& input,
+    const float* bias,
+    int64_t post_op,
+    int64_t N,
+    float* output) {
+  constexpr int64_t kTileM = kNumVecs * Vec::size();
+  const int64_t M = input.size(0);
+  const int64_t K = w.K;
+  const int64_t padded_K = (K + 3) / 4 * 4;
+  const int64_t padded_M = (M + kTileM - 1) / kTileM * kTileM;
+  // zero padded, the last block of a row may read past K
+  auto xt = at::zeros({padded_K, padded_M}, input.options());
+  xt.narrow(0, 0, K).narrow(1, 0, M).copy_(input.t());
+  const float* xt_data = xt.data_ptr<float>();
+
+  const int64_t num_m_tiles = padded_M / kTileM;
+  const int64_t num_n_blocks = (N + kBlockN - 1) / kBlockN;
+  at::parallel_for(
+      0, num_m_tiles * num_n_blocks, 1, [&](int64_t begin, int64_t end) {
+        float tile[kBlockN * kTileM];
+        for (int64_t task = begin; task < end; task++) {
+          const int64_t m0 = task / num_n_blocks * kTileM;
+          const int64_t n0 = task % num_n_blocks * kBlockN;
+          const int64_t n1 = std::min(n0 + kBlockN, N);
+          for (int64_t n = n0; n < n1; n++) {
+            Vec acc[kNumVecs];
+            for (int64_t i = 0; i < kNumVecs; i++) {
+              acc[i] = Vec(bias != nullptr ? bias[n] : 0.f);
+            }
+            row_times_xt<kNumVecs>(w, n, xt_data + m0, padded_M, acc);
+            for (int64_t i = 0; i < kNumVecs; i++) {
+              apply_post_op(acc[i], post_op)
+                  .store(tile + (n - n0) * kTileM + i * Vec::size());
+            }
+          }
+          const int64_t m1 = std::min(m0 + kTileM, M);
+          for (int64_t m = m0; m < m1; m++) {
+            for (int64_t n = n0; n < n1; n++) {
+              output[m * N + n] = tile[(n - n0) * kTileM + m - m0];
+            }
+          }
+        }
+      });
+}
+
+void sparse_linear_kernel_impl(
+    const at::Tensor& input,
+    const SparseLinearWeight& weight,
+    const at::Tensor& bias,
+    int64_t post_op,
+    at::Tensor& output) {
+  SparseWeightView w{
+      weight.format,
+      weight.in_features,
+      weight.values.data_ptr<float>(),
+      weight.indices.data_ptr(),
+      weight.format == kBlockCSR ? weight.row_ptr.data_ptr<int32_t>()
+                                 : nullptr};
+  const int64_t M = input.size(0);
+  const int64_t N = weight.out_features;
+  const float* bias_data = bias.defined() ? bias.data_ptr<float>() : nullptr;
+  float* output_data = output.data_ptr<float>();
+
+  if (M < Vec::size()) {
+    sparse_linear_small_m(
+        w, input.data_ptr<float>(), bias_data, post_op, M, N, output_data);
+  } else if (M <= Vec::size()) {
+    sparse_linear_tiled<1>(w, input, bias_data, post_op, N, output_data);
+  } else if (M <= 2 * Vec::size()) {
+    sparse_linear_tiled<2>(w, input, bias_data, post_op, N, output_data);
+  } else {
+    sparse_linear_tiled<kMaxTileVecs>(
+        w, input, bias_data, post_op, N, output_data);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(sparse_linear_kernel_stub, &sparse_linear_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
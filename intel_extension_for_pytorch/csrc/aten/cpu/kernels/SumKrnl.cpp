@@ -10,9 +10,12 @@
 #include <c10/util/irange.h>
 
 #include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "csrc/utils/library.h"
 
+#include <csrc/aten/cpu/Mean.h>
 #include <csrc/aten/cpu/Sum.h>
 
 namespace torch_ipex {
@@ -313,29 +316,53 @@ struct OuterNanSumCastLoadPolicy {
   }
 };
 
+/* The output may be stored to several times, once per part of the reduced
+ * dimensions handled by a loop, so store policies accumulate.
+ */
+
 template <typename scalar_t, typename acc_t>
 struct CastStoreAccumulate {
-  static void store(
+  void store(
       char* C10_RESTRICT data,
       int64_t stride,
       int64_t index,
-      acc_t value) {
+      acc_t value) const {
     auto* ptr = reinterpret_cast<scalar_t*>(data + index * stride);
     *ptr += value;
   }
 };
 
+/* Scaling is linear, so scaling each partial sum before accumulating it gives
+ * the scaled total. mean uses it to divide by the reduced size in the same
+ * pass as the sum.
+ */
+template <typename scalar_t, typename acc_t>
+struct CastStoreScaleAccumulate {
+  acc_t scale;
+
+  void store(
+      char* C10_RESTRICT data,
+      int64_t stride,
+      int64_t index,
+      acc_t value) const {
+    auto* ptr = reinterpret_cast<scalar_t*>(data + index * stride);
+    *ptr += value * scale;
+  }
+};
+
 template <typename StorePolicy, typename scalar_t>
 static void store(
+    const StorePolicy& policy,
     char* C10_RESTRICT data,
     int64_t stride,
     int64_t index,
     scalar_t value) {
-  StorePolicy::store(data, stride, index, value);
+  policy.store(data, stride, index, value);
 }
 
 template <typename StorePolicy, typename scalar_t, size_t numel>
 static void store(
+    const StorePolicy& policy,
     char* C10_RESTRICT data,
     int64_t stride,
     int64_t index,
@@ -343,12 +370,13 @@ static void store(
   auto* base_ptr = data + stride * index;
   for (const auto k : c10::irange(numel)) {
     auto val = values[k];
-    StorePolicy::store(base_ptr, stride, k, val);
+    policy.store(base_ptr, stride, k, val);
   }
 }
 
 template <typename StorePolicy, typename scalar_t>
 static void store(
+    const StorePolicy& policy,
     char* C10_RESTRICT data,
     int64_t stride,
     int64_t index,
@@ -356,7 +384,7 @@ static void store(
   using vec_t = at::vec::Vectorized<scalar_t>;
   alignas(64) std::array<scalar_t, vec_t::size()> array_values;
   values.store(array_values.data());
-  store<StorePolicy>(data, stride, index, array_values);
+  store(policy, data, stride, index, array_values);
 }
 
 /** Simultaneously sum over n rows at once
@@ -493,7 +521,8 @@ void vectorized_inner_sum(
     int64_t outer_stride,
     int64_t out_stride,
     int64_t size0,
-    int64_t size1) {
+    int64_t size1,
+    const StorePolicy& store_policy) {
   using vacc_t = at::vec::Vectorized<acc_t>;
   constexpr int64_t vec_stride = VecLoadPolicy::memsize();
   constexpr int64_t scalar_stride = ScalarLoadPolicy::memsize();
@@ -515,7 +544,7 @@ void vectorized_inner_sum(
     for (const auto k : c10::irange(partials.size())) {
       final_acc += partials[k];
     }
-    store<StorePolicy>(data[0], out_stride, j, final_acc);
+    store(store_policy, data[0], out_stride, j, final_acc);
   }
 }
 
@@ -526,11 +555,12 @@ void scalar_inner_sum(
     int64_t in_strides[2],
     int64_t out_stride,
     int64_t size0,
-    int64_t size1) {
+    int64_t size1,
+    const StorePolicy& store_policy) {
   for (const auto j : c10::irange(size1)) {
     const auto* row_in = data[1] + j * in_strides[1];
     auto ans = row_sum<acc_t, LoadPolicy>(row_in, in_strides[0], size0);
-    store<StorePolicy>(data[0], out_stride, j, ans);
+    store(store_policy, data[0], out_stride, j, ans);
   }
 }
 
@@ -545,7 +575,8 @@ void vectorized_outer_sum(
     int64_t inner_stride,
     int64_t out_stride,
     int64_t size0,
-    int64_t size1) {
+    int64_t size1,
+    const StorePolicy& store_policy) {
   using vacc_t = at::vec::Vectorized<acc_t>;
   constexpr int64_t scalar_stride = ScalarLoadPolicy::memsize();
   constexpr int64_t vec_stride = VecLoadPolicy::memsize();
@@ -560,7 +591,7 @@ void vectorized_outer_sum(
 
     for (const auto i : c10::irange(nrows)) {
       const int64_t base_idx = j + i * vacc_t::size();
-      store<StorePolicy>(data[0], out_stride, base_idx, sums[i]);
+      store(store_policy, data[0], out_stride, base_idx, sums[i]);
     }
   }
 
@@ -570,13 +601,13 @@ void vectorized_outer_sum(
         row_sum<vacc_t, VecLoadPolicy>(row_in, inner_stride, size0);
 
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
-    store<StorePolicy>(data[0], out_stride, j, sums);
+    store(store_policy, data[0], out_stride, j, sums);
   }
 
   for (; j < size1; ++j) {
     const auto* row_in = data[1] + j * scalar_stride;
     auto ans = row_sum<acc_t, ScalarLoadPolicy>(row_in, inner_stride, size0);
-    store<StorePolicy>(data[0], out_stride, j, ans);
+    store(store_policy, data[0], out_stride, j, ans);
   }
 }
 
@@ -587,26 +618,27 @@ void scalar_outer_sum(
     int64_t in_strides[2],
     int64_t out_stride,
     int64_t size0,
-    int64_t size1) {
+    int64_t size1,
+    const StorePolicy& store_policy) {
   constexpr int64_t nrows = 4;
   int64_t j = 0;
   for (; j + (nrows - 1) < size1; j += nrows) {
     const auto* row_in = data[1] + j * in_strides[1];
     auto sums = multi_row_sum<acc_t, nrows, LoadPolicy>(
         row_in, in_strides[0], in_strides[1], size0);
-    store<StorePolicy>(data[0], out_stride, j, sums);
+    store(store_policy, data[0], out_stride, j, sums);
   }
 
   for (; j < size1; ++j) {
     const auto* row_in = data[1] + j * in_strides[1];
     auto ans = row_sum<acc_t, LoadPolicy>(row_in, in_strides[0], size0);
-    store<StorePolicy>(data[0], out_stride, j, ans);
+    store(store_policy, data[0], out_stride, j, ans);
   }
 }
 
 // Custom floating point sum for better accuracy
-template <bool ignore_nan, typename scalar_t>
-void cascade_sum(at::TensorIterator& iter) {
+template <bool ignore_nan, typename scalar_t, typename StorePolicy>
+void cascade_sum(at::TensorIterator& iter, const StorePolicy& store_policy) {
   iter.output_base().fill_(scalar_t(0));
   iter.parallel_reduce([&](char** data,
                            const int64_t* strides,
@@ -624,30 +656,23 @@ void cascade_sum(at::TensorIterator& iter) {
       std::swap(size0, size1);
     }
 
+    using vec_t = at::vec::Vectorized<scalar_t>;
+    using acc_t = at::acc_type<scalar_t, true>;
+    using vacc_t = at::vec::Vectorized<acc_t>;
+    using ScalarLoadPolicy = std::conditional_t<
+        ignore_nan,
+        NanSumCastLoadPolicy<scalar_t, acc_t>,
+        CastLoadPolicy<scalar_t, acc_t>>;
+
     // Special case? - not a true reduction
     if (out_strides[0] != 0 && out_strides[1] != 0) {
       // NOLINTNEXTLINE(modernize-avoid-c-arrays,cppcoreguidelines-avoid-c-arrays)
       int64_t outer_strides[] = {strides[2], strides[3]};
       at::native::UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
-        // NOLINTNEXTLINE(modernize-avoid-c-arrays,cppcoreguidelines-avoid-c-arrays)
-        char* ptrs[3] = {data[0], data[0], data[1]};
-        // NOLINTNEXTLINE(modernize-avoid-c-arrays,cppcoreguidelines-avoid-c-arrays)
-        int64_t inner_strides[3] = {strides[0], strides[0], strides[1]};
-        c10::guts::if_constexpr<ignore_nan>(
-            [&](auto) {
-              at::native::basic_loop(
-                  ptrs, inner_strides, 0, size0, [](scalar_t a, scalar_t b) {
-                    auto a_notnan = at::_isnan(a) ? scalar_t(0) : a;
-                    auto b_notnan = at::_isnan(b) ? scalar_t(0) : b;
-                    return a_notnan + b_notnan;
-                  });
-            },
-            [&](auto) {
-              at::native::basic_loop(
-                  ptrs, inner_strides, 0, size0, [](scalar_t a, scalar_t b) {
-                    return a + b;
-                  });
-            });
+        for (const auto i : c10::irange(size0)) {
+          const acc_t value = ScalarLoadPolicy::load(data[1], strides[1], i);
+          store(store_policy, data[0], strides[0], i, value);
+        }
       });
       return;
     }
@@ -655,36 +680,28 @@ void cascade_sum(at::TensorIterator& iter) {
     const int64_t out_stride = out_strides[1];
     TORCH_INTERNAL_ASSERT(out_strides[0] == 0);
 
-    using vec_t = at::vec::Vectorized<scalar_t>;
-    using acc_t = at::acc_type<scalar_t, true>;
-    using vacc_t = at::vec::Vectorized<acc_t>;
-    using ScalarLoadPolicy = std::conditional_t<
-        ignore_nan,
-        NanSumCastLoadPolicy<scalar_t, acc_t>,
-        CastLoadPolicy<scalar_t, acc_t>>;
-    using StorePolicy = CastStoreAccumulate<scalar_t, acc_t>;
     if (in_strides[0] == sizeof(scalar_t) && size0 >= vec_t::size()) {
       // Contiguous inner reduction
       using VecLoadPolicy = std::conditional_t<
           ignore_nan,
           InnerNanSumCastLoadPolicy<vec_t, vacc_t>,
           InnerSumCastLoadPolicy<vec_t, vacc_t>>;
-      vectorized_inner_sum<acc_t, VecLoadPolicy, ScalarLoadPolicy, StorePolicy>(
-          data, in_strides[1], out_stride, size0, size1);
+      vectorized_inner_sum<acc_t, VecLoadPolicy, ScalarLoadPolicy>(
+          data, in_strides[1], out_stride, size0, size1, store_policy);
     } else if (in_strides[1] == sizeof(scalar_t) && size1 >= vec_t::size()) {
       // Contiguous outer reduction
       using VecLoadPolicy = std::conditional_t<
           ignore_nan,
           OuterNanSumCastLoadPolicy<vec_t, vacc_t>,
           OuterSumCastLoadPolicy<vec_t, vacc_t>>;
-      vectorized_outer_sum<acc_t, VecLoadPolicy, ScalarLoadPolicy, StorePolicy>(
-          data, in_strides[0], out_stride, size0, size1);
+      vectorized_outer_sum<acc_t, VecLoadPolicy, ScalarLoadPolicy>(
+          data, in_strides[0], out_stride, size0, size1, store_policy);
     } else if (in_strides[0] < in_strides[1]) {
-      scalar_inner_sum<acc_t, ScalarLoadPolicy, StorePolicy>(
-          data, in_strides, out_stride, size0, size1);
+      scalar_inner_sum<acc_t, ScalarLoadPolicy>(
+          data, in_strides, out_stride, size0, size1, store_policy);
     } else {
-      scalar_outer_sum<acc_t, ScalarLoadPolicy, StorePolicy>(
-          data, in_strides, out_stride, size0, size1);
+      scalar_outer_sum<acc_t, ScalarLoadPolicy>(
+          data, in_strides, out_stride, size0, size1, store_policy);
     }
   });
 }
@@ -707,12 +724,234 @@ void sum_kernel_impl(at::TensorIterator& iter) {
       at::ScalarType::Half,
       iter.dtype(),
       "sum_cpu",
-      [&] { cascade_sum</*ignore_nan=*/false, scalar_t>(iter); });
+      [&] {
+        using acc_t = at::acc_type<scalar_t, true>;
+        cascade_sum</*ignore_nan=*/false, scalar_t>(
+            iter, CastStoreAccumulate<scalar_t, acc_t>());
+      });
+}
+
+void mean_kernel_impl(at::TensorIterator& iter, double scale) {
+  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND2(
+      at::ScalarType::BFloat16,
+      at::ScalarType::Half,
+      iter.dtype(),
+      "mean_cpu",
+      [&] {
+        using acc_t = at::acc_type<scalar_t, true>;
+        cascade_sum</*ignore_nan=*/false, scalar_t>(
+            iter, CastStoreScaleAccumulate<scalar_t, acc_t>{acc_t(scale)});
+      });
+}
+
+/* var and std are computed in a single pass with Welford's algorithm: each
+ * vector lane keeps the running mean and the sum of squared deviations m2 of
+ * the elements it has seen. Partial results of lanes and chunks are combined
+ * with Chan's formula, which is as stable as Welford's update.
+ */
+
+// Rows of the reduced dimension a task reduces when a reduction is split
+constexpr int64_t kVarChunkSize = 4096;
+
+template <typename acc_t>
+inline void welford_combine(
+    int64_t& count,
+    acc_t& mean,
+    acc_t& m2,
+    int64_t other_count,
+    acc_t other_mean,
+    acc_t other_m2) {
+  if (other_count == 0) {
+    return;
+  }
+  const int64_t new_count = count + other_count;
+  const acc_t delta = other_mean - mean;
+  const acc_t other_ratio = acc_t(other_count) / acc_t(new_count);
+  mean += delta * other_ratio;
+  m2 += other_m2 + delta * delta * acc_t(count) * other_ratio;
+  count = new_count;
+}
+
+// Welford moments of size contiguous elements
+template <typename scalar_t, typename acc_t>
+void welford_row(
+    const scalar_t* data,
+    int64_t size,
+    acc_t& mean,
+    acc_t& m2) {
+  using vec_t = at::vec::Vectorized<scalar_t>;
+  using vacc_t = at::vec::Vectorized<acc_t>;
+  using VecLoadPolicy = OuterSumCastLoadPolicy<vec_t, vacc_t>;
+  using ScalarLoadPolicy = CastLoadPolicy<scalar_t, acc_t>;
+  constexpr int64_t vec_stride = VecLoadPolicy::memsize();
+  const char* in_data = reinterpret_cast<const char*>(data);
+  const int64_t vec_size = size / vacc_t::size();
+
+  vacc_t vec_mean(0);
+  vacc_t vec_m2(0);
+  for (const auto i : c10::irange(vec_size)) {
+    const vacc_t x = VecLoadPolicy::load(in_data, vec_stride, i);
+    const vacc_t delta = x - vec_mean;
+    vec_mean += delta * vacc_t(acc_t(1) / acc_t(i + 1));
+    vec_m2 += delta * (x - vec_mean);
+  }
+
+  alignas(64) std::array<acc_t, vacc_t::size()> means;
+  alignas(64) std::array<acc_t, vacc_t::size()> m2s;
+  vec_mean.store(means.data());
+  vec_m2.store(m2s.data());
+  int64_t count = 0;
+  mean = acc_t(0);
+  m2 = acc_t(0);
+  if (vec_size > 0) {
+    for (const auto k : c10::irange(vacc_t::size())) {
+      welford_combine(count, mean, m2, vec_size, means[k], m2s[k]);
+    }
+  }
+  for (int64_t i = vec_size * vacc_t::size(); i < size; ++i) {
+    const acc_t x = ScalarLoadPolicy::load(in_data, sizeof(scalar_t), i);
+    welford_combine(count, mean, m2, 1, x, acc_t(0));
+  }
+}
+
+// Welford moments of the columns of rows [row_begin, row_end) of a [R, I]
+// matrix, one column per vector lane
+template <typename scalar_t, typename acc_t>
+void welford_columns(
+    const scalar_t* data,
+    int64_t row_begin,
+    int64_t row_end,
+    int64_t I,
+    acc_t* mean,
+    acc_t* m2) {
+  using vec_t = at::vec::Vectorized<scalar_t>;
+  using vacc_t = at::vec::Vectorized<acc_t>;
+  using VecLoadPolicy = OuterSumCastLoadPolicy<vec_t, vacc_t>;
+  using ScalarLoadPolicy = CastLoadPolicy<scalar_t, acc_t>;
+  std::fill_n(mean, I, acc_t(0));
+  std::fill_n(m2, I, acc_t(0));
+  for (int64_t r = row_begin; r < row_end; ++r) {
+    const acc_t rcount = acc_t(1) / acc_t(r - row_begin + 1);
+    const char* row = reinterpret_cast<const char*>(data + r * I);
+    int64_t i = 0;
+    for (; i + vacc_t::size() <= I; i += vacc_t::size()) {
+      const vacc_t x = VecLoadPolicy::load(row, sizeof(scalar_t), i);
+      vacc_t vec_mean = vacc_t::loadu(mean + i);
+      const vacc_t delta = x - vec_mean;
+      vec_mean += delta * vacc_t(rcount);
+      const vacc_t vec_m2 = vacc_t::loadu(m2 + i) + delta * (x - vec_mean);
+      vec_mean.store(mean + i);
+      vec_m2.store(m2 + i);
+    }
+    for (; i < I; ++i) {
+      const acc_t x = ScalarLoadPolicy::load(row, sizeof(scalar_t), i);
+      const acc_t delta = x - mean[i];
+      mean[i] += delta * rcount;
+      m2[i] += delta * (x - mean[i]);
+    }
+  }
+}
+
+template <typename scalar_t>
+void var_mean_kernel(
+    const at::Tensor& self,
+    int64_t O,
+    int64_t R,
+    int64_t I,
+    int64_t correction,
+    bool take_sqrt,
+    at::Tensor& var,
+    at::Tensor& mean) {
+  using acc_t = at::acc_type<scalar_t, true>;
+  const scalar_t* self_data = self.data_ptr<scalar_t>();
+  scalar_t* var_data = var.data_ptr<scalar_t>();
+  scalar_t* mean_data = mean.defined() ? mean.data_ptr<scalar_t>() : nullptr;
+
+  // Split the reduced dimension into chunks when the outputs alone can't
+  // keep the threads busy, e.g. statistics over the whole batch
+  const int64_t num_threads = at::get_num_threads();
+  int64_t num_chunks = 1;
+  if (O < num_threads && R > kVarChunkSize) {
+    num_chunks =
+        std::min(at::divup(R, kVarChunkSize), at::divup(num_threads, O));
+  }
+  const int64_t chunk_size = at::divup(R, num_chunks);
+  num_chunks = at::divup(R, chunk_size);
+
+  // moments of chunk c of output (o, i) at [o, c, i]
+  std::vector<acc_t> chunk_mean(O * num_chunks * I);
+  std::vector<acc_t> chunk_m2(O * num_chunks * I);
+  at::parallel_for(0, O * num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (const auto task : c10::irange(begin, end)) {
+      const int64_t o = task / num_chunks;
+      const int64_t row_begin = task % num_chunks * chunk_size;
+      const int64_t row_end = std::min(row_begin + chunk_size, R);
+      const scalar_t* data = self_data + o * R * I;
+      if (I == 1) {
+        welford_row<scalar_t, acc_t>(
+            data + row_begin,
+            row_end - row_begin,
+            chunk_mean[task],
+            chunk_m2[task]);
+      } else {
+        welford_columns<scalar_t, acc_t>(
+            data,
+            row_begin,
+            row_end,
+            I,
+            chunk_mean.data() + task * I,
+            chunk_m2.data() + task * I);
+      }
+    }
+  });
+
+  // the variance of less than correction + 1 elements is NaN or inf, as in
+  // PyTorch
+  const acc_t divisor = std::max(int64_t(0), R - correction);
+  const int64_t grain_size = at::internal::GRAIN_SIZE / num_chunks;
+  at::parallel_for(0, O * I, grain_size, [&](int64_t begin, int64_t end) {
+    for (const auto j : c10::irange(begin, end)) {
+      const int64_t o = j / I;
+      const int64_t i = j % I;
+      int64_t count = 0;
+      acc_t m = acc_t(0);
+      acc_t m2 = acc_t(0);
+      for (const auto c : c10::irange(num_chunks)) {
+        const int64_t index = (o * num_chunks + c) * I + i;
+        const int64_t chunk_count = std::min(chunk_size, R - c * chunk_size);
+        welford_combine(
+            count, m, m2, chunk_count, chunk_mean[index], chunk_m2[index]);
+      }
+      const acc_t v = m2 / divisor;
+      var_data[j] = take_sqrt ? std::sqrt(v) : v;
+      if (mean_data != nullptr) {
+        mean_data[j] = m;
+      }
+    }
+  });
+}
+
+void var_mean_kernel_impl(
+    const at::Tensor& self,
+    int64_t O,
+    int64_t R,
+    int64_t I,
+    int64_t correction,
+    bool take_sqrt,
+    at::Tensor& var,
+    at::Tensor& mean) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(), "var_mean_cpu", [&] {
+        var_mean_kernel<scalar_t>(
+            self, O, R, I, correction, take_sqrt, var, mean);
+      });
 }
 
 } // anonymous namespace
 
 REGISTER_DISPATCH(sum_kernel_stub, &sum_kernel_impl);
+REGISTER_DISPATCH(mean_kernel_stub, &mean_kernel_impl);
+REGISTER_DISPATCH(var_mean_kernel_stub, &var_mean_kernel_impl);
 
 } // namespace cpu
-} // namespace torch_ipex
\ No newline at end of file
+} // namespace torch_ipex
@@ -0,0 +1,112 @@
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+
+#include <csrc/aten/cpu/WoqLinear.h>
+
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using Vec = at::vec::Vectorized<float>;
+
+// output features computed by a task
+constexpr int64_t kBlockN = 16;
+
+// Dequantizes a weight row of K into w. The integers are converted first and
+// scaled group by group afterwards, both loops vectorize.
+inline void dequantize_row(
+    const uint8_t* q,
+    const float* scales,
+    int64_t bits,
+    int64_t group_size,
+    int64_t K,
+    float* w) {
+  if (bits == 4) {
+    for (int64_t j = 0; j < K / 2; j++) {
+      w[2 * j] = static_cast<float>(q[j] & 0xf) - 8.f;
+      w[2 * j + 1] = static_cast<float>(q[j] >> 4) - 8.f;
+    }
+    if (K % 2 != 0) {
+      w[K - 1] = static_cast<float>(q[K / 2] & 0xf) - 8.f;
+    }
+  } else {
+    const int8_t* q8 = reinterpret_cast<const int8_t*>(q);
+    for (int64_t k = 0; k < K; k++) {
+      w[k] = static_cast<float>(q8[k]);
+    }
+  }
+  for (int64_t g = 0; g < K / group_size; g++) {
+    const Vec scale(scales[g]);
+    float* w_group = w + g * group_size;
+    at::vec::map(
+        [scale](Vec x) { return x * scale; }, w_group, w_group, group_size);
+  }
+}
+
+inline float dot(const float* a, const float* b, int64_t K) {
+  Vec acc(0.f);
+  int64_t k = 0;
+  for (; k + Vec::size() <= K; k += Vec::size()) {
+    acc = at::vec::fmadd(Vec::loadu(a + k), Vec::loadu(b + k), acc);
+  }
+  float acc_arr[Vec::size()];
+  acc.store(acc_arr);
+  float sum = 0.f;
+  for (int64_t i = 0; i < Vec::size(); i++) {
+    sum += acc_arr[i];
+  }
+  for (; k < K; k++) {
+    sum += a[k] * b[k];
+  }
+  return sum;
+}
+
+// Decoding multiplies a few input rows by the whole weight, so the time goes
+// into reading the weight. Each row of it is read once in its quantized form,
+// dequantized into a buffer that stays in cache and multiplied by all the
+// input rows.
+void woq_linear_gemv_kernel_impl(
+    const at::Tensor& input,
+    const WoqLinearWeight& weight,
+    const at::Tensor& bias,
+    at::Tensor& output) {
+  const int64_t M = input.size(0);
+  const int64_t N = weight.out_features;
+  const int64_t K = weight.in_features;
+  const int64_t num_groups = K / weight.group_size;
+  const int64_t ldq = weight.bits == 4 ? (K + 1) / 2 : K;
+  const uint8_t* qweight =
+      static_cast<const uint8_t*>(weight.qweight.data_ptr());
+  const float* scales = weight.scales.data_ptr<float>();
+  const float* input_data = input.data_ptr<float>();
+  const float* bias_data = bias.defined() ? bias.data_ptr<float>() : nullptr;
+  float* output_data = output.data_ptr<float>();
+
+  at::parallel_for(0, N, kBlockN, [&](int64_t begin, int64_t end) {
+    std::vector<float> w_row(K);
+    for (int64_t n = begin; n < end; n++) {
+      dequantize_row(
+          qweight + n * ldq,
+          scales + n * num_groups,
+          weight.bits,
+          weight.group_size,
+          K,
+          w_row.data());
+      const float b = bias_data != nullptr ? bias_data[n] : 0.f;
+      for (int64_t m = 0; m < M; m++) {
+        output_data[m * N + n] = dot(w_row.data(), input_data + m * K, K) + b;
+      }
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(woq_linear_gemv_kernel_stub, &woq_linear_gemv_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -238,8 +238,7 @@ void adagrad_fused_step_kernel<float, at::BFloat16>(
           param2_bvec.store(param2_ptr + d);
         }
         for (; d < size; d++) {
-          float param_val =
-              at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
+          float param_val = param_ptr[d];
           float grad_val = float(grad_ptr[d]) + param_val * weight_decay;
           state_sum_ptr[d] += grad_val * grad_val;
 
@@ -251,6 +250,256 @@ void adagrad_fused_step_kernel<float, at::BFloat16>(
       });
 }
 
+// Sparse gradients of embedding tables: only the rows present in the
+// gradient are updated, which is what torch.optim.Adagrad does for sparse
+// gradients. The gradient is coalesced so that each row is owned by a single
+// task. f gets a per-task fp32 buffer of two rows for the BFloat16 cases.
+template <typename func_t>
+void adagrad_for_each_sparse_row(
+    const at::Tensor& param,
+    const at::Tensor& grad,
+    const func_t& f) {
+  const int64_t nnz = grad._nnz();
+  const int64_t sparse_dim = grad.sparse_dim();
+  auto indices_accessor = grad._indices().accessor<int64_t, 2>();
+  const int64_t row_size = grad._values().numel() / nnz;
+  if (row_size == 0) {
+    return;
+  }
+  const int64_t grain_size = std::max<int64_t>(1, 512 / row_size);
+  at::parallel_for(0, nnz, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<float> buffer(2 * row_size);
+    for (int64_t n = begin; n < end; n++) {
+      int64_t param_offset = 0;
+      for (int64_t d = 0; d < sparse_dim; d++) {
+        param_offset += param.stride(d) * indices_accessor[d][n];
+      }
+      f(n * row_size, param_offset, row_size, buffer.data());
+    }
+  });
+}
+
+template <typename scalar_t>
+inline void adagrad_sparse_row_update(
+    scalar_t* param_ptr,
+    scalar_t* state_sum_ptr,
+    const scalar_t* grad_ptr,
+    int64_t size,
+    scalar_t clr,
+    scalar_t eps) {
+  using Vec = at::vec::Vectorized<scalar_t>;
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec grad_vec = Vec::loadu(grad_ptr + d);
+    Vec sum_vec = Vec::loadu(state_sum_ptr + d) + grad_vec * grad_vec;
+    sum_vec.store(state_sum_ptr + d);
+    Vec std_vec = sum_vec.sqrt() + Vec(eps);
+    Vec param_vec = Vec::loadu(param_ptr + d) - grad_vec / std_vec * Vec(clr);
+    param_vec.store(param_ptr + d);
+  }
+  for (; d < size; d++) {
+    state_sum_ptr[d] += grad_ptr[d] * grad_ptr[d];
+    scalar_t std_val = std::sqrt(state_sum_ptr[d]) + eps;
+    param_ptr[d] -= grad_ptr[d] / std_val * clr;
+  }
+}
+
+// The fp32 rows of a master weight split into its top and bottom BFloat16
+// halves are only assembled in a per-thread row buffer.
+inline void load_split_row(
+    const at::BFloat16* top_ptr,
+    const at::BFloat16* bot_ptr,
+    float* out_ptr,
+    int64_t size) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec out_fvec, out_fvec2;
+    std::tie(out_fvec, out_fvec2) = at::vec::pack_bfloat16_float(
+        bVec::loadu(top_ptr + d), bVec::loadu(bot_ptr + d));
+    out_fvec.store(out_ptr + d);
+    out_fvec2.store(out_ptr + d + fVec::size());
+  }
+  for (; d < size; d++) {
+    out_ptr[d] = at::vec::pack_bfloat16_float(top_ptr[d], bot_ptr[d]);
+  }
+}
+
+inline void store_split_row(
+    at::BFloat16* top_ptr,
+    at::BFloat16* bot_ptr,
+    const float* in_ptr,
+    int64_t size) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec top_bvec, bot_bvec;
+    std::tie(top_bvec, bot_bvec) = at::vec::unpack_float_bfloat16(
+        fVec::loadu(in_ptr + d), fVec::loadu(in_ptr + d + fVec::size()));
+    top_bvec.store(top_ptr + d);
+    bot_bvec.store(bot_ptr + d);
+  }
+  for (; d < size; d++) {
+    std::tie(top_ptr[d], bot_ptr[d]) =
+        at::vec::unpack_float_bfloat16(in_ptr[d]);
+  }
+}
+
+template <typename scalar_t, typename grad_t>
+void adagrad_sparse_step_kernel(
+    const at::Tensor& param,
+    const at::Tensor& grad,
+    const at::Tensor& state_sum,
+    const at::Tensor& param2,
+    double clr,
+    double eps) {
+  scalar_t* param_data = param.data_ptr<scalar_t>();
+  scalar_t* state_sum_data = state_sum.data_ptr<scalar_t>();
+  auto values = grad._values().contiguous();
+  const scalar_t* values_data = values.data_ptr<scalar_t>();
+  adagrad_for_each_sparse_row(
+      param,
+      grad,
+      [&](int64_t value_offset,
+          int64_t offset,
+          int64_t size,
+          float* /* buffer */) {
+        adagrad_sparse_row_update<scalar_t>(
+            param_data + offset,
+            state_sum_data + offset,
+            values_data + value_offset,
+            size,
+            scalar_t(clr),
+            scalar_t(eps));
+      });
+}
+
+template <>
+void adagrad_sparse_step_kernel<at::BFloat16, at::BFloat16>(
+    const at::Tensor& param,
+    const at::Tensor& grad,
+    const at::Tensor& state_sum,
+    const at::Tensor& param2,
+    double clr,
+    double eps) {
+  TORCH_CHECK(
+      state_sum.scalar_type() == at::kFloat,
+      "adagrad_fused_step_kernel: expect stats_sum to be float32");
+  TORCH_CHECK(
+      param2.scalar_type() == at::kBFloat16,
+      "adagrad_fused_step_kernel: expect param2 to be at::BFloat16");
+  at::BFloat16* param_data = param.data_ptr<at::BFloat16>();
+  at::BFloat16* param2_data = param2.data_ptr<at::BFloat16>();
+  float* state_sum_data = state_sum.data_ptr<float>();
+  auto values = grad._values().contiguous();
+  const at::BFloat16* values_data = values.data_ptr<at::BFloat16>();
+  adagrad_for_each_sparse_row(
+      param,
+      grad,
+      [&](int64_t value_offset,
+          int64_t offset,
+          int64_t size,
+          float* buffer) {
+        float* param_row = buffer;
+        float* grad_row = buffer + size;
+        load_split_row(
+            param_data + offset, param2_data + offset, param_row, size);
+        at::vec::convert(values_data + value_offset, grad_row, size);
+        adagrad_sparse_row_update<float>(
+            param_row,
+            state_sum_data + offset,
+            grad_row,
+            size,
+            float(clr),
+            float(eps));
+        store_split_row(
+            param_data + offset, param2_data + offset, param_row, size);
+      });
+}
+
+template <>
+void adagrad_sparse_step_kernel<float, at::BFloat16>(
+    const at::Tensor& param,
+    const at::Tensor& grad,
+    const at::Tensor& state_sum,
+    const at::Tensor& param2,
+    double clr,
+    double eps) {
+  TORCH_CHECK(
+      state_sum.scalar_type() == at::kFloat,
+      "adagrad_fused_step_kernel: expect stats_sum to be float32");
+  TORCH_CHECK(
+      param2.scalar_type() == at::kBFloat16,
+      "adagrad_fused_step_kernel: expect param2 to be at::BFloat16");
+  float* param_data = param.data_ptr<float>();
+  at::BFloat16* param2_data = param2.data_ptr<at::BFloat16>();
+  float* state_sum_data = state_sum.data_ptr<float>();
+  auto values = grad._values().contiguous();
+  const at::BFloat16* values_data = values.data_ptr<at::BFloat16>();
+  adagrad_for_each_sparse_row(
+      param,
+      grad,
+      [&](int64_t value_offset,
+          int64_t offset,
+          int64_t size,
+          float* buffer) {
+        float* grad_row = buffer;
+        at::vec::convert(values_data + value_offset, grad_row, size);
+        adagrad_sparse_row_update<float>(
+            param_data + offset,
+            state_sum_data + offset,
+            grad_row,
+            size,
+            float(clr),
+            float(eps));
+        // sync float param to bfloat16
+        at::vec::convert(param_data + offset, param2_data + offset, size);
+      });
+}
+
+void adagrad_sparse_step(
+    const at::Tensor& param,
+    const at::Tensor& grad_,
+    const at::Tensor& state_sum,
+    const at::Tensor& param2,
+    double clr,
+    double eps) {
+  TORCH_CHECK(
+      param.is_contiguous() && state_sum.is_contiguous() &&
+          (param2.numel() == 0 || param2.is_contiguous()),
+      "adagrad_fused_step: expect contiguous param, state_sum and trail for "
+      "sparse gradients");
+  // the update is non-linear so indices must be unique
+  auto grad = grad_.coalesce();
+  if (grad._nnz() == 0) {
+    return;
+  }
+
+  auto grad_dtype = grad.scalar_type();
+  auto param_dtype = param.scalar_type();
+  if (at::ScalarType::Float == grad_dtype) {
+    adagrad_sparse_step_kernel<float, float>(
+        param, grad, state_sum, param2, clr, eps);
+  } else if (at::ScalarType::Double == grad_dtype) {
+    adagrad_sparse_step_kernel<double, double>(
+        param, grad, state_sum, param2, clr, eps);
+  } else if (
+      at::ScalarType::BFloat16 == grad_dtype &&
+      at::ScalarType::BFloat16 == param_dtype) {
+    adagrad_sparse_step_kernel<at::BFloat16, at::BFloat16>(
+        param, grad, state_sum, param2, clr, eps);
+  } else if (
+      at::ScalarType::BFloat16 == grad_dtype &&
+      at::ScalarType::Float == param_dtype) {
+    adagrad_sparse_step_kernel<float, at::BFloat16>(
+        param, grad, state_sum, param2, clr, eps);
+  } else {
+    TORCH_CHECK(false, "expect bfloat16 or float or double param");
+  }
+}
+
 std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
     const at::Tensor& param_,
     const at::Tensor& grad_,
@@ -261,6 +510,17 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
     double weight_decay,
     double lr_decay,
     double eps) {
+  if (grad_.is_sparse()) {
+    adagrad_sparse_step(
+        param_,
+        grad_,
+        state_sum_,
+        param2_,
+        learning_rate / (1 + (step - 1) * lr_decay),
+        eps);
+    return std::make_tuple(param_, state_sum_);
+  }
+
   auto param = param_.contiguous();
   auto grad = grad_.contiguous();
   auto state_sum = state_sum_.contiguous();
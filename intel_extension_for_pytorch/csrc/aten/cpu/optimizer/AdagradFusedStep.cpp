@@ -28,6 +28,10 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
   TORCH_CHECK(
       weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
 
+  TORCH_CHECK(
+      !grad_.is_sparse() || weight_decay == 0,
+      "weight_decay option is not compatible with sparse gradients");
+
   TORCH_CHECK(
       param_.sizes() == grad_.sizes(),
       "Expect param and grad_ have the same sizes, param sizes: ",
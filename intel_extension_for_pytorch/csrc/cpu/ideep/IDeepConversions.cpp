@@ -209,9 +209,8 @@ at::Tensor mkldnn_to_dense(
 }
 
 // Init a aten tensor according to ideep tensor's desc.
-at::Tensor empty_aten_tensor_from_desc(
-    const ideep::tensor::desc& desc,
-    const at::TensorOptions& options) {
+static std::vector<int64_t> aten_sizes_from_desc(
+    const ideep::tensor::desc& desc) {
   auto ndims = desc.data.ndims;
   auto nblks = desc.blocking_desc().inner_nblks;
   std::vector<int64_t> at_sizes(ndims + nblks);
@@ -226,7 +225,21 @@ at::Tensor empty_aten_tensor_from_desc(
   for (auto i = 0; i < ndims; i++) {
     at_sizes[i] = padded_dims[i] / blk_size_per_dim[i];
   }
-  return at::empty(at_sizes, options);
+  return at_sizes;
+}
+
+at::Tensor empty_aten_tensor_from_desc(
+    const ideep::tensor::desc& desc,
+    const at::TensorOptions& options) {
+  return at::empty(aten_sizes_from_desc(desc), options);
+}
+
+at::Tensor aten_tensor_view_from_desc(
+    const ideep::tensor::desc& desc,
+    void* data,
+    const std::function<void(void*)>& deleter,
+    const at::TensorOptions& options) {
+  return at::from_blob(data, aten_sizes_from_desc(desc), deleter, options);
 }
 
 } // namespace cpu
@@ -36,6 +36,14 @@ at::Tensor empty_aten_tensor_from_desc(
     const ideep::tensor::desc& desc,
     const at::TensorOptions& options);
 
+// Construct an aten tensor with the same sizes as empty_aten_tensor_from_desc
+// on top of the given buffer, the deleter is called when it's released
+at::Tensor aten_tensor_view_from_desc(
+    const ideep::tensor::desc& desc,
+    void* data,
+    const std::function<void(void*)>& deleter,
+    const at::TensorOptions& options);
+
 // ##Background##
 // This function returns the input tensor's stride with a workaround that checks
 // (and fixes) the stride when the input tensor has dim size 1. Currently oneDNN
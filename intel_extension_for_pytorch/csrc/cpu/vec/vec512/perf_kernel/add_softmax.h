@@ -77,176 +77,190 @@ inline __m512 _dil_exp_kernel(__m512 vec_src) {
   return vec_res;
 }
 
-template <typename scalar_t>
-inline void _dil_div_add_reduce_max_fusion_kernel(
-    const scalar_t* a,
-    const scalar_t* b,
-    const float& dim_per_head,
-    const int& size,
-    float* out,
-    float& max) {
-  auto vec_ps_min = _mm512_set1_ps(std::numeric_limits<float>::min());
-  auto vec_ps_min_tail = _mm512_set1_ps(std::numeric_limits<float>::min());
-  auto vec_a = vec_ps_min;
-  auto vec_b = vec_ps_min;
-  auto vec_out = vec_ps_min;
-
-  int i = 0;
-  auto vec_r_dim_per_head = _mm512_set1_ps(1.0 / dim_per_head);
-  for (; i <= size - 16; i += 16) {
-    vec_a = _loadu(a + i);
-    vec_b = _loadu(b + i);
-    vec_out = _mm512_fmadd_ps(vec_a, vec_r_dim_per_head, vec_b);
-    vec_ps_min = _mm512_max_ps(vec_ps_min, vec_out);
-    _mm512_storeu_ps(out + i, vec_out);
-  }
+// x - max, lanes whose max is still -inf give -inf instead of NaN: they have
+// seen no unmasked score yet, their exp is 0.
+inline __m512 _dil_sub_max(__m512 vec_x, __m512 vec_max) {
+  auto vec_neg_inf = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+  __mmask16 neg_inf_mask =
+      _mm512_cmp_ps_mask(vec_max, vec_neg_inf, _CMP_EQ_OQ);
+  return _mm512_sub_ps(
+      vec_x,
+      _mm512_mask_blend_ps(neg_inf_mask, vec_max, _mm512_setzero_ps()));
+}
 
-  if (i < size) {
-    __mmask16 mask = (1 << (size - i)) - 1;
-    vec_a = _maskz_loadu(a + i, mask);
-    vec_b = _maskz_loadu(b + i, mask);
-    vec_out = _mm512_fmadd_ps(vec_a, vec_r_dim_per_head, vec_b);
-    vec_ps_min = _mm512_mask_max_ps(vec_ps_min, mask, vec_out, vec_ps_min);
-    _mm512_mask_storeu_ps(out + i, mask, vec_out);
+// Online softmax update of the per lane max and sum of exp(x - max): the sum
+// is rescaled by exp(old_max - new_max) when the max grows, which is rare
+// once the first chunks of the row have been seen.
+inline void _dil_online_softmax_update(
+    __m512 vec_x,
+    __m512& vec_max,
+    __m512& vec_sum) {
+  if (_mm512_cmp_ps_mask(vec_x, vec_max, _CMP_GT_OQ)) {
+    auto vec_new_max = _mm512_max_ps(vec_max, vec_x);
+    vec_sum = _mm512_mul_ps(
+        vec_sum, _dil_exp_kernel(_dil_sub_max(vec_max, vec_new_max)));
+    vec_max = vec_new_max;
   }
-
-  // NOTE: _mm512_reduce_max_ps is sequence instruction
-  max = _mm512_reduce_max_ps(vec_ps_min);
+  vec_sum = _mm512_add_ps(
+      vec_sum, _dil_exp_kernel(_dil_sub_max(vec_x, vec_max)));
 }
 
-template <typename scalar_t>
-inline void _dil_maskedfill_div_max_fusion_kernel(
-    const scalar_t* a,
-    const float* b,
-    const float& fill_value,
-    const float& dim_per_head,
+/**
+ * @brief Computes the max and the sum of exp(x - max) of a row of softmax
+ * inputs in a single pass, without writing the row.
+ *
+ * @param[in] score functor giving the softmax inputs x of the row: score(i)
+ * for the 16 elements starting at i, score(i, mask) for the tail
+ * @param[in] size the number of elements of the row
+ * @param[out] max the max of the row
+ * @param[out] sum the sum of exp(x - max) of the row
+ */
+template <typename score_fn_t>
+inline void _dil_online_softmax_reduce_kernel(
+    const score_fn_t& score,
     const int& size,
-    float* out,
-    float& max) {
-  auto vec_fill = _mm512_set1_ps(fill_value);
-  auto vec_ps_min = vec_fill;
-  auto mask_c = _mm512_set1_ps(1.0);
-  auto vec_dim_per_head = _mm512_set1_ps(dim_per_head);
-
-  auto vec_a = vec_ps_min;
-  auto vec_b = vec_ps_min;
-  auto vec_out = vec_ps_min;
+    float& max,
+    float& sum) {
+  auto vec_neg_inf = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+  auto vec_max = vec_neg_inf;
+  auto vec_sum = _mm512_setzero_ps();
 
   int i = 0;
   for (; i <= size - 16; i += 16) {
-    vec_a = _loadu(a + i);
-    vec_b = _loadu(b + i);
-    __mmask16 fill_mask = _mm512_cmp_ps_mask(vec_b, mask_c, 12);
-    vec_out = _mm512_mask_div_ps(vec_fill, fill_mask, vec_a, vec_dim_per_head);
-    vec_ps_min = _mm512_max_ps(vec_ps_min, vec_out);
-    _mm512_storeu_ps(out + i, vec_out);
+    _dil_online_softmax_update(score(i), vec_max, vec_sum);
   }
 
   if (i < size) {
     __mmask16 mask = (1 << (size - i)) - 1;
-    vec_a = _maskz_loadu(a + i, mask);
-    vec_b = _maskz_loadu(b + i, mask);
-    __mmask16 fill_mask = _mm512_cmp_ps_mask(vec_b, mask_c, 12);
-    vec_out = _mm512_mask_div_ps(vec_fill, fill_mask, vec_a, vec_dim_per_head);
-    vec_ps_min = _mm512_max_ps(vec_ps_min, vec_out);
-    _mm512_mask_storeu_ps(out + i, mask, vec_out);
+    auto vec_x = _mm512_mask_blend_ps(mask, vec_neg_inf, score(i, mask));
+    _dil_online_softmax_update(vec_x, vec_max, vec_sum);
   }
 
   // NOTE: _mm512_reduce_max_ps is sequence instruction
-  max = _mm512_reduce_max_ps(vec_ps_min);
+  max = _mm512_reduce_max_ps(vec_max);
+  // rescale the lane sums to the max of the row
+  vec_sum = _mm512_mul_ps(
+      vec_sum, _dil_exp_kernel(_dil_sub_max(vec_max, _mm512_set1_ps(max))));
+  // NOTE: _mm512_reduce_add_ps is sequence instruction
+  sum = _mm512_reduce_add_ps(vec_sum);
 }
 
-inline void _dil_exp_reduce_sum_fusion_kernel(
-    float* a,
+/**
+ * @brief Writes the softmax of a row, out = exp(x - max) / sum, from the max
+ * and sum computed by _dil_online_softmax_reduce_kernel. The softmax inputs
+ * are recomputed from score, the row is read while it is still in cache.
+ */
+template <typename score_fn_t, typename scalar_t>
+inline void _dil_online_softmax_normalize_kernel(
+    const score_fn_t& score,
     const int& size,
-    float* out,
-    float& val) {
-  static auto vec_zero = _mm512_set1_ps(0.f);
-  auto vec_max = _mm512_set1_ps(val);
-  auto vec_sum = _mm512_set1_ps(0.f);
-  __m512 vec_a = {};
-  __m512 vec_out = {};
+    const float& max,
+    const float& sum,
+    scalar_t* out) {
+  auto vec_max = _mm512_set1_ps(max);
+  auto vec_r_sum = _mm512_set1_ps(1.0f / sum);
 
   int i = 0;
   for (; i <= size - 16; i += 16) {
-    vec_a = _mm512_loadu_ps(a + i);
-    vec_out = _mm512_sub_ps(vec_a, vec_max);
-    vec_out = _dil_exp_kernel(vec_out);
-    vec_sum = _mm512_add_ps(vec_sum, vec_out);
-    _mm512_storeu_ps(out + i, vec_out);
+    auto vec_out = _dil_exp_kernel(_dil_sub_max(score(i), vec_max));
+    _storeu(out + i, _mm512_mul_ps(vec_out, vec_r_sum));
   }
 
   if (i < size) {
     __mmask16 mask = (1 << (size - i)) - 1;
-    auto vec_a = _mm512_mask_loadu_ps(vec_max, mask, a + i);
-    auto vec_out = _mm512_sub_ps(vec_a, vec_max);
-    vec_out = _dil_exp_kernel(vec_out);
-    vec_sum = _mm512_mask_add_ps(vec_sum, mask, vec_sum, vec_out);
-    _mm512_mask_storeu_ps(out + i, mask, vec_out);
+    auto vec_out = _dil_exp_kernel(_dil_sub_max(score(i, mask), vec_max));
+    _mask_storeu(out + i, _mm512_mul_ps(vec_out, vec_r_sum), mask);
   }
-
-  // NOTE: _mm512_reduce_add_ps is sequence instruction
-  val = _mm512_reduce_add_ps(vec_sum);
 }
 
+// softmax input a / dim_per_head + b
 template <typename scalar_t>
-inline void _dil_normalization_kernel(
-    const float* a,
-    const float& sum,
-    const int& size,
-    scalar_t* out) {
-  auto vec_sum = _mm512_set1_ps(sum);
-  __m512 vec_a = {};
-  __m512 vec_out = {};
+struct _DivAddScore {
+  const scalar_t* a;
+  const scalar_t* b;
+  __m512 vec_r_dim_per_head;
 
-  int i = 0;
-  for (; i <= size - 16; i += 16) {
-    auto vec_a = _mm512_loadu_ps(a + i);
-    auto vec_out = _mm512_div_ps(vec_a, vec_sum);
-    _storeu(out + i, vec_out);
+  _DivAddScore(const scalar_t* a, const scalar_t* b, float dim_per_head)
+      : a(a), b(b), vec_r_dim_per_head(_mm512_set1_ps(1.0 / dim_per_head)) {}
+
+  __m512 operator()(int i) const {
+    return _mm512_fmadd_ps(_loadu(a + i), vec_r_dim_per_head, _loadu(b + i));
   }
 
-  if (i < size) {
-    __mmask16 mask = (1 << (size - i)) - 1;
-    auto vec_a = _mm512_maskz_loadu_ps(mask, a + i);
-    auto vec_out = _mm512_div_ps(vec_a, vec_sum);
-    _mask_storeu(out + i, vec_out, mask);
+  __m512 operator()(int i, __mmask16 mask) const {
+    return _mm512_fmadd_ps(
+        _maskz_loadu(a + i, mask),
+        vec_r_dim_per_head,
+        _maskz_loadu(b + i, mask));
   }
+};
+
+// The lanes of a masked_fill mask which keep their score: the float mask
+// (from the converted bool mask) is 1 for the filled lanes, the bool mask is
+// true.
+inline __mmask16 _dil_keep_mask(const float* b, __mmask16 mask) {
+  return _mm512_mask_cmp_ps_mask(
+      mask, _mm512_maskz_loadu_ps(mask, b), _mm512_set1_ps(1.0), 12);
 }
 
-inline void _dil_add_reduce_max_fusion_kernel(
-    float* a,
-    const float* b,
-    const int& size,
-    float* out,
-    float& max) {
-  auto vec_ps_min = _mm512_set1_ps(std::numeric_limits<float>::min());
-  auto vec_ps_min_tail = _mm512_set1_ps(std::numeric_limits<float>::min());
-  auto vec_a = vec_ps_min;
-  auto vec_b = vec_ps_min;
-  auto vec_out = vec_ps_min;
+inline __mmask16 _dil_keep_mask(const bool* b, __mmask16 mask) {
+  return _mm_mask_cmpeq_epi8_mask(
+      mask, _mm_maskz_loadu_epi8(mask, b), _mm_setzero_si128());
+}
 
-  int i = 0;
-  for (; i <= size - 16; i += 16) {
-    vec_a = _loadu(a + i);
-    vec_b = _loadu(b + i);
-    vec_out = _mm512_add_ps(vec_a, vec_b);
-    vec_ps_min = _mm512_max_ps(vec_ps_min, vec_out);
-    _mm512_storeu_ps(out + i, vec_out);
+// softmax input mask ? fill : a / dim_per_head
+template <typename scalar_t, typename mask_t>
+struct _DivMaskedFillScore {
+  const scalar_t* a;
+  const mask_t* b;
+  __m512 vec_fill;
+  __m512 vec_dim_per_head;
+
+  _DivMaskedFillScore(
+      const scalar_t* a,
+      const mask_t* b,
+      float fill_value,
+      float dim_per_head)
+      : a(a),
+        b(b),
+        vec_fill(_mm512_set1_ps(fill_value)),
+        vec_dim_per_head(_mm512_set1_ps(dim_per_head)) {}
+
+  __m512 operator()(int i) const {
+    return _mm512_mask_div_ps(
+        vec_fill,
+        _dil_keep_mask(b + i, 0xffff),
+        _loadu(a + i),
+        vec_dim_per_head);
   }
 
-  if (i < size) {
-    __mmask16 mask = (1 << (size - i)) - 1;
-    vec_a = _maskz_loadu(a + i, mask);
-    vec_b = _maskz_loadu(b + i, mask);
-    vec_out = _mm512_add_ps(vec_a, vec_b);
-    vec_ps_min = _mm512_mask_max_ps(vec_ps_min, mask, vec_out, vec_ps_min);
-    _mm512_mask_storeu_ps(out + i, mask, vec_out);
+  __m512 operator()(int i, __mmask16 mask) const {
+    return _mm512_mask_div_ps(
+        vec_fill,
+        _dil_keep_mask(b + i, mask),
+        _maskz_loadu(a + i, mask),
+        vec_dim_per_head);
   }
+};
 
-  // NOTE: _mm512_reduce_max_ps is sequence instruction
-  max = _mm512_reduce_max_ps(vec_ps_min);
-}
+// softmax input a * scale, the causal mask is applied by the caller through
+// the length of the row
+template <typename scalar_t>
+struct _ScaleScore {
+  const scalar_t* a;
+  __m512 vec_scale;
+
+  _ScaleScore(const scalar_t* a, float scale)
+      : a(a), vec_scale(_mm512_set1_ps(scale)) {}
+
+  __m512 operator()(int i) const {
+    return _mm512_mul_ps(_loadu(a + i), vec_scale);
+  }
+
+  __m512 operator()(int i, __mmask16 mask) const {
+    return _mm512_mul_ps(_maskz_loadu(a + i, mask), vec_scale);
+  }
+};
 
 } // namespace kernel
 } // namespace cpu
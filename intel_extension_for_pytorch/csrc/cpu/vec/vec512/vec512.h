@@ -1,4 +1,5 @@
 #include "vec512_bfloat16.h"
 #include "vec512_int8.h"
+#include "vec512_prefix_sum_ker.h"
 
 #include "perf_kernel/kernel.h"
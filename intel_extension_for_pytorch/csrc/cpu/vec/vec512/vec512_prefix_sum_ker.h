@@ -0,0 +1,116 @@
+#pragma once
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+
+// In-register inclusive scan of one vector: log2(lanes) steps of
+// "shift lanes left by k with zero fill, then add", the shift is an alignr
+// against a zero vector.
+inline __m512 prefix_sum_m512(__m512 a) {
+  __m512i zero = _mm512_setzero_si512();
+  __m512i x = _mm512_castps_si512(a);
+  a = _mm512_add_ps(a, _mm512_castsi512_ps(_mm512_alignr_epi32(x, zero, 15)));
+  x = _mm512_castps_si512(a);
+  a = _mm512_add_ps(a, _mm512_castsi512_ps(_mm512_alignr_epi32(x, zero, 14)));
+  x = _mm512_castps_si512(a);
+  a = _mm512_add_ps(a, _mm512_castsi512_ps(_mm512_alignr_epi32(x, zero, 12)));
+  x = _mm512_castps_si512(a);
+  a = _mm512_add_ps(a, _mm512_castsi512_ps(_mm512_alignr_epi32(x, zero, 8)));
+  return a;
+}
+
+inline __m512i prefix_sum_m512i_epi32(__m512i a) {
+  __m512i zero = _mm512_setzero_si512();
+  a = _mm512_add_epi32(a, _mm512_alignr_epi32(a, zero, 15));
+  a = _mm512_add_epi32(a, _mm512_alignr_epi32(a, zero, 14));
+  a = _mm512_add_epi32(a, _mm512_alignr_epi32(a, zero, 12));
+  a = _mm512_add_epi32(a, _mm512_alignr_epi32(a, zero, 8));
+  return a;
+}
+
+inline __m512i prefix_sum_m512i_epi64(__m512i a) {
+  __m512i zero = _mm512_setzero_si512();
+  a = _mm512_add_epi64(a, _mm512_alignr_epi64(a, zero, 7));
+  a = _mm512_add_epi64(a, _mm512_alignr_epi64(a, zero, 6));
+  a = _mm512_add_epi64(a, _mm512_alignr_epi64(a, zero, 4));
+  return a;
+}
+
+template <>
+inline void prefix_sum<float>(
+    const float* src,
+    float* dst,
+    float init,
+    int64_t n) {
+  int64_t i;
+  __m512 offset = _mm512_set1_ps(init);
+  __m512i last = _mm512_set1_epi32(15);
+  for (i = 0; i <= (n - 16); i += 16) {
+    __m512 y = _mm512_add_ps(offset, prefix_sum_m512(_mm512_loadu_ps(src + i)));
+    _mm512_storeu_ps(dst + i, y);
+
+    // broadcast offset
+    offset = _mm512_permutexvar_ps(last, y);
+  }
+  if (i < n) {
+    __mmask16 mask = (1 << (n - i)) - 1;
+    __m512 y = _mm512_add_ps(
+        offset, prefix_sum_m512(_mm512_maskz_loadu_ps(mask, src + i)));
+    _mm512_mask_storeu_ps(dst + i, mask, y);
+  }
+}
+
+template <>
+inline void prefix_sum<int32_t>(
+    const int32_t* src,
+    int32_t* dst,
+    int32_t init,
+    int64_t n) {
+  int64_t i;
+  __m512i offset = _mm512_set1_epi32(init);
+  __m512i last = _mm512_set1_epi32(15);
+  for (i = 0; i <= (n - 16); i += 16) {
+    __m512i a = _mm512_loadu_si512(src + i);
+    __m512i y = _mm512_add_epi32(offset, prefix_sum_m512i_epi32(a));
+    _mm512_storeu_si512(dst + i, y);
+
+    // broadcast offset
+    offset = _mm512_permutexvar_epi32(last, y);
+  }
+  if (i < n) {
+    __mmask16 mask = (1 << (n - i)) - 1;
+    __m512i a = _mm512_maskz_loadu_epi32(mask, src + i);
+    __m512i y = _mm512_add_epi32(offset, prefix_sum_m512i_epi32(a));
+    _mm512_mask_storeu_epi32(dst + i, mask, y);
+  }
+}
+
+template <>
+inline void prefix_sum<int64_t>(
+    const int64_t* src,
+    int64_t* dst,
+    int64_t init,
+    int64_t n) {
+  int64_t i;
+  __m512i offset = _mm512_set1_epi64(init);
+  __m512i last = _mm512_set1_epi64(7);
+  for (i = 0; i <= (n - 8); i += 8) {
+    __m512i a = _mm512_loadu_si512(src + i);
+    __m512i y = _mm512_add_epi64(offset, prefix_sum_m512i_epi64(a));
+    _mm512_storeu_si512(dst + i, y);
+
+    // broadcast offset
+    offset = _mm512_permutexvar_epi64(last, y);
+  }
+  if (i < n) {
+    __mmask8 mask = (1 << (n - i)) - 1;
+    __m512i a = _mm512_maskz_loadu_epi64(mask, src + i);
+    __m512i y = _mm512_add_epi64(offset, prefix_sum_m512i_epi64(a));
+    _mm512_mask_storeu_epi64(dst + i, mask, y);
+  }
+}
+
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
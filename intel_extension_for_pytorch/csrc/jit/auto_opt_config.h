@@ -17,9 +17,54 @@ class AutoOptConfig {
     return jit_fuse_;
   }
 
+  inline void set_jit_static_memory_plan(bool jit_static_memory_plan) {
+    jit_static_memory_plan_ = jit_static_memory_plan;
+  }
+
+  inline bool get_jit_static_memory_plan() {
+    return jit_static_memory_plan_;
+  }
+
+  inline void set_jit_cat_elimination(bool jit_cat_elimination) {
+    jit_cat_elimination_ = jit_cat_elimination;
+  }
+
+  inline bool get_jit_cat_elimination() {
+    return jit_cat_elimination_;
+  }
+
+  inline void set_jit_inter_op_parallel(bool jit_inter_op_parallel) {
+    jit_inter_op_parallel_ = jit_inter_op_parallel;
+  }
+
+  inline bool get_jit_inter_op_parallel() {
+    return jit_inter_op_parallel_;
+  }
+
+  inline void set_jit_horizontal_fusion(bool jit_horizontal_fusion) {
+    jit_horizontal_fusion_ = jit_horizontal_fusion;
+  }
+
+  inline bool get_jit_horizontal_fusion() {
+    return jit_horizontal_fusion_;
+  }
+
+  inline void set_jit_sparse_linear(bool jit_sparse_linear) {
+    jit_sparse_linear_ = jit_sparse_linear;
+  }
+
+  inline bool get_jit_sparse_linear() {
+    return jit_sparse_linear_;
+  }
+
  private:
   AutoOptConfig()
       : jit_fuse_(true),
+        jit_static_memory_plan_(false),
+        jit_cat_elimination_(false),
+        jit_inter_op_parallel_(false),
+        jit_horizontal_fusion_(false),
+        jit_sparse_linear_(false),
         calibration_step_(false),
         qscheme_(at::QScheme::PER_TENSOR_AFFINE) {}
 
@@ -28,6 +73,21 @@ class AutoOptConfig {
   AutoOptConfig& operator=(const AutoOptConfig&) = default;
 
   bool jit_fuse_;
+  // plan the outputs of IPEX ops into a static arena in frozen graphs, off
+  // by default since the arena of each thread stays allocated between runs
+  bool jit_static_memory_plan_;
+  // let the producers of aten::cat write into slices of its output
+  bool jit_cat_elimination_;
+  // run the independent branches of frozen graphs concurrently on
+  // partitioned CPUPools, requires the IOMP runtime extension
+  bool jit_inter_op_parallel_;
+  // group the independent small linears and bmms of frozen graphs into
+  // grouped GEMMs
+  bool jit_horizontal_fusion_;
+  // replace the FP32 linears of frozen graphs whose weights are sparse with
+  // sparse prepacked linears when they measure faster, off by default since
+  // the choice depends on timings taken while freezing
+  bool jit_sparse_linear_;
   // the flag for one iteration of calibration step whether end or not.
   bool calibration_step_;
   at::QScheme qscheme_;
@@ -0,0 +1,268 @@
+#include "auto_partition.h"
+#include "fusion_group_name.h"
+#include "prepare_binary.h"
+
+#include "csrc/jit/fusion_pass.h"
+
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/tensorexpr_fuser.h>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+using namespace torch::jit;
+
+namespace {
+
+// The number of runs of each path discarded before measuring, the first run
+// compiles the LLGA partition and prepacks the IPEX weights.
+constexpr int kWarmupRuns = 2;
+constexpr int kMeasureRuns = 5;
+
+// The decisions made so far, keyed by region. They are kept in a text file
+// with one "<key> <llga|ipex> <llga_us> <ipex_us>" line per region, so that
+// later process starts skip the measurement.
+class AutoPartitionDecisions {
+ public:
+  static AutoPartitionDecisions& singleton() {
+    static AutoPartitionDecisions decisions;
+    return decisions;
+  }
+
+  void setCacheFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    std::ifstream file(path_);
+    std::string line;
+    while (std::getline(file, line)) {
+      std::istringstream fields(line);
+      std::string key, choice;
+      if (fields >> key >> choice) {
+        decisions_[key] = choice == "llga" ? 0 : 1;
+      }
+    }
+  }
+
+  c10::optional<int> lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = decisions_.find(key);
+    if (it == decisions_.end()) {
+      return c10::nullopt;
+    }
+    return it->second;
+  }
+
+  void record(
+      const std::string& key,
+      int choice,
+      double llga_us,
+      double ipex_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    decisions_[key] = choice;
+    if (path_.empty()) {
+      return;
+    }
+    std::ofstream file(path_, std::ios::app);
+    file << key << " " << (choice == 0 ? "llga" : "ipex") << " " << llga_us
+         << " " << ipex_us << "\n";
+  }
+
+ private:
+  std::mutex mutex_;
+  std::string path_;
+  std::unordered_map<std::string, int> decisions_;
+};
+
+// FNV-1a, the key has to be stable across processes
+std::string regionKey(const Graph& subgraph) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : subgraph.toString()) {
+    hash = (hash ^ c) * 1099511628211ULL;
+  }
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return key.str();
+}
+
+bool hasQuantization(const Graph& subgraph) {
+  for (auto node : subgraph.nodes()) {
+    if (node->kind() == Symbol::aten("quantize_per_tensor") ||
+        node->kind() == Symbol::aten("quantize_per_channel") ||
+        node->kind() == Symbol::aten("dequantize")) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void createAutoPartitionGroup(Node* fusion_group) {
+  auto subgraph = fusion_group->g(attr::Subgraph);
+  // IPEX has no equivalent of the INT8 partitions
+  if (hasQuantization(*subgraph)) {
+    return;
+  }
+
+  // The IPEX path runs the ops of the partition through IPEXFusionPass. The
+  // constants, such as the frozen weights, have been copied into the
+  // subgraph, so the prepacking ops get folded as well.
+  auto ipex_graph = subgraph->copy();
+  RevertPrepareBinaryForLLGA(ipex_graph);
+  torch_ipex::jit::IPEXFusionPass(ipex_graph);
+  RemoveTensorTypeSpecializations(ipex_graph);
+
+  // The LLGA path runs the fusion group alone. Its inputs are checked against
+  // the profiled types by the kernel instead of a LlgaFusionGuard, since the
+  // IPEX path is a better fallback than the unfused ops.
+  auto llga_graph = std::make_shared<Graph>();
+  std::unordered_map<Value*, Value*> value_map;
+  std::vector<TypePtr> input_types;
+  for (Value* input : fusion_group->inputs()) {
+    value_map[input] = llga_graph->addInput()->copyMetadata(input);
+    input_types.push_back(input->type());
+  }
+  Node* llga_node = llga_graph->insertNode(llga_graph->createClone(
+      fusion_group, [&](Value* v) { return value_map.at(v); }));
+  for (Value* output : llga_node->outputs()) {
+    llga_graph->registerOutput(output);
+  }
+
+  Graph* graph = fusion_group->owningGraph();
+  Node* group = graph->create(
+      Symbol::fromQualString(LlgaAutoPartitionGroupName()),
+      fusion_group->inputs(),
+      fusion_group->outputs().size());
+  group->g_(kLlgaGraphAttr, llga_graph);
+  group->g_(kIpexGraphAttr, ipex_graph);
+  group->tys_(attr::types, input_types);
+  group->s_(kAutoPartitionKeyAttr, regionKey(*subgraph));
+  group->insertBefore(fusion_group);
+  for (size_t i = 0; i < fusion_group->outputs().size(); i++) {
+    group->output(i)->copyMetadata(fusion_group->output(i));
+    fusion_group->output(i)->replaceAllUsesWith(group->output(i));
+  }
+  GRAPH_DEBUG("Created auto partition group: ", *group);
+  fusion_group->destroy();
+}
+
+void createAutoPartitionGroups(Block* block) {
+  std::vector<Node*> fusion_groups;
+  for (Node* node : block->nodes()) {
+    for (Block* sub_block : node->blocks()) {
+      createAutoPartitionGroups(sub_block);
+    }
+    if (node->kind() == Symbol::fromQualString(LlgaFusionGroupName())) {
+      fusion_groups.push_back(node);
+    }
+  }
+  for (Node* fusion_group : fusion_groups) {
+    createAutoPartitionGroup(fusion_group);
+  }
+}
+
+} // namespace
+
+void CreateAutoPartitionGroups(std::shared_ptr<Graph>& graph) {
+  createAutoPartitionGroups(graph->block());
+}
+
+void setAutoPartitionCacheFile(const std::string& path) {
+  AutoPartitionDecisions::singleton().setCacheFile(path);
+}
+
+AutoPartitionKernel::AutoPartitionKernel(const Node* node)
+    : num_inputs_(node->inputs().size()),
+      input_types_(node->tys(attr::types)),
+      key_(node->s(kAutoPartitionKeyAttr)),
+      llga_code_(node->g(kLlgaGraphAttr), "LlgaAutoPartition_llga"),
+      ipex_code_(node->g(kIpexGraphAttr), "LlgaAutoPartition_ipex") {
+  auto decision = AutoPartitionDecisions::singleton().lookup(key_);
+  if (decision) {
+    choice_ = *decision;
+  }
+  best_us_[kLlga] = std::numeric_limits<double>::max();
+  best_us_[kIpex] = std::numeric_limits<double>::max();
+}
+
+bool AutoPartitionKernel::inputsMatch(const Stack& inputs) const {
+  for (size_t i = 0; i < num_inputs_; i++) {
+    auto tensor_type = input_types_[i]->cast<TensorType>();
+    if (!tensor_type) {
+      continue;
+    }
+    if (!inputs[i].isTensor() ||
+        !tensor_type->matchTensor(inputs[i].toTensor())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AutoPartitionKernel::runAndMeasure(Stack& inputs) {
+  int choice;
+  int run_id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    choice = started_runs_[kLlga] <= started_runs_[kIpex] ? kLlga : kIpex;
+    run_id = started_runs_[choice]++;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  InterpreterState(code(choice)).run(inputs);
+  double us = std::chrono::duration<double, std::micro>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (run_id < kWarmupRuns || choice_ != kUndecided) {
+    return;
+  }
+  best_us_[choice] = std::min(best_us_[choice], us);
+  measured_runs_[choice]++;
+  if (measured_runs_[kLlga] >= kMeasureRuns &&
+      measured_runs_[kIpex] >= kMeasureRuns) {
+    int decision = best_us_[kLlga] <= best_us_[kIpex] ? kLlga : kIpex;
+    GRAPH_DEBUG(
+        "Auto partition ",
+        key_,
+        ": llga ",
+        best_us_[kLlga],
+        "us, ipex ",
+        best_us_[kIpex],
+        "us");
+    AutoPartitionDecisions::singleton().record(
+        key_, decision, best_us_[kLlga], best_us_[kIpex]);
+    choice_ = decision;
+  }
+}
+
+void AutoPartitionKernel::run(Stack& stack) {
+  auto input_refs = last(stack, num_inputs_);
+  Stack inputs(input_refs.begin(), input_refs.end());
+  drop(stack, num_inputs_);
+
+  if (!inputsMatch(inputs)) {
+    InterpreterState(ipex_code_).run(inputs);
+  } else if (choice_ == kUndecided) {
+    runAndMeasure(inputs);
+  } else {
+    InterpreterState(code(choice_)).run(inputs);
+  }
+
+  for (auto& output : inputs) {
+    stack.emplace_back(std::move(output));
+  }
+}
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
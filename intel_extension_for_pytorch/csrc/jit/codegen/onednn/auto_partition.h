@@ -0,0 +1,66 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+// Attributes of ipex::LlgaAutoPartitionGroup:
+//   llga: a graph holding the LLGA fusion group of the region alone
+//   ipex: the ops of the region optimized by IPEXFusionPass
+//   types: the profiled types of the inputs, the LLGA path is only taken
+//     when the inputs match them
+//   key: identifies the region in the persisted decisions
+static auto kLlgaGraphAttr = torch::jit::Symbol::attr("llga");
+static auto kIpexGraphAttr = torch::jit::Symbol::attr("ipex");
+static auto kAutoPartitionKeyAttr = torch::jit::Symbol::attr("key");
+
+// Replaces every non-quantized LLGA fusion group with an
+// ipex::LlgaAutoPartitionGroup, which holds both the LLGA partition and the
+// IPEX-fused ops of the same region and picks the faster one at runtime.
+void CreateAutoPartitionGroups(std::shared_ptr<torch::jit::Graph>& graph);
+
+// Loads the decisions persisted in path, later decisions are appended to it.
+void setAutoPartitionCacheFile(const std::string& path);
+
+class AutoPartitionKernel {
+ public:
+  explicit AutoPartitionKernel(const torch::jit::Node* node);
+
+  void run(torch::jit::Stack& stack);
+
+ private:
+  enum Choice { kUndecided = -1, kLlga = 0, kIpex = 1 };
+
+  bool inputsMatch(const torch::jit::Stack& inputs) const;
+
+  // Alternates between both paths during warm-up and keeps the faster one
+  // once each path has been measured kMeasureRuns times.
+  void runAndMeasure(torch::jit::Stack& inputs);
+
+  torch::jit::Code& code(int choice) {
+    return choice == kLlga ? llga_code_ : ipex_code_;
+  }
+
+  size_t num_inputs_;
+  std::vector<c10::TypePtr> input_types_;
+  std::string key_;
+  torch::jit::Code llga_code_;
+  torch::jit::Code ipex_code_;
+  std::atomic<int> choice_{kUndecided};
+  std::mutex mutex_;
+  int started_runs_[2] = {0, 0};
+  int measured_runs_[2] = {0, 0};
+  double best_us_[2];
+};
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
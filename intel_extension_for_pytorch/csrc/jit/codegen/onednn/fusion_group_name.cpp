@@ -15,6 +15,12 @@ const std::string& LlgaGuardName() {
   return LlgaGuardName;
 }
 
+const std::string& LlgaAutoPartitionGroupName() {
+  static const std::string LlgaAutoPartitionGroupName =
+      "ipex::LlgaAutoPartitionGroup";
+  return LlgaAutoPartitionGroupName;
+}
+
 } // namespace onednn
 } // namespace fuser
 } // namespace jit
@@ -14,6 +14,7 @@ namespace onednn {
 // Symbol::fromQualString(LlgaGuardName())
 extern const std::string& LlgaFusionGroupName();
 extern const std::string& LlgaGuardName();
+extern const std::string& LlgaAutoPartitionGroupName();
 
 } // namespace onednn
 } // namespace fuser
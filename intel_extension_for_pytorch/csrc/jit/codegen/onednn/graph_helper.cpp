@@ -492,6 +492,12 @@ bool shouldRewrite(dnnl::graph::partition partition) {
     return true;
   }
 
+  // auto partition times the fp32 and bf16 partitions against IPEX, so it
+  // needs the fusion groups to be created in the first place
+  if (is_llga_auto_partition_enabled()) {
+    return true;
+  }
+
   // check if the partition is quantization-related
   auto opIds = partition.get_ops();
   for (size_t opId : opIds) {
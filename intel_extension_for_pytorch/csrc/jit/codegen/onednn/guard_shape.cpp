@@ -1,10 +1,14 @@
 #include "guard_shape.h"
 #include "fusion_group_name.h"
+#include "interface.h"
 
+#include <ATen/core/grad_mode.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
 
+#include <unordered_set>
+
 namespace torch_ipex {
 namespace jit {
 namespace fuser {
@@ -113,6 +117,217 @@ void insertTypeGuardForFusionGroup(
   }
 }
 
+namespace {
+
+bool isContiguous(const TensorTypePtr& t) {
+  auto sizes = t->sizes().concrete_sizes();
+  auto strides = t->strides().concrete_sizes();
+  if (!sizes || !strides) {
+    return false;
+  }
+  int64_t expected = 1;
+  for (int64_t i = static_cast<int64_t>(sizes->size()) - 1; i >= 0; i--) {
+    if ((*sizes)[i] != 1 && (*strides)[i] != expected) {
+      return false;
+    }
+    expected *= (*sizes)[i];
+  }
+  return true;
+}
+
+// Only the rank of the intermediates and the outputs is kept, their shapes
+// are inferred by oneDNN Graph when the partition gets compiled.
+TensorTypePtr withUnknownDims(const TensorTypePtr& t) {
+  auto rank = *t->sizes().size();
+  return TensorType::create(
+      t->scalarType(),
+      t->device(),
+      c10::VaryingShape<int64_t>(rank),
+      c10::VaryingShape<int64_t>(rank),
+      t->requiresGrad());
+}
+
+// The batch dim of every input and the sequence dim of the [batch, seq,
+// hidden] activations of the NLP models are dynamic.
+TensorTypePtr withDynamicDims(const TensorTypePtr& t) {
+  auto concrete_sizes = t->sizes().concrete_sizes();
+  // The outputs of an upstream dynamic group reach the guard through its
+  // prim::If and only have their rank left
+  if (!concrete_sizes) {
+    return t->sizes().size() ? withUnknownDims(t) : t;
+  }
+  auto sizes = *concrete_sizes;
+  std::vector<c10::optional<int64_t>> dynamic_sizes(
+      sizes.begin(), sizes.end());
+  dynamic_sizes[0] = c10::nullopt;
+  if (sizes.size() == 3) {
+    dynamic_sizes[1] = c10::nullopt;
+  }
+  return TensorType::create(
+      t->scalarType(),
+      t->device(),
+      c10::VaryingShape<int64_t>(dynamic_sizes),
+      c10::VaryingShape<int64_t>(sizes.size()),
+      t->requiresGrad());
+}
+
+bool isFusionGroup(Node* node) {
+  return node->kind() == Symbol::fromQualString(LlgaFusionGroupName());
+}
+
+bool isGuardedInput(Value* input) {
+  return input->type()->cast<TensorType>() &&
+      input->node()->kind() != prim::Constant && !isFusionGroup(input->node());
+}
+
+// A fusion group can be compiled per input shape when its ops do not encode
+// the shapes in their arguments and all the guarded inputs are contiguous.
+// The inputs produced by other fusion groups are not guarded, the kernel
+// takes their shapes at run time.
+bool canUseDynamicShape(Node* fusion_group) {
+  static const std::unordered_set<Symbol> shape_ops = {
+      aten::view,
+      aten::reshape,
+      aten::expand,
+      aten::contiguous,
+  };
+  for (Node* node : fusion_group->g(attr::Subgraph)->nodes()) {
+    if (shape_ops.count(node->kind())) {
+      return false;
+    }
+  }
+  bool has_tensor_input = false;
+  for (Value* input : fusion_group->inputs()) {
+    if (input->type()->cast<TensorType>() && isFusionGroup(input->node())) {
+      has_tensor_input = true;
+    }
+    if (!isGuardedInput(input)) {
+      continue;
+    }
+    auto t = input->type()->expect<TensorType>();
+    auto rank = t->sizes().size();
+    if (!rank || *rank == 0 || !t->sizes().isComplete() || !isContiguous(t)) {
+      return false;
+    }
+    has_tensor_input = true;
+  }
+  return has_tensor_input;
+}
+
+bool hasStaticConsumer(
+    Node* fusion_group,
+    const std::unordered_set<Node*>& dynamic_groups) {
+  for (Value* output : fusion_group->outputs()) {
+    for (const Use& use : output->uses()) {
+      if (isFusionGroup(use.user) && !dynamic_groups.count(use.user)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// The guard of a fusion group does not check the outputs of the upstream
+// fusion groups. So a group is only compiled per input shape when all the
+// fusion groups consuming its outputs are too, otherwise a downstream group
+// compiled for the profiled shapes could be fed another shape.
+std::unordered_set<Node*> selectDynamicShapeGroups(
+    const std::vector<Node*>& fusion_groups) {
+  std::unordered_set<Node*> dynamic_groups;
+  for (Node* fusion_group : fusion_groups) {
+    if (canUseDynamicShape(fusion_group)) {
+      dynamic_groups.insert(fusion_group);
+    }
+  }
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = dynamic_groups.begin(); it != dynamic_groups.end();) {
+      if (hasStaticConsumer(*it, dynamic_groups)) {
+        it = dynamic_groups.erase(it);
+        changed = true;
+      } else {
+        ++it;
+      }
+    }
+  }
+  return dynamic_groups;
+}
+
+void collectFusionGroups(Block* block, std::vector<Node*>& fusion_groups) {
+  for (Node* n : block->nodes()) {
+    for (Block* b : n->blocks()) {
+      collectFusionGroups(b, fusion_groups);
+    }
+    if (isFusionGroup(n)) {
+      fusion_groups.push_back(n);
+    }
+  }
+}
+
+// Relaxes the types of the subgraph, so that the LLGA kernel compiles the
+// partition for each input shape instead of once for the profiled shapes.
+void useDynamicShape(Node* fusion_group) {
+  auto subgraph = fusion_group->g(attr::Subgraph);
+  for (size_t i = 0; i < fusion_group->inputs().size(); i++) {
+    Value* input = fusion_group->input(i);
+    if (isGuardedInput(input)) {
+      auto t = input->type()->expect<TensorType>();
+      subgraph->inputs()[i]->setType(withDynamicDims(t));
+    } else if (isFusionGroup(input->node())) {
+      // Outputs of the upstream fusion groups follow their input shapes
+      auto t = input->type()->cast<TensorType>();
+      if (t && t->sizes().size()) {
+        subgraph->inputs()[i]->setType(withUnknownDims(t));
+      }
+    }
+  }
+  for (Node* node : subgraph->nodes()) {
+    if (node->kind() == prim::Constant) {
+      continue;
+    }
+    for (Value* output : node->outputs()) {
+      auto t = output->type()->cast<TensorType>();
+      if (t && t->sizes().size()) {
+        output->setType(withUnknownDims(t));
+      }
+    }
+  }
+  for (Value* output : fusion_group->outputs()) {
+    auto t = output->type()->cast<TensorType>();
+    if (t && t->sizes().size()) {
+      output->setType(withUnknownDims(t));
+    }
+  }
+  GRAPH_DEBUG("Using dynamic shape for ", *fusion_group);
+}
+
+} // namespace
+
+bool matchDynamicShape(const TensorTypePtr& type, const at::Tensor& tensor) {
+  if (!tensor.defined() ||
+      type->scalarType().value_or(tensor.scalar_type()) !=
+          tensor.scalar_type() ||
+      type->device().value_or(tensor.device()) != tensor.device()) {
+    return false;
+  }
+  bool rg = at::GradMode::is_enabled() && tensor.requires_grad();
+  if (type->requiresGrad().value_or(rg) != rg) {
+    return false;
+  }
+  auto rank = type->sizes().size();
+  if (!rank || *rank != static_cast<size_t>(tensor.dim())) {
+    return false;
+  }
+  for (size_t i = 0; i < *rank; i++) {
+    auto size = type->sizes()[i];
+    if (size && *size != tensor.size(i)) {
+      return false;
+    }
+  }
+  return tensor.is_contiguous();
+}
+
 //! [ Note -- prepareFusionGroupAndGuardOutputs implementation ]
 //! shamelessly copying code from NNC (tensorexpr_fuser)  with very little
 //! modification, original code at:
@@ -122,12 +337,17 @@ void insertTypeGuardForFusionGroup(
 //! depending on the content of the tensor.
 void prepareFusionGroupAndGuardOutputs(Block* block) {
   std::vector<Node*> fusion_groups;
-  for (Node* n : block->nodes()) {
-    for (Block* b : n->blocks()) {
-      prepareFusionGroupAndGuardOutputs(b);
-    }
-    if (n->kind() == Symbol::fromQualString(LlgaFusionGroupName())) {
-      fusion_groups.push_back(n);
+  collectFusionGroups(block, fusion_groups);
+  std::unordered_set<Node*> dynamic_groups;
+  if (is_llga_dynamic_shape_enabled()) {
+    dynamic_groups = selectDynamicShapeGroups(fusion_groups);
+  }
+  // The subgraphs are relaxed before any guard gets inserted, the inputs fed
+  // by an upstream fusion group are only recognized as such until its outputs
+  // are routed through the prim::If of its guard.
+  for (Node* fusion_group : fusion_groups) {
+    if (dynamic_groups.count(fusion_group)) {
+      useDynamicShape(fusion_group);
     }
   }
   for (Node* fusion_group : fusion_groups) {
@@ -135,6 +355,13 @@ void prepareFusionGroupAndGuardOutputs(Block* block) {
     // refer to
     // `torch/csrc/jit/passes/tensorexpr_fuser.cpp:removeOutputsUsedOnlyInSize`
     // removeOutputsUsedOnlyInSize(fusion_group);
+    if (dynamic_groups.count(fusion_group)) {
+      insertTypeGuardForFusionGroup(
+          fusion_group,
+          [](const TensorTypePtr& t) { return withDynamicDims(t); },
+          Symbol::fromQualString(fuser::onednn::LlgaGuardName()));
+      continue;
+    }
     insertTypeGuardForFusionGroup(
         fusion_group,
         [](const TensorTypePtr& t) { return t; },
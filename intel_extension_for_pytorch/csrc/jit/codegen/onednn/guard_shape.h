@@ -9,6 +9,13 @@ namespace onednn {
 
 void prepareFusionGroupAndGuardOutputs(torch::jit::Block* block);
 
+// Checks a tensor against a guard type with dynamic dims: the rank, the
+// static dims, the dtype and the device must match and the tensor must be
+// contiguous.
+bool matchDynamicShape(
+    const c10::TensorTypePtr& type,
+    const at::Tensor& tensor);
+
 } // namespace onednn
 } // namespace fuser
 } // namespace jit
@@ -1,5 +1,6 @@
 #include "interface.h"
 #include <oneapi/dnnl/dnnl_graph.hpp>
+#include "auto_partition.h"
 #include "defer_size_check.h"
 #include "fusion_group_name.h"
 #include "graph_fuser.h"
@@ -31,6 +32,8 @@ namespace onednn {
 using namespace torch::jit;
 namespace {
 thread_local bool llga_fp32_bf16_enabled = false;
+thread_local bool llga_auto_partition_enabled = false;
+thread_local bool llga_dynamic_shape_enabled = false;
 }
 
 bool is_llga_fp32_bf16_enabled() {
@@ -40,6 +43,23 @@ void set_llga_fp32_bf16_enabled(bool new_enabled) {
   llga_fp32_bf16_enabled = new_enabled;
 }
 
+bool is_llga_auto_partition_enabled() {
+  return llga_auto_partition_enabled;
+}
+void set_llga_auto_partition_enabled(bool new_enabled) {
+  llga_auto_partition_enabled = new_enabled;
+}
+void set_llga_auto_partition_cache_file(const std::string& path) {
+  setAutoPartitionCacheFile(path);
+}
+
+bool is_llga_dynamic_shape_enabled() {
+  return llga_dynamic_shape_enabled;
+}
+void set_llga_dynamic_shape_enabled(bool new_enabled) {
+  llga_dynamic_shape_enabled = new_enabled;
+}
+
 void fuseGraph(std::shared_ptr<Graph>& g) {
   // Follow the process of the tensorexpr_fuser in profiling mode:
   // Remove prim::profile nodes and embed the profile info directly in the
@@ -84,7 +104,14 @@ void fuseGraph(std::shared_ptr<Graph>& g) {
     GRAPH_DUMP("After DeferSizeCheck. Before CreateLlgaSubgraphs", g);
     // CreateLlgaSubgraphs must be placed after all the preparation passes above
     CreateLlgaSubgraphs(g);
-    GRAPH_DUMP("After CreateLlgaSubgraphs. Before PropagateLayout", g);
+    GRAPH_DUMP(
+        "After CreateLlgaSubgraphs. Before CreateAutoPartitionGroups", g);
+    // CreateAutoPartitionGroups wraps the fusion groups, so the layout
+    // propagation and the guards below leave them alone
+    if (is_llga_auto_partition_enabled()) {
+      CreateAutoPartitionGroups(g);
+    }
+    GRAPH_DUMP("After CreateAutoPartitionGroups. Before PropagateLayout", g);
     // PropagateLayout must be placed after CreateLlgaSubgraphs
     PropagateLayout(g);
     GRAPH_DUMP(
@@ -134,6 +161,25 @@ torch::jit::RegisterOperators LLGAFusionGroupOp({
         AliasAnalysisKind::PURE_FUNCTION),
 });
 
+Operation createLlgaAutoPartitionKernel(const Node* node) {
+  auto kernel = std::make_shared<fuser::onednn::AutoPartitionKernel>(node);
+  return [kernel](Stack* stack) {
+    RECORD_FUNCTION(
+        fuser::onednn::LlgaAutoPartitionGroupName(),
+        c10::ArrayRef<c10::IValue>());
+
+    kernel->run(*stack);
+    return 0;
+  };
+}
+
+torch::jit::RegisterOperators LLGAAutoPartitionGroupOp({
+    torch::jit::Operator(
+        Symbol::fromQualString(fuser::onednn::LlgaAutoPartitionGroupName()),
+        createLlgaAutoPartitionKernel,
+        AliasAnalysisKind::PURE_FUNCTION),
+});
+
 Operation createLlgaGuardKernel(const Node* node) {
   return [node](Stack* stack) {
     RECORD_FUNCTION(
@@ -161,13 +207,20 @@ Operation createLlgaGuardKernel(const Node* node) {
       // If input tensor is of mkldnn, it's originated from an upstream
       // LLGA partition that has passed the check on input shapes.
       // It is valid to continue here as long as the output shapes from
-      // oneDNN graph partitions are determined by the input shapes.
+      // oneDNN graph partitions are determined by the input shapes. A
+      // partition compiled per input shape only feeds partitions compiled
+      // per input shape as well, see selectDynamicShapeGroups.
       if (tensor.is_mkldnn()) {
         GRAPH_DEBUG("input ", i, " is_mkldnn, continue");
         continue;
       }
 
-      if (!guard_tensor_type->matchTensor(tensor)) {
+      // Guards of the partitions compiled per input shape have dynamic dims
+      const auto& sizes = guard_tensor_type->sizes();
+      bool matched = sizes.isComplete() || !sizes.size()
+          ? guard_tensor_type->matchTensor(tensor)
+          : fuser::onednn::matchDynamicShape(guard_tensor_type, tensor);
+      if (!matched) {
         GRAPH_DEBUG("input ", i, " check failed, return false");
         push(stack, IValue(false));
         return;
@@ -18,6 +18,16 @@ bool is_llga_fp32_bf16_enabled();
 
 void set_llga_fp32_bf16_enabled(bool new_enabled);
 
+bool is_llga_auto_partition_enabled();
+
+void set_llga_auto_partition_enabled(bool new_enabled);
+
+void set_llga_auto_partition_cache_file(const std::string& path);
+
+bool is_llga_dynamic_shape_enabled();
+
+void set_llga_dynamic_shape_enabled(bool new_enabled);
+
 TORCH_API void fuseGraph(std::shared_ptr<torch::jit::Graph>& g);
 
 void setLlgaWeightCacheEnabled(bool enabled);
@@ -39,6 +39,12 @@ LlgaKernel::LlgaKernel(const Node* fusionNode)
       "LLGA subgraph should contain only one partition");
   partition_ = partitions[0];
   nPartitionInputs_ = partition_.get_in_ports().size();
+  for (auto* input : graph_->inputs()) {
+    auto tensorType = input->type()->cast<TensorType>();
+    if (tensorType && !tensorType->sizes().isComplete()) {
+      dynamicShape_ = true;
+    }
+  }
   GRAPH_DEBUG("Initialized ", debugName(), "\n", graph_->toString());
 }
 
@@ -158,12 +164,22 @@ ArgSpecs LlgaKernel::initializeOutputSpecs() const {
 std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
     const TensorArgs& inputs,
     TensorArgs& outputs) const {
+  return prepareRunArgs(
+      inputs, outputs, inputSpecs_, outputSpecs_, inplacePairs_);
+}
+
+std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
+    const TensorArgs& inputs,
+    TensorArgs& outputs,
+    const ArgSpecs& inputSpecs,
+    const ArgSpecs& outputSpecs,
+    const std::unordered_map<size_t, size_t>& inplacePairs) const {
   RECORD_FUNCTION(
       "LLGA_bridge::prepareRunArgs", c10::ArrayRef<c10::IValue>({}));
 
   RunArgs runInputs, runOutputs;
   for (size_t i = 0; i < runArgsIdx_.size(); i++) {
-    auto spec = inputSpecs_[i];
+    auto spec = inputSpecs[i];
     auto input = inputs[runArgsIdx_[i]];
     runInputs.push_back(
         {spec.logical_tensor(), Engine::getEngine(), input.data_ptr()});
@@ -171,7 +187,7 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
   for (size_t i = 0; i < constantInputs_.size(); i++) {
     // constantInputSpecs are placed after graphInputSpecs
     auto constantInputSpecIdx = nGraphInputs_ + i;
-    auto constantInputSpec = inputSpecs_[constantInputSpecIdx];
+    auto constantInputSpec = inputSpecs[constantInputSpecIdx];
     runInputs.push_back(
         {constantInputSpec.logical_tensor(),
          Engine::getEngine(),
@@ -179,12 +195,12 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
   }
 
   for (size_t i = 0; i < nOutputs_; i++) {
-    auto spec = outputSpecs_[i];
+    auto spec = outputSpecs[i];
     auto opt = c10::TensorOptions(spec.aten_scalar_type()).device(device_);
 
     auto outputId = spec.tid();
-    auto iter = inplacePairs_.find(outputId);
-    if (iter != inplacePairs_.end()) {
+    auto iter = inplacePairs.find(outputId);
+    if (iter != inplacePairs.end()) {
       // output reuses one of input tensors
 #ifdef GRAPH_DEBUG_ENABLED
       GRAPH_DEBUG("Inplace computation");
@@ -262,16 +278,25 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
 }
 
 compiled_partition LlgaKernel::compile(const partition& partition) {
-  auto inputs = fmap(inputSpecs_, toLogicalTensor);
-  auto outputs = fmap(outputSpecs_, toLogicalTensor);
+  return compile(partition, inputSpecs_, outputSpecs_, inplacePairs_);
+}
+
+compiled_partition LlgaKernel::compile(
+    const partition& partition,
+    const ArgSpecs& inputSpecs,
+    ArgSpecs& outputSpecs,
+    std::unordered_map<size_t, size_t>& inplacePairs) const {
+  auto inputs = fmap(inputSpecs, toLogicalTensor);
+  auto outputs = fmap(outputSpecs, toLogicalTensor);
   auto compilation = partition.compile(inputs, outputs, Engine::getEngine());
 
-  // Since layouts of opaque outputs would be known after compilation,
-  // we need to query them out from compilation and update outputSpecs
+  // Since layouts of opaque outputs and shapes of dynamic outputs would be
+  // known after compilation, we need to query them out from compilation and
+  // update outputSpecs
   for (size_t i = 0; i < nOutputs_; i++) {
-    auto tid = outputSpecs_[i].tid();
-    outputSpecs_[i] =
-        outputSpecs_[i].update_desc(compilation.query_logical_tensor(tid));
+    auto tid = outputSpecs[i].tid();
+    outputSpecs[i] =
+        outputSpecs[i].update_desc(compilation.query_logical_tensor(tid));
   }
 
   // Build static mapping from output id to input offset
@@ -280,12 +305,12 @@ compiled_partition LlgaKernel::compile(const partition& partition) {
     size_t inputId = option.first;
     size_t outputId = option.second;
     auto inputSpecIter =
-        std::find_if(inputSpecs_.begin(), inputSpecs_.end(), [&](auto& spec) {
+        std::find_if(inputSpecs.begin(), inputSpecs.end(), [&](auto& spec) {
           return spec.tid() == inputId;
         });
-    TORCH_CHECK(inputSpecIter != inputSpecs_.end(), "In-place input not found");
-    auto inputOffset = inputSpecIter - inputSpecs_.begin();
-    inplacePairs_[outputId] = inputOffset;
+    TORCH_CHECK(inputSpecIter != inputSpecs.end(), "In-place input not found");
+    auto inputOffset = inputSpecIter - inputSpecs.begin();
+    inplacePairs[outputId] = inputOffset;
   }
 
   return compilation;
@@ -303,6 +328,48 @@ dnnl::graph::compiled_partition& LlgaKernel::compileAndCache(
   return compilations_[i_thread];
 }
 
+std::shared_ptr<LlgaKernel::ShapeBucket> LlgaKernel::getShapeBucket(
+    const TensorArgs& inputs,
+    int n_thread) {
+  std::vector<int64_t> key{n_thread};
+  for (auto& input : inputs) {
+    key.push_back(input.dim());
+    key.insert(key.end(), input.sizes().begin(), input.sizes().end());
+  }
+  {
+    UniqueReadLock<ReadWriteMutex> lock(shapeBucketsMutex_);
+    auto it = shapeBuckets_.find(key);
+    if (it != shapeBuckets_.end()) {
+      return it->second;
+    }
+  }
+
+#ifdef GRAPH_DEBUG_ENABLED
+  GRAPH_DEBUG("Compiling partition for a new input shape");
+#endif
+  // The constant inputs keep the specs initialized with the first inputs
+  auto bucket = std::make_shared<ShapeBucket>();
+  bucket->inputSpecs = inputSpecs_;
+  for (size_t i = 0; i < runArgsIdx_.size(); i++) {
+    auto offset = runArgsIdx_[i];
+    bucket->inputSpecs[i] = ArgSpec(graph_->inputs()[offset])
+                                .supplementTensorInfo(inputs[offset]);
+  }
+  bucket->outputSpecs = initializeOutputSpecs();
+  bucket->compilation = compile(
+      partition_,
+      bucket->inputSpecs,
+      bucket->outputSpecs,
+      bucket->inplacePairs);
+
+  // Shapes beyond the limit are compiled at every run
+  UniqueWriteLock<ReadWriteMutex> lock(shapeBucketsMutex_);
+  if (shapeBuckets_.size() < MAX_SHAPE_BUCKETS) {
+    shapeBuckets_.emplace(key, bucket);
+  }
+  return bucket;
+}
+
 void LlgaKernel::run(Stack& stack) {
   GRAPH_DEBUG("In ", debugName(), "\n");
 
@@ -334,7 +401,19 @@ void LlgaKernel::run(Stack& stack) {
   dnnl::graph::compiled_partition compilation;
 
   int n_thread = omp_get_max_threads();
-  if (n_thread > 0 && n_thread <= MAX_COMPILATION_CACHE_SIZE) {
+  if (dynamicShape_) {
+#ifdef GRAPH_DEBUG_ENABLED
+    GRAPH_DEBUG("Compilation of the input shape");
+#endif
+    auto bucket = getShapeBucket(inputs, n_thread);
+    compilation = bucket->compilation;
+    std::tie(runInputs, runOutputs) = prepareRunArgs(
+        inputs,
+        outputs,
+        bucket->inputSpecs,
+        bucket->outputSpecs,
+        bucket->inplacePairs);
+  } else if (n_thread > 0 && n_thread <= MAX_COMPILATION_CACHE_SIZE) {
 #ifdef GRAPH_DEBUG_ENABLED
     GRAPH_DEBUG("Cached compilation");
 #endif
@@ -345,10 +424,12 @@ void LlgaKernel::run(Stack& stack) {
 #endif
     compilation = compile(partition_);
   }
+  if (!dynamicShape_) {
 #ifdef GRAPH_DEBUG_ENABLED
-  GRAPH_DEBUG("Preparing runtime tensors");
+    GRAPH_DEBUG("Preparing runtime tensors");
 #endif
-  std::tie(runInputs, runOutputs) = prepareRunArgs(inputs, outputs);
+    std::tie(runInputs, runOutputs) = prepareRunArgs(inputs, outputs);
+  }
 #ifdef GRAPH_DEBUG_ENABLED
   GRAPH_DEBUG("Executing partition");
 #endif
@@ -22,6 +22,7 @@ using RunArgs = std::vector<RunArg>;
 using TensorArgs = std::vector<at::Tensor>;
 
 constexpr int MAX_COMPILATION_CACHE_SIZE = 1024;
+constexpr size_t MAX_SHAPE_BUCKETS = 64;
 
 class LlgaKernel {
  public:
@@ -66,10 +67,36 @@ class LlgaKernel {
       const dnnl::graph::partition& partition,
       int n_thread);
 
+  dnnl::graph::compiled_partition compile(
+      const dnnl::graph::partition& partition,
+      const ArgSpecs& inputSpecs,
+      ArgSpecs& outputSpecs,
+      std::unordered_map<size_t, size_t>& inplacePairs) const;
+
   std::tuple<RunArgs, RunArgs> prepareRunArgs(
       const TensorArgs& inputs,
       TensorArgs& outputs) const;
 
+  std::tuple<RunArgs, RunArgs> prepareRunArgs(
+      const TensorArgs& inputs,
+      TensorArgs& outputs,
+      const ArgSpecs& inputSpecs,
+      const ArgSpecs& outputSpecs,
+      const std::unordered_map<size_t, size_t>& inplacePairs) const;
+
+  // The partition compiled for one set of input shapes, used when the
+  // inputs of the partition have dynamic dims.
+  struct ShapeBucket {
+    ArgSpecs inputSpecs;
+    ArgSpecs outputSpecs;
+    std::unordered_map<size_t, size_t> inplacePairs;
+    dnnl::graph::compiled_partition compilation;
+  };
+
+  std::shared_ptr<ShapeBucket> getShapeBucket(
+      const TensorArgs& inputs,
+      int n_thread);
+
   static std::string genDebugName() {
     static size_t debugId = 0;
     return "LlgaPartition_" + std::to_string(debugId++);
@@ -113,6 +140,11 @@ class LlgaKernel {
   std::unordered_map<size_t, size_t> inplacePairs_; // output id -> input offset
   std::string debugName_;
   std::string profileName_;
+  // The partition is compiled per input shape instead of once for the
+  // profiled shapes
+  bool dynamicShape_ = false;
+  std::map<std::vector<int64_t>, std::shared_ptr<ShapeBucket>> shapeBuckets_;
+  ReadWriteMutex shapeBucketsMutex_;
   std::once_flag spec_initialized_flag_;
   std::vector<std::once_flag> compilation_initialized_flags_ =
       std::vector<std::once_flag>(MAX_COMPILATION_CACHE_SIZE);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+struct ContextGroupedLinear final {
+  // weights of the grouped layers transposed to [in_features, out_features],
+  // so the GEMMs read them row by row without transpose
+  std::vector<at::Tensor> packed_weights_;
+  // biases of the grouped layers, zeros for a layer without bias
+  std::vector<at::Tensor> biases_;
+
+  ContextGroupedLinear() = delete;
+
+  ContextGroupedLinear(
+      std::vector<at::Tensor>&& packed_weights,
+      std::vector<at::Tensor>&& biases)
+      : packed_weights_(std::move(packed_weights)),
+        biases_(std::move(biases)) {}
+
+  ContextGroupedLinear(ContextGroupedLinear&&) = default;
+  ContextGroupedLinear& operator=(ContextGroupedLinear&&) = default;
+
+  ~ContextGroupedLinear() {}
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
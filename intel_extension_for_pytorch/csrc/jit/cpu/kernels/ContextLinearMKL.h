@@ -4,14 +4,31 @@
 
 #include "csrc/cpu/ideep/ideep.hpp"
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
 namespace torch_ipex {
 namespace cpu {
 namespace detail {
+// The weight packed for the power of two batch sizes, keyed by the batch size
+// they are packed for. The buckets in packing are being packed in the
+// background.
+struct MKLPackedWeightCache {
+  std::mutex mutex;
+  std::map<int64_t, at::Tensor> weights;
+  std::set<int64_t> packing;
+};
+
 struct ContextLinearMKL final {
   std::vector<int64_t> sgemm_sizes_ = {0, 0, 0};
+  // packed for sgemm_sizes_[0], the batch size the context is created for
   at::Tensor mkl_weight_;
   at::Tensor ori_weight_;
   c10::optional<at::Tensor> bias_;
+  std::shared_ptr<MKLPackedWeightCache> packed_cache_ =
+      std::make_shared<MKLPackedWeightCache>();
 
   ContextLinearMKL() = delete;
 
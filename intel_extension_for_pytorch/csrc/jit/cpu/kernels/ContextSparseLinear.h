@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include "csrc/aten/cpu/SparseLinear.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+struct ContextSparseLinear final {
+  // the weight compressed to the block CSR or 2:4 layout
+  SparseLinearWeight weight_;
+  c10::optional<at::Tensor> bias_;
+
+  ContextSparseLinear() = delete;
+
+  ContextSparseLinear(
+      SparseLinearWeight&& weight,
+      c10::optional<at::Tensor>&& bias)
+      : weight_(std::move(weight)), bias_(std::move(bias)) {}
+
+  ContextSparseLinear(ContextSparseLinear&&) = default;
+  ContextSparseLinear& operator=(ContextSparseLinear&&) = default;
+
+  ~ContextSparseLinear() {}
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include "csrc/aten/cpu/WoqLinear.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+struct ContextWoqLinear final {
+  // the weight quantized to int8 or int4 with its scales
+  WoqLinearWeight weight_;
+  // FP32 whatever the activation dtype
+  c10::optional<at::Tensor> bias_;
+
+  ContextWoqLinear() = delete;
+
+  ContextWoqLinear(WoqLinearWeight&& weight, c10::optional<at::Tensor>&& bias)
+      : weight_(std::move(weight)), bias_(std::move(bias)) {}
+
+  ContextWoqLinear(ContextWoqLinear&&) = default;
+  ContextWoqLinear& operator=(ContextWoqLinear&&) = default;
+
+  ~ContextWoqLinear() {}
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,6 +1,9 @@
 #include "ConvPacked.h"
 #include <dnnl.hpp>
+#include "PackedWeightFormat.h"
+#include "WeightSharing.h"
 #include "csrc/aten/cpu/Conv.h"
+#include "csrc/aten/cpu/GroupNorm.h"
 #include "csrc/aten/cpu/ParamUtils.h"
 #include "csrc/aten/cpu/WeightPack.h"
 #include "csrc/aten/cpu/utils/utils.h"
@@ -13,14 +16,24 @@ namespace cpu {
 namespace detail {
 namespace convolution {
 
-#define DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN(FUSED_OP)               \
-  at::Tensor convolution_##FUSED_OP##_run(                           \
-      const at::Tensor& input,                                       \
-      const c10::intrusive_ptr<ConvolutionOpContext>& op_context) {  \
-    RECORD_FUNCTION(                                                 \
-        "ipex_prepack::convolution_" #FUSED_OP "_run",               \
-        c10::ArrayRef<c10::IValue>({}));                             \
-    return op_context->run(input, ideep::attr_t::fuse_##FUSED_OP()); \
+#define DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN(FUSED_OP)                \
+  at::Tensor convolution_##FUSED_OP##_run(                            \
+      const at::Tensor& input,                                        \
+      const c10::intrusive_ptr<ConvolutionOpContext>& op_context) {   \
+    RECORD_FUNCTION(                                                  \
+        "ipex_prepack::convolution_" #FUSED_OP "_run",                \
+        c10::ArrayRef<c10::IValue>({}));                              \
+    return op_context->run(input, ideep::attr_t::fuse_##FUSED_OP());  \
+  }                                                                   \
+  at::Tensor convolution_##FUSED_OP##_run_out(                        \
+      const at::Tensor& input,                                        \
+      at::Tensor& output,                                             \
+      const c10::intrusive_ptr<ConvolutionOpContext>& op_context) {   \
+    RECORD_FUNCTION(                                                  \
+        "ipex_prepack::convolution_" #FUSED_OP "_run_out",            \
+        c10::ArrayRef<c10::IValue>({}));                              \
+    return convolution_run_out_impl(                                  \
+        input, output, op_context, ideep::attr_t::fuse_##FUSED_OP()); \
   }
 
 // follow check rules from
@@ -168,6 +181,62 @@ c10::intrusive_ptr<ConvolutionOpContext> createConvolutionPrePackOpContext(
       ideep::attr_t());
 }
 
+// The input and the output are channels last as soon as either the input or
+// the weight is.
+static at::MemoryFormat run_memory_format(
+    const ContextConvolution& context,
+    const at::Tensor& input) {
+  bool use_channels_last =
+      input.suggest_memory_format() == at::MemoryFormat::ChannelsLast ||
+      input.suggest_memory_format() == at::MemoryFormat::ChannelsLast3d ||
+      context.weight_is_channels_last_;
+  if (use_channels_last) {
+    if (input.dim() == 4) {
+      return at::MemoryFormat::ChannelsLast;
+    } else if (input.dim() == 5) {
+      return at::MemoryFormat::ChannelsLast3d;
+    }
+  }
+  return at::MemoryFormat::Contiguous;
+}
+
+// The output is planned by StaticMemoryPlanning for the profiled input shape
+// and shares the arena with the other planned tensors, so it can neither be
+// resized nor be replaced by a new tensor. run() converts an output which is
+// not in its memory format, which would leave the planned one unwritten.
+static at::Tensor convolution_run_out_impl(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context,
+    const ideep::attr_t& attr) {
+  const auto& context = op_context->get_context();
+  auto output_size = calc_conv_output_size(
+      input.sizes(),
+      context.weight_packed_.get_dims(),
+      context.padding_,
+      context.stride_,
+      context.dilation_);
+  TORCH_CHECK(
+      output.sizes() == at::IntArrayRef(output_size) &&
+          output.scalar_type() == input.scalar_type(),
+      "convolution run_out: expected a ",
+      input.scalar_type(),
+      " output of size ",
+      at::IntArrayRef(output_size),
+      " but got ",
+      output.scalar_type(),
+      " of size ",
+      output.sizes(),
+      ", the static memory plan only supports the profiled input shapes");
+  auto memory_format = run_memory_format(context, input);
+  TORCH_CHECK(
+      input.dim() == 3 ? is_channels_last_1d(output)
+                       : output.is_contiguous(memory_format),
+      "convolution run_out: the output is not in the memory format of the "
+      "convolution");
+  return op_context->run(input, output, attr);
+}
+
 at::Tensor convolution_run(
     const at::Tensor& input,
     const c10::intrusive_ptr<ConvolutionOpContext>& op_context) {
@@ -176,6 +245,16 @@ at::Tensor convolution_run(
   return op_context->run(input, ideep::attr_t());
 }
 
+at::Tensor convolution_run_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::convolution_run_out", c10::ArrayRef<c10::IValue>({}));
+
+  return convolution_run_out_impl(input, output, op_context, ideep::attr_t());
+}
+
 DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN(relu);
 DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN(sigmoid);
 DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN(swish);
@@ -264,6 +343,61 @@ at::Tensor convolution_gelu_run(
       input, ideep::attr_t::fuse_gelu(1.0, 0.f, 0.f, gelu_type));
 }
 
+// The conv output of a batch tile of at most this size is still in the caches
+// when its GroupNorm statistics are computed and it gets normalized.
+constexpr int64_t kGroupNormSiluTileBytes = 2 * 1024 * 1024;
+
+at::Tensor convolution_group_norm_silu_run(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight,
+    const c10::optional<at::Tensor>& bias,
+    double eps,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::convolution_group_norm_silu_run",
+      c10::ArrayRef<c10::IValue>({}));
+  const auto& context = op_context->get_context();
+  auto output_size = calc_conv_output_size(
+      input.sizes(),
+      context.weight_packed_.get_dims(),
+      context.padding_,
+      context.stride_,
+      context.dilation_);
+  int64_t sample_bytes = input.element_size();
+  for (size_t d = 1; d < output_size.size(); d++) {
+    sample_bytes *= output_size[d];
+  }
+  const int64_t batch = input.size(0);
+  const int64_t tile = std::max<int64_t>(
+      1, kGroupNormSiluTileBytes / std::max<int64_t>(sample_bytes, 1));
+
+  // the convolution output is not visible outside of the fused op, it is
+  // normalized in place
+  if (input.dim() == 3 || tile >= batch) {
+    auto output = op_context->run(input, ideep::attr_t());
+    return group_norm_silu_(output, num_groups, weight, bias, eps);
+  }
+
+  // The statistics of a sample only depend on its own groups, so each batch
+  // tile is normalized right after the convolution writes it, instead of
+  // reading the whole activation back twice.
+  auto output = at::empty(
+      output_size,
+      input.options().memory_format(run_memory_format(context, input)));
+  for (int64_t n = 0; n < batch; n += tile) {
+    auto rows = std::min(tile, batch - n);
+    auto output_tile = output.narrow(0, n, rows);
+    op_context->run(input.narrow(0, n, rows), output_tile, ideep::attr_t());
+    auto normalized =
+        group_norm_silu_(output_tile, num_groups, weight, bias, eps);
+    if (!normalized.is_same(output_tile)) {
+      output_tile.copy_(normalized);
+    }
+  }
+  return output;
+}
+
 at::Tensor convolution_add_run(
     const at::Tensor& input,
     at::Tensor& accumu,
@@ -446,7 +580,7 @@ at::Tensor convolution_bottleneck_run(
 }
 
 ContextConvolution create(
-    const at::Tensor& weight,
+    const at::Tensor& weight_or_packed,
     const c10::optional<at::Tensor>& bias,
     const at::IntArrayRef stride,
     const at::IntArrayRef padding,
@@ -455,6 +589,14 @@ ContextConvolution create(
     const bool weight_is_channels_last,
     const std::vector<int64_t>& input_size_,
     const ideep::attr_t& attr) {
+  // A serialized packed weight only provides the shape of the public weight
+  // here, its data gets adopted by the packed weight below
+  c10::optional<SerializedPackedWeight> serialized;
+  if (is_serialized_packed_weight(weight_or_packed)) {
+    serialized.emplace(weight_or_packed);
+  }
+  const auto weight =
+      serialized ? serialized->public_weight_like() : weight_or_packed;
   auto input_size = input_size_.empty()
       ? gen_dummy_input_size_for(weight.sizes(), groups)
       : input_size_;
@@ -557,15 +699,25 @@ ContextConvolution create(
   ideep::data_type dtype = w.get_data_type();
   auto expected_desc =
       ideep::tensor::desc(conv_params.pd.weights_desc(), groups);
-  auto at_weight = empty_aten_tensor_from_desc(expected_desc, weight.options());
+  at::Tensor at_weight;
   ideep::tensor packed_weight;
-  if (ideep::data_type::f32 == dtype) {
-    packed_weight.init(expected_desc, at_weight.template data_ptr<float>());
+  if (serialized) {
+    std::tie(packed_weight, at_weight) =
+        serialized->pack(expected_desc, weight.options());
   } else {
-    packed_weight.init(
-        expected_desc, at_weight.template data_ptr<c10::BFloat16>());
+    at_weight = empty_aten_tensor_from_desc(expected_desc, weight.options());
+    if (ideep::data_type::f32 == dtype) {
+      packed_weight.init(expected_desc, at_weight.template data_ptr<float>());
+    } else {
+      packed_weight.init(
+          expected_desc, at_weight.template data_ptr<c10::BFloat16>());
+    }
+    packed_weight.feed_from(w);
+  }
+  if (is_weight_sharing_enabled()) {
+    at_weight = share_weight(at_weight);
+    packed_weight.init(expected_desc, at_weight.data_ptr());
   }
-  packed_weight.feed_from(w);
 
   return ContextConvolution{
       std::move(ori_desc),
@@ -586,18 +738,7 @@ at::Tensor run(
     const ContextConvolution& context,
     const at::Tensor& input,
     const ideep::attr_t& attr) {
-  bool use_channels_last =
-      input.suggest_memory_format() == at::MemoryFormat::ChannelsLast ||
-      input.suggest_memory_format() == at::MemoryFormat::ChannelsLast3d ||
-      context.weight_is_channels_last_;
-  auto memory_format = at::MemoryFormat::Contiguous;
-  if (use_channels_last) {
-    if (input.dim() == 4) {
-      memory_format = at::MemoryFormat::ChannelsLast;
-    } else if (input.dim() == 5) {
-      memory_format = at::MemoryFormat::ChannelsLast3d;
-    }
-  }
+  auto memory_format = run_memory_format(context, input);
   auto input_ = input;
   if (!is_channels_last_1d(input)) {
     input_ = input.contiguous(memory_format);
@@ -662,19 +803,7 @@ at::Tensor& run(
     const at::Tensor& input,
     at::Tensor& accumu,
     const ideep::attr_t& attr) {
-  bool use_channels_last =
-      input.suggest_memory_format() == at::MemoryFormat::ChannelsLast ||
-      input.suggest_memory_format() == at::MemoryFormat::ChannelsLast3d ||
-      context.weight_is_channels_last_;
-
-  auto memory_format = at::MemoryFormat::Contiguous;
-  if (use_channels_last) {
-    if (input.dim() == 4) {
-      memory_format = at::MemoryFormat::ChannelsLast;
-    } else if (input.dim() == 5) {
-      memory_format = at::MemoryFormat::ChannelsLast3d;
-    }
-  }
+  auto memory_format = run_memory_format(context, input);
   auto input_ = input;
   if (!is_channels_last_1d(input)) {
     input_ = input.contiguous(memory_format);
@@ -11,9 +11,13 @@ namespace cpu {
 namespace detail {
 namespace convolution {
 
-#define DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(FUSED_OP) \
-  at::Tensor convolution_##FUSED_OP##_run(              \
-      const at::Tensor& input,                          \
+#define DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(FUSED_OP)            \
+  at::Tensor convolution_##FUSED_OP##_run(                         \
+      const at::Tensor& input,                                     \
+      const c10::intrusive_ptr<ConvolutionOpContext>& op_context); \
+  at::Tensor convolution_##FUSED_OP##_run_out(                     \
+      const at::Tensor& input,                                     \
+      at::Tensor& output,                                          \
       const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
 
 static void check_shape_forward(
@@ -39,6 +43,14 @@ at::Tensor convolution_run(
     const at::Tensor& input,
     const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
 
+// Same as convolution_run but writes the result into the preallocated output,
+// which is used by the static memory planner. Falls back to allocating a new
+// output if the planned one does not match the actual output shape.
+at::Tensor convolution_run_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
+
 DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(relu);
 DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(sigmoid);
 DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(swish);
@@ -81,6 +93,19 @@ at::Tensor convolution_gelu_run(
     c10::string_view approximate,
     const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
 
+// Convolution followed by GroupNorm and SiLU. The convolution runs per batch
+// tile and the GroupNorm statistics and the normalization of a tile are
+// computed in place right after it is written, while it is still in the
+// caches. The tiles hold one sample at least, a larger sample is read back from
+// memory, which only saves the second activation.
+at::Tensor convolution_group_norm_silu_run(
+    const at::Tensor& input,
+    int64_t num_groups,
+    const c10::optional<at::Tensor>& weight,
+    const c10::optional<at::Tensor>& bias,
+    double eps,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
+
 at::Tensor convolution_add_run(
     const at::Tensor& input,
     at::Tensor& accumu,
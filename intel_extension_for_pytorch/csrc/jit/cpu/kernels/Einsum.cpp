@@ -1,3 +1,4 @@
+#include "Einsum.h"
 #include "Matmul.h"
 
 #include <ATen/Context.h>
@@ -7,7 +8,11 @@
 #include <c10/util/Logging.h>
 #include <torch/csrc/autograd/function.h>
 
+#include <bitset>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "csrc/cpu/ideep/IDeepConversions.h"
 #include "csrc/cpu/ideep/ideep.hpp"
@@ -787,5 +792,480 @@ at::Tensor einsum_binary(
   return result;
 }
 
+namespace {
+
+constexpr uint8_t kEinsumNumLabels = 52;
+// the contraction order is searched exhaustively up to this many operands
+// and greedily above
+constexpr size_t kEinsumOptimalMaxOperands = 5;
+constexpr size_t kEinsumPlanCacheSize = 1024;
+
+using EinsumLabelSet = std::bitset<kEinsumNumLabels>;
+
+// Contracts the operands at positions lhs < rhs of the working list, which
+// are removed from it, and appends the result whose labels are kept.
+struct EinsumStep {
+  size_t lhs;
+  size_t rhs;
+  EinsumLabelSet kept;
+};
+
+struct EinsumPlan {
+  std::vector<std::vector<uint8_t>> operand_labels;
+  std::vector<uint8_t> output_labels;
+  std::vector<EinsumStep> steps;
+};
+
+// Parses the labels of the operands and of the output. Returns false for the
+// equations the planner does not handle: ellipses, labels repeated within an
+// operand and all the invalid ones, which are left to at::einsum.
+bool einsum_parse(
+    c10::string_view equation,
+    const c10::List<at::Tensor>& operands,
+    EinsumPlan& plan) {
+  const auto arrow_pos = equation.find("->");
+  const auto lhs = equation.substr(0, arrow_pos);
+  plan.operand_labels.assign(1, {});
+  std::vector<int64_t> label_count(kEinsumNumLabels, 0);
+  for (const unsigned char label : lhs) {
+    if (label == ' ') {
+      continue;
+    }
+    if (label == ',') {
+      plan.operand_labels.emplace_back();
+      continue;
+    }
+    if (!einsum_check_label(label)) {
+      return false;
+    }
+    auto& labels = plan.operand_labels.back();
+    const auto index = einsum_label_to_index(label);
+    if (std::find(labels.begin(), labels.end(), index) != labels.end()) {
+      return false;
+    }
+    labels.push_back(index);
+    label_count[index]++;
+  }
+  if (plan.operand_labels.size() != operands.size()) {
+    return false;
+  }
+  for (const auto i : c10::irange(operands.size())) {
+    if (static_cast<int64_t>(plan.operand_labels[i].size()) !=
+        operands.get(i).dim()) {
+      return false;
+    }
+  }
+
+  plan.output_labels.clear();
+  if (arrow_pos == c10::string_view::npos) {
+    // implicit output: the labels seen once, in alphabetical order
+    for (const auto index : c10::irange(kEinsumNumLabels)) {
+      if (label_count[index] == 1) {
+        plan.output_labels.push_back(index);
+      }
+    }
+    return true;
+  }
+  for (const unsigned char label : equation.substr(arrow_pos + 2)) {
+    if (label == ' ') {
+      continue;
+    }
+    if (!einsum_check_label(label)) {
+      return false;
+    }
+    const auto index = einsum_label_to_index(label);
+    if (label_count[index] == 0 ||
+        std::find(
+            plan.output_labels.begin(), plan.output_labels.end(), index) !=
+            plan.output_labels.end()) {
+      return false;
+    }
+    plan.output_labels.push_back(index);
+  }
+  return true;
+}
+
+double einsum_set_size(
+    const EinsumLabelSet& labels,
+    const std::vector<int64_t>& label_size) {
+  double size = 1;
+  for (const auto index : c10::irange(kEinsumNumLabels)) {
+    if (labels[index]) {
+      size *= label_size[index];
+    }
+  }
+  return size;
+}
+
+// The labels of the contraction of operands i and j which are still needed
+// by the other operands or the output
+EinsumLabelSet einsum_kept_labels(
+    const std::vector<EinsumLabelSet>& operands,
+    const EinsumLabelSet& output,
+    size_t i,
+    size_t j) {
+  EinsumLabelSet needed = output;
+  for (const auto k : c10::irange(operands.size())) {
+    if (k != i && k != j) {
+      needed |= operands[k];
+    }
+  }
+  return (operands[i] | operands[j]) & needed;
+}
+
+std::vector<EinsumLabelSet> einsum_after_step(
+    const std::vector<EinsumLabelSet>& operands,
+    const EinsumStep& step) {
+  std::vector<EinsumLabelSet> result;
+  for (const auto k : c10::irange(operands.size())) {
+    if (k != step.lhs && k != step.rhs) {
+      result.push_back(operands[k]);
+    }
+  }
+  result.push_back(step.kept);
+  return result;
+}
+
+// The cost of a contraction is the number of multiply-adds, the size of the
+// union of the labels of both operands. All the orders are tried, the
+// branches already more expensive than the best order found are pruned.
+void einsum_search_optimal(
+    const std::vector<EinsumLabelSet>& operands,
+    const EinsumLabelSet& output,
+    const std::vector<int64_t>& label_size,
+    double cost,
+    std::vector<EinsumStep>& steps,
+    double& best_cost,
+    std::vector<EinsumStep>& best_steps) {
+  if (cost >= best_cost) {
+    return;
+  }
+  if (operands.size() == 1) {
+    best_cost = cost;
+    best_steps = steps;
+    return;
+  }
+  for (const auto i : c10::irange(operands.size())) {
+    for (const auto j : c10::irange(i + 1, operands.size())) {
+      EinsumStep step{i, j, einsum_kept_labels(operands, output, i, j)};
+      steps.push_back(step);
+      einsum_search_optimal(
+          einsum_after_step(operands, step),
+          output,
+          label_size,
+          cost + einsum_set_size(operands[i] | operands[j], label_size),
+          steps,
+          best_cost,
+          best_steps);
+      steps.pop_back();
+    }
+  }
+}
+
+// Contracts the pair which reduces the total size of the operands the most,
+// pairs without a common label (outer products) only when there is no other
+// choice. Ties are broken by the cost of the contraction.
+std::vector<EinsumStep> einsum_search_greedy(
+    std::vector<EinsumLabelSet> operands,
+    const EinsumLabelSet& output,
+    const std::vector<int64_t>& label_size) {
+  std::vector<EinsumStep> steps;
+  while (operands.size() > 1) {
+    EinsumStep best{0, 1, EinsumLabelSet()};
+    bool best_shares = false;
+    double best_gain = 0;
+    double best_cost = 0;
+    bool found = false;
+    for (const auto i : c10::irange(operands.size())) {
+      for (const auto j : c10::irange(i + 1, operands.size())) {
+        const bool shares = (operands[i] & operands[j]).any();
+        const auto kept = einsum_kept_labels(operands, output, i, j);
+        const double gain = einsum_set_size(kept, label_size) -
+            einsum_set_size(operands[i], label_size) -
+            einsum_set_size(operands[j], label_size);
+        const double cost =
+            einsum_set_size(operands[i] | operands[j], label_size);
+        const bool better = !found || (shares && !best_shares) ||
+            (shares == best_shares &&
+             (gain < best_gain || (gain == best_gain && cost < best_cost)));
+        if (better) {
+          best = EinsumStep{i, j, kept};
+          best_shares = shares;
+          best_gain = gain;
+          best_cost = cost;
+          found = true;
+        }
+      }
+    }
+    steps.push_back(best);
+    operands = einsum_after_step(operands, best);
+  }
+  return steps;
+}
+
+// Returns nullptr for the equations and shapes left to at::einsum
+std::shared_ptr<const EinsumPlan> einsum_make_plan(
+    c10::string_view equation,
+    const c10::List<at::Tensor>& operands) {
+  auto plan = std::make_shared<EinsumPlan>();
+  if (!einsum_parse(equation, operands, *plan)) {
+    return nullptr;
+  }
+  // a label has the same size in all the operands, broadcasting is left to
+  // at::einsum
+  std::vector<int64_t> label_size(kEinsumNumLabels, -1);
+  std::vector<EinsumLabelSet> label_sets;
+  for (const auto i : c10::irange(operands.size())) {
+    const auto& labels = plan->operand_labels[i];
+    const auto operand = operands.get(i);
+    EinsumLabelSet label_set;
+    for (const auto d : c10::irange(labels.size())) {
+      auto& size = label_size[labels[d]];
+      if (operand.size(d) == 0 || (size != -1 && size != operand.size(d))) {
+        return nullptr;
+      }
+      size = operand.size(d);
+      label_set.set(labels[d]);
+    }
+    label_sets.push_back(label_set);
+  }
+  EinsumLabelSet output;
+  for (const auto label : plan->output_labels) {
+    output.set(label);
+  }
+
+  if (label_sets.size() <= kEinsumOptimalMaxOperands) {
+    std::vector<EinsumStep> steps;
+    double best_cost = std::numeric_limits<double>::infinity();
+    einsum_search_optimal(
+        label_sets, output, label_size, 0, steps, best_cost, plan->steps);
+  } else {
+    plan->steps = einsum_search_greedy(label_sets, output, label_size);
+  }
+  return plan;
+}
+
+// Plans keyed by the equation and the shapes of the operands
+std::shared_ptr<const EinsumPlan> einsum_get_plan(
+    c10::string_view equation,
+    const c10::List<at::Tensor>& operands) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::shared_ptr<const EinsumPlan>>
+      cache;
+  std::string key(equation.data(), equation.size());
+  for (const auto i : c10::irange(operands.size())) {
+    key += ';';
+    for (const auto size : operands.get(i).sizes()) {
+      key += std::to_string(size) + ',';
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      return it->second;
+    }
+  }
+  auto plan = einsum_make_plan(equation, operands);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (cache.size() >= kEinsumPlanCacheSize) {
+    cache.clear();
+  }
+  cache.emplace(std::move(key), plan);
+  return plan;
+}
+
+// Orders the dims of the tensor from the outermost to the innermost one in
+// memory, so that the dims of a group stay mergeable into a view
+void einsum_order_by_stride(const Tensor& tensor, std::vector<int64_t>& dims) {
+  std::stable_sort(dims.begin(), dims.end(), [&](int64_t a, int64_t b) {
+    return tensor.stride(a) > tensor.stride(b);
+  });
+}
+
+Tensor einsum_bmm(const Tensor& left, const Tensor& right) {
+  const auto st = left.scalar_type();
+  if ((st == at::kFloat || st == at::kBFloat16) &&
+      right.scalar_type() == st) {
+    // strided matrices, including transposed ones, are read in place
+    return bmm_impl(left, right, at::Tensor(), ideep::attr_t(), {}, 1.0f);
+  }
+  return at::bmm(left, right);
+}
+
+// Contracts left and right into a tensor whose dims are labelled
+// [batch..., left only..., right only...], returned in labels. The labels of
+// one operand only which are not kept are summed out first.
+Tensor einsum_contract_pair(
+    Tensor left,
+    std::vector<uint8_t> left_labels,
+    Tensor right,
+    std::vector<uint8_t> right_labels,
+    const EinsumLabelSet& kept,
+    std::vector<uint8_t>& labels) {
+  auto sum_out_unique = [&kept](
+                            Tensor& tensor,
+                            std::vector<uint8_t>& tensor_labels,
+                            const std::vector<uint8_t>& other_labels) {
+    std::vector<int64_t> dims;
+    std::vector<uint8_t> remaining;
+    for (const auto d : c10::irange(tensor_labels.size())) {
+      const auto label = tensor_labels[d];
+      if (!kept[label] &&
+          std::find(other_labels.begin(), other_labels.end(), label) ==
+              other_labels.end()) {
+        dims.push_back(d);
+      } else {
+        remaining.push_back(label);
+      }
+    }
+    if (!dims.empty()) {
+      tensor = tensor.sum(dims);
+      tensor_labels = remaining;
+    }
+  };
+  sum_out_unique(left, left_labels, right_labels);
+  sum_out_unique(right, right_labels, left_labels);
+
+  std::vector<int64_t> batch, lo, sum, ro;
+  for (const auto d : c10::irange(left_labels.size())) {
+    const auto label = left_labels[d];
+    if (std::find(right_labels.begin(), right_labels.end(), label) ==
+        right_labels.end()) {
+      lo.push_back(d);
+    } else if (kept[label]) {
+      batch.push_back(d);
+    } else {
+      sum.push_back(d);
+    }
+  }
+  einsum_order_by_stride(left, batch);
+  einsum_order_by_stride(left, lo);
+  einsum_order_by_stride(left, sum);
+  auto right_dim = [&](int64_t left_d) {
+    return static_cast<int64_t>(
+        std::find(
+            right_labels.begin(), right_labels.end(), left_labels[left_d]) -
+        right_labels.begin());
+  };
+  std::vector<int64_t> right_batch, right_sum;
+  for (const auto d : batch) {
+    right_batch.push_back(right_dim(d));
+  }
+  for (const auto d : sum) {
+    right_sum.push_back(right_dim(d));
+  }
+  for (const auto d : c10::irange(right_labels.size())) {
+    if (std::find(left_labels.begin(), left_labels.end(), right_labels[d]) ==
+        left_labels.end()) {
+      ro.push_back(d);
+    }
+  }
+  einsum_order_by_stride(right, ro);
+
+  int64_t batch_size = 1, m = 1, k = 1, n = 1;
+  std::vector<int64_t> out_size;
+  labels.clear();
+  for (const auto d : batch) {
+    batch_size *= left.size(d);
+    out_size.push_back(left.size(d));
+    labels.push_back(left_labels[d]);
+  }
+  for (const auto d : lo) {
+    m *= left.size(d);
+    out_size.push_back(left.size(d));
+    labels.push_back(left_labels[d]);
+  }
+  for (const auto d : sum) {
+    k *= left.size(d);
+  }
+  for (const auto d : ro) {
+    n *= right.size(d);
+    out_size.push_back(right.size(d));
+    labels.push_back(right_labels[d]);
+  }
+
+  std::vector<int64_t> left_perm(batch);
+  left_perm.insert(left_perm.end(), lo.begin(), lo.end());
+  left_perm.insert(left_perm.end(), sum.begin(), sum.end());
+  std::vector<int64_t> right_perm(right_batch);
+  right_perm.insert(right_perm.end(), right_sum.begin(), right_sum.end());
+  right_perm.insert(right_perm.end(), ro.begin(), ro.end());
+  // the reshapes are views whenever the dims of each group are adjacent in
+  // memory, the matrices may come out transposed
+  auto left_3d = left.permute(left_perm).reshape({batch_size, m, k});
+  auto right_3d = right.permute(right_perm).reshape({batch_size, k, n});
+  return einsum_bmm(left_3d, right_3d).view(out_size);
+}
+
+} // namespace
+
+//! function: einsum_contraction
+/*!
+ * Einsum of any number of operands, contracted pairwise in the order
+ * minimizing the number of multiply-adds. The order is found exhaustively for
+ * a few operands and greedily for more, as opt_einsum does, and the plans are
+ * cached by equation and shapes. Each contraction is a batched GEMM of
+ * permuted views of its operands. The equations with ellipses, diagonals or
+ * broadcast dims go to at::einsum.
+ *\param equation:  The subscripts for the Einstein summation.
+ *\param operands: The tensors to compute the Einstein summation of.
+ */
+at::Tensor einsum_contraction(
+    c10::string_view equation,
+    const c10::List<at::Tensor>& operands) {
+  RECORD_FUNCTION("ipex::einsum", c10::ArrayRef<c10::IValue>({}));
+  auto plan = einsum_get_plan(equation, operands);
+  if (!plan) {
+    return at::einsum(equation, operands.vec());
+  }
+
+  std::vector<Tensor> tensors = operands.vec();
+  auto labels = plan->operand_labels;
+  for (const auto& step : plan->steps) {
+    std::vector<uint8_t> result_labels;
+    auto result = einsum_contract_pair(
+        tensors[step.lhs],
+        labels[step.lhs],
+        tensors[step.rhs],
+        labels[step.rhs],
+        step.kept,
+        result_labels);
+    tensors.erase(tensors.begin() + step.rhs);
+    tensors.erase(tensors.begin() + step.lhs);
+    labels.erase(labels.begin() + step.rhs);
+    labels.erase(labels.begin() + step.lhs);
+    tensors.push_back(result);
+    labels.push_back(result_labels);
+  }
+
+  // a single operand may still have labels to sum out
+  auto result = tensors[0];
+  auto result_labels = labels[0];
+  const auto& output_labels = plan->output_labels;
+  std::vector<int64_t> sum_dims;
+  std::vector<uint8_t> remaining;
+  for (const auto d : c10::irange(result_labels.size())) {
+    if (std::find(
+            output_labels.begin(), output_labels.end(), result_labels[d]) ==
+        output_labels.end()) {
+      sum_dims.push_back(d);
+    } else {
+      remaining.push_back(result_labels[d]);
+    }
+  }
+  if (!sum_dims.empty()) {
+    result = result.sum(sum_dims);
+    result_labels = remaining;
+  }
+  std::vector<int64_t> perm;
+  for (const auto label : output_labels) {
+    perm.push_back(
+        std::find(result_labels.begin(), result_labels.end(), label) -
+        result_labels.begin());
+  }
+  return result.permute(perm);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
@@ -15,6 +15,7 @@ namespace jit {
 // So we fake some op namespaces to workaround that.
 namespace ipex {
 static auto einsum_binary = Symbol::fromQualString("ipex::einsum_binary");
+static auto einsum = Symbol::fromQualString("ipex::einsum");
 
 } // namespace ipex
 
@@ -30,6 +31,10 @@ at::Tensor einsum_binary(
     const at::Tensor& input,
     const c10::Scalar& alpha);
 
+at::Tensor einsum_contraction(
+    c10::string_view equation,
+    const c10::List<at::Tensor>& operands);
+
 bool is_add_broadcast_supported_by_onednn(
     const at::Tensor& left,
     const at::Tensor& right,
@@ -0,0 +1,118 @@
+#include "GroupedLinearPacked.h"
+#include <ATen/Functions.h>
+#include <torch/csrc/autograd/function.h>
+#include "Matmul.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace grouped_linear {
+
+c10::intrusive_ptr<GroupedLinearOpContext>
+createGroupedLinearPrePackOpContext(
+    at::TensorList weights,
+    at::TensorList biases) {
+  RECORD_FUNCTION(
+      "ipex_prepack::createGroupedLinearPrePackOpContext",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return IpexGroupedLinearOpContext::create_context(
+      weights.vec(), biases.vec());
+}
+
+std::vector<at::Tensor> grouped_linear_run(
+    const std::vector<at::Tensor>& inputs,
+    c10::intrusive_ptr<GroupedLinearOpContext> op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::grouped_linear_run", c10::ArrayRef<c10::IValue>({}));
+
+  return op_context->run(inputs);
+}
+
+ContextGroupedLinear create(
+    const std::vector<at::Tensor>& weights,
+    const std::vector<at::Tensor>& biases) {
+  TORCH_CHECK(
+      !weights.empty() && weights.size() == biases.size(),
+      "grouped_linear_prepack: expected one bias per weight");
+  std::vector<at::Tensor> packed_weights;
+  std::vector<at::Tensor> packed_biases;
+  for (size_t i = 0; i < weights.size(); i++) {
+    const auto& weight = weights[i];
+    const auto& bias = biases[i];
+    TORCH_CHECK(
+        weight.dim() == 2 && weight.scalar_type() == at::kFloat,
+        "grouped_linear_prepack: expected 2D FP32 weights");
+    TORCH_CHECK(
+        bias.dim() == 1 && bias.size(0) == weight.size(0) &&
+            bias.scalar_type() == at::kFloat,
+        "grouped_linear_prepack: expected 1D FP32 biases of out_features");
+    packed_weights.push_back(weight.t().contiguous());
+    packed_biases.push_back(bias.contiguous());
+  }
+  return ContextGroupedLinear{
+      std::move(packed_weights),
+      std::move(packed_biases),
+  };
+}
+
+std::vector<at::Tensor> run(
+    ContextGroupedLinear& context,
+    const std::vector<at::Tensor>& inputs) {
+  const size_t num_layers = context.packed_weights_.size();
+  TORCH_CHECK(
+      inputs.size() == num_layers,
+      "grouped_linear_run: expected ",
+      num_layers,
+      " inputs, but got ",
+      inputs.size());
+  std::vector<at::Tensor> outputs(num_layers);
+  // keeps the contiguous inputs alive until the grouped call
+  std::vector<at::Tensor> inputs_(num_layers);
+  std::vector<SgemmGroup> groups;
+  for (size_t i = 0; i < num_layers; i++) {
+    const auto& weight = context.packed_weights_[i];
+    const auto& bias = context.biases_[i];
+    const auto& input = inputs[i];
+    const int64_t K = weight.size(0);
+    const int64_t N = weight.size(1);
+    TORCH_CHECK(
+        input.dim() >= 1 && input.size(-1) == K,
+        "Check the shapes of mat1 and mat2, they cannot be multiplied!");
+    if (input.scalar_type() != at::kFloat || input.numel() == 0) {
+      outputs[i] = at::linear(input, weight.t(), bias);
+      continue;
+    }
+    inputs_[i] = input.contiguous();
+    const int64_t M = input.numel() / K;
+    auto output_size = input.sizes().vec();
+    output_size.back() = N;
+    auto output = at::empty(output_size, input.options());
+    // the GEMM accumulates onto the broadcast bias (beta = 1)
+    output.view({M, N}).copy_(bias.expand({M, N}));
+    outputs[i] = output;
+
+    SgemmGroup gemm{
+        false,
+        false,
+        M,
+        N,
+        K,
+        K,
+        N,
+        N,
+        1.0f,
+        1.0f,
+        {inputs_[i].data_ptr<float>()},
+        {weight.data_ptr<float>()},
+        {output.data_ptr<float>()}};
+    append_sgemm_group(groups, std::move(gemm));
+  }
+  mkl_fp32_grouped_gemm_impl(groups);
+  return outputs;
+}
+
+} // namespace grouped_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
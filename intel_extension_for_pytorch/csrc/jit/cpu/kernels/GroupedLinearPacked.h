@@ -0,0 +1,32 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include "ContextGroupedLinear.h"
+#include "OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace grouped_linear {
+
+c10::intrusive_ptr<GroupedLinearOpContext>
+createGroupedLinearPrePackOpContext(
+    at::TensorList weights,
+    at::TensorList biases);
+
+std::vector<at::Tensor> grouped_linear_run(
+    const std::vector<at::Tensor>& inputs,
+    c10::intrusive_ptr<GroupedLinearOpContext> op_context);
+
+ContextGroupedLinear create(
+    const std::vector<at::Tensor>& weights,
+    const std::vector<at::Tensor>& biases);
+
+std::vector<at::Tensor> run(
+    ContextGroupedLinear& context,
+    const std::vector<at::Tensor>& inputs);
+
+} // namespace grouped_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
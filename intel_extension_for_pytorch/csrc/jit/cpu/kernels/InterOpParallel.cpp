@@ -0,0 +1,104 @@
+#include "InterOpParallel.h"
+
+#include <ATen/ThreadLocalState.h>
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/jit/runtime/custom_operator.h>
+
+#include <future>
+
+namespace torch_ipex {
+namespace cpu {
+
+using namespace torch::jit;
+
+InterOpParallelKernel::InterOpParallelKernel(const Node* node)
+    : num_inputs_(node->inputs().size()) {
+  const auto& graphs = node->gs(kBranchesAttr);
+  const auto& branch_inputs = node->is(kBranchInputsAttr);
+  const auto& branch_cores = node->is(kBranchCoresAttr);
+  const auto& cores = node->is(kCoresAttr);
+  TORCH_CHECK(
+      graphs.size() == branch_inputs.size() &&
+          graphs.size() == branch_cores.size(),
+      "InterOpParallelGroup: malformed branch attributes");
+
+  size_t core_offset = 0;
+  for (size_t i = 0; i < graphs.size(); i++) {
+    Branch branch;
+    branch.code = std::make_unique<Code>(
+        graphs[i], "InterOpParallelBranch_" + std::to_string(i));
+    branch.num_inputs = branch_inputs[i];
+    std::vector<int32_t> core_list(
+        cores.begin() + core_offset,
+        cores.begin() + core_offset + branch_cores[i]);
+    core_offset += branch_cores[i];
+    branch.cpu_pool =
+        std::make_unique<torch_ipex::runtime::CPUPool>(core_list);
+    // the worker thread of the executor pins itself to the pool, which has to
+    // outlive it
+    branch.task_executor =
+        std::make_shared<torch_ipex::runtime::TaskExecutor>(*branch.cpu_pool);
+    branches_.emplace_back(std::move(branch));
+  }
+}
+
+void InterOpParallelKernel::run(Stack& stack) {
+  auto inputs = last(stack, num_inputs_);
+  // propagate the grad mode, autocast and profiler state to the workers
+  at::ThreadLocalState tls_state;
+  std::vector<std::future<Stack>> results;
+  size_t input_offset = 0;
+  for (auto& branch : branches_) {
+    Stack branch_stack(
+        inputs.begin() + input_offset,
+        inputs.begin() + input_offset + branch.num_inputs);
+    input_offset += branch.num_inputs;
+    Code* code = branch.code.get();
+    auto task = std::make_shared<std::packaged_task<Stack()>>(
+        [code, tls_state, branch_stack = std::move(branch_stack)]() mutable {
+          at::ThreadLocalStateGuard guard(tls_state);
+          InterpreterState(*code).run(branch_stack);
+          return std::move(branch_stack);
+        });
+    results.emplace_back(task->get_future());
+
+    auto& executor = branch.task_executor;
+    {
+      std::unique_lock<std::mutex> lock(executor->get_mutex());
+      TORCH_CHECK(
+          !executor->is_stop(),
+          "InterOpParallelGroup: task submitted to a stopped executor");
+      executor->get_tasks().emplace([task]() { (*task)(); });
+    }
+    executor->get_condition().notify_one();
+  }
+  drop(stack, num_inputs_);
+
+  // the outputs of the group are the outputs of the branches in order, an
+  // exception raised by a branch is rethrown here
+  for (auto& result : results) {
+    for (auto& output : result.get()) {
+      stack.emplace_back(std::move(output));
+    }
+  }
+}
+
+Operation createInterOpParallelKernel(const Node* node) {
+  auto kernel = std::make_shared<InterOpParallelKernel>(node);
+  return [kernel](Stack* stack) {
+    RECORD_FUNCTION("ipex::InterOpParallelGroup", c10::ArrayRef<c10::IValue>());
+
+    kernel->run(*stack);
+    return 0;
+  };
+}
+
+torch::jit::RegisterOperators InterOpParallelGroupOp({
+    torch::jit::Operator(
+        torch::jit::ipex::inter_op_parallel_group,
+        createInterOpParallelKernel,
+        AliasAnalysisKind::CONSERVATIVE),
+});
+
+} // namespace cpu
+} // namespace torch_ipex
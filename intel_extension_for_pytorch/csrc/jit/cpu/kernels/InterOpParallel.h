@@ -0,0 +1,57 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+
+#include "csrc/cpu/runtime/CPUPool.h"
+#include "csrc/cpu/runtime/TaskExecutor.h"
+
+namespace torch {
+namespace jit {
+
+namespace ipex {
+static auto inter_op_parallel_group =
+    Symbol::fromQualString("ipex::InterOpParallelGroup");
+
+} // namespace ipex
+
+} // namespace jit
+} // namespace torch
+
+namespace torch_ipex {
+namespace cpu {
+
+// Attributes of ipex::InterOpParallelGroup:
+//   branches: the subgraph of each branch
+//   branch_inputs: the number of inputs of the group taken by each branch,
+//     in order, the outputs of the group are the outputs of the branches in
+//     the same order
+//   branch_cores: the number of cores of each branch
+//   cores: the core ids of all the branches, in order
+static auto kBranchesAttr = torch::jit::Symbol::attr("branches");
+static auto kBranchInputsAttr = torch::jit::Symbol::attr("branch_inputs");
+static auto kBranchCoresAttr = torch::jit::Symbol::attr("branch_cores");
+static auto kCoresAttr = torch::jit::Symbol::attr("cores");
+
+// Runs the branches of an ipex::InterOpParallelGroup concurrently, each one
+// by its own TaskExecutor pinned to its CPUPool, and waits for all of them.
+class InterOpParallelKernel {
+ public:
+  explicit InterOpParallelKernel(const torch::jit::Node* node);
+
+  void run(torch::jit::Stack& stack);
+
+ private:
+  struct Branch {
+    std::unique_ptr<torch::jit::Code> code;
+    size_t num_inputs;
+    std::unique_ptr<torch_ipex::runtime::CPUPool> cpu_pool;
+    std::shared_ptr<torch_ipex::runtime::TaskExecutor> task_executor;
+  };
+
+  std::vector<Branch> branches_;
+  size_t num_inputs_;
+};
+
+} // namespace cpu
+} // namespace torch_ipex
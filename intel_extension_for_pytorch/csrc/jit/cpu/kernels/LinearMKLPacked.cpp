@@ -1,14 +1,69 @@
 #include "LinearMKLPacked.h"
+#include "WeightSharing.h"
 #include "csrc/aten/cpu/LinearMKL.h"
 #include "csrc/aten/cpu/WeightPack.h"
 #include "csrc/cpu/ideep/IDeepConversions.h"
 #include "csrc/cpu/ideep/ideep.hpp"
 
+#include <ATen/Functions.h>
+#include <ATen/Parallel.h>
+
 namespace torch_ipex {
 namespace cpu {
 namespace detail {
 namespace mkl_sgemm {
 
+namespace {
+
+// The packed layout depends on M. Besides the batch size it is created for,
+// a context packs its weight for the power of two batch sizes and pads the
+// rows of the input up to them, so the number of packed weights only grows
+// with the log of the largest batch size.
+int64_t batchBucket(int64_t batch_size) {
+  int64_t bucket = 1;
+  while (bucket < batch_size) {
+    bucket <<= 1;
+  }
+  return bucket;
+}
+
+// Writes the linear of the [batch, K] input into the [batch, N] output.
+void sgemm(
+    ContextLinearMKL& context,
+    const at::Tensor& input,
+    const at::Tensor& bias,
+    at::Tensor& output) {
+  auto K = context.sgemm_sizes_[1];
+  auto N = context.sgemm_sizes_[2];
+  int64_t batch = input.numel() / K;
+  if (batch == context.sgemm_sizes_[0]) {
+    mkl_sgemm_kernel_output(input, context.mkl_weight_, bias, N, output);
+    return;
+  }
+
+  auto bucket = batchBucket(batch);
+  auto weight = packed_weight_for(context, bucket);
+  if (!weight.defined()) {
+    // the unpacked sgemm until the bucket is packed
+    output.view({batch, N})
+        .copy_(at::linear(
+            input.view({batch, K}), context.ori_weight_, context.bias_));
+    return;
+  }
+  if (bucket == batch) {
+    mkl_sgemm_kernel_output(input, weight, bias, N, output);
+    return;
+  }
+  auto padded_input = at::empty({bucket, K}, input.options());
+  padded_input.narrow(0, 0, batch).copy_(input.view({batch, K}));
+  padded_input.narrow(0, batch, bucket - batch).zero_();
+  auto padded_output = at::empty({bucket, N}, output.options());
+  mkl_sgemm_kernel_output(padded_input, weight, bias, N, padded_output);
+  output.view({batch, N}).copy_(padded_output.narrow(0, 0, batch));
+}
+
+} // namespace
+
 c10::intrusive_ptr<MKLOpContext> createLinearMKLPrePackOpContext(
     at::Tensor&& weight,
     c10::optional<at::Tensor>&& bias,
@@ -44,6 +99,11 @@ ContextLinearMKL create(
 
   auto mkl_weight =
       mkl_sgemm_pack_weight(batch, out_features, in_features, weight);
+  // the original weight is kept for repacking, share it as well
+  if (is_weight_sharing_enabled()) {
+    mkl_weight = share_weight(mkl_weight);
+    weight = share_weight(weight.contiguous());
+  }
 
   return ContextLinearMKL{
       std::move(sgemm_sizes),
@@ -62,11 +122,13 @@ at::Tensor run(ContextLinearMKL& context, const at::Tensor& input) {
   c10::MaybeOwned<at::Tensor> bias_maybe_owned =
       at::borrow_from_optional_tensor(context.bias_);
   const at::Tensor& bias = *bias_maybe_owned;
-  int64_t input_batch = (int64_t)(input_.numel() / K);
-  if (input_batch != context.sgemm_sizes_[0])
-    repack_for(context, input_batch);
-  return mkl_sgemm_kernel(
-      input_, context.mkl_weight_, bias, context.sgemm_sizes_[2]);
+  auto input_size = input_.sizes();
+  std::vector<int64_t> output_size(input_size.begin(), input_size.end() - 1);
+  output_size.push_back(context.sgemm_sizes_[2]);
+  auto output = at::empty(output_size, input_.options());
+  output.set_requires_grad(input_.requires_grad());
+  sgemm(context, input_, bias, output);
+  return output;
 }
 
 at::Tensor& run(
@@ -81,11 +143,7 @@ at::Tensor& run(
   c10::MaybeOwned<at::Tensor> bias_maybe_owned =
       at::borrow_from_optional_tensor(context.bias_);
   const at::Tensor& bias = *bias_maybe_owned;
-  int64_t input_batch = (int64_t)(input_.numel() / K);
-  if (input_batch != context.sgemm_sizes_[0])
-    repack_for(context, input_batch);
-  mkl_sgemm_kernel_output(
-      input_, context.mkl_weight_, bias, context.sgemm_sizes_[2], accumu);
+  sgemm(context, input_, bias, accumu);
   return accumu;
 }
 
@@ -96,17 +154,44 @@ at::Tensor pack(ContextLinearMKL& context, const at::Tensor& tensor) {
   return mkl_sgemm_pack_weight(batch_size, out_features, in_features, tensor);
 }
 
-void repack_for(ContextLinearMKL& context, int64_t batch_size) {
+at::Tensor packed_weight_for(ContextLinearMKL& context, int64_t bucket) {
+  if (bucket == context.sgemm_sizes_[0]) {
+    return context.mkl_weight_;
+  }
+
+  auto cache = context.packed_cache_;
+  {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    auto it = cache->weights.find(bucket);
+    if (it != cache->weights.end()) {
+      return it->second;
+    }
+    if (!cache->packing.insert(bucket).second) {
+      return at::Tensor();
+    }
+  }
+
+  // the task owns the cache and the weight, it may outlive the context
+  auto ori_weight = context.ori_weight_;
   auto in_features = context.sgemm_sizes_[1];
   auto out_features = context.sgemm_sizes_[2];
-
-  context.sgemm_sizes_[0] = batch_size;
-  mkl_sgemm_repack_weight(
-      batch_size,
-      out_features,
-      in_features,
-      context.ori_weight_,
-      context.mkl_weight_);
+  at::launch([cache, ori_weight, bucket, in_features, out_features]() {
+    try {
+      auto weight = mkl_sgemm_pack_weight(
+          bucket, out_features, in_features, ori_weight);
+      std::lock_guard<std::mutex> lock(cache->mutex);
+      cache->weights.emplace(bucket, std::move(weight));
+      cache->packing.erase(bucket);
+    } catch (const std::exception& e) {
+      // the bucket is left in packing, it keeps using the unpacked sgemm
+      TORCH_WARN(
+          "Failed to pack the MKL weight for ",
+          bucket,
+          " rows: ",
+          e.what());
+    }
+  });
+  return at::Tensor();
 }
 
 } // namespace mkl_sgemm
@@ -32,7 +32,10 @@ at::Tensor& run(
 
 at::Tensor pack(ContextLinearMKL& context, const at::Tensor& tensor);
 
-void repack_for(ContextLinearMKL& context, int64_t batch_size);
+// Returns the weight packed for bucket rows, a power of two. A bucket seen
+// for the first time gets packed in the background and an undefined tensor is
+// returned until it is ready.
+at::Tensor packed_weight_for(ContextLinearMKL& context, int64_t bucket);
 
 } // namespace mkl_sgemm
 } // namespace detail
@@ -1,4 +1,6 @@
 #include "LinearPacked.h"
+#include "PackedWeightFormat.h"
+#include "WeightSharing.h"
 #include "csrc/aten/cpu/Linear.h"
 #include "csrc/aten/cpu/WeightPack.h"
 #include "csrc/cpu/ideep/IDeepConversions.h"
@@ -9,16 +11,52 @@ namespace cpu {
 namespace detail {
 namespace linear {
 
-#define DEFINE_LINEAR_UNARY_ELTWISE_RUN(FUSED_OP)                    \
-  at::Tensor linear_##FUSED_OP##_run(                                \
-      const at::Tensor& input,                                       \
-      const c10::intrusive_ptr<LinearOpContext>& op_context) {       \
-    RECORD_FUNCTION(                                                 \
-        "ipex_prepack::linear_" #FUSED_OP "_run",                    \
-        c10::ArrayRef<c10::IValue>({}));                             \
-    return op_context->run(input, ideep::attr_t::fuse_##FUSED_OP()); \
+#define DEFINE_LINEAR_UNARY_ELTWISE_RUN(FUSED_OP)                     \
+  at::Tensor linear_##FUSED_OP##_run(                                 \
+      const at::Tensor& input,                                        \
+      const c10::intrusive_ptr<LinearOpContext>& op_context) {        \
+    RECORD_FUNCTION(                                                  \
+        "ipex_prepack::linear_" #FUSED_OP "_run",                     \
+        c10::ArrayRef<c10::IValue>({}));                              \
+    return op_context->run(input, ideep::attr_t::fuse_##FUSED_OP());  \
+  }                                                                   \
+  at::Tensor linear_##FUSED_OP##_run_out(                             \
+      const at::Tensor& input,                                        \
+      at::Tensor& output,                                             \
+      const c10::intrusive_ptr<LinearOpContext>& op_context) {        \
+    RECORD_FUNCTION(                                                  \
+        "ipex_prepack::linear_" #FUSED_OP "_run_out",                 \
+        c10::ArrayRef<c10::IValue>({}));                              \
+    return linear_run_out_impl(                                       \
+        input, output, op_context, ideep::attr_t::fuse_##FUSED_OP()); \
   }
 
+// The output is planned by StaticMemoryPlanning for the profiled input shape
+// and shares the arena with the other planned tensors, so it can neither be
+// resized nor be replaced by a new tensor.
+static at::Tensor linear_run_out_impl(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<LinearOpContext>& op_context,
+    const ideep::attr_t& attr) {
+  auto output_size = input.sizes().vec();
+  output_size.back() = op_context->get_context().weight_packed_.get_dim(0);
+  TORCH_CHECK(
+      output.sizes() == at::IntArrayRef(output_size) &&
+          output.scalar_type() == input.scalar_type() &&
+          output.is_contiguous(),
+      "linear run_out: expected a contiguous ",
+      input.scalar_type(),
+      " output of size ",
+      at::IntArrayRef(output_size),
+      " but got ",
+      output.scalar_type(),
+      " of size ",
+      output.sizes(),
+      ", the static memory plan only supports the profiled input shapes");
+  return op_context->run(input, output, attr);
+}
+
 c10::intrusive_ptr<LinearOpContext> createLinearPrePackOpContext(
     at::Tensor&& weight,
     c10::optional<at::Tensor>&& bias,
@@ -41,6 +79,16 @@ at::Tensor linear_run(
   return op_context->run(input, ideep::attr_t());
 }
 
+at::Tensor linear_run_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<LinearOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::linear_run_out", c10::ArrayRef<c10::IValue>({}));
+
+  return linear_run_out_impl(input, output, op_context, ideep::attr_t());
+}
+
 DEFINE_LINEAR_UNARY_ELTWISE_RUN(relu);
 DEFINE_LINEAR_UNARY_ELTWISE_RUN(sigmoid);
 DEFINE_LINEAR_UNARY_ELTWISE_RUN(swish);
@@ -153,9 +201,17 @@ at::Tensor linear_add_relu_run(
 }
 
 ContextLinear create(
-    const at::Tensor& weight,
+    const at::Tensor& weight_or_packed,
     const c10::optional<at::Tensor>& bias,
     const c10::optional<int64_t> batch_size) {
+  // A serialized packed weight only provides the shape of the public weight
+  // here, its data gets adopted by the packed weight below
+  c10::optional<SerializedPackedWeight> serialized;
+  if (is_serialized_packed_weight(weight_or_packed)) {
+    serialized.emplace(weight_or_packed);
+  }
+  const auto weight =
+      serialized ? serialized->public_weight_like() : weight_or_packed;
   auto out_features = weight.size(0);
   auto in_features = weight.size(1);
   ideep::tensor packed_weight;
@@ -171,14 +227,24 @@ ContextLinear create(
       input_size,
       /* weight dtype */ dtype,
       /* src dtype */ dtype);
-  auto at_weight = empty_aten_tensor_from_desc(packed_desc, weight.options());
-  if (ideep::data_type::f32 == dtype) {
-    packed_weight.init(packed_desc, at_weight.template data_ptr<float>());
+  at::Tensor at_weight;
+  if (serialized) {
+    std::tie(packed_weight, at_weight) =
+        serialized->pack(packed_desc, weight.options());
   } else {
-    packed_weight.init(
-        packed_desc, at_weight.template data_ptr<c10::BFloat16>());
+    at_weight = empty_aten_tensor_from_desc(packed_desc, weight.options());
+    if (ideep::data_type::f32 == dtype) {
+      packed_weight.init(packed_desc, at_weight.template data_ptr<float>());
+    } else {
+      packed_weight.init(
+          packed_desc, at_weight.template data_ptr<c10::BFloat16>());
+    }
+    packed_weight.feed_from(w);
+  }
+  if (is_weight_sharing_enabled()) {
+    at_weight = share_weight(at_weight);
+    packed_weight.init(packed_desc, at_weight.data_ptr());
   }
-  packed_weight.feed_from(w);
   return ContextLinear{
       std::move(ori_desc),
       std::move(packed_weight),
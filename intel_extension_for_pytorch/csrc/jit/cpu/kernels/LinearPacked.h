@@ -9,9 +9,13 @@ namespace cpu {
 namespace detail {
 namespace linear {
 
-#define DECLARE_LINEAR_UNARY_ELTWISE_RUN(FUSED_OP) \
-  at::Tensor linear_##FUSED_OP##_run(              \
-      const at::Tensor& input,                     \
+#define DECLARE_LINEAR_UNARY_ELTWISE_RUN(FUSED_OP)            \
+  at::Tensor linear_##FUSED_OP##_run(                         \
+      const at::Tensor& input,                                \
+      const c10::intrusive_ptr<LinearOpContext>& op_context); \
+  at::Tensor linear_##FUSED_OP##_run_out(                     \
+      const at::Tensor& input,                                \
+      at::Tensor& output,                                     \
       const c10::intrusive_ptr<LinearOpContext>& op_context);
 
 c10::intrusive_ptr<LinearOpContext> createLinearPrePackOpContext(
@@ -23,6 +27,14 @@ at::Tensor linear_run(
     const at::Tensor& input,
     const c10::intrusive_ptr<LinearOpContext>& op_context);
 
+// Same as linear_run but writes the result into the preallocated output,
+// which is used by the static memory planner. Falls back to allocating a new
+// output if the planned one does not match the actual output shape.
+at::Tensor linear_run_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<LinearOpContext>& op_context);
+
 DECLARE_LINEAR_UNARY_ELTWISE_RUN(relu);
 DECLARE_LINEAR_UNARY_ELTWISE_RUN(sigmoid);
 DECLARE_LINEAR_UNARY_ELTWISE_RUN(swish);
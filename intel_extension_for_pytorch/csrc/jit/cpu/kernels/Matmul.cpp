@@ -6,6 +6,7 @@
 #include <c10/util/Logging.h>
 #include <torch/csrc/autograd/function.h>
 
+#include <algorithm>
 #include <limits>
 
 #include "csrc/cpu/ideep/IDeepConversions.h"
@@ -102,6 +103,81 @@ void mkl_fp32_bmm_impl(
       size_per_grp);
 }
 
+void append_sgemm_group(std::vector<SgemmGroup>& groups, SgemmGroup&& gemm) {
+  for (auto& group : groups) {
+    if (group.trans_a == gemm.trans_a && group.trans_b == gemm.trans_b &&
+        group.m == gemm.m && group.n == gemm.n && group.k == gemm.k &&
+        group.lda == gemm.lda && group.ldb == gemm.ldb &&
+        group.ldc == gemm.ldc && group.alpha == gemm.alpha &&
+        group.beta == gemm.beta) {
+      group.a.insert(group.a.end(), gemm.a.begin(), gemm.a.end());
+      group.b.insert(group.b.end(), gemm.b.begin(), gemm.b.end());
+      group.c.insert(group.c.end(), gemm.c.begin(), gemm.c.end());
+      return;
+    }
+  }
+  groups.emplace_back(std::move(gemm));
+}
+
+/**
+ * MKL FP32 grouped GEMM kernel
+ *
+ * Issues all the GEMMs of all the groups with a single cblas_sgemm_batch call,
+ * so that many independent small GEMMs, each too small to keep all the cores
+ * busy, are scheduled by MKL at once instead of one after another. The GEMMs
+ * of different groups may have different sizes.
+ **/
+void mkl_fp32_grouped_gemm_impl(const std::vector<SgemmGroup>& groups) {
+  const MKL_INT group_count = groups.size();
+  if (group_count == 0) {
+    return;
+  }
+
+  std::vector<CBLAS_TRANSPOSE> transA(group_count);
+  std::vector<CBLAS_TRANSPOSE> transB(group_count);
+  std::vector<MKL_INT> m(group_count), n(group_count), k(group_count);
+  std::vector<MKL_INT> lda(group_count), ldb(group_count), ldc(group_count);
+  std::vector<float> alpha(group_count), beta(group_count);
+  std::vector<MKL_INT> size_per_grp(group_count);
+  std::vector<const float*> a_array, b_array;
+  std::vector<float*> c_array;
+  for (MKL_INT i = 0; i < group_count; ++i) {
+    const auto& group = groups[i];
+    transA[i] = group.trans_a ? CblasTrans : CblasNoTrans;
+    transB[i] = group.trans_b ? CblasTrans : CblasNoTrans;
+    m[i] = group.m;
+    n[i] = group.n;
+    k[i] = group.k;
+    lda[i] = group.lda;
+    ldb[i] = group.ldb;
+    ldc[i] = group.ldc;
+    alpha[i] = group.alpha;
+    beta[i] = group.beta;
+    size_per_grp[i] = group.c.size();
+    a_array.insert(a_array.end(), group.a.begin(), group.a.end());
+    b_array.insert(b_array.end(), group.b.begin(), group.b.end());
+    c_array.insert(c_array.end(), group.c.begin(), group.c.end());
+  }
+
+  cblas_sgemm_batch(
+      CblasRowMajor,
+      transA.data(),
+      transB.data(),
+      m.data(),
+      n.data(),
+      k.data(),
+      alpha.data(),
+      a_array.data(),
+      lda.data(),
+      b_array.data(),
+      ldb.data(),
+      beta.data(),
+      c_array.data(),
+      ldc.data(),
+      group_count,
+      size_per_grp.data());
+}
+
 /**
  * bmm oneDNN kernel
  *
@@ -291,5 +367,85 @@ at::Tensor dil_bmm_add(
   }
 }
 
+/**
+ * Runs the independent bmm(batch1[i], batch2[i]) with one grouped GEMM call.
+ * Every bmm is one group of batch-size GEMMs. The bmm which the MKL kernel
+ * cannot take (non FP32, not 3-dim, mismatched or empty shapes) fall back to
+ * at::bmm one by one.
+ *
+ * @param batch1 The left operands
+ * @param batch2 The right operands
+ * @return The outputs, one per pair of operands.
+ **/
+std::vector<at::Tensor> dil_grouped_bmm(
+    const std::vector<at::Tensor>& batch1,
+    const std::vector<at::Tensor>& batch2) {
+#if defined(IPEX_PROFILE_OP)
+  RECORD_FUNCTION("dil_grouped_bmm", c10::ArrayRef<c10::IValue>({}));
+#endif
+  TORCH_CHECK(
+      batch1.size() == batch2.size(),
+      "dil_grouped_bmm: expected the same number of left and right operands");
+  // the leading dimension of a matrix is its non unit stride, it has to
+  // cover the length of the rows (or of the columns when transposed)
+  auto gemm_ready = [](const at::Tensor& t) {
+    auto rows = std::max<int64_t>(1, t.size(-2));
+    auto cols = std::max<int64_t>(1, t.size(-1));
+    return (t.stride(-1) == 1 && t.stride(-2) >= cols) ||
+        (t.stride(-2) == 1 && t.stride(-1) >= rows);
+  };
+
+  std::vector<at::Tensor> outputs(batch1.size());
+  // keeps the contiguous copies alive until the grouped call
+  std::vector<at::Tensor> operands;
+  std::vector<SgemmGroup> groups;
+  for (size_t i = 0; i < batch1.size(); i++) {
+    const auto& t1 = batch1[i];
+    const auto& t2 = batch2[i];
+    if (t1.scalar_type() != at::kFloat || t2.scalar_type() != at::kFloat ||
+        t1.dim() != 3 || t2.dim() != 3 || t1.size(0) != t2.size(0) ||
+        t1.size(2) != t2.size(1) || t1.numel() == 0 || t2.numel() == 0) {
+      outputs[i] = at::bmm(t1, t2);
+      continue;
+    }
+    auto a = gemm_ready(t1) ? t1 : t1.contiguous();
+    auto b = gemm_ready(t2) ? t2 : t2.contiguous();
+    operands.push_back(a);
+    operands.push_back(b);
+    const int64_t batch = a.size(0);
+    const int64_t m = a.size(1);
+    const int64_t k = a.size(2);
+    const int64_t n = b.size(2);
+    auto out = at::empty({batch, m, n}, a.options());
+    outputs[i] = out;
+
+    SgemmGroup gemm{
+        a.stride(-1) != 1,
+        b.stride(-1) != 1,
+        m,
+        n,
+        k,
+        a.stride(-1) == 1 ? a.stride(-2) : a.stride(-1),
+        b.stride(-1) == 1 ? b.stride(-2) : b.stride(-1),
+        n,
+        1.0f,
+        0.0f,
+        {},
+        {},
+        {}};
+    const float* a_data = a.data_ptr<float>();
+    const float* b_data = b.data_ptr<float>();
+    float* c_data = out.data_ptr<float>();
+    for (int64_t j = 0; j < batch; j++) {
+      gemm.a.push_back(a_data + j * a.stride(0));
+      gemm.b.push_back(b_data + j * b.stride(0));
+      gemm.c.push_back(c_data + j * m * n);
+    }
+    append_sgemm_group(groups, std::move(gemm));
+  }
+  mkl_fp32_grouped_gemm_impl(groups);
+  return outputs;
+}
+
 } // namespace cpu
 } // namespace torch_ipex
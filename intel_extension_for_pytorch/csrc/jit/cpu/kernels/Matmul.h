@@ -16,6 +16,7 @@ namespace jit {
 namespace ipex {
 static auto matmul_div = Symbol::fromQualString("ipex::matmul_div");
 static auto bmm_add = Symbol::fromQualString("ipex::bmm_add");
+static auto grouped_bmm = Symbol::fromQualString("ipex::grouped_bmm");
 
 } // namespace ipex
 
@@ -31,6 +32,31 @@ void mkl_fp32_bmm_impl(
     at::Tensor& out,
     const double& output_scale);
 
+// One group descriptor of a grouped GEMM: the row major GEMMs
+// c = alpha * op(a) * op(b) + beta * c which share the same transposes,
+// sizes, leading dimensions and scales.
+struct SgemmGroup {
+  bool trans_a;
+  bool trans_b;
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  int64_t lda;
+  int64_t ldb;
+  int64_t ldc;
+  float alpha;
+  float beta;
+  std::vector<const float*> a;
+  std::vector<const float*> b;
+  std::vector<float*> c;
+};
+
+// Appends the GEMMs of gemm to the group of groups with the same descriptor,
+// or as a new group if there is none.
+void append_sgemm_group(std::vector<SgemmGroup>& groups, SgemmGroup&& gemm);
+
+void mkl_fp32_grouped_gemm_impl(const std::vector<SgemmGroup>& groups);
+
 at::Tensor bmm_impl(
     const at::Tensor& tensor1,
     const at::Tensor& tensor2,
@@ -59,5 +85,9 @@ at::Tensor dil_bmm_add(
     const at::Tensor& batch2,
     const c10::Scalar& alpha);
 
+std::vector<at::Tensor> dil_grouped_bmm(
+    const std::vector<at::Tensor>& batch1,
+    const std::vector<at::Tensor>& batch2);
+
 } // namespace cpu
 } // namespace torch_ipex
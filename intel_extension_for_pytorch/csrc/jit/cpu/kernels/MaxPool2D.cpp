@@ -10,6 +10,7 @@
 #include <limits>
 
 #include "csrc/aten/cpu/ParamUtils.h"
+#include "csrc/aten/cpu/Pooling.h"
 #include "csrc/aten/cpu/utils/utils.h"
 #include "csrc/cpu/ideep/IDeepConversions.h"
 #include "csrc/cpu/ideep/ideep.hpp"
@@ -149,6 +150,21 @@ at::Tensor pooling_impl(
   }
 }
 
+namespace {
+
+// NHWC and quantized inputs are pooled by pooling_channels_last, which keeps
+// the layout and reduces the channels with vector loads. Quantized inputs
+// would otherwise go through the stock quantized kernels.
+bool use_pooling_channels_last(const at::Tensor& input) {
+  if (input.dim() != 4 || !pooling_channels_last_supported(input)) {
+    return false;
+  }
+  return input.is_quantized() ||
+      input.suggest_memory_format() == at::MemoryFormat::ChannelsLast;
+}
+
+} // namespace
+
 // This path will be removed after pytorch offical path is optimized well.
 at::Tensor dil_max_pool2d(
     const at::Tensor& input,
@@ -159,10 +175,23 @@ at::Tensor dil_max_pool2d(
     bool ceil_mode) {
   RECORD_FUNCTION("dil_max_pool2d", c10::ArrayRef<c10::IValue>({}));
 
-  TORCH_CHECK(
-      std::all_of(
-          dilation.cbegin(), dilation.cend(), [](int64_t i) { return 1 == i; }),
-      "dil_max_pool does not support dilation case");
+  if (use_pooling_channels_last(input)) {
+    return pooling_channels_last(
+        input,
+        kernel_size,
+        stride,
+        padding,
+        dilation,
+        ceil_mode,
+        /*is_max=*/true);
+  }
+  if (!std::all_of(dilation.cbegin(), dilation.cend(), [](int64_t i) {
+        return 1 == i;
+      })) {
+    // dil_max_pool does not support dilation case
+    return at::max_pool2d(
+        input, kernel_size, stride, padding, dilation, ceil_mode);
+  }
   return pooling_impl(
       input,
       kernel_size,
@@ -173,5 +202,70 @@ at::Tensor dil_max_pool2d(
       ideep::algorithm::pooling_max);
 }
 
+at::Tensor max_pool2d_relu(
+    const at::Tensor& input,
+    at::IntArrayRef kernel_size,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    bool ceil_mode) {
+  RECORD_FUNCTION("ipex::max_pool2d_relu", c10::ArrayRef<c10::IValue>({}));
+
+  if (use_pooling_channels_last(input)) {
+    return pooling_channels_last(
+        input,
+        kernel_size,
+        stride,
+        padding,
+        dilation,
+        ceil_mode,
+        /*is_max=*/true,
+        /*count_include_pad=*/true,
+        /*divisor_override=*/c10::nullopt,
+        /*fuse_relu=*/true);
+  }
+  // the ReLU is applied to the pooled output, which is smaller
+  return dil_max_pool2d(
+             input, kernel_size, stride, padding, dilation, ceil_mode)
+      .relu_();
+}
+
+at::Tensor max_pool2d_quantize(
+    const at::Tensor& input,
+    at::IntArrayRef kernel_size,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    bool ceil_mode,
+    double scale,
+    int64_t zero_point,
+    at::ScalarType dtype) {
+  RECORD_FUNCTION(
+      "ipex::max_pool2d_quantize", c10::ArrayRef<c10::IValue>({}));
+
+  if (!input.is_quantized() &&
+      (dtype == at::kQUInt8 || dtype == at::kQInt8) &&
+      use_pooling_channels_last(input)) {
+    return pooling_channels_last(
+        input,
+        kernel_size,
+        stride,
+        padding,
+        dilation,
+        ceil_mode,
+        /*is_max=*/true,
+        /*count_include_pad=*/true,
+        /*divisor_override=*/c10::nullopt,
+        /*fuse_relu=*/false,
+        dtype,
+        scale,
+        zero_point);
+  }
+  auto output =
+      dil_max_pool2d(input, kernel_size, stride, padding, dilation, ceil_mode);
+  return at::quantize_per_tensor(
+      output.to(at::kFloat), scale, zero_point, dtype);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
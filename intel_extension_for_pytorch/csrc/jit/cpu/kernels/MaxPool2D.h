@@ -19,5 +19,26 @@ at::Tensor dil_max_pool2d(
     at::IntArrayRef dilation,
     bool ceil_mode);
 
+// ipex::max_pool2d of a ReLU output, max(relu(x)) is relu(max(x))
+at::Tensor max_pool2d_relu(
+    const at::Tensor& input,
+    at::IntArrayRef kernel_size,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    bool ceil_mode);
+
+// ipex::max_pool2d followed by aten::quantize_per_tensor
+at::Tensor max_pool2d_quantize(
+    const at::Tensor& input,
+    at::IntArrayRef kernel_size,
+    at::IntArrayRef stride,
+    at::IntArrayRef padding,
+    at::IntArrayRef dilation,
+    bool ceil_mode,
+    double scale,
+    int64_t zero_point,
+    at::ScalarType dtype);
+
 } // namespace cpu
 } // namespace torch_ipex
@@ -15,6 +15,19 @@
 namespace torch_ipex {
 namespace cpu {
 
+namespace {
+
+// The masked_fill softmax kernels read bool masks directly, the other dtypes
+// are converted to float for creating vec mask for kernel computation.
+at::Tensor softmax_mask(const at::Tensor& mask) {
+  if (mask.scalar_type() == at::kBool) {
+    return mask.contiguous();
+  }
+  return mask.toType(at::kFloat);
+}
+
+} // namespace
+
 /**
  * We tried to fuse Div+Matmul+Add+Softmax as a signel operator. But
  * the oneDNN matmul performance with binary postop is poor, then we splited
@@ -81,8 +94,7 @@ at::Tensor dil_distil_mha_scores_calc(
   auto _fill = fill.to<float>();
   auto qk = at::Tensor();
   qk = bmm_impl(q, k, qk, ideep::attr_t(), {}, 1.f);
-  //  convert the mask to float for creating vec mask for kernel computation
-  auto _mask_qk = mask_qk.toType(at::kFloat);
+  auto _mask_qk = softmax_mask(mask_qk);
   return DivMaskedfillSoftmax(
       qk, _mask_qk, mask_qk_reshp, _fill, _dim_per_head);
 }
@@ -101,8 +113,7 @@ at::Tensor dil_maskedfill_softmax(
   RECORD_FUNCTION("dil_maskedfill_softmax", c10::ArrayRef<c10::IValue>({}));
   float _dim_per_head = 1;
   auto _fill = fill.to<float>();
-  // convert the mask to float for creating vec mask for kernel computation
-  auto _mask_qk = mask_qk.toType(at::kFloat);
+  auto _mask_qk = softmax_mask(mask_qk);
   return DivMaskedfillSoftmax(
       qk, _mask_qk, mask_qk_reshp, _fill, _dim_per_head);
 }
@@ -192,7 +203,7 @@ at::Tensor dil_transfree_distil_mha(
       .transpose_(1, 2);
 
   bmm_impl(query, key, qk, ideep::attr_t(), {}, 1.f);
-  auto _mask_qk = mask_qk.toType(at::kFloat);
+  auto _mask_qk = softmax_mask(mask_qk);
   qk = DivMaskedfillSoftmax(qk, _mask_qk, mask_qk_reshp, _fill, _dim_per_head);
 
   auto output = dil_mha_matmul_trans(qk, value);
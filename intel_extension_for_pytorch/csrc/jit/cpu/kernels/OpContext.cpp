@@ -2,8 +2,11 @@
 #include <torch/all.h>
 #include "ConvPacked.h"
 #include "ConvTransposePacked.h"
+#include "GroupedLinearPacked.h"
 #include "LinearMKLPacked.h"
 #include "LinearPacked.h"
+#include "SparseLinearPacked.h"
+#include "WoqLinearPacked.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -233,6 +236,80 @@ int64_t IpexLinearMKLOpContext::get_in_features() {
   return op_context_.sgemm_sizes_[1];
 }
 
+c10::intrusive_ptr<GroupedLinearOpContext> IpexGroupedLinearOpContext::
+    create_context(
+        std::vector<at::Tensor>&& weights,
+        std::vector<at::Tensor>&& biases) {
+  auto op_context =
+      torch_ipex::cpu::detail::grouped_linear::create(weights, biases);
+  return c10::make_intrusive<IpexGroupedLinearOpContext>(
+      std::move(op_context));
+}
+
+std::vector<at::Tensor> IpexGroupedLinearOpContext::run(
+    const std::vector<at::Tensor>& inputs) {
+  return torch_ipex::cpu::detail::grouped_linear::run(op_context_, inputs);
+}
+
+detail::ContextGroupedLinear& IpexGroupedLinearOpContext::
+    get_grouped_context() {
+  return op_context_;
+}
+
+c10::intrusive_ptr<SparseLinearOpContext> IpexSparseLinearOpContext::
+    create_context(at::Tensor&& weight, c10::optional<at::Tensor>&& bias) {
+  auto op_context =
+      torch_ipex::cpu::detail::sparse_linear::create(weight, bias);
+  return c10::make_intrusive<IpexSparseLinearOpContext>(
+      std::move(op_context));
+}
+
+at::Tensor IpexSparseLinearOpContext::run(
+    const at::Tensor& input,
+    int64_t post_op) {
+  return torch_ipex::cpu::detail::sparse_linear::run(
+      op_context_, input, post_op);
+}
+
+detail::ContextSparseLinear& IpexSparseLinearOpContext::get_sparse_context() {
+  return op_context_;
+}
+
+c10::intrusive_ptr<WoqLinearOpContext> IpexWoqLinearOpContext::create_context(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size) {
+  auto op_context = torch_ipex::cpu::detail::woq_linear::create(
+      weight, bias, bits, group_size);
+  return c10::make_intrusive<IpexWoqLinearOpContext>(std::move(op_context));
+}
+
+c10::intrusive_ptr<WoqLinearOpContext> IpexWoqLinearOpContext::create_context(
+    SerializationTypeWoqLinearPrePack&& state) {
+  auto op_context =
+      torch_ipex::cpu::detail::woq_linear::create(std::move(state));
+  return c10::make_intrusive<IpexWoqLinearOpContext>(std::move(op_context));
+}
+
+at::Tensor IpexWoqLinearOpContext::run(const at::Tensor& input) {
+  return torch_ipex::cpu::detail::woq_linear::run(op_context_, input);
+}
+
+at::Tensor IpexWoqLinearOpContext::get_data_handle() {
+  at::Tensor ptr = at::empty(1, at::kLong);
+  ptr.data_ptr<int64_t>()[0] = reinterpret_cast<int64_t>(this);
+  return ptr;
+}
+
+at::Tensor IpexWoqLinearOpContext::to_public() {
+  return woq_linear_unpack(op_context_.weight_);
+}
+
+detail::ContextWoqLinear& IpexWoqLinearOpContext::get_woq_context() {
+  return op_context_;
+}
+
 at::Tensor IpexConvTransposeOpContext::run(
     const at::Tensor& input,
     const ideep::attr_t& attr) {
@@ -6,8 +6,12 @@
 
 #include "ContextConvTranspose.h"
 #include "ContextConvolution.h"
+#include "ContextGroupedLinear.h"
 #include "ContextLinear.h"
 #include "ContextLinearMKL.h"
+#include "ContextSparseLinear.h"
+#include "ContextWoqLinear.h"
+#include "PackedWeightFormat.h"
 #include "csrc/cpu/ideep/ideep.hpp"
 
 namespace torch_ipex {
@@ -33,7 +37,12 @@ class ConvolutionOpContext : public torch::jit::CustomClassHolder {
 
  public:
   SerializationTypeConvolutionPrePack unpack() {
-    auto orig_weight_ = this->to_public(this->get_at_packed_weight());
+    auto orig_weight_ = detail::is_packed_weight_serialization_enabled()
+        ? detail::serialize_packed_weight(
+              this->get_context().weight_packed_,
+              this->get_context().original_desc_,
+              this->get_context().at_weight_.scalar_type())
+        : this->to_public(this->get_at_packed_weight());
     auto orig_bias_ = this->get_context().at_bias_;
     auto groups_ = this->get_context().groups_;
     auto weight_is_channels_last_ =
@@ -150,7 +159,12 @@ class LinearOpContext : public torch::jit::CustomClassHolder {
 
  public:
   SerializationTypeLinearPrePack unpack() {
-    auto orig_weight_ = this->to_public(this->get_at_packed_weight());
+    auto orig_weight_ = detail::is_packed_weight_serialization_enabled()
+        ? detail::serialize_packed_weight(
+              this->get_context().weight_packed_,
+              this->get_context().original_desc_,
+              this->get_context().at_weight_.scalar_type())
+        : this->to_public(this->get_at_packed_weight());
     auto orig_bias_ = this->get_context().bias_;
     return std::make_tuple(orig_weight_, orig_bias_, batch_size_);
   }
@@ -299,6 +313,136 @@ class IpexLinearMKLOpContext final : public MKLOpContext {
       c10::optional<int64_t> batch_size);
 };
 
+using SerializationTypeGroupedLinearPrePack =
+    std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>>;
+
+class GroupedLinearOpContext : public torch::jit::CustomClassHolder {
+ public:
+  SerializationTypeGroupedLinearPrePack unpack() {
+    auto& context = this->get_grouped_context();
+    std::vector<at::Tensor> orig_weights;
+    for (const auto& packed_weight : context.packed_weights_) {
+      orig_weights.push_back(packed_weight.t().contiguous());
+    }
+    return std::make_tuple(orig_weights, context.biases_);
+  }
+
+  virtual std::vector<at::Tensor> run(
+      const std::vector<at::Tensor>& inputs) = 0;
+
+  virtual detail::ContextGroupedLinear& get_grouped_context() = 0;
+};
+
+class IpexGroupedLinearOpContext final : public GroupedLinearOpContext {
+ private:
+  detail::ContextGroupedLinear op_context_;
+
+ public:
+  IpexGroupedLinearOpContext(detail::ContextGroupedLinear&& op_context)
+      : op_context_(std::move(op_context)) {}
+
+  virtual std::vector<at::Tensor> run(
+      const std::vector<at::Tensor>& inputs) override;
+
+  virtual detail::ContextGroupedLinear& get_grouped_context() override;
+
+  static c10::intrusive_ptr<GroupedLinearOpContext> create_context(
+      std::vector<at::Tensor>&& weights,
+      std::vector<at::Tensor>&& biases);
+};
+
+using SerializationTypeSparseLinearPrePack =
+    std::tuple<at::Tensor, c10::optional<at::Tensor>>;
+
+class SparseLinearOpContext : public torch::jit::CustomClassHolder {
+ public:
+  SerializationTypeSparseLinearPrePack unpack() {
+    auto& context = this->get_sparse_context();
+    return std::make_tuple(
+        sparse_linear_unpack(context.weight_), context.bias_);
+  }
+
+  virtual at::Tensor run(const at::Tensor& input, int64_t post_op) = 0;
+
+  virtual detail::ContextSparseLinear& get_sparse_context() = 0;
+};
+
+class IpexSparseLinearOpContext final : public SparseLinearOpContext {
+ private:
+  detail::ContextSparseLinear op_context_;
+
+ public:
+  IpexSparseLinearOpContext(detail::ContextSparseLinear&& op_context)
+      : op_context_(std::move(op_context)) {}
+
+  virtual at::Tensor run(const at::Tensor& input, int64_t post_op) override;
+
+  virtual detail::ContextSparseLinear& get_sparse_context() override;
+
+  static c10::intrusive_ptr<SparseLinearOpContext> create_context(
+      at::Tensor&& weight,
+      c10::optional<at::Tensor>&& bias);
+};
+
+// The quantized weight is serialized as is, with its scales, bias, bits,
+// group size and in_features.
+using SerializationTypeWoqLinearPrePack = std::tuple<
+    at::Tensor,
+    at::Tensor,
+    c10::optional<at::Tensor>,
+    int64_t,
+    int64_t,
+    int64_t>;
+
+class WoqLinearOpContext : public torch::jit::CustomClassHolder {
+ public:
+  SerializationTypeWoqLinearPrePack unpack() {
+    auto& context = this->get_woq_context();
+    return std::make_tuple(
+        context.weight_.qweight,
+        context.weight_.scales,
+        context.bias_,
+        context.weight_.bits,
+        context.weight_.group_size,
+        context.weight_.in_features);
+  }
+
+  virtual at::Tensor run(const at::Tensor& input) = 0;
+
+  virtual at::Tensor get_data_handle() = 0;
+
+  // Returns the dequantized FP32 weight
+  virtual at::Tensor to_public() = 0;
+
+  virtual detail::ContextWoqLinear& get_woq_context() = 0;
+};
+
+class IpexWoqLinearOpContext final : public WoqLinearOpContext {
+ private:
+  detail::ContextWoqLinear op_context_;
+
+ public:
+  IpexWoqLinearOpContext(detail::ContextWoqLinear&& op_context)
+      : op_context_(std::move(op_context)) {}
+
+  virtual at::Tensor run(const at::Tensor& input) override;
+
+  virtual at::Tensor get_data_handle() override;
+
+  virtual at::Tensor to_public() override;
+
+  virtual detail::ContextWoqLinear& get_woq_context() override;
+
+  static c10::intrusive_ptr<WoqLinearOpContext> create_context(
+      at::Tensor&& weight,
+      c10::optional<at::Tensor>&& bias,
+      int64_t bits,
+      int64_t group_size);
+
+  static c10::intrusive_ptr<WoqLinearOpContext> create_context(
+      SerializationTypeWoqLinearPrePack&& state);
+};
+
 // deconv op
 using SerializationTypeConvTransposePrePack = std::tuple<
     at::Tensor,
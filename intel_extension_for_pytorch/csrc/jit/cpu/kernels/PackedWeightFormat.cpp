@@ -0,0 +1,153 @@
+#include "PackedWeightFormat.h"
+
+#include <ATen/ATen.h>
+#include <dnnl.h>
+
+#include "csrc/cpu/ideep/IDeepConversions.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+namespace {
+
+constexpr char kPackedWeightMagic[8] = "IPEXPKW";
+constexpr int32_t kPackedWeightVersion = 1;
+
+// The raw dnnl_memory_desc_t is stored, its layout is stable within a major
+// version of oneDNN.
+struct PackedWeightHeader {
+  char magic[8];
+  int32_t version;
+  int32_t dnnl_major_version;
+  int32_t isa;
+  int32_t dtype;
+  int64_t ndims;
+  int64_t sizes[DNNL_MAX_NDIMS];
+  int64_t strides[DNNL_MAX_NDIMS];
+  int64_t data_size;
+  dnnl_memory_desc_t packed_desc;
+};
+
+// The packed data starts at a 64-byte boundary of the blob, which keeps it
+// aligned for oneDNN since the blob storage is allocated 64-byte aligned.
+constexpr int64_t kPackedWeightDataOffset =
+    (sizeof(PackedWeightHeader) + 63) / 64 * 64;
+
+std::atomic<bool> packed_weight_serialization_enabled{false};
+
+const PackedWeightHeader& get_header(const at::Tensor& blob) {
+  return *reinterpret_cast<const PackedWeightHeader*>(
+      blob.data_ptr<uint8_t>());
+}
+
+} // namespace
+
+bool is_packed_weight_serialization_enabled() {
+  return packed_weight_serialization_enabled;
+}
+
+void set_packed_weight_serialization_enabled(bool enabled) {
+  packed_weight_serialization_enabled = enabled;
+}
+
+at::Tensor serialize_packed_weight(
+    const ideep::tensor& packed_weight,
+    const ideep::tensor::desc& original_desc,
+    at::ScalarType dtype) {
+  auto packed_desc = packed_weight.get_desc();
+  auto dims = original_desc.get_dims();
+  auto strides = original_desc.get_strides();
+  TORCH_CHECK(
+      dims.size() <= DNNL_MAX_NDIMS && strides.size() == dims.size(),
+      "serialize_packed_weight: unsupported weight desc");
+
+  PackedWeightHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kPackedWeightMagic, sizeof(header.magic));
+  header.version = kPackedWeightVersion;
+  header.dnnl_major_version = dnnl_version()->major;
+  header.isa = static_cast<int32_t>(dnnl_get_effective_cpu_isa());
+  header.dtype = static_cast<int32_t>(dtype);
+  header.ndims = dims.size();
+  std::copy(dims.begin(), dims.end(), header.sizes);
+  std::copy(strides.begin(), strides.end(), header.strides);
+  header.data_size = packed_desc.get_size();
+  header.packed_desc = packed_desc.data;
+
+  auto blob =
+      at::empty({kPackedWeightDataOffset + header.data_size}, at::kByte);
+  auto blob_data = blob.data_ptr<uint8_t>();
+  std::memcpy(blob_data, &header, sizeof(header));
+  std::memcpy(
+      blob_data + kPackedWeightDataOffset,
+      packed_weight.get_data_handle(),
+      header.data_size);
+  return blob;
+}
+
+bool is_serialized_packed_weight(const at::Tensor& tensor) {
+  if (!tensor.defined() || tensor.scalar_type() != at::kByte ||
+      tensor.dim() != 1 || !tensor.is_contiguous() ||
+      tensor.numel() < kPackedWeightDataOffset) {
+    return false;
+  }
+  const auto& header = get_header(tensor);
+  return std::memcmp(
+             header.magic, kPackedWeightMagic, sizeof(header.magic)) == 0 &&
+      tensor.numel() == kPackedWeightDataOffset + header.data_size;
+}
+
+SerializedPackedWeight::SerializedPackedWeight(const at::Tensor& blob)
+    : blob_(blob) {
+  const auto& header = get_header(blob_);
+  TORCH_CHECK(
+      header.version == kPackedWeightVersion &&
+          header.dnnl_major_version == dnnl_version()->major,
+      "The packed weight was serialized by an incompatible version, "
+      "please serialize the model again");
+  sizes_.assign(header.sizes, header.sizes + header.ndims);
+  strides_.assign(header.strides, header.strides + header.ndims);
+  dtype_ = static_cast<at::ScalarType>(header.dtype);
+  packed_desc_ = ideep::tensor::desc(header.packed_desc);
+  same_isa_ =
+      header.isa == static_cast<int32_t>(dnnl_get_effective_cpu_isa());
+}
+
+at::Tensor SerializedPackedWeight::public_weight_like() const {
+  return at::empty_strided(
+      sizes_, strides_, at::device(at::kCPU).dtype(dtype_));
+}
+
+std::tuple<ideep::tensor, at::Tensor> SerializedPackedWeight::pack(
+    const ideep::tensor::desc& expected_desc,
+    const at::TensorOptions& options) const {
+  auto data = blob_.data_ptr<uint8_t>() + kPackedWeightDataOffset;
+  bool same_layout = same_isa_ &&
+      dnnl_memory_desc_equal(&packed_desc_.data, &expected_desc.data) &&
+      packed_desc_.g() == expected_desc.g();
+  bool aligned = reinterpret_cast<uintptr_t>(data) % 64 == 0;
+
+  at::Tensor at_weight;
+  ideep::tensor packed_weight;
+  if (same_layout && aligned) {
+    // the blob is kept alive by the aten tensor
+    auto blob = blob_;
+    at_weight = aten_tensor_view_from_desc(
+        expected_desc, data, [blob](void*) {}, options);
+    packed_weight.init(expected_desc, at_weight.data_ptr());
+  } else {
+    at_weight = empty_aten_tensor_from_desc(expected_desc, options);
+    packed_weight.init(expected_desc, at_weight.data_ptr());
+    ideep::tensor serialized(packed_desc_, data);
+    packed_weight.feed_from(serialized);
+  }
+  return std::make_tuple(std::move(packed_weight), std::move(at_weight));
+}
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include "csrc/cpu/ideep/ideep.hpp"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+// Serialized prepacked weight.
+//
+// When enabled, the convolution and linear op contexts serialize their weight
+// in the packed blocked layout instead of reordering it back to the public
+// layout. The serialized weight takes the place of the public weight in the
+// pickled state, as a 1-D uint8 tensor holding a PackedWeightHeader (public
+// shape, packed desc, ISA tag) followed by the packed data. When such a state
+// is loaded, the op context adopts the data without a copy if the current
+// machine expects the same packed layout, and reorders it from the serialized
+// layout otherwise.
+
+bool is_packed_weight_serialization_enabled();
+
+void set_packed_weight_serialization_enabled(bool enabled);
+
+at::Tensor serialize_packed_weight(
+    const ideep::tensor& packed_weight,
+    const ideep::tensor::desc& original_desc,
+    at::ScalarType dtype);
+
+bool is_serialized_packed_weight(const at::Tensor& tensor);
+
+class SerializedPackedWeight {
+ public:
+  explicit SerializedPackedWeight(const at::Tensor& blob);
+
+  // An uninitialized tensor with the shape, strides and dtype of the public
+  // weight. The op contexts only take the shape and descs from it.
+  at::Tensor public_weight_like() const;
+
+  // Returns the packed weight in expected_desc and the aten tensor sharing its
+  // memory. The serialized data is adopted as is when it's already in
+  // expected_desc, otherwise it's reordered into a new buffer.
+  std::tuple<ideep::tensor, at::Tensor> pack(
+      const ideep::tensor::desc& expected_desc,
+      const at::TensorOptions& options) const;
+
+ private:
+  at::Tensor blob_;
+  std::vector<int64_t> sizes_;
+  std::vector<int64_t> strides_;
+  at::ScalarType dtype_;
+  ideep::tensor::desc packed_desc_;
+  bool same_isa_;
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
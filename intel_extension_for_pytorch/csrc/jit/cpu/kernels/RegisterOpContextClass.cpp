@@ -3,16 +3,22 @@
 
 #include "ConvPacked.h"
 #include "ConvTransposePacked.h"
+#include "GroupedLinearPacked.h"
 #include "LinearMKLPacked.h"
 #include "LinearPacked.h"
 #include "OpContext.h"
+#include "SparseLinearPacked.h"
+#include "WoqLinearPacked.h"
 
 namespace torch_ipex {
 namespace cpu {
 using detail::conv_transpose::createConvTransposePrePackOpContext;
 using detail::convolution::createConvolutionPrePackOpContext;
+using detail::grouped_linear::createGroupedLinearPrePackOpContext;
 using detail::linear::createLinearPrePackOpContext;
 using detail::mkl_sgemm::createLinearMKLPrePackOpContext;
+using detail::sparse_linear::createSparseLinearPrePackOpContext;
+using detail::woq_linear::createWoqLinearPrePackOpContext;
 
 TORCH_LIBRARY(ipex_prepack, m) {
   m.class_<ConvolutionOpContext>("ConvolutionOpContext")
@@ -78,6 +84,42 @@ TORCH_LIBRARY(ipex_prepack, m) {
       .def("pack", &torch_ipex::cpu::MKLOpContext::pack)
       .def("to_public", &torch_ipex::cpu::MKLOpContext::to_public)
       .def("get_data_handle", &torch_ipex::cpu::MKLOpContext::get_data_handle);
+  m.class_<GroupedLinearOpContext>("GroupedLinearOpContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<GroupedLinearOpContext>& op_context)
+              -> SerializationTypeGroupedLinearPrePack { // __getstate__
+            return op_context->unpack();
+          },
+          [](SerializationTypeGroupedLinearPrePack state)
+              -> c10::intrusive_ptr<GroupedLinearOpContext> { // __setstate__
+            return IpexGroupedLinearOpContext::create_context(
+                std::move(std::get<0>(state)), std::move(std::get<1>(state)));
+          });
+  m.class_<SparseLinearOpContext>("SparseLinearOpContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<SparseLinearOpContext>& op_context)
+              -> SerializationTypeSparseLinearPrePack { // __getstate__
+            return op_context->unpack();
+          },
+          [](SerializationTypeSparseLinearPrePack state)
+              -> c10::intrusive_ptr<SparseLinearOpContext> { // __setstate__
+            return createSparseLinearPrePackOpContext(
+                std::move(std::get<0>(state)), std::move(std::get<1>(state)));
+          });
+  m.class_<WoqLinearOpContext>("WoqLinearOpContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<WoqLinearOpContext>& op_context)
+              -> SerializationTypeWoqLinearPrePack { // __getstate__
+            return op_context->unpack();
+          },
+          [](SerializationTypeWoqLinearPrePack state)
+              -> c10::intrusive_ptr<WoqLinearOpContext> { // __setstate__
+            return IpexWoqLinearOpContext::create_context(std::move(state));
+          })
+      .def("to_public", &torch_ipex::cpu::WoqLinearOpContext::to_public)
+      .def(
+          "get_data_handle",
+          &torch_ipex::cpu::WoqLinearOpContext::get_data_handle);
   m.class_<ConvTransposeOpContext>("ConvTransposeOpContext")
       .def_pickle(
           [](const c10::intrusive_ptr<ConvTransposeOpContext>& op_context)
@@ -116,6 +158,15 @@ TORCH_LIBRARY(ipex_prepack, m) {
   m.def(
       "mkl_sgemm_prepack(Tensor W, Tensor? B, int? batch_size) "
       "-> __torch__.torch.classes.ipex_prepack.MKLOpContext");
+  m.def(
+      "grouped_linear_prepack(Tensor[] W, Tensor[] B) "
+      "-> __torch__.torch.classes.ipex_prepack.GroupedLinearOpContext");
+  m.def(
+      "sparse_linear_prepack(Tensor W, Tensor? B) "
+      "-> __torch__.torch.classes.ipex_prepack.SparseLinearOpContext");
+  m.def(
+      "woq_linear_prepack(Tensor W, Tensor? B, int bits, int group_size) "
+      "-> __torch__.torch.classes.ipex_prepack.WoqLinearOpContext");
   m.def(
       "conv_transpose_prepack(Tensor W, Tensor? B, int[] stride, "
       "int[] padding, int[] output_padding, int groups, int[] dilation, "
@@ -127,6 +178,12 @@ TORCH_LIBRARY_IMPL(ipex_prepack, AutogradCPU, m) {
   m.impl("convolution_prepack", TORCH_FN(createConvolutionPrePackOpContext));
   m.impl("linear_prepack", TORCH_FN(createLinearPrePackOpContext));
   m.impl("mkl_sgemm_prepack", TORCH_FN(createLinearMKLPrePackOpContext));
+  m.impl(
+      "grouped_linear_prepack",
+      TORCH_FN(createGroupedLinearPrePackOpContext));
+  m.impl(
+      "sparse_linear_prepack", TORCH_FN(createSparseLinearPrePackOpContext));
+  m.impl("woq_linear_prepack", TORCH_FN(createWoqLinearPrePackOpContext));
   m.impl(
       "conv_transpose_prepack", TORCH_FN(createConvTransposePrePackOpContext));
 }
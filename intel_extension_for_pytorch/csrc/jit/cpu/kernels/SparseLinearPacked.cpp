@@ -0,0 +1,120 @@
+#include "SparseLinearPacked.h"
+#include <ATen/Functions.h>
+#include <torch/csrc/autograd/function.h>
+
+#include <chrono>
+#include <limits>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace sparse_linear {
+
+namespace {
+
+// Weights whose compressed layout does more than this fraction of the dense
+// multiply-adds are not worth timing
+constexpr double kMaxWorkRatio = 0.5;
+constexpr int kTimedRuns = 3;
+
+template <typename Func>
+double best_time_us(const Func& func) {
+  // the first run warms up the caches and the primitive caches
+  func();
+  double best_us = std::numeric_limits<double>::max();
+  for (int i = 0; i < kTimedRuns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    best_us = std::min(
+        best_us,
+        std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+  }
+  return best_us;
+}
+
+} // namespace
+
+c10::intrusive_ptr<SparseLinearOpContext> createSparseLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias) {
+  RECORD_FUNCTION(
+      "ipex_prepack::createSparseLinearPrePackOpContext",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return IpexSparseLinearOpContext::create_context(
+      std::move(weight), std::move(bias));
+}
+
+at::Tensor sparse_linear_run(
+    const at::Tensor& input,
+    const c10::intrusive_ptr<SparseLinearOpContext>& op_context,
+    int64_t post_op) {
+  RECORD_FUNCTION(
+      "ipex_prepack::sparse_linear_run", c10::ArrayRef<c10::IValue>({}));
+
+  return op_context->run(input, post_op);
+}
+
+ContextSparseLinear create(
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias) {
+  if (bias.has_value()) {
+    TORCH_CHECK(
+        bias->dim() == 1 && bias->size(0) == weight.size(0) &&
+            bias->scalar_type() == at::kFloat,
+        "sparse_linear_prepack: expected a 1D FP32 bias of out_features");
+  }
+  return ContextSparseLinear{
+      sparse_linear_pack(weight),
+      bias.has_value() ? c10::make_optional(bias->contiguous())
+                       : c10::nullopt,
+  };
+}
+
+at::Tensor run(
+    const ContextSparseLinear& context,
+    const at::Tensor& input,
+    int64_t post_op) {
+  return sparse_linear_kernel(
+      input,
+      context.weight_,
+      context.bias_.has_value() ? context.bias_.value() : at::Tensor(),
+      post_op);
+}
+
+bool is_sparse_linear_faster(
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    int64_t batch_size) {
+  if (weight.dim() != 2 || weight.scalar_type() != at::kFloat ||
+      batch_size <= 0 || weight.numel() == 0) {
+    return false;
+  }
+  // the compressed layouts keep at least the nonzeros, so the dense weights
+  // are rejected by counting them before any packing or timing
+  double density =
+      static_cast<double>(at::count_nonzero(weight).item<int64_t>()) /
+      weight.numel();
+  if (density > kMaxWorkRatio) {
+    return false;
+  }
+  auto context = create(weight, bias);
+  if (sparse_linear_work_ratio(context.weight_) > kMaxWorkRatio) {
+    return false;
+  }
+  // at::linear runs the same MKL SGEMM as the dense prepacked path
+  auto input = at::randn({batch_size, weight.size(1)});
+  auto dense_weight = weight.contiguous();
+  double dense_us =
+      best_time_us([&]() { at::linear(input, dense_weight, bias); });
+  double sparse_us =
+      best_time_us([&]() { run(context, input, kSparseLinearNone); });
+  return sparse_us < dense_us;
+}
+
+} // namespace sparse_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include "ContextSparseLinear.h"
+#include "OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace sparse_linear {
+
+c10::intrusive_ptr<SparseLinearOpContext> createSparseLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias);
+
+at::Tensor sparse_linear_run(
+    const at::Tensor& input,
+    const c10::intrusive_ptr<SparseLinearOpContext>& op_context,
+    int64_t post_op);
+
+ContextSparseLinear create(
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias);
+
+at::Tensor run(
+    const ContextSparseLinear& context,
+    const at::Tensor& input,
+    int64_t post_op);
+
+// Whether the compressed weight beats the dense linear for inputs of
+// batch_size rows. The weight has to be sparse enough first, its zeros are
+// counted before it is packed, then both paths are timed on a random input.
+bool is_sparse_linear_faster(
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    int64_t batch_size);
+
+} // namespace sparse_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
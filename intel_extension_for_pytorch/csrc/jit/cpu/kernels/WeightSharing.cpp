@@ -0,0 +1,276 @@
+#include "WeightSharing.h"
+
+#include <ATen/ATen.h>
+#include <c10/util/Exception.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+namespace {
+
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+bool env_flag(const char* name) {
+  const char* val = std::getenv(name);
+  return val != nullptr && std::strcmp(val, "1") == 0;
+}
+
+struct WeightSharingConfig {
+  std::mutex mutex;
+  std::string dir;
+  bool hugepage;
+  bool numa_replica;
+
+  WeightSharingConfig()
+      : hugepage(env_flag("IPEX_WEIGHT_SHARING_HUGEPAGE")),
+        numa_replica(env_flag("IPEX_WEIGHT_SHARING_NUMA_REPLICA")) {
+    const char* val = std::getenv("IPEX_WEIGHT_SHARING_DIR");
+    if (val != nullptr) {
+      dir = val;
+    }
+  }
+};
+
+WeightSharingConfig& config() {
+  static WeightSharingConfig weight_sharing_config;
+  return weight_sharing_config;
+}
+
+// FNV-1a over 8-byte words, the hash names the file so it has to be stable
+// across processes
+std::string weight_key(const at::Tensor& weight) {
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&hash](uint64_t value) {
+    hash = (hash ^ value) * 1099511628211ULL;
+  };
+  mix(static_cast<uint64_t>(weight.scalar_type()));
+  for (auto size : weight.sizes()) {
+    mix(static_cast<uint64_t>(size));
+  }
+  auto data = static_cast<const char*>(weight.data_ptr());
+  size_t nbytes = weight.nbytes();
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= nbytes; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    mix(word);
+  }
+  for (; i < nbytes; i++) {
+    mix(static_cast<unsigned char>(data[i]));
+  }
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash << "_"
+      << std::dec << nbytes;
+  return key.str();
+}
+
+// The NUMA node of the CPU the caller runs on, 0 if it can't be told
+int current_numa_node() {
+  int cpu = sched_getcpu();
+  if (cpu < 0) {
+    return 0;
+  }
+  auto cpu_dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+  DIR* dir = opendir(cpu_dir.c_str());
+  if (dir == nullptr) {
+    return 0;
+  }
+  int node = 0;
+  while (struct dirent* entry = readdir(dir)) {
+    if (std::sscanf(entry->d_name, "node%d", &node) == 1) {
+      break;
+    }
+  }
+  closedir(dir);
+  return node;
+}
+
+// Writes the weight file under a temporary name and publishes it with
+// link(), which fails if another process has published it meanwhile. The
+// first file published is kept, the contents are the same anyway.
+bool publish_weight_file(
+    const std::string& path,
+    const void* data,
+    size_t nbytes) {
+  auto tmp_path = path + ".tmp." + std::to_string(getpid());
+  int fd = open(tmp_path.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  auto bytes = static_cast<const char*>(data);
+  size_t written = 0;
+  while (written < nbytes) {
+    auto n = write(fd, bytes + written, nbytes - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    written += n;
+  }
+  close(fd);
+  bool published = written == nbytes &&
+      (link(tmp_path.c_str(), path.c_str()) == 0 || errno == EEXIST);
+  unlink(tmp_path.c_str());
+  return published;
+}
+
+// Maps nbytes of fd privately, at a 2MB-aligned address when hugepage is
+// set. Returns nullptr on failure.
+void* map_weight_file(int fd, size_t nbytes, bool hugepage) {
+  const int prot = PROT_READ | PROT_WRITE;
+  if (!hugepage) {
+    void* addr = mmap(nullptr, nbytes, prot, MAP_PRIVATE, fd, 0);
+    return addr == MAP_FAILED ? nullptr : addr;
+  }
+
+  // Reserve a range large enough to hold an aligned mapping and give back
+  // what's left around it once mapped.
+  size_t reserved_size = nbytes + kHugePageSize;
+  void* reserved = mmap(
+      nullptr,
+      reserved_size,
+      PROT_NONE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+      -1,
+      0);
+  if (reserved == MAP_FAILED) {
+    return nullptr;
+  }
+  auto begin = reinterpret_cast<uintptr_t>(reserved);
+  auto aligned = (begin + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  void* addr = mmap(
+      reinterpret_cast<void*>(aligned),
+      nbytes,
+      prot,
+      MAP_PRIVATE | MAP_FIXED,
+      fd,
+      0);
+  if (addr == MAP_FAILED) {
+    munmap(reserved, reserved_size);
+    return nullptr;
+  }
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  auto end = aligned + (nbytes + page_size - 1) / page_size * page_size;
+  if (aligned > begin) {
+    munmap(reserved, aligned - begin);
+  }
+  if (begin + reserved_size > end) {
+    munmap(reinterpret_cast<void*>(end), begin + reserved_size - end);
+  }
+  madvise(addr, nbytes, MADV_HUGEPAGE);
+  return addr;
+}
+
+} // namespace
+
+void set_weight_sharing_dir(const std::string& dir) {
+  std::lock_guard<std::mutex> lock(config().mutex);
+  config().dir = dir;
+}
+
+std::string get_weight_sharing_dir() {
+  std::lock_guard<std::mutex> lock(config().mutex);
+  return config().dir;
+}
+
+bool is_weight_sharing_enabled() {
+  return !get_weight_sharing_dir().empty();
+}
+
+void set_weight_sharing_hugepage(bool enabled) {
+  std::lock_guard<std::mutex> lock(config().mutex);
+  config().hugepage = enabled;
+}
+
+bool is_weight_sharing_hugepage() {
+  std::lock_guard<std::mutex> lock(config().mutex);
+  return config().hugepage;
+}
+
+void set_weight_sharing_numa_replica(bool enabled) {
+  std::lock_guard<std::mutex> lock(config().mutex);
+  config().numa_replica = enabled;
+}
+
+bool is_weight_sharing_numa_replica() {
+  std::lock_guard<std::mutex> lock(config().mutex);
+  return config().numa_replica;
+}
+
+at::Tensor share_weight(const at::Tensor& weight) {
+  std::string dir;
+  bool hugepage, numa_replica;
+  {
+    std::lock_guard<std::mutex> lock(config().mutex);
+    dir = config().dir;
+    hugepage = config().hugepage;
+    numa_replica = config().numa_replica;
+  }
+  if (dir.empty() || !weight.is_contiguous() || weight.nbytes() == 0) {
+    return weight;
+  }
+
+  auto path = dir + "/ipex_weight_" + weight_key(weight);
+  if (numa_replica) {
+    path += "_node" + std::to_string(current_numa_node());
+  }
+  path += ".bin";
+
+  // Serializes the op contexts of this process creating the same file
+  static std::mutex publish_mutex;
+  std::lock_guard<std::mutex> lock(publish_mutex);
+  size_t nbytes = weight.nbytes();
+  if (access(path.c_str(), F_OK) != 0 &&
+      !publish_weight_file(path, weight.data_ptr(), nbytes)) {
+    TORCH_WARN(
+        "Failed to write the shared weight file ",
+        path,
+        ", the weight is not shared");
+    return weight;
+  }
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    TORCH_WARN("Failed to open the shared weight file ", path);
+    return weight;
+  }
+  struct stat st;
+  void* addr = nullptr;
+  if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == nbytes) {
+    addr = map_weight_file(fd, nbytes, hugepage);
+  }
+  // the mapping stays valid once the file is closed
+  close(fd);
+  if (addr == nullptr) {
+    TORCH_WARN("Failed to map the shared weight file ", path);
+    return weight;
+  }
+  return at::from_blob(
+      addr,
+      weight.sizes(),
+      weight.strides(),
+      [addr, nbytes](void*) { munmap(addr, nbytes); },
+      weight.options());
+}
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include <string>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+// File-backed weight sharing.
+//
+// When a directory is set, the op contexts move their packed weights into
+// files under it and map them back with mmap. Processes packing the same
+// weights map the same file, so the kernel keeps a single physical copy of
+// them in the page cache however many instances run on the host. The files
+// are named after a hash of the packed data and are written once, by the
+// first process that needs them. Pages are faulted in lazily on first use.
+//
+// The mapping is private, a process writing to its weights (e.g. training)
+// gets its own copy of the pages it writes.
+//
+// Options, also settable with the environment variables in brackets:
+//   dir [IPEX_WEIGHT_SHARING_DIR]: where the weight files live, sharing is
+//     disabled when it's empty.
+//   hugepage [IPEX_WEIGHT_SHARING_HUGEPAGE=1]: aligns the mappings to 2MB
+//     and advises transparent huge pages for them. It only takes effect when
+//     dir is on a tmpfs mounted with huge=within_size or huge=always.
+//   numa_replica [IPEX_WEIGHT_SHARING_NUMA_REPLICA=1]: keeps one copy of the
+//     weights per NUMA node, the node of the CPU creating the op context.
+
+void set_weight_sharing_dir(const std::string& dir);
+
+std::string get_weight_sharing_dir();
+
+bool is_weight_sharing_enabled();
+
+void set_weight_sharing_hugepage(bool enabled);
+
+bool is_weight_sharing_hugepage();
+
+void set_weight_sharing_numa_replica(bool enabled);
+
+bool is_weight_sharing_numa_replica();
+
+// Returns a tensor with the data, sizes and strides of weight, backed by the
+// shared file of its data. The file is created if it doesn't exist yet.
+// weight is returned as is when sharing is disabled or fails.
+at::Tensor share_weight(const at::Tensor& weight);
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,74 @@
+#include "WoqLinearPacked.h"
+#include <ATen/Functions.h>
+#include <torch/csrc/autograd/function.h>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace woq_linear {
+
+c10::intrusive_ptr<WoqLinearOpContext> createWoqLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size) {
+  RECORD_FUNCTION(
+      "ipex_prepack::createWoqLinearPrePackOpContext",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return IpexWoqLinearOpContext::create_context(
+      std::move(weight), std::move(bias), bits, group_size);
+}
+
+at::Tensor woq_linear_run(
+    const at::Tensor& input,
+    const c10::intrusive_ptr<WoqLinearOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::woq_linear_run", c10::ArrayRef<c10::IValue>({}));
+
+  return op_context->run(input);
+}
+
+ContextWoqLinear create(
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    int64_t bits,
+    int64_t group_size) {
+  if (bias.has_value()) {
+    TORCH_CHECK(
+        bias->dim() == 1 && bias->size(0) == weight.size(0),
+        "woq_linear_prepack: expected a 1D bias of out_features");
+  }
+  return ContextWoqLinear{
+      woq_linear_pack(weight, bits, group_size),
+      bias.has_value() ? c10::make_optional(bias->to(at::kFloat).contiguous())
+                       : c10::nullopt,
+  };
+}
+
+ContextWoqLinear create(SerializationTypeWoqLinearPrePack&& state) {
+  WoqLinearWeight weight;
+  weight.qweight = std::move(std::get<0>(state));
+  weight.scales = std::move(std::get<1>(state));
+  weight.bits = std::get<3>(state);
+  weight.group_size = std::get<4>(state);
+  weight.out_features = weight.qweight.size(0);
+  weight.in_features = std::get<5>(state);
+  TORCH_CHECK(
+      (weight.bits == 8 || weight.bits == 4) && weight.group_size > 0 &&
+          weight.scales.size(1) * weight.group_size == weight.in_features,
+      "woq_linear: invalid serialized quantized weight");
+  return ContextWoqLinear{std::move(weight), std::move(std::get<2>(state))};
+}
+
+at::Tensor run(const ContextWoqLinear& context, const at::Tensor& input) {
+  return woq_linear_kernel(
+      input,
+      context.weight_,
+      context.bias_.has_value() ? context.bias_.value() : at::Tensor());
+}
+
+} // namespace woq_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
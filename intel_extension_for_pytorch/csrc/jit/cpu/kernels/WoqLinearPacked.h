@@ -0,0 +1,36 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include "ContextWoqLinear.h"
+#include "OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace woq_linear {
+
+c10::intrusive_ptr<WoqLinearOpContext> createWoqLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size);
+
+at::Tensor woq_linear_run(
+    const at::Tensor& input,
+    const c10::intrusive_ptr<WoqLinearOpContext>& op_context);
+
+ContextWoqLinear create(
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    int64_t bits,
+    int64_t group_size);
+
+// Rebuilds a context from the quantized state of a serialized one
+ContextWoqLinear create(SerializationTypeWoqLinearPrePack&& state);
+
+at::Tensor run(const ContextWoqLinear& context, const at::Tensor& input);
+
+} // namespace woq_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,215 @@
+#include "cat_elimination.h"
+#include "static_memory_planning.h"
+
+#include <ATen/ATen.h>
+#include <ATen/record_function.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/graph_iterator.h>
+
+namespace torch_ipex {
+namespace jit {
+
+using namespace torch::jit;
+
+namespace {
+
+struct CompleteType {
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> strides;
+  at::ScalarType dtype;
+};
+
+// Fills the sizes, strides and dtype of a CPU tensor value whose type is
+// complete, returns false otherwise.
+bool getCompleteType(Value* value, CompleteType& complete) {
+  auto type = value->type()->cast<TensorType>();
+  if (!type || !type->scalarType().has_value() ||
+      !type->device().has_value() || !type->device()->is_cpu()) {
+    return false;
+  }
+  if (type->requiresGrad().has_value() && type->requiresGrad().value()) {
+    return false;
+  }
+  auto sizes = type->sizes().concrete_sizes();
+  auto strides = type->strides().concrete_sizes();
+  if (!sizes.has_value() || !strides.has_value() || sizes->empty()) {
+    return false;
+  }
+  complete.sizes = *sizes;
+  complete.strides = *strides;
+  complete.dtype = *type->scalarType();
+  return true;
+}
+
+// Whether the producer of input may write into its slice of the concatenated
+// output: it has to be an op with an out variant whose only use is the
+// concatenation, and the slice has to be laid out the way the op would
+// allocate its output.
+bool canWriteIntoSlice(
+    Value* input,
+    const CompleteType& input_type,
+    const CompleteType& output_type,
+    Node* cat) {
+  Node* producer = input->node();
+  if (!opsWithOutVariant().count(producer->kind()) ||
+      producer->inputs().size() != 2 || producer->outputs().size() != 1 ||
+      producer->owningBlock() != cat->owningBlock() ||
+      input->uses().size() != 1) {
+    return false;
+  }
+  // the slice shares the strides of the output, they have to match the ones
+  // of the producer output on all the dims which are not of size 1
+  for (size_t d = 0; d < input_type.sizes.size(); d++) {
+    if (input_type.sizes[d] != 1 &&
+        input_type.strides[d] != output_type.strides[d]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool eliminateCat(std::shared_ptr<Graph>& graph, Node* cat) {
+  Node* list = cat->input(0)->node();
+  auto dim_ivalue = toIValue(cat->input(1));
+  if (list->kind() != prim::ListConstruct ||
+      cat->input(0)->uses().size() != 1 || !dim_ivalue.has_value() ||
+      !dim_ivalue->isInt()) {
+    return false;
+  }
+  CompleteType output_type;
+  if (!getCompleteType(cat->output(), output_type)) {
+    return false;
+  }
+  const int64_t rank = output_type.sizes.size();
+  int64_t dim = dim_ivalue->toInt();
+  dim = dim < 0 ? dim + rank : dim;
+  if (dim < 0 || dim >= rank) {
+    return false;
+  }
+
+  std::vector<int64_t> starts;
+  std::vector<int64_t> lengths;
+  std::vector<bool> writes_into_slice;
+  Node* first_producer = nullptr;
+  int64_t start = 0;
+  for (auto* input : list->inputs()) {
+    CompleteType input_type;
+    if (!getCompleteType(input, input_type) ||
+        input_type.sizes.size() != output_type.sizes.size() ||
+        input_type.dtype != output_type.dtype) {
+      return false;
+    }
+    for (int64_t d = 0; d < rank; d++) {
+      if (d != dim && input_type.sizes[d] != output_type.sizes[d]) {
+        return false;
+      }
+    }
+    starts.push_back(start);
+    lengths.push_back(input_type.sizes[dim]);
+    start += input_type.sizes[dim];
+    bool can_write = canWriteIntoSlice(input, input_type, output_type, cat);
+    writes_into_slice.push_back(can_write);
+    if (can_write &&
+        (first_producer == nullptr ||
+         input->node()->isBefore(first_producer))) {
+      first_producer = input->node();
+    }
+  }
+  if (first_producer == nullptr || start != output_type.sizes[dim]) {
+    return false;
+  }
+
+  // the buffer and all the slices are created ahead of the first producer,
+  // they only depend on constants
+  std::vector<Value*> slices;
+  Value* buffer = nullptr;
+  {
+    WithInsertPoint guard(first_producer);
+    buffer = graph->insert(
+        Symbol::fromQualString("ipex::cat_buffer"),
+        {output_type.sizes,
+         output_type.strides,
+         static_cast<int64_t>(output_type.dtype)});
+    buffer->setType(cat->output()->type());
+    for (size_t i = 0; i < starts.size(); i++) {
+      slices.push_back(
+          graph->insert(aten::narrow, {buffer, dim, starts[i], lengths[i]}));
+    }
+  }
+  for (size_t i = 0; i < slices.size(); i++) {
+    if (!writes_into_slice[i]) {
+      continue;
+    }
+    Node* producer = list->input(i)->node();
+    // kind is unchanged, the extra output argument selects the ".out"
+    // overload of the op
+    Node* out_node = graph->create(
+        producer->kind(),
+        {producer->input(0), slices[i], producer->input(1)},
+        1);
+    out_node->insertBefore(producer);
+    out_node->output()->setType(producer->output()->type());
+    producer->output()->replaceAllUsesWith(out_node->output());
+    producer->destroy();
+  }
+
+  WithInsertPoint guard(cat);
+  Value* slice_list =
+      graph->insertNode(graph->createList(TensorType::get(), slices))
+          ->output();
+  Value* result = graph->insert(
+      Symbol::fromQualString("ipex::cat_from_slices"),
+      {buffer, slice_list, cat->input(0), dim});
+  result->setType(cat->output()->type());
+  cat->output()->replaceAllUsesWith(result);
+  cat->destroy();
+  return true;
+}
+
+} // namespace
+
+at::Tensor cat_from_slices(
+    at::Tensor& buffer,
+    const std::vector<at::Tensor>& slices,
+    const std::vector<at::Tensor>& results,
+    int64_t dim) {
+  RECORD_FUNCTION("ipex::cat_from_slices", c10::ArrayRef<c10::IValue>({}));
+
+  // the buffer was allocated for the profiled shapes, the ops fed with other
+  // ones have allocated their outputs and are concatenated as usual
+  for (size_t i = 0; i < results.size(); i++) {
+    if (results[i].sizes() != slices[i].sizes() ||
+        results[i].scalar_type() != slices[i].scalar_type()) {
+      return at::cat(results, dim);
+    }
+  }
+  for (size_t i = 0; i < results.size(); i++) {
+    if (results[i].data_ptr() != slices[i].data_ptr() ||
+        results[i].strides() != slices[i].strides()) {
+      slices[i].copy_(results[i]);
+    }
+  }
+  return buffer;
+}
+
+void CatElimination(std::shared_ptr<Graph>& graph) {
+  std::vector<Node*> cats;
+  DepthFirstGraphNodeIterator it(graph);
+  for (Node* node = it.next(); node != nullptr; node = it.next()) {
+    if (node->kind() == aten::cat) {
+      cats.push_back(node);
+    }
+  }
+  int64_t eliminated = 0;
+  for (auto* cat : cats) {
+    if (eliminateCat(graph, cat)) {
+      eliminated++;
+    }
+  }
+  GRAPH_DEBUG("CatElimination: eliminated ", eliminated, " aten::cat");
+  GRAPH_DUMP("After CatElimination", graph);
+}
+
+} // namespace jit
+} // namespace torch_ipex
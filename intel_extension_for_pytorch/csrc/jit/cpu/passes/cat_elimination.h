@@ -0,0 +1,30 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch_ipex {
+namespace jit {
+
+// Removes the copies of aten::cat whose inputs are produced by IPEX ops with
+// an out variant (ipex_prepack::linear_*_run and
+// ipex_prepack::convolution_*_run). The concatenated output is allocated once
+// from its profiled type by ipex::cat_buffer, and each producer writes
+// straight into its slice of it through its ".out" overload. Only slices
+// which are dense in the layout the producer would allocate are handed out,
+// since the out variants fall back to allocating otherwise.
+//
+// ipex::cat_from_slices finishes the concatenation: the inputs which were not
+// written in place are copied into their slice, and when a runtime shape no
+// longer matches the profiled one it falls back to at::cat.
+void CatElimination(std::shared_ptr<torch::jit::Graph>& graph);
+
+// Backs ipex::cat_from_slices. Returns buffer when every result either is its
+// slice or could be copied into it, the at::cat of the results otherwise.
+at::Tensor cat_from_slices(
+    at::Tensor& buffer,
+    const std::vector<at::Tensor>& slices,
+    const std::vector<at::Tensor>& results,
+    int64_t dim);
+
+} // namespace jit
+} // namespace torch_ipex
@@ -3,6 +3,7 @@
 #include "utils.h"
 
 #include <ATen/code_template.h>
+#include <c10/core/MemoryFormat.h>
 #include <torch/csrc/jit/passes/remove_mutation.h>
 
 namespace torch_ipex {
@@ -209,6 +210,26 @@ void FuseAddLayerNorm(std::shared_ptr<Graph>& graph) {
   rewriter_aten.runOnGraph(graph);
 }
 
+void FuseGroupNormSilu(std::shared_ptr<Graph>& graph) {
+  auto aten_group_norm_silu = at::jit::CodeTemplate(R"(
+      graph(%input, %num_groups:int, %w, %b, %eps:float, %cudnn_enabled:bool):
+        %r = aten::group_norm(%input, %num_groups, %w, %b, %eps, %cudnn_enabled)
+        %s = aten::${silu_op}(%r)
+        return (%s) )");
+  std::string fused_group_norm_silu = R"(
+      graph(%input, %num_groups:int, %w, %b, %eps:float, %cudnn_enabled:bool):
+        %s = ipex::group_norm_silu(%input, %num_groups, %w, %b, %eps, %cudnn_enabled)
+        return (%s) )";
+  for (const auto& silu_op : {"silu", "silu_"}) {
+    at::jit::TemplateEnv env;
+    env.s("silu_op", silu_op);
+    SubgraphRewriter rewriter;
+    rewriter.RegisterRewritePattern(
+        aten_group_norm_silu.format(env), fused_group_norm_silu);
+    rewriter.runOnGraph(graph);
+  }
+}
+
 void FuseMatmulDivOrMul(std::shared_ptr<Graph>& graph) {
   const std::string div_str = R"(div)";
   const std::string div_inplace_str = R"(div_)";
@@ -892,7 +913,10 @@ void FuseLinearSwishCustomized(std::shared_ptr<Graph>& graph) {
   ls_fusion.runOnGraph(graph);
 }
 
-// This path will be removed after pytorch offical path is optimized well.
+// The NHWC and quantized inputs are pooled by pooling_channels_last, so only
+// the max_pool2d of such inputs are replaced. The oneDNN path of
+// ipex::max_pool2d will be removed after pytorch offical path is optimized
+// well.
 void replaceAtenMaxPool2dWithIpexMaxPool2d(std::shared_ptr<Graph>& graph) {
   std::string max_pool2d = R"(
       graph(%a, %kernel_size:int[], %stride:int[], %padding:int[], %dilation:int[], %ceil_mode:bool):
@@ -911,17 +935,60 @@ void replaceAtenMaxPool2dWithIpexMaxPool2d(std::shared_ptr<Graph>& graph) {
     if (!input->type()->cast<TensorType>()) {
       return false;
     }
-    auto dtype_option = input->type()->cast<TensorType>()->scalarType();
+    auto input_type = input->type()->cast<TensorType>();
+    auto dtype_option = input_type->scalarType();
     if (!dtype_option) {
       return false;
     }
-    if (dtype_option.value() != c10::ScalarType::BFloat16 ||
+    if (dtype_option.value() == c10::ScalarType::QUInt8 ||
+        dtype_option.value() == c10::ScalarType::QInt8) {
+      return true;
+    }
+    if (dtype_option.value() != c10::ScalarType::BFloat16 &&
         dtype_option.value() != c10::ScalarType::Float) {
       return false;
     }
-    return true;
+    // the NCHW inputs keep aten::max_pool2d
+    auto sizes = input_type->sizes().concrete_sizes();
+    auto strides = input_type->strides().concrete_sizes();
+    return sizes.has_value() && strides.has_value() && sizes->size() == 4 &&
+        c10::is_channels_last_strides_2d(sizes.value(), strides.value());
   };
   rewriter_max_pool2d.runOnGraph(graph, filter);
+
+  // the ReLU is applied to the input rows while they are pooled
+  std::string relu_max_pool2d = R"(
+      graph(%a, %kernel_size:int[], %stride:int[], %padding:int[], %dilation:int[], %ceil_mode:bool):
+        %x = aten::relu(%a)
+        %res = ipex::max_pool2d(%x, %kernel_size, %stride, %padding, %dilation, %ceil_mode)
+        return (%res) )";
+  std::string max_pool2d_relu = R"(
+      graph(%a, %kernel_size:int[], %stride:int[], %padding:int[], %dilation:int[], %ceil_mode:bool):
+        %res = ipex::max_pool2d_relu(%a, %kernel_size, %stride, %padding, %dilation, %ceil_mode)
+        return (%res) )";
+  // the pooled rows are quantized before they are stored
+  std::string max_pool2d_quantize_per_tensor = R"(
+      graph(%a, %kernel_size:int[], %stride:int[], %padding:int[], %dilation:int[], %ceil_mode:bool, %scale, %zero_point, %dtype):
+        %x = ipex::max_pool2d(%a, %kernel_size, %stride, %padding, %dilation, %ceil_mode)
+        %res = aten::quantize_per_tensor(%x, %scale, %zero_point, %dtype)
+        return (%res) )";
+  std::string max_pool2d_quantize = R"(
+      graph(%a, %kernel_size:int[], %stride:int[], %padding:int[], %dilation:int[], %ceil_mode:bool, %scale, %zero_point, %dtype):
+        %res = ipex::max_pool2d_quantize(%a, %kernel_size, %stride, %padding, %dilation, %ceil_mode, %scale, %zero_point, %dtype)
+        return (%res) )";
+  auto single_use_filter =
+      [](const Match& match,
+         const std::unordered_map<std::string, Value*>& vmap) {
+        return match.values_map.at(vmap.at("x"))->uses().size() == 1;
+      };
+  SubgraphRewriter rewriter_max_pool2d_relu;
+  rewriter_max_pool2d_relu.RegisterRewritePattern(
+      relu_max_pool2d, max_pool2d_relu);
+  rewriter_max_pool2d_relu.runOnGraph(graph, single_use_filter);
+  SubgraphRewriter rewriter_max_pool2d_quantize;
+  rewriter_max_pool2d_quantize.RegisterRewritePattern(
+      max_pool2d_quantize_per_tensor, max_pool2d_quantize);
+  rewriter_max_pool2d_quantize.runOnGraph(graph, single_use_filter);
 }
 
 } // namespace graph_rewrite
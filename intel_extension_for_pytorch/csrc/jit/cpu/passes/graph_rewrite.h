@@ -14,7 +14,8 @@ namespace graph_rewrite {
 void FuseShuffle(std::shared_ptr<torch::jit::Graph>& graph);
 void FuseMHAScoreCalc(std::shared_ptr<torch::jit::Graph>& graph);
 void FuseLinearSwishCustomized(std::shared_ptr<torch::jit::Graph>& graph);
-// This path will be removed after pytorch offical path is optimized well.
+// Replaces FP32, BF16 and quantized aten::max_pool2d with ipex::max_pool2d,
+// then fuses a preceding aten::relu or a following aten::quantize_per_tensor.
 void replaceAtenMaxPool2dWithIpexMaxPool2d(
     std::shared_ptr<torch::jit::Graph>& graph);
 void fuseBmmAdd(std::shared_ptr<torch::jit::Graph>& graph);
@@ -40,10 +41,13 @@ void replaceFrozenIPEXConvWithAtenConv(
 void replaceFrozenIPEXLinearWithAtenLinear(
     std::shared_ptr<torch::jit::Graph>& graph,
     const bool& use_mkl_sgemm);
+void replaceFrozenIPEXWoqLinearWithRun(
+    std::shared_ptr<torch::jit::Graph>& graph);
 void insertPrePackedConvOp(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseConvWithEltwise(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseConvAddRelu(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseBottleneck(std::shared_ptr<torch::jit::Graph>& graph);
+void fuseConvGroupNormSilu(std::shared_ptr<torch::jit::Graph>& graph);
 
 void RecordAtenLinearNodes(
     std::shared_ptr<torch::jit::Graph>& graph,
@@ -54,9 +58,11 @@ void insertPrePackedLinearOp(
     std::unordered_set<torch::jit::Node*>& aten_linear,
     const bool& use_mkl_sgemm);
 void fuseLinearWithEltwise(std::shared_ptr<torch::jit::Graph>& graph);
+void fuseSparseLinearWithEltwise(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseLinearAddRelu(std::shared_ptr<torch::jit::Graph>& graph);
 
 void FuseAddLayerNorm(std::shared_ptr<torch::jit::Graph>& graph);
+void FuseGroupNormSilu(std::shared_ptr<torch::jit::Graph>& graph);
 void FuseMatmulDivOrMul(std::shared_ptr<torch::jit::Graph>& graph);
 void FuseConcatBnRelu(std::shared_ptr<torch::jit::Graph>& graph);
 
@@ -65,6 +71,7 @@ void fuseConvTransposeWithEltwise(std::shared_ptr<torch::jit::Graph>& graph);
 void fuseConvTransposeAdd(std::shared_ptr<torch::jit::Graph>& graph);
 
 void FusedEinsumPost(std::shared_ptr<torch::jit::Graph>& graph);
+void FusedEinsumMultiOperands(std::shared_ptr<torch::jit::Graph>& graph);
 
 void FusedTransFreeMha(std::shared_ptr<torch::jit::Graph>& graph);
 } // namespace graph_rewrite
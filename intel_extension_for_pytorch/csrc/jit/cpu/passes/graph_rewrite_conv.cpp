@@ -456,6 +456,32 @@ void fuseBottleneck(std::shared_ptr<Graph>& graph) {
   rewriter_v2.runOnGraph(graph, filter_v2);
 }
 
+void fuseConvGroupNormSilu(std::shared_ptr<Graph>& graph) {
+  // conv -> GroupNorm -> SiLU of the diffusion UNet/VAE blocks, the group norm
+  // and SiLU are already fused by FuseGroupNormSilu
+  std::string conv_group_norm_silu = R"(
+    graph(%input, %packed_weight, %num_groups:int, %w, %b, %eps:float, %cudnn_enabled:bool):
+        %x = ipex_prepack::convolution_run(%input, %packed_weight)
+        %res = ipex::group_norm_silu(%x, %num_groups, %w, %b, %eps, %cudnn_enabled)
+        return (%res))";
+  std::string conv_group_norm_silu_fused = R"(
+    graph(%input, %packed_weight, %num_groups:int, %w, %b, %eps:float, %cudnn_enabled:bool):
+        %res = ipex_prepack::convolution_group_norm_silu_run(%input, %num_groups, %w, %b, %eps, %packed_weight)
+        return (%res))";
+
+  // The fused op normalizes the conv output in place, which is only valid
+  // when the group norm is its single use.
+  auto filter = [](const Match& match,
+                   const std::unordered_map<std::string, Value*>& vmap) {
+    auto conv_output = match.values_map.at(vmap.at("x"));
+    return conv_output->uses().size() == 1;
+  };
+  SubgraphRewriter rewriter;
+  rewriter.RegisterRewritePattern(
+      conv_group_norm_silu, conv_group_norm_silu_fused);
+  rewriter.runOnGraph(graph, filter);
+}
+
 } // namespace graph_rewrite
 } // namespace jit
 } // namespace torch_ipex
@@ -48,6 +48,35 @@ void FusedEinsumPost(std::shared_ptr<Graph>& graph) {
   rewriter_einsum_binary.runOnGraph(graph, ipex_einsum_filter);
 }
 
+void FusedEinsumMultiOperands(std::shared_ptr<Graph>& graph) {
+  // einsum of 3 or more operands, contracted pairwise in a planned order
+  auto multi_operands_filter =
+      [](const Match& match,
+         const std::unordered_map<std::string, Value*>& vmap) {
+        const auto& match_vmap = match.values_map;
+        auto equation = torch_ipex::jit::graph_rewrite_helper::getIValue(
+            "equation", match_vmap, vmap);
+        if (!equation.has_value() || !equation->isString()) {
+          return false;
+        }
+        auto equation_view = equation->toStringView();
+        int num_ops =
+            std::count(equation_view.begin(), equation_view.end(), ',') + 1;
+        return num_ops > 2;
+      };
+  SubgraphRewriter rewriter_einsum;
+  std::string aten_einsum = R"(
+     graph(%equation, %inputs):
+        %res = aten::einsum(%equation, %inputs)
+        return (%res))";
+  std::string ipex_einsum = R"(
+    graph(%equation, %inputs):
+        %res = ipex::einsum(%equation, %inputs)
+        return (%res))";
+  rewriter_einsum.RegisterRewritePattern(aten_einsum, ipex_einsum);
+  rewriter_einsum.runOnGraph(graph, multi_operands_filter);
+}
+
 } // namespace graph_rewrite
 } // namespace jit
 } // namespace torch_ipex
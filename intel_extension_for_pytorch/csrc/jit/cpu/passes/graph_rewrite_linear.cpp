@@ -1,5 +1,7 @@
 #include <ATen/code_template.h>
 #include "csrc/cpu/ideep/ideep.hpp"
+#include "csrc/jit/auto_opt_config.h"
+#include "csrc/jit/cpu/kernels/SparseLinearPacked.h"
 #include "csrc/jit/cpu/passes/utils.h"
 
 #include "graph_rewrite.h"
@@ -88,6 +90,94 @@ void replaceFrozenIPEXLinearWithAtenLinear(
   EliminateDeadCode(graph);
 }
 
+void replaceFrozenIPEXWoqLinearWithRun(
+    Block* b,
+    std::unordered_set<Node*>& get_data_handle_nodes) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      replaceFrozenIPEXWoqLinearWithRun(block, get_data_handle_nodes);
+    }
+    if (n->kind() != Symbol::fromQualString("torch_ipex::ipex_woq_linear")) {
+      continue;
+    }
+    auto handle_node = n->inputs().at(1)->node();
+    if (!(handle_node->kind() == prim::CallMethod &&
+          handle_node->s(attr::name) == "get_data_handle")) {
+      continue;
+    }
+    auto op_context = handle_node->inputs().at(0);
+    // For graph before "freeze", the op context is not a constant yet
+    if (!toIValue(op_context).has_value()) {
+      continue;
+    }
+    WithInsertPoint guard(n);
+    auto graph = n->owningGraph();
+    auto woq_linear = graph->insertNode(graph->create(
+        Symbol::fromQualString("ipex_prepack::woq_linear_run"), 1));
+    woq_linear->addInput(n->inputs().at(0));
+    woq_linear->addInput(op_context);
+    woq_linear->output()->setType(n->output()->type());
+    n->output()->replaceAllUsesWith(woq_linear->output());
+    get_data_handle_nodes.insert(handle_node);
+  }
+  EliminateDeadCode(b);
+}
+
+// The weight-only quantized linear calls the op taking its op context
+// through a data handle, which is fine for the eager mode. The frozen graph
+// calls ipex_prepack::woq_linear_run on the context constant instead.
+void replaceFrozenIPEXWoqLinearWithRun(std::shared_ptr<Graph>& graph) {
+  std::unordered_set<Node*> get_data_handle_nodes;
+  replaceFrozenIPEXWoqLinearWithRun(graph->block(), get_data_handle_nodes);
+  for (auto& n : get_data_handle_nodes) {
+    if (!n->hasUses()) {
+      n->destroy();
+    }
+  }
+  EliminateDeadCode(graph);
+}
+
+// Replaces the FP32 linear n with ipex_prepack::sparse_linear_run when its
+// constant weight is sparse enough for the sparse kernel to beat the dense
+// one at the observed batch size.
+bool insertPrePackedSparseLinearOp(Node* n, int64_t batch_size) {
+  auto input_dtype =
+      n->inputs().at(0)->type()->cast<TensorType>()->scalarType();
+  if (!(input_dtype.has_value() && input_dtype.value() == at::kFloat)) {
+    return false;
+  }
+  auto weight = toIValue(n->inputs().at(1));
+  auto bias = toIValue(n->inputs().at(2));
+  if (!(weight.has_value() && weight->isTensor() && bias.has_value() &&
+        (bias->isNone() || bias->isTensor()))) {
+    return false;
+  }
+  c10::optional<at::Tensor> bias_tensor;
+  if (bias->isTensor()) {
+    bias_tensor = bias->toTensor();
+  }
+  if (!detail::sparse_linear::is_sparse_linear_faster(
+          weight->toTensor(), bias_tensor, batch_size)) {
+    return false;
+  }
+
+  auto graph = n->owningGraph();
+  auto prepack_node = graph->create(
+      Symbol::fromQualString("ipex_prepack::sparse_linear_prepack"), 1);
+  prepack_node->addInput(n->inputs().at(1));
+  prepack_node->addInput(n->inputs().at(2));
+  prepack_node->output()->setType(getCustomClass(
+      "__torch__.torch.classes.ipex_prepack.SparseLinearOpContext"));
+  graph->insertNode(prepack_node);
+  auto sparse_linear = graph->insertNode(graph->create(
+      Symbol::fromQualString("ipex_prepack::sparse_linear_run"), 1));
+  sparse_linear->addInput(n->inputs().at(0));
+  sparse_linear->addInput(prepack_node->output());
+  sparse_linear->output()->setType(n->output()->type()->cast<TensorType>());
+  n->output()->replaceAllUsesWith(sparse_linear->output());
+  return true;
+}
+
 void insertPrePackedLinearOp(
     Block* b,
     std::unordered_set<Node*>& aten_linear,
@@ -129,6 +219,11 @@ void insertPrePackedLinearOp(
       continue;
     }
     auto weight_size = weight_size_option.value();
+    if (AutoOptConfig::singleton().get_jit_sparse_linear() &&
+        weight_dtype_option.value() == at::ScalarType::Float &&
+        insertPrePackedSparseLinearOp(n, b_size)) {
+      continue;
+    }
 
     // Note that once creating a graph node, make sure it is also inserted into
     // the graph, for: PyTorch (when disabled TE) has a check on the graph node,
@@ -297,6 +392,58 @@ void fuseLinearWithEltwise(std::shared_ptr<Graph>& graph) {
   rewriter_swish.runOnGraph(graph);
 }
 
+void fuseSparseLinearWithEltwise(std::shared_ptr<Graph>& graph) {
+  std::array<std::string, 2> relu_operators = {"relu", "relu_"};
+  std::array<std::string, 2> gelu_operators = {"gelu", "gelu_"};
+
+  auto sparse_linear_relu_rstring = CodeTemplate(R"(
+    graph(%input, %packed_weight):
+        %x = ipex_prepack::sparse_linear_run(%input, %packed_weight)
+        %res = aten::${relu}(%x)
+        return (%res))");
+
+  std::string sparse_linear_relu_fused = R"(
+    graph(%input, %packed_weight):
+        %res = ipex_prepack::sparse_linear_relu_run(%input, %packed_weight)
+        return (%res))";
+
+  auto sparse_linear_gelu_rstring = CodeTemplate(R"(
+    graph(%input, %packed_weight, %approximate):
+        %x = ipex_prepack::sparse_linear_run(%input, %packed_weight)
+        %res = aten::${gelu}(%x, %approximate)
+        return (%res))");
+
+  std::string sparse_linear_gelu_fused = R"(
+    graph(%input, %packed_weight, %approximate):
+        %res = ipex_prepack::sparse_linear_gelu_run(%input, %packed_weight)
+        return (%res))";
+
+  // the kernel only implements the erf GELU
+  auto filter_gelu_none = [](const Match& match,
+                             const std::unordered_map<std::string, Value*>&
+                                 vmap) {
+    auto approximate = toIValue(match.values_map.at(vmap.at("approximate")));
+    return approximate.has_value() && approximate->isString() &&
+        approximate->toStringRef() == "none";
+  };
+
+  SubgraphRewriter rewriter_relu, rewriter_gelu;
+  for (const auto& relu : relu_operators) {
+    TemplateEnv env;
+    env.s("relu", relu);
+    rewriter_relu.RegisterRewritePattern(
+        sparse_linear_relu_rstring.format(env), sparse_linear_relu_fused);
+  }
+  for (const auto& gelu : gelu_operators) {
+    TemplateEnv env;
+    env.s("gelu", gelu);
+    rewriter_gelu.RegisterRewritePattern(
+        sparse_linear_gelu_rstring.format(env), sparse_linear_gelu_fused);
+  }
+  rewriter_relu.runOnGraph(graph);
+  rewriter_gelu.runOnGraph(graph, filter_gelu_none);
+}
+
 void fuseLinearAddRelu(std::shared_ptr<Graph>& graph) {
   SubgraphRewriter rewriter_add_accumu_on_the_right,
       rewriter_add_accumu_on_the_left, rewriter_add_relu;
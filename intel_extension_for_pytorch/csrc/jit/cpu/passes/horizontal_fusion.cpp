@@ -0,0 +1,272 @@
+#include "horizontal_fusion.h"
+#include <ATen/Functions.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/custom_class.h>
+#include <unordered_set>
+#include <vector>
+
+#include "utils.h"
+
+namespace torch_ipex {
+namespace jit {
+namespace {
+
+using Tensor = at::Tensor;
+using namespace torch::jit;
+
+// A linear with a larger weight already keeps all the cores busy on its own.
+constexpr int64_t kMaxGroupedWeightNumel = 512 * 256;
+
+// Checks if the output is consumed by an op which the linear and matmul fusion
+// passes fold into its producer as a post op. Grouping such a producer would
+// trade the fused epilogue for an extra pass over its output.
+bool feedsPostOpFusion(Value* output) {
+  for (const auto& use : output->uses()) {
+    auto kind = use.user->kind();
+    if (kind == aten::add || kind == aten::add_ || kind == aten::mul ||
+        kind == aten::mul_ || kind == aten::div || kind == aten::div_) {
+      return true;
+    }
+    std::string name = kind.toQualString();
+    if (graph_rewrite::utils::supported_unary_post_op_fusion_set().count(
+            name) ||
+        graph_rewrite::utils::supported_non_unary_post_op_fusion_set().count(
+            name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isFloatTensor(Value* v) {
+  auto type = v->type()->cast<TensorType>();
+  return type && type->scalarType() == at::kFloat;
+}
+
+class HorizontalFusion {
+ public:
+  explicit HorizontalFusion(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)) {}
+
+  bool run(std::unordered_set<Node*>& aten_linear) {
+    handleBlockAndSubblocks(graph_->block(), aten_linear);
+    return graph_modified;
+  }
+
+  AliasDb* getAliasDb() {
+    if (!aliasDb_) {
+      aliasDb_ = std::make_unique<AliasDb>(graph_);
+    }
+    return aliasDb_.get();
+  }
+
+  bool isGroupableLinear(Node* n) {
+    auto weight = n->namedInput("weight");
+    auto bias = n->namedInput("bias");
+    if (weight->node()->kind() != prim::Constant ||
+        (bias->type() != NoneType::get() &&
+         bias->node()->kind() != prim::Constant)) {
+      return false;
+    }
+    auto weight_tensor = constant_as<Tensor>(weight);
+    if (!weight_tensor.has_value() || weight_tensor->dim() != 2 ||
+        weight_tensor->scalar_type() != at::kFloat ||
+        weight_tensor->numel() > kMaxGroupedWeightNumel) {
+      return false;
+    }
+    if (bias->type() != NoneType::get()) {
+      auto bias_tensor = constant_as<Tensor>(bias);
+      if (!bias_tensor.has_value() ||
+          bias_tensor->scalar_type() != at::kFloat) {
+        return false;
+      }
+    }
+    return !feedsPostOpFusion(n->output());
+  }
+
+  bool isGroupableBmm(Node* n) {
+    return isFloatTensor(n->input(0)) && isFloatTensor(n->input(1)) &&
+        !feedsPostOpFusion(n->output());
+  }
+
+  // Replaces the outputs of the grouped nodes by the elements of the list
+  // returned by the grouped node, then removes the grouped nodes.
+  void replaceWithListUnpack(
+      std::vector<Node*>& group,
+      Value* outputs,
+      std::unordered_set<Node*>& aten_linear) {
+    Node* unpack = graph_->insertNode(
+        graph_->createListUnpack(outputs, group.size()));
+    for (size_t i = 0; i < group.size(); i++) {
+      unpack->output(i)->setType(group[i]->output()->type());
+      group[i]->output()->replaceAllUsesWith(unpack->output(i));
+      aten_linear.erase(group[i]);
+      group[i]->destroy();
+    }
+  }
+
+  void mergeLinearLayers(
+      std::vector<Node*>& group,
+      std::unordered_set<Node*>& aten_linear) {
+    std::vector<Value*> inputs;
+    std::vector<Tensor> weights;
+    std::vector<Tensor> biases;
+    for (Node* n : group) {
+      inputs.push_back(n->input(0));
+      auto weight = constant_as<Tensor>(n->namedInput("weight")).value();
+      auto bias = n->namedInput("bias");
+      weights.push_back(weight);
+      biases.push_back(
+          bias->type() == NoneType::get()
+              ? at::zeros({weight.size(0)}, weight.options())
+              : constant_as<Tensor>(bias).value());
+    }
+    Value* weights_value = graph_->insertConstant(IValue(weights));
+    Value* biases_value = graph_->insertConstant(IValue(biases));
+    Node* prepack_node = graph_->create(
+        Symbol::fromQualString("ipex_prepack::grouped_linear_prepack"),
+        {weights_value, biases_value});
+    prepack_node->output()->setType(getCustomClass(
+        "__torch__.torch.classes.ipex_prepack.GroupedLinearOpContext"));
+    graph_->insertNode(prepack_node);
+    Value* input_list =
+        graph_->insertNode(graph_->createList(TensorType::get(), inputs))
+            ->output();
+    Node* run_node = graph_->create(
+        Symbol::fromQualString("ipex_prepack::grouped_linear_run"),
+        {input_list, prepack_node->output()});
+    run_node->output()->setType(ListType::ofTensors());
+    graph_->insertNode(run_node);
+    replaceWithListUnpack(group, run_node->output(), aten_linear);
+  }
+
+  void mergeBmms(
+      std::vector<Node*>& group,
+      std::unordered_set<Node*>& aten_linear) {
+    std::vector<Value*> batch1;
+    std::vector<Value*> batch2;
+    for (Node* n : group) {
+      batch1.push_back(n->input(0));
+      batch2.push_back(n->input(1));
+    }
+    Value* batch1_list =
+        graph_->insertNode(graph_->createList(TensorType::get(), batch1))
+            ->output();
+    Value* batch2_list =
+        graph_->insertNode(graph_->createList(TensorType::get(), batch2))
+            ->output();
+    Node* bmm_node = graph_->create(
+        Symbol::fromQualString("ipex::grouped_bmm"),
+        {batch1_list, batch2_list});
+    bmm_node->output()->setType(ListType::ofTensors());
+    graph_->insertNode(bmm_node);
+    replaceWithListUnpack(group, bmm_node->output(), aten_linear);
+  }
+
+  // Finds the first set of at least two mutually independent groupable nodes
+  // of the kind in the block and replaces them by one grouped node. Returns
+  // false when no such set is left.
+  bool fuseFirstGroup(
+      Block* block,
+      Symbol kind,
+      std::unordered_set<Node*>& aten_linear) {
+    std::vector<Node*> candidates;
+    for (Node* n : block->nodes()) {
+      if (n->kind() != kind || checked_nodes.count(n) != 0) {
+        continue;
+      }
+      if (kind == aten::linear ? isGroupableLinear(n) : isGroupableBmm(n)) {
+        candidates.push_back(n);
+      }
+    }
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+      Node* base_node = candidates[i];
+      std::vector<Node*> group = {base_node};
+      // The candidates are in topological order, so a later node can only be
+      // grouped if it (with the nodes it depends on) could be moved before all
+      // the nodes already in the group, which also proves their independence.
+      // Nothing is moved until the group is complete, a rejected candidate
+      // keeps its place.
+      for (size_t j = i + 1; j < candidates.size(); j++) {
+        Node* node = candidates[j];
+        bool can_move_before_all = true;
+        for (auto n : group) {
+          can_move_before_all &=
+              getAliasDb()->couldMoveBeforeTopologically(node, n);
+        }
+        if (can_move_before_all) {
+          group.push_back(node);
+        }
+      }
+      // Moves the other members with their dependencies before base_node. A
+      // member that can no longer be moved is left out of the group.
+      for (auto it = group.begin() + 1; it != group.end();) {
+        if (getAliasDb()->moveBeforeTopologicallyValid(*it, base_node)) {
+          ++it;
+        } else {
+          it = group.erase(it);
+        }
+      }
+      if (group.size() == 1) {
+        checked_nodes.insert(base_node);
+        continue;
+      }
+
+      // base_node stays the last node of the group, all the inputs of the
+      // group are defined before it and all the uses are after it
+      {
+        WithInsertPoint guard(base_node);
+        if (kind == aten::linear) {
+          mergeLinearLayers(group, aten_linear);
+        } else {
+          mergeBmms(group, aten_linear);
+        }
+      }
+      graph_modified = true;
+      // the alias db does not know about the values of the grouped node
+      aliasDb_ = nullptr;
+      return true;
+    }
+    return false;
+  }
+
+  void handleBlockAndSubblocks(
+      Block* block,
+      std::unordered_set<Node*>& aten_linear) {
+    for (auto node : block->nodes()) {
+      for (Block* subblock : node->blocks()) {
+        handleBlockAndSubblocks(subblock, aten_linear);
+      }
+    }
+
+    while (fuseFirstGroup(block, aten::linear, aten_linear)) {
+    }
+    while (fuseFirstGroup(block, aten::bmm, aten_linear)) {
+    }
+  }
+
+ private:
+  std::shared_ptr<Graph> graph_;
+  bool graph_modified = false;
+  std::unique_ptr<AliasDb> aliasDb_ = nullptr;
+  std::unordered_set<Node*> checked_nodes;
+};
+} // namespace
+
+TORCH_API bool FrozenHorizontalFusion(
+    std::shared_ptr<Graph>& graph,
+    std::unordered_set<Node*>& aten_linear) {
+  HorizontalFusion horizontalFusion(graph);
+  GRAPH_DUMP("Before FrozenHorizontalFusion", graph);
+  bool changed = horizontalFusion.run(aten_linear);
+  if (changed) {
+    GRAPH_DUMP("After FrozenHorizontalFusion", graph);
+  }
+  return changed;
+}
+
+} // namespace jit
+} // namespace torch_ipex
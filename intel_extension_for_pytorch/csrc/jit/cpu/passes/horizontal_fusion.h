@@ -0,0 +1,18 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch_ipex {
+namespace jit {
+
+// Groups the independent small FP32 aten::linear ops with constant weights of
+// a block into a single ipex_prepack::grouped_linear_run op, and the
+// independent FP32 aten::bmm ops into a single ipex::grouped_bmm op. Unlike
+// FrozenConcatLinear, the grouped ops do not need to share their input: all of
+// them are computed by one grouped GEMM call.
+TORCH_API bool FrozenHorizontalFusion(
+    std::shared_ptr<torch::jit::Graph>& graph,
+    std::unordered_set<torch::jit::Node*>& aten_linear);
+
+} // namespace jit
+} // namespace torch_ipex
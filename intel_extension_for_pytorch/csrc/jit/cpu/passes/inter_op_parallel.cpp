@@ -0,0 +1,385 @@
+#include "inter_op_parallel.h"
+
+#include <ATen/Parallel.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/jit_log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "csrc/cpu/runtime/CPUPool.h"
+#include "csrc/jit/cpu/kernels/InterOpParallel.h"
+
+namespace torch_ipex {
+namespace jit {
+
+using namespace torch::jit;
+using namespace torch_ipex::cpu;
+
+namespace {
+
+// A branch has to be worth at least this many estimated FLOPs to be run by its
+// own executor, below that the hand-off to the worker thread costs more than
+// what the concurrency saves.
+constexpr double kMinBranchCost = 1 << 20;
+
+int64_t completeNumel(Value* v) {
+  auto type = v->type()->cast<TensorType>();
+  if (!type) {
+    return -1;
+  }
+  auto sizes = type->sizes().concrete_sizes();
+  if (!sizes.has_value()) {
+    return -1;
+  }
+  return std::accumulate(
+      sizes->begin(), sizes->end(), (int64_t)1, std::multiplies<int64_t>());
+}
+
+// Concrete size of the dim of v, or -1 if it is unknown.
+int64_t completeSize(Value* v, int64_t dim) {
+  auto type = v->type()->cast<TensorType>();
+  if (!type) {
+    return -1;
+  }
+  auto sizes = type->sizes().concrete_sizes();
+  if (!sizes.has_value() || sizes->empty()) {
+    return -1;
+  }
+  if (dim < 0) {
+    dim += sizes->size();
+  }
+  return dim >= 0 && dim < (int64_t)sizes->size() ? sizes->at(dim) : -1;
+}
+
+bool contains(const std::string& kind, const char* pattern) {
+  return kind.find(pattern) != std::string::npos;
+}
+
+// A rough FLOP estimate of the node from its profiled shapes: the GEMM based
+// ops do one multiply-add per output element and reduced input element (the
+// window of the convolutions is not visible from the graph and is ignored),
+// the embedding lookups one add per looked up element, and any other op one
+// operation per output element. Unknown shapes count as free.
+double nodeCost(Node* node) {
+  if (node->outputs().empty()) {
+    return 0;
+  }
+  int64_t out_numel = completeNumel(node->output(0));
+  if (out_numel < 0) {
+    return 0;
+  }
+  std::string kind = node->kind().toQualString();
+  if (node->inputs().empty()) {
+    return out_numel;
+  }
+  Value* input = node->input(0);
+  int64_t reduce_size = -1;
+  if (contains(kind, "linear") || contains(kind, "matmul") ||
+      contains(kind, "bmm") || contains(kind, "mkl_sgemm") ||
+      kind == "aten::mm" || kind == "aten::addmm") {
+    reduce_size = completeSize(input, -1);
+  } else if (contains(kind, "conv")) {
+    reduce_size = completeSize(input, 1);
+  } else if (contains(kind, "embedding") && node->inputs().size() > 1) {
+    int64_t indices_numel = completeNumel(node->input(1));
+    int64_t dim = completeSize(node->output(0), -1);
+    if (indices_numel >= 0 && dim >= 0) {
+      return (double)indices_numel * dim;
+    }
+  }
+  if (reduce_size > 0) {
+    return 2.0 * out_numel * reduce_size;
+  }
+  return out_numel;
+}
+
+// Splits the cores between the branches in proportion to their costs, every
+// branch gets at least one core, the remainders go to the largest fractions.
+std::vector<int64_t> splitCores(
+    const std::vector<double>& costs,
+    int64_t num_cores) {
+  const int64_t num_branches = costs.size();
+  double total_cost = std::accumulate(costs.begin(), costs.end(), 0.0);
+  int64_t remaining = num_cores - num_branches;
+  std::vector<int64_t> cores(num_branches, 1);
+  std::vector<std::pair<double, int64_t>> fractions;
+  int64_t assigned = 0;
+  for (int64_t i = 0; i < num_branches; i++) {
+    double share = remaining * costs[i] / total_cost;
+    int64_t whole = std::floor(share);
+    cores[i] += whole;
+    assigned += whole;
+    fractions.emplace_back(share - whole, i);
+  }
+  std::sort(fractions.rbegin(), fractions.rend());
+  for (int64_t i = 0; i < remaining - assigned; i++) {
+    cores[fractions[i % num_branches].second]++;
+  }
+  return cores;
+}
+
+struct Component {
+  std::vector<Node*> nodes;
+  double cost = 0;
+};
+
+// The nodes which must not be reordered with respect to the nodes of other
+// branches: nodes with side effects or sub-blocks, and nodes which write to a
+// value not produced inside the current segment, since the readers of that
+// value in the other branches would no longer be ordered before the write.
+bool isBarrier(
+    Node* node,
+    AliasDb& alias_db,
+    const std::unordered_map<Node*, size_t>& segment_nodes) {
+  if (node->hasSideEffects() || !node->blocks().empty() ||
+      node->kind() == prim::fork) {
+    return true;
+  }
+  if (!alias_db.isMutable(node)) {
+    return false;
+  }
+  for (auto* input : node->inputs()) {
+    if (alias_db.writesToAlias(node, {input}) &&
+        segment_nodes.count(input->node()) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+class InterOpParallelPlanner {
+ public:
+  InterOpParallelPlanner(
+      std::shared_ptr<Graph> graph,
+      std::vector<int32_t> cores)
+      : graph_(std::move(graph)), cores_(std::move(cores)) {}
+
+  void run() {
+    AliasDb alias_db(graph_);
+    std::unordered_map<Node*, size_t> component_of;
+    std::vector<Component> components;
+    // union-find over the components of the current segment
+    std::vector<size_t> parent;
+    auto find = [&](size_t c) {
+      while (parent[c] != c) {
+        c = parent[c] = parent[parent[c]];
+      }
+      return c;
+    };
+
+    auto close_segment = [&](Node* insert_point) {
+      std::vector<Component> branches;
+      for (size_t c = 0; c < components.size(); c++) {
+        if (find(c) == c && components[c].cost >= kMinBranchCost) {
+          branches.emplace_back(std::move(components[c]));
+        }
+      }
+      if (branches.size() >= 2) {
+        regions_.emplace_back(std::move(branches), insert_point);
+      }
+      component_of.clear();
+      components.clear();
+      parent.clear();
+    };
+
+    for (Node* node : graph_->block()->nodes()) {
+      if (node->kind() == prim::Constant) {
+        continue;
+      }
+      if (isBarrier(node, alias_db, component_of)) {
+        close_segment(node);
+        continue;
+      }
+      std::unordered_set<size_t> producers;
+      for (auto* input : node->inputs()) {
+        auto it = component_of.find(input->node());
+        if (it != component_of.end()) {
+          producers.insert(find(it->second));
+        }
+      }
+      size_t heavy_producers = 0;
+      for (auto c : producers) {
+        heavy_producers += components[c].cost >= kMinBranchCost;
+      }
+      if (heavy_producers >= 2) {
+        // the node joins concurrent branches, they end before it
+        close_segment(node);
+        producers.clear();
+      }
+
+      size_t c = components.size();
+      components.emplace_back();
+      parent.push_back(c);
+      components[c].nodes.push_back(node);
+      components[c].cost = nodeCost(node);
+      for (auto p : producers) {
+        // merge in topological order, the nodes of a component stay sorted
+        auto& merged = components[c];
+        auto& producer = components[p];
+        std::vector<Node*> nodes;
+        std::merge(
+            producer.nodes.begin(),
+            producer.nodes.end(),
+            merged.nodes.begin(),
+            merged.nodes.end(),
+            std::back_inserter(nodes),
+            [](Node* a, Node* b) { return a->isBefore(b); });
+        merged.nodes = std::move(nodes);
+        merged.cost += producer.cost;
+        producer.nodes.clear();
+        parent[p] = c;
+      }
+      component_of[node] = c;
+    }
+    close_segment(graph_->return_node());
+
+    for (auto& region : regions_) {
+      createGroup(region.first, region.second);
+    }
+  }
+
+ private:
+  // Moves the nodes of the component into a new graph. The values defined
+  // outside of the component become inputs of the graph, except constants
+  // which are copied, and the values used outside become outputs.
+  std::shared_ptr<Graph> createBranchGraph(
+      const Component& component,
+      std::vector<Value*>& inputs,
+      std::vector<Value*>& outputs) {
+    auto branch_graph = std::make_shared<Graph>();
+    std::unordered_set<Node*> node_set(
+        component.nodes.begin(), component.nodes.end());
+    std::unordered_map<Value*, Value*> env;
+    auto value_map = [&](Value* v) -> Value* {
+      auto it = env.find(v);
+      if (it != env.end()) {
+        return it->second;
+      }
+      Value* mapped = nullptr;
+      if (v->node()->kind() == prim::Constant) {
+        mapped = branch_graph
+                     ->insertNode(branch_graph->createClone(
+                         v->node(), [](Value*) -> Value* { return nullptr; }))
+                     ->output();
+      } else {
+        mapped = branch_graph->addInput()->copyMetadata(v);
+        inputs.push_back(v);
+      }
+      env[v] = mapped;
+      return mapped;
+    };
+    for (Node* node : component.nodes) {
+      Node* clone =
+          branch_graph->insertNode(branch_graph->createClone(node, value_map));
+      for (size_t i = 0; i < node->outputs().size(); i++) {
+        env[node->output(i)] = clone->output(i);
+      }
+    }
+    for (Node* node : component.nodes) {
+      for (auto* output : node->outputs()) {
+        bool used_outside = std::any_of(
+            output->uses().begin(), output->uses().end(), [&](const Use& u) {
+              return node_set.count(u.user) == 0;
+            });
+        if (used_outside) {
+          branch_graph->registerOutput(env[output]);
+          outputs.push_back(output);
+        }
+      }
+    }
+    return branch_graph;
+  }
+
+  void createGroup(std::vector<Component>& branches, Node* insert_point) {
+    // the most expensive branches first, at most one branch per core
+    std::stable_sort(
+        branches.begin(),
+        branches.end(),
+        [](const Component& a, const Component& b) { return a.cost > b.cost; });
+    if (branches.size() > cores_.size()) {
+      branches.resize(cores_.size());
+    }
+    if (branches.size() < 2) {
+      return;
+    }
+    std::vector<double> costs;
+    for (const auto& branch : branches) {
+      costs.push_back(branch.cost);
+    }
+    auto branch_cores = splitCores(costs, cores_.size());
+
+    std::vector<std::shared_ptr<Graph>> branch_graphs;
+    std::vector<int64_t> branch_inputs;
+    std::vector<Value*> inputs;
+    std::vector<Value*> outputs;
+    for (const auto& branch : branches) {
+      size_t num_inputs = inputs.size();
+      branch_graphs.push_back(createBranchGraph(branch, inputs, outputs));
+      branch_inputs.push_back(inputs.size() - num_inputs);
+    }
+
+    Node* group = graph_->create(
+        torch::jit::ipex::inter_op_parallel_group, inputs, outputs.size());
+    group->gs_(kBranchesAttr, branch_graphs);
+    group->is_(kBranchInputsAttr, branch_inputs);
+    group->is_(kBranchCoresAttr, branch_cores);
+    group->is_(
+        kCoresAttr, std::vector<int64_t>(cores_.begin(), cores_.end()));
+    group->insertBefore(insert_point);
+
+    std::unordered_set<Node*> moved;
+    for (const auto& branch : branches) {
+      moved.insert(branch.nodes.begin(), branch.nodes.end());
+    }
+    for (size_t i = 0; i < outputs.size(); i++) {
+      group->output(i)->copyMetadata(outputs[i]);
+      auto uses = outputs[i]->uses();
+      for (const auto& use : uses) {
+        if (moved.count(use.user) == 0) {
+          use.user->replaceInput(use.offset, group->output(i));
+        }
+      }
+    }
+    for (const auto& branch : branches) {
+      for (auto it = branch.nodes.rbegin(); it != branch.nodes.rend(); ++it) {
+        (*it)->destroy();
+      }
+    }
+    GRAPH_DEBUG(
+        "InterOpParallel: ",
+        branches.size(),
+        " concurrent branches before ",
+        *insert_point);
+  }
+
+  std::shared_ptr<Graph> graph_;
+  std::vector<int32_t> cores_;
+  std::vector<std::pair<std::vector<Component>, Node*>> regions_;
+};
+
+} // namespace
+
+void InterOpParallel(std::shared_ptr<Graph>& graph) {
+  // the branches are pinned to cores through the IOMP runtime extension
+  if (!torch_ipex::runtime::is_runtime_ext_enabled()) {
+    return;
+  }
+  auto cores = torch_ipex::runtime::get_process_available_cores();
+  // stay within the threads the graph would have used
+  if ((int64_t)cores.size() > at::get_num_threads()) {
+    cores.resize(at::get_num_threads());
+  }
+  if (cores.size() < 2) {
+    return;
+  }
+  InterOpParallelPlanner(graph, std::move(cores)).run();
+  GRAPH_DUMP("After InterOpParallel", graph);
+}
+
+} // namespace jit
+} // namespace torch_ipex
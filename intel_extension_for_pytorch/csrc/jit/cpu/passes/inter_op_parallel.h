@@ -0,0 +1,17 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch_ipex {
+namespace jit {
+
+// Finds the independent branches of the top level block, such as the bottom
+// MLP and the embedding lookups of DLRM or the conv branches of an Inception
+// block, and moves each region of concurrent branches into one
+// ipex::InterOpParallelGroup node. At runtime every branch of the group runs
+// in its own TaskExecutor pinned to a disjoint CPUPool, the cores are split
+// between the branches in proportion to their estimated cost.
+void InterOpParallel(std::shared_ptr<torch::jit::Graph>& graph);
+
+} // namespace jit
+} // namespace torch_ipex
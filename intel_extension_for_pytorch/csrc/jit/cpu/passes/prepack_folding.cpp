@@ -35,6 +35,9 @@ static const std::set<std::string> prepack_foldable_ops = {
     "ipex_prepack::linear_prepack",
     "ipex_prepack::conv_transpose_prepack",
     "ipex_prepack::mkl_sgemm_prepack",
+    "ipex_prepack::grouped_linear_prepack",
+    "ipex_prepack::sparse_linear_prepack",
+    "ipex_prepack::woq_linear_prepack",
 };
 
 void PrePackingOpsFolder(Block* b) {
@@ -5,10 +5,12 @@
 
 #include "csrc/aten/cpu/AddLayerNorm.h"
 #include "csrc/aten/cpu/ConcatBnRelu.h"
+#include "csrc/aten/cpu/GroupNorm.h"
 #include "csrc/jit/cpu/kernels/ConvPacked.h"
 #include "csrc/jit/cpu/kernels/ConvTransposePacked.h"
 #include "csrc/jit/cpu/kernels/Einsum.h"
 #include "csrc/jit/cpu/kernels/Embeddingbag.h"
+#include "csrc/jit/cpu/kernels/GroupedLinearPacked.h"
 #include "csrc/jit/cpu/kernels/Interaction.h"
 #include "csrc/jit/cpu/kernels/LinearMKLPacked.h"
 #include "csrc/jit/cpu/kernels/LinearPacked.h"
@@ -20,6 +22,10 @@
 #include "csrc/jit/cpu/kernels/RNN.h"
 #include "csrc/jit/cpu/kernels/Shuffle.h"
 #include "csrc/jit/cpu/kernels/Softmax.h"
+#include "csrc/jit/cpu/kernels/SparseLinearPacked.h"
+#include "csrc/jit/cpu/kernels/WoqLinearPacked.h"
+#include "csrc/jit/cpu/passes/cat_elimination.h"
+#include "csrc/jit/cpu/passes/static_memory_planning.h"
 
 namespace torch_ipex {
 namespace jit {
@@ -89,6 +95,27 @@ at::Tensor toOptionalTensor(const IValue& v) {
       },                                                           \
       aliasAnalysisFromSchema())
 
+#define CreateConvUnaryPostOpRunOut(FUSED_OP)                      \
+  Operator(                                                        \
+      "ipex_prepack::convolution_" #FUSED_OP                       \
+      ".out(Tensor input, Tensor(a!) out, "                        \
+      "__torch__.torch.classes.ipex_prepack.ConvolutionOpContext " \
+      "W_prepack) -> Tensor(a!)",                                  \
+      [](const Node* node) -> Operation {                          \
+        return [](Stack* stack) {                                  \
+          auto output = (std::move(peek(stack, 1, 3))).toTensor(); \
+          auto result = convolution_##FUSED_OP##_out(              \
+              (std::move(peek(stack, 0, 3))).toTensor(),           \
+              output,                                              \
+              (std::move(peek(stack, 2, 3)))                       \
+                  .toCustomClass<ConvolutionOpContext>());         \
+          drop(stack, 3);                                          \
+          torch::jit::pack(stack, std::move(result));              \
+          return 0;                                                \
+        };                                                         \
+      },                                                           \
+      aliasAnalysisFromSchema())
+
 #define CreateConvBinaryPostOpPrepack(FUSED_OP, ATTR)                         \
   Operator(                                                                   \
       "ipex_prepack::convolution_" #FUSED_OP "_prepack(" CONV_PREPACK_ARGS    \
@@ -159,6 +186,27 @@ at::Tensor toOptionalTensor(const IValue& v) {
       },                                                      \
       aliasAnalysisFromSchema())
 
+#define CreateLinearUnaryPostOpRunOut(FUSED_OP)                    \
+  Operator(                                                        \
+      "ipex_prepack::linear_" #FUSED_OP                            \
+      ".out(Tensor input, Tensor(a!) out, "                        \
+      "__torch__.torch.classes.ipex_prepack.LinearOpContext "      \
+      "W_prepack) -> Tensor(a!)",                                  \
+      [](const Node* node) -> Operation {                          \
+        return [](Stack* stack) {                                  \
+          auto output = (std::move(peek(stack, 1, 3))).toTensor(); \
+          auto result = linear_##FUSED_OP##_out(                   \
+              (std::move(peek(stack, 0, 3))).toTensor(),           \
+              output,                                              \
+              (std::move(peek(stack, 2, 3)))                       \
+                  .toCustomClass<LinearOpContext>());              \
+          drop(stack, 3);                                          \
+          torch::jit::pack(stack, std::move(result));              \
+          return 0;                                                \
+        };                                                         \
+      },                                                           \
+      aliasAnalysisFromSchema())
+
 #define CreateConvTransposeUnaryPostOpRun(FUSED_OP)                  \
   Operator(                                                          \
       "ipex_prepack::conv_transpose_" #FUSED_OP                      \
@@ -178,6 +226,26 @@ at::Tensor toOptionalTensor(const IValue& v) {
       },                                                             \
       aliasAnalysisFromSchema())
 
+#define CreateSparseLinearRun(FUSED_OP, POST_OP)                    \
+  Operator(                                                         \
+      "ipex_prepack::sparse_linear_" #FUSED_OP                      \
+      "(Tensor input, "                                             \
+      "__torch__.torch.classes.ipex_prepack.SparseLinearOpContext " \
+      "W_prepack) -> Tensor",                                       \
+      [](const Node* node) -> Operation {                           \
+        return [](Stack* stack) {                                   \
+          auto result = detail::sparse_linear::sparse_linear_run(   \
+              (std::move(peek(stack, 0, 2))).toTensor(),            \
+              (std::move(peek(stack, 1, 2)))                        \
+                  .toCustomClass<SparseLinearOpContext>(),          \
+              POST_OP);                                             \
+          drop(stack, 2);                                           \
+          torch::jit::pack(stack, std::move(result));               \
+          return 0;                                                 \
+        };                                                          \
+      },                                                            \
+      aliasAnalysisFromSchema())
+
 torch::jit::RegisterOperators op({
     CreateConvUnaryPostOpPrepack(relu),
     CreateConvUnaryPostOpPrepack(sigmoid),
@@ -208,6 +276,21 @@ torch::jit::RegisterOperators op({
     CreateConvUnaryPostOpRun(sqrt_run),
     CreateConvUnaryPostOpRun(hardsigmoid_run),
 
+    CreateConvUnaryPostOpRunOut(run),
+    CreateConvUnaryPostOpRunOut(relu_run),
+    CreateConvUnaryPostOpRunOut(sigmoid_run),
+    CreateConvUnaryPostOpRunOut(swish_run),
+    CreateConvUnaryPostOpRunOut(tanh_run),
+    CreateConvUnaryPostOpRunOut(mish_run),
+    CreateConvUnaryPostOpRunOut(abs_run),
+    CreateConvUnaryPostOpRunOut(exp_run),
+    CreateConvUnaryPostOpRunOut(hardswish_run),
+    CreateConvUnaryPostOpRunOut(square_run),
+    CreateConvUnaryPostOpRunOut(log_run),
+    CreateConvUnaryPostOpRunOut(round_run),
+    CreateConvUnaryPostOpRunOut(sqrt_run),
+    CreateConvUnaryPostOpRunOut(hardsigmoid_run),
+
     CreateConvBinaryPostOpPrepack(add, fuse_sum),
     CreateConvBinaryPostOpPrepack(add_relu, residual),
     CreateConvBinaryPostOpRun(add_run),
@@ -490,6 +573,27 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex_prepack::convolution_group_norm_silu_run(Tensor input, "
+        "int num_groups, Tensor? weight, Tensor? bias, float eps, "
+        "__torch__.torch.classes.ipex_prepack.ConvolutionOpContext "
+        "W_prepack) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = convolution_group_norm_silu_run(
+                (std::move(peek(stack, 0, 6))).toTensor(),
+                (std::move(peek(stack, 1, 6))).toInt(),
+                toOptionalTensor(std::move(peek(stack, 2, 6))),
+                toOptionalTensor(std::move(peek(stack, 3, 6))),
+                (std::move(peek(stack, 4, 6))).toDouble(),
+                (std::move(peek(stack, 5, 6)))
+                    .toCustomClass<ConvolutionOpContext>());
+            drop(stack, 6);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
 
     CreateLinearUnaryPostOpRun(run),
     CreateLinearUnaryPostOpRun(relu_run),
@@ -506,6 +610,21 @@ torch::jit::RegisterOperators op({
     CreateLinearUnaryPostOpRun(sqrt_run),
     CreateLinearUnaryPostOpRun(hardsigmoid_run),
 
+    CreateLinearUnaryPostOpRunOut(run),
+    CreateLinearUnaryPostOpRunOut(relu_run),
+    CreateLinearUnaryPostOpRunOut(sigmoid_run),
+    CreateLinearUnaryPostOpRunOut(swish_run),
+    CreateLinearUnaryPostOpRunOut(tanh_run),
+    CreateLinearUnaryPostOpRunOut(mish_run),
+    CreateLinearUnaryPostOpRunOut(abs_run),
+    CreateLinearUnaryPostOpRunOut(exp_run),
+    CreateLinearUnaryPostOpRunOut(hardswish_run),
+    CreateLinearUnaryPostOpRunOut(square_run),
+    CreateLinearUnaryPostOpRunOut(log_run),
+    CreateLinearUnaryPostOpRunOut(round_run),
+    CreateLinearUnaryPostOpRunOut(sqrt_run),
+    CreateLinearUnaryPostOpRunOut(hardsigmoid_run),
+
     Operator(
         "ipex_prepack::linear_leaky_relu_run(Tensor input, Scalar alpha, "
         "__torch__.torch.classes.ipex_prepack.LinearOpContext "
@@ -651,6 +770,43 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex_prepack::grouped_linear_run(Tensor[] inputs, "
+        "__torch__.torch.classes.ipex_prepack.GroupedLinearOpContext "
+        "W_prepack) -> Tensor[]",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = detail::grouped_linear::grouped_linear_run(
+                (std::move(peek(stack, 0, 2))).toTensorVector(),
+                (std::move(peek(stack, 1, 2)))
+                    .toCustomClass<GroupedLinearOpContext>());
+            drop(stack, 2);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+
+    CreateSparseLinearRun(run, kSparseLinearNone),
+    CreateSparseLinearRun(relu_run, kSparseLinearRelu),
+    CreateSparseLinearRun(gelu_run, kSparseLinearGelu),
+
+    Operator(
+        "ipex_prepack::woq_linear_run(Tensor input, "
+        "__torch__.torch.classes.ipex_prepack.WoqLinearOpContext "
+        "W_prepack) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = detail::woq_linear::woq_linear_run(
+                (std::move(peek(stack, 0, 2))).toTensor(),
+                (std::move(peek(stack, 1, 2)))
+                    .toCustomClass<WoqLinearOpContext>());
+            drop(stack, 2);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
 
     // ConvTranspose fusion run OP
     CreateConvTransposeUnaryPostOpRun(run),
@@ -884,6 +1040,20 @@ torch::jit::RegisterOperators op({
         },
         aliasAnalysisFromSchema()),
 
+    Operator(
+        "ipex::grouped_bmm(Tensor[] batch1, Tensor[] batch2) -> Tensor[]",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = dil_grouped_bmm(
+                (std::move(peek(stack, 0, 2))).toTensorVector(),
+                (std::move(peek(stack, 1, 2))).toTensorVector());
+            drop(stack, 2);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+
     Operator(
         "ipex::matmul(Tensor batch1, Tensor batch2) -> Tensor",
         [](const Node* node) -> Operation {
@@ -1204,6 +1374,23 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::group_norm_silu(Tensor input, int num_groups, Tensor? weight, "
+        "Tensor? bias, float eps, bool cudnn_enabled) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = group_norm_silu(
+                (std::move(peek(stack, 0, 6))).toTensor(),
+                (std::move(peek(stack, 1, 6))).toInt(),
+                toOptionalTensor(std::move(peek(stack, 2, 6))),
+                toOptionalTensor(std::move(peek(stack, 3, 6))),
+                (std::move(peek(stack, 4, 6))).toDouble());
+            drop(stack, 6);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
     Operator(
         "ipex::concat_bn_relu(Tensor[] a, Tensor bn_scale, Tensor bn_beta, "
         "Tensor? weight, Tensor? bias, Tensor? running_mean, Tensor? running_var, bool training, float momentum, float eps, bool cudnn_enabled, int dim) -> "
@@ -1274,6 +1461,19 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::einsum(str equation, Tensor[] tensors) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = einsum_contraction(
+                (std::move(peek(stack, 0, 2))).toStringView(),
+                (std::move(peek(stack, 1, 2))).toTensorList());
+            drop(stack, 2);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
     Operator(
         "ipex::max_pool2d(Tensor input, int[2] kernel_size, int[2] stride, "
         "int[2] padding, int[2] dilation, bool ceil_mode) -> Tensor",
@@ -1292,6 +1492,117 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::max_pool2d_relu(Tensor input, int[2] kernel_size, "
+        "int[2] stride, int[2] padding, int[2] dilation, bool ceil_mode) "
+        "-> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = max_pool2d_relu(
+                (std::move(peek(stack, 0, 6))).toTensor(),
+                (std::move(peek(stack, 1, 6))).toIntVector(),
+                (std::move(peek(stack, 2, 6))).toIntVector(),
+                (std::move(peek(stack, 3, 6))).toIntVector(),
+                (std::move(peek(stack, 4, 6))).toIntVector(),
+                (std::move(peek(stack, 5, 6))).toBool());
+            drop(stack, 6);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::max_pool2d_quantize(Tensor input, int[2] kernel_size, "
+        "int[2] stride, int[2] padding, int[2] dilation, bool ceil_mode, "
+        "float scale, int zero_point, ScalarType dtype) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = max_pool2d_quantize(
+                (std::move(peek(stack, 0, 9))).toTensor(),
+                (std::move(peek(stack, 1, 9))).toIntVector(),
+                (std::move(peek(stack, 2, 9))).toIntVector(),
+                (std::move(peek(stack, 3, 9))).toIntVector(),
+                (std::move(peek(stack, 4, 9))).toIntVector(),
+                (std::move(peek(stack, 5, 9))).toBool(),
+                (std::move(peek(stack, 6, 9))).toDouble(),
+                (std::move(peek(stack, 7, 9))).toInt(),
+                (std::move(peek(stack, 8, 9))).toScalarType());
+            drop(stack, 9);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+
+    // ops inserted by StaticMemoryPlanning. The static_arena of each graph
+    // owns its own buffers, so it must not be merged or folded either.
+    Operator(
+        "ipex::static_arena(int nbytes) -> Tensor",
+        [](const Node* node) -> Operation {
+          // one arena per graph, kept alive as long as the graph code
+          auto arena = std::make_shared<StaticArena>();
+          return [arena](Stack* stack) {
+            auto result = arena->get((std::move(peek(stack, 0, 1))).toInt());
+            drop(stack, 1);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        c10::AliasAnalysisKind::CONSERVATIVE),
+    Operator(
+        "ipex::arena_view(Tensor(a) arena, int offset, int[] sizes, "
+        "int[] strides, ScalarType dtype) -> Tensor(a)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = arena_view(
+                (std::move(peek(stack, 0, 5))).toTensor(),
+                (std::move(peek(stack, 1, 5))).toInt(),
+                (std::move(peek(stack, 2, 5))).toIntVector(),
+                (std::move(peek(stack, 3, 5))).toIntVector(),
+                (std::move(peek(stack, 4, 5))).toScalarType());
+            drop(stack, 5);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+
+    // ops inserted by CatElimination. Each cat_buffer is a distinct buffer,
+    // even with the same arguments, so CSE and constant propagation must not
+    // merge or fold it.
+    Operator(
+        "ipex::cat_buffer(int[] sizes, int[] strides, ScalarType dtype) "
+        "-> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = at::empty_strided(
+                (std::move(peek(stack, 0, 3))).toIntVector(),
+                (std::move(peek(stack, 1, 3))).toIntVector(),
+                at::TensorOptions().dtype(
+                    (std::move(peek(stack, 2, 3))).toScalarType()));
+            drop(stack, 3);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        c10::AliasAnalysisKind::CONSERVATIVE),
+    Operator(
+        "ipex::cat_from_slices(Tensor(a!) buffer, Tensor[] slices, "
+        "Tensor[] results, int dim) -> Tensor(a!)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto buffer = (std::move(peek(stack, 0, 4))).toTensor();
+            auto result = cat_from_slices(
+                buffer,
+                (std::move(peek(stack, 1, 4))).toTensorVector(),
+                (std::move(peek(stack, 2, 4))).toTensorVector(),
+                (std::move(peek(stack, 3, 4))).toInt());
+            drop(stack, 4);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
 });
 
 } // namespace jit
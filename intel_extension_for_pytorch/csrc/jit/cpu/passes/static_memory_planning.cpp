@@ -0,0 +1,310 @@
+#include "static_memory_planning.h"
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/graph_iterator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch_ipex {
+namespace jit {
+
+using namespace torch::jit;
+
+namespace {
+
+// oneDNN and the ATen CPU allocator both prefer 64 bytes aligned buffers.
+constexpr int64_t kArenaAlignment = 64;
+
+struct ThreadArena {
+  std::weak_ptr<char> owner;
+  at::Tensor buffer;
+};
+
+// The buffers of the calling thread, keyed by the id of their StaticArena
+thread_local std::unordered_map<uint64_t, ThreadArena> thread_arenas;
+
+std::atomic<uint64_t> next_arena_id{0};
+
+struct PlannedTensor {
+  Node* node;
+  // first and last index (inclusive) of the top level nodes for which the
+  // tensor has to stay alive
+  int64_t begin;
+  int64_t end;
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> strides;
+  at::ScalarType dtype;
+  int64_t nbytes;
+  int64_t offset;
+};
+
+int64_t alignUp(int64_t x) {
+  return (x + kArenaAlignment - 1) / kArenaAlignment * kArenaAlignment;
+}
+
+// Fills sizes, strides, dtype and nbytes of the output of the node if its
+// type is complete, returns false otherwise.
+bool getCompleteOutputType(Node* node, PlannedTensor& planned) {
+  auto type = node->output()->type()->cast<TensorType>();
+  if (!type || !type->scalarType().has_value() ||
+      !type->device().has_value() || !type->device()->is_cpu()) {
+    return false;
+  }
+  if (type->requiresGrad().has_value() && type->requiresGrad().value()) {
+    return false;
+  }
+  auto sizes = type->sizes().concrete_sizes();
+  auto strides = type->strides().concrete_sizes();
+  if (!sizes.has_value() || !strides.has_value()) {
+    return false;
+  }
+  int64_t numel = 1;
+  for (size_t d = 0; d < sizes->size(); d++) {
+    if (sizes->at(d) == 0) {
+      return false;
+    }
+    numel += (sizes->at(d) - 1) * strides->at(d);
+  }
+  planned.sizes = *sizes;
+  planned.strides = *strides;
+  planned.dtype = *type->scalarType();
+  planned.nbytes = numel * at::elementSize(planned.dtype);
+  return true;
+}
+
+// Index of the top level node which contains the use.
+int64_t topLevelIndex(
+    Node* user,
+    Block* top_block,
+    const std::unordered_map<Node*, int64_t>& node_index) {
+  while (user->owningBlock() != top_block) {
+    user = user->owningBlock()->owningNode();
+  }
+  auto it = node_index.find(user);
+  return it == node_index.end() ? -1 : it->second;
+}
+
+// Greedy by size interval colouring: the largest tensors are placed first, at
+// the lowest offset which does not overlap with an already placed tensor
+// whose lifetime intersects.
+int64_t assignOffsets(std::vector<PlannedTensor>& planned) {
+  std::vector<size_t> order(planned.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return planned[a].nbytes > planned[b].nbytes;
+  });
+
+  int64_t arena_size = 0;
+  std::vector<size_t> placed;
+  for (auto i : order) {
+    auto& cur = planned[i];
+    std::vector<size_t> live;
+    for (auto p : placed) {
+      if (planned[p].begin <= cur.end && cur.begin <= planned[p].end) {
+        live.push_back(p);
+      }
+    }
+    std::sort(live.begin(), live.end(), [&](size_t a, size_t b) {
+      return planned[a].offset < planned[b].offset;
+    });
+    int64_t offset = 0;
+    for (auto p : live) {
+      if (offset + cur.nbytes <= planned[p].offset) {
+        break;
+      }
+      offset = std::max(offset, alignUp(planned[p].offset + planned[p].nbytes));
+    }
+    cur.offset = offset;
+    arena_size = std::max(arena_size, offset + cur.nbytes);
+    placed.push_back(i);
+  }
+  return alignUp(arena_size);
+}
+
+} // namespace
+
+const std::unordered_set<Symbol>& opsWithOutVariant() {
+  static const std::unordered_set<Symbol> ops = []() {
+    std::unordered_set<Symbol> ops;
+    const std::vector<std::string> fused_ops = {
+        "",
+        "relu_",
+        "sigmoid_",
+        "swish_",
+        "tanh_",
+        "mish_",
+        "abs_",
+        "exp_",
+        "hardswish_",
+        "square_",
+        "log_",
+        "round_",
+        "sqrt_",
+        "hardsigmoid_"};
+    for (const auto& fused_op : fused_ops) {
+      ops.insert(Symbol::fromQualString(
+          "ipex_prepack::linear_" + fused_op + "run"));
+      ops.insert(Symbol::fromQualString(
+          "ipex_prepack::convolution_" + fused_op + "run"));
+    }
+    return ops;
+  }();
+  return ops;
+}
+
+StaticArena::StaticArena()
+    : id_(next_arena_id++), alive_(std::make_shared<char>(0)) {}
+
+at::Tensor StaticArena::get(int64_t nbytes) {
+  auto it = thread_arenas.find(id_);
+  if (it == thread_arenas.end()) {
+    // drop the buffers of the arenas destroyed since
+    for (auto e = thread_arenas.begin(); e != thread_arenas.end();) {
+      if (e->second.owner.expired()) {
+        e = thread_arenas.erase(e);
+      } else {
+        ++e;
+      }
+    }
+    it = thread_arenas.emplace(id_, ThreadArena{alive_, at::Tensor()}).first;
+  }
+  auto& arena = it->second.buffer;
+  if (!arena.defined() || arena.numel() < nbytes) {
+    arena = at::empty({nbytes}, at::TensorOptions().dtype(at::kByte));
+  }
+  return arena;
+}
+
+at::Tensor arena_view(
+    const at::Tensor& arena,
+    int64_t offset,
+    at::IntArrayRef sizes,
+    at::IntArrayRef strides,
+    at::ScalarType dtype) {
+  auto view = at::empty({0}, arena.options().dtype(dtype));
+  // offsets are aligned to kArenaAlignment, so they are a multiple of the
+  // element size of any dtype
+  view.set_(arena.storage(), offset / at::elementSize(dtype), sizes, strides);
+  return view;
+}
+
+void StaticMemoryPlanning(std::shared_ptr<Graph>& graph) {
+  // A forked subgraph may still use a tensor after the node which forked it,
+  // leave such graphs to the caching allocator.
+  DepthFirstGraphNodeIterator it(graph);
+  for (Node* node = it.next(); node != nullptr; node = it.next()) {
+    if (node->kind() == prim::fork) {
+      return;
+    }
+  }
+
+  Block* top_block = graph->block();
+  std::unordered_map<Node*, int64_t> node_index;
+  std::vector<Value*> values(graph->inputs().begin(), graph->inputs().end());
+  int64_t index = 0;
+  for (Node* node : top_block->nodes()) {
+    node_index[node] = index++;
+  }
+  DepthFirstGraphNodeIterator value_it(graph);
+  for (Node* node = value_it.next(); node != nullptr; node = value_it.next()) {
+    for (auto* output : node->outputs()) {
+      values.push_back(output);
+    }
+  }
+
+  AliasDb alias_db(graph);
+  std::vector<PlannedTensor> planned;
+  for (Node* node : top_block->nodes()) {
+    // the producers already writing into a slice of a concatenation have
+    // their output argument
+    if (!opsWithOutVariant().count(node->kind()) ||
+        node->inputs().size() != 2 || node->outputs().size() != 1) {
+      continue;
+    }
+    Value* output = node->output();
+    PlannedTensor cur;
+    if (!getCompleteOutputType(node, cur)) {
+      continue;
+    }
+    // the buffer is reused by the next invocation, so it must neither be
+    // returned nor be stored into anything coming from the caller
+    if (alias_db.mayContainAlias(output, graph->outputs()) ||
+        alias_db.mayContainAlias(output, graph->inputs())) {
+      continue;
+    }
+    cur.node = node;
+    cur.begin = node_index[node];
+    cur.end = cur.begin;
+    // the buffer stays alive as long as any view or container of it is used
+    bool escaped = false;
+    for (auto* value : values) {
+      if (value != output && !alias_db.mayContainAlias(output, value)) {
+        continue;
+      }
+      for (const auto& use : value->uses()) {
+        auto use_index = topLevelIndex(use.user, top_block, node_index);
+        if (use_index < 0) {
+          escaped = true;
+          break;
+        }
+        cur.end = std::max(cur.end, use_index);
+      }
+      if (escaped) {
+        break;
+      }
+    }
+    if (!escaped) {
+      planned.push_back(std::move(cur));
+    }
+  }
+  if (planned.empty()) {
+    return;
+  }
+
+  int64_t arena_size = assignOffsets(planned);
+  GRAPH_DEBUG(
+      "StaticMemoryPlanning: planned ",
+      planned.size(),
+      " tensors into an arena of ",
+      arena_size,
+      " bytes");
+
+  Value* arena = nullptr;
+  {
+    WithInsertPoint guard(*top_block->nodes().begin());
+    arena = graph->insert(
+        Symbol::fromQualString("ipex::static_arena"), {arena_size});
+  }
+  for (auto& cur : planned) {
+    Node* node = cur.node;
+    WithInsertPoint guard(node);
+    Value* buffer = graph->insert(
+        Symbol::fromQualString("ipex::arena_view"),
+        {arena,
+         cur.offset,
+         cur.sizes,
+         cur.strides,
+         static_cast<int64_t>(cur.dtype)});
+    buffer->setType(node->output()->type());
+    // kind is unchanged, the extra output argument selects the ".out"
+    // overload of the op
+    Node* out_node = graph->create(
+        node->kind(), {node->input(0), buffer, node->input(1)}, 1);
+    out_node->insertBefore(node);
+    out_node->output()->setType(node->output()->type());
+    node->output()->replaceAllUsesWith(out_node->output());
+    node->destroy();
+  }
+  GRAPH_DUMP("After StaticMemoryPlanning", graph);
+}
+
+} // namespace jit
+} // namespace torch_ipex
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <memory>
+#include <unordered_set>
+
+namespace torch_ipex {
+namespace jit {
+
+// Plans the outputs of the IPEX ops which have an out variant
+// (ipex_prepack::linear_*_run and ipex_prepack::convolution_*_run) into one
+// preallocated arena. The lifetimes of these intermediate tensors are computed
+// on the frozen graph and their byte ranges are assigned by a greedy interval
+// colouring, so tensors which are never alive at the same time share memory.
+// Only tensors with complete (profiled) types which do not escape the graph
+// are planned, the ops fail when they are fed with another input shape.
+void StaticMemoryPlanning(std::shared_ptr<torch::jit::Graph>& graph);
+
+// The ops whose output may be written into a given buffer through their
+// ".out" overload, which takes it right after the input.
+const std::unordered_set<torch::jit::Symbol>& opsWithOutVariant();
+
+// The arena backing ipex::static_arena. One buffer is kept per calling thread,
+// so concurrent inference streams running the same graph do not share it, and
+// it is reused across invocations to avoid the allocator traffic. The buffers
+// are owned by the threads, they are freed when their thread exits or, the
+// next time the thread gets an arena, once the graph is destroyed.
+class StaticArena {
+ public:
+  StaticArena();
+
+  at::Tensor get(int64_t nbytes);
+
+ private:
+  // unique to the arena, unlike its address which may be reused
+  const uint64_t id_;
+  // expires with the arena
+  std::shared_ptr<char> alive_;
+};
+
+// Returns a tensor of the given dtype, sizes and strides which lives at the
+// byte offset of the arena, backing ipex::arena_view.
+at::Tensor arena_view(
+    const at::Tensor& arena,
+    int64_t offset,
+    at::IntArrayRef sizes,
+    at::IntArrayRef strides,
+    at::ScalarType dtype);
+
+} // namespace jit
+} // namespace torch_ipex
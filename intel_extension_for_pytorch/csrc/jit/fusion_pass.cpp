@@ -1,14 +1,19 @@
 #include "fusion_pass.h"
 #include <string>
+#include "auto_opt_config.h"
 #include "codegen/onednn/interface.h"
 #include "cpu/kernels/Matmul.h"
+#include "cpu/passes/cat_elimination.h"
 #include "cpu/passes/concat_linear.h"
 #include "cpu/passes/frozen_conv_folding.h"
 #include "cpu/passes/frozen_linear_folding.h"
 #include "cpu/passes/graph_rewrite.h"
 #include "cpu/passes/graph_rewrite_helper.h"
+#include "cpu/passes/horizontal_fusion.h"
+#include "cpu/passes/inter_op_parallel.h"
 #include "cpu/passes/prepack_folding.h"
 #include "cpu/passes/remove_redundant_aliases.h"
+#include "cpu/passes/static_memory_planning.h"
 
 #include <c10/util/hash.h>
 #include <torch/csrc/jit/frontend/error_report.h>
@@ -77,6 +82,7 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
 
   // ipex einsum
   graph_rewrite::FusedEinsumPost(graph);
+  graph_rewrite::FusedEinsumMultiOperands(graph);
 
   // Fuse the scores calculation(dim + matmul + (add)? + softmax) for
   // Multi-Head-Attention
@@ -117,10 +123,16 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   // linear folding
   graph_rewrite::replaceFrozenIPEXLinearWithAtenLinear(
       graph, aten_linear_recorder.use_mkl());
+  graph_rewrite::replaceFrozenIPEXWoqLinearWithRun(graph);
   // concat multi-linear with same input
   torch_ipex::jit::FrozenConcatLinear(
       graph, aten_linear_recorder.get_records());
   graph_rewrite::FrozenLinearFolding(graph);
+  // group independent small linears and bmms into grouped GEMMs
+  if (AutoOptConfig::singleton().get_jit_horizontal_fusion()) {
+    torch_ipex::jit::FrozenHorizontalFusion(
+        graph, aten_linear_recorder.get_records());
+  }
 
   // linear fusion
   GRAPH_DUMP("After FrozenLinearFolding.Before insertPrePackedLinearOp", graph);
@@ -131,6 +143,7 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   GRAPH_DUMP(
       "After insertPrePackedLinearOp.Before fuseLinearWithEltwise", graph);
   graph_rewrite::fuseLinearWithEltwise(graph);
+  graph_rewrite::fuseSparseLinearWithEltwise(graph);
   GRAPH_DUMP("After fuseLinearWithEltwise.Before fuseLinearAddRelu", graph);
   graph_rewrite::fuseLinearAddRelu(graph);
   GRAPH_DUMP("After fuseLinearAddRelu.", graph);
@@ -138,6 +151,10 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
 
   // fuse add+layernorm
   graph_rewrite::FuseAddLayerNorm(graph);
+  // fuse groupnorm+silu
+  graph_rewrite::FuseGroupNormSilu(graph);
+  // fuse conv+groupnorm+silu
+  graph_rewrite::fuseConvGroupNormSilu(graph);
 
   // deconvolution fusion
   GRAPH_DUMP(
@@ -248,7 +265,8 @@ void FusionPass(std::shared_ptr<Graph>& graph) {
       "After RemoveProfileNodesAndSpecializeTypes. Before LLGA fusion pass",
       graph);
 
-  if (isQuantized(graph) || fuser::onednn::is_llga_fp32_bf16_enabled()) {
+  if (isQuantized(graph) || fuser::onednn::is_llga_fp32_bf16_enabled() ||
+      fuser::onednn::is_llga_auto_partition_enabled()) {
     RemoveRedundantAliases(graph);
     fuser::onednn::fuseGraph(graph);
   }
@@ -279,6 +297,24 @@ void FusionPass(std::shared_ptr<Graph>& graph) {
   // Note: Since TE is with priority and it has not supported inplace op yet,
   //       we make inplace optimization after TE.
   ApplyInplaceOptimization(graph);
+
+  // Let the prepacked IPEX ops feeding aten::cat write into slices of its
+  // output. It relies on the profiled shapes as well.
+  if (AutoOptConfig::singleton().get_jit_cat_elimination()) {
+    CatElimination(graph);
+  }
+
+  // Run the independent branches concurrently on partitioned CPUPools. The
+  // cost model relies on the profiled shapes as well.
+  if (AutoOptConfig::singleton().get_jit_inter_op_parallel()) {
+    InterOpParallel(graph);
+  }
+
+  // Plan the outputs of the prepacked IPEX ops into a static arena. It relies
+  // on the profiled shapes, so it must run before they are removed.
+  if (AutoOptConfig::singleton().get_jit_static_memory_plan()) {
+    StaticMemoryPlanning(graph);
+  }
   RemoveTensorTypeSpecializations(graph);
   GRAPH_DUMP(
       "After RemoveTensorTypeSpecializations. End of optimization pass", graph);
@@ -2,6 +2,8 @@
 
 #include "intel_extension_for_pytorch/csrc/aten/cpu/utils/isa_help.h"
 #include "intel_extension_for_pytorch/csrc/jit/codegen/onednn/interface.h"
+#include "intel_extension_for_pytorch/csrc/jit/cpu/kernels/PackedWeightFormat.h"
+#include "intel_extension_for_pytorch/csrc/jit/cpu/kernels/WeightSharing.h"
 #include "intel_extension_for_pytorch/csrc/version.h"
 
 #include <c10/core/Device.h>
@@ -99,6 +101,21 @@ void InitIpexModuleBindings(py::module m) {
   m.def(
       "set_llga_fp32_bf16_enabled",
       &torch_ipex::jit::fuser::onednn::set_llga_fp32_bf16_enabled);
+  m.def(
+      "is_llga_auto_partition_enabled",
+      &torch_ipex::jit::fuser::onednn::is_llga_auto_partition_enabled);
+  m.def(
+      "set_llga_auto_partition_enabled",
+      &torch_ipex::jit::fuser::onednn::set_llga_auto_partition_enabled);
+  m.def(
+      "set_llga_auto_partition_cache_file",
+      &torch_ipex::jit::fuser::onednn::set_llga_auto_partition_cache_file);
+  m.def(
+      "is_llga_dynamic_shape_enabled",
+      &torch_ipex::jit::fuser::onednn::is_llga_dynamic_shape_enabled);
+  m.def(
+      "set_llga_dynamic_shape_enabled",
+      &torch_ipex::jit::fuser::onednn::set_llga_dynamic_shape_enabled);
   m.def(
       "_jit_set_llga_weight_cache_enabled",
       &torch_ipex::jit::fuser::onednn::setLlgaWeightCacheEnabled);
@@ -115,6 +132,73 @@ void InitIpexModuleBindings(py::module m) {
   m.def("get_jit_opt", []() {
     return AutoOptConfig::singleton().get_jit_fuse();
   });
+  m.def("enable_jit_static_memory_plan", []() {
+    AutoOptConfig::singleton().set_jit_static_memory_plan(true);
+  });
+  m.def("disable_jit_static_memory_plan", []() {
+    AutoOptConfig::singleton().set_jit_static_memory_plan(false);
+  });
+  m.def("get_jit_static_memory_plan", []() {
+    return AutoOptConfig::singleton().get_jit_static_memory_plan();
+  });
+  m.def("enable_jit_cat_elimination", []() {
+    AutoOptConfig::singleton().set_jit_cat_elimination(true);
+  });
+  m.def("disable_jit_cat_elimination", []() {
+    AutoOptConfig::singleton().set_jit_cat_elimination(false);
+  });
+  m.def("get_jit_cat_elimination", []() {
+    return AutoOptConfig::singleton().get_jit_cat_elimination();
+  });
+  m.def("enable_jit_inter_op_parallel", []() {
+    AutoOptConfig::singleton().set_jit_inter_op_parallel(true);
+  });
+  m.def("disable_jit_inter_op_parallel", []() {
+    AutoOptConfig::singleton().set_jit_inter_op_parallel(false);
+  });
+  m.def("get_jit_inter_op_parallel", []() {
+    return AutoOptConfig::singleton().get_jit_inter_op_parallel();
+  });
+  m.def("enable_jit_horizontal_fusion", []() {
+    AutoOptConfig::singleton().set_jit_horizontal_fusion(true);
+  });
+  m.def("disable_jit_horizontal_fusion", []() {
+    AutoOptConfig::singleton().set_jit_horizontal_fusion(false);
+  });
+  m.def("get_jit_horizontal_fusion", []() {
+    return AutoOptConfig::singleton().get_jit_horizontal_fusion();
+  });
+  m.def("enable_jit_sparse_linear", []() {
+    AutoOptConfig::singleton().set_jit_sparse_linear(true);
+  });
+  m.def("disable_jit_sparse_linear", []() {
+    AutoOptConfig::singleton().set_jit_sparse_linear(false);
+  });
+  m.def("get_jit_sparse_linear", []() {
+    return AutoOptConfig::singleton().get_jit_sparse_linear();
+  });
+
+  // serialize the prepacked weights in their packed layout
+  m.def(
+      "set_packed_weight_serialization_enabled",
+      &torch_ipex::cpu::detail::set_packed_weight_serialization_enabled);
+  m.def(
+      "is_packed_weight_serialization_enabled",
+      &torch_ipex::cpu::detail::is_packed_weight_serialization_enabled);
+
+  // share the prepacked weights between processes through mapped files
+  m.def(
+      "set_weight_sharing_dir",
+      &torch_ipex::cpu::detail::set_weight_sharing_dir);
+  m.def(
+      "get_weight_sharing_dir",
+      &torch_ipex::cpu::detail::get_weight_sharing_dir);
+  m.def(
+      "set_weight_sharing_hugepage",
+      &torch_ipex::cpu::detail::set_weight_sharing_hugepage);
+  m.def(
+      "set_weight_sharing_numa_replica",
+      &torch_ipex::cpu::detail::set_weight_sharing_numa_replica);
 
   // BF32
   py::enum_<FP32MathMode>(m, "FP32MathMode")
@@ -84,7 +84,9 @@ def optimize(
     split_master_weight_for_bf16=None,
     fuse_update_step=None,
     auto_kernel_selection=None,
-    sample_input=None
+    sample_input=None,
+    weight_only_quant=None,
+    weight_only_quant_group_size=None
 ):
     r"""
     Apply optimizations at Python frontend to the given model (nn.Module), as
@@ -167,6 +169,19 @@ def optimize(
             ``True``. You might get better performance at the cost of extra memory usage.
             The default value is ``None``. Explicitly setting this knob overwrites the
             configuration set by ``level`` knob.
+        weight_only_quant (string) [experimental]: ``"int8"`` or ``"int4"``.
+            Quantizes the weights of ``nn.Linear`` to the given type while the
+            activations stay in ``torch.float`` or ``torch.bfloat16``. The
+            weights are dequantized on the fly in the kernel, which cuts the
+            weight memory traffic of memory-bound inference, e.g. large
+            language model decoding with small batches. It only works for
+            inference model. The default value is ``None``, meaning no weight
+            only quantization.
+        weight_only_quant_group_size (int) [experimental]: Number of
+            consecutive weights of an output channel sharing a quantization
+            scale. Linear layers whose ``in_features`` it doesn't divide fall
+            back to one scale per output channel. The default value is
+            ``None``, meaning one scale per output channel.
 
     Returns:
         Model and optimizer (if given) modified according to the ``level`` knob
@@ -217,6 +232,10 @@ def optimize(
         assert optimizer is not None, "The optimizer should be given for training mode"
     else:
         assert optimizer is None, "The optimizer should not be given for inference mode"
+    if weight_only_quant is not None:
+        assert not model.training, "The weight only quantization only works for inference mode"
+        assert weight_only_quant in ["int8", "int4"], \
+            "Unexpected weight only quantization type {}. Options are 'int8', 'int4'.".format(weight_only_quant)
 
     opt_properties = _Properties()
     if level not in opt_levels:
@@ -264,6 +283,12 @@ def optimize(
             utils._model_convert.replace_dropout_with_identity(optimized_model)
         if dtype == torch.bfloat16:
             optimized_model = utils._model_convert.convert_module_data_type(optimized_model, torch.bfloat16)
+        if weight_only_quant is not None:
+            # the quantized linears are not nn.Linear anymore, weight prepack skips them
+            optimized_model = utils._weight_prepack.weight_only_quantize_linear(
+                optimized_model,
+                8 if weight_only_quant == "int8" else 4,
+                weight_only_quant_group_size if weight_only_quant_group_size is not None else 0)
 
     if opt_properties.optimize_lstm:
         utils._model_convert.replace_lstm_with_ipex_lstm(optimized_model)
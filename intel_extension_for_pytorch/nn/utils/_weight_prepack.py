@@ -170,6 +170,30 @@ class _IPEXLinear(torch.nn.Module):
                               missing_keys, unexpected_keys, error_msgs):
         assert False, "_IPEXLinear does not support _load_from_state_dict method"
 
+class _IPEXWoqLinear(nn.Module):
+    r"""
+    Inference linear with its weight quantized to int8 or int4. The weight is
+    dequantized on the fly by the kernel, the activations stay in fp32 or bf16.
+    """
+    __constants__ = ['in_features', 'out_features', 'bits', 'group_size']
+
+    def __init__(self, dense_module, bits, group_size):
+        super(_IPEXWoqLinear, self).__init__()
+        self.in_features = dense_module.in_features
+        self.out_features = dense_module.out_features
+        self.bits = bits
+        self.group_size = group_size
+        bias = dense_module.bias.detach() if dense_module.bias is not None else None
+        self.ctx = torch.ops.ipex_prepack.woq_linear_prepack(
+            dense_module.weight.detach(), bias, bits, group_size)
+
+    def forward(self, x):
+        return torch.ops.torch_ipex.ipex_woq_linear(x, self.ctx.get_data_handle())
+
+    def extra_repr(self):
+        return 'in_features={}, out_features={}, bits={}, group_size={}'.format(
+            self.in_features, self.out_features, self.bits, self.group_size)
+
 class _IPEXConvTransposeNd(nn.Module):
     __constants__ = ['stride', 'padding', 'dilation', 'groups',
                      'out_channels', 'kernel_size', 'output_padding']
@@ -353,6 +377,27 @@ def weight_prepack_with_ipex(module, optimizer, params_attr, auto_kernel_selecti
         optim._optimizer_utils.patch_state_dict(opt_optmizer)
     return opt_model, opt_optmizer, params_attr
 
+def weight_only_quantize_linear(module, bits, group_size):
+    def convert(m):
+        if type(m) is torch.nn.Linear and (m.weight.dtype == torch.float32 or m.weight.dtype == torch.bfloat16):
+            layer_group_size = group_size
+            if group_size > 0 and m.in_features % group_size != 0:
+                warnings.warn(
+                    "The weight only quantization group size {} does not divide in_features {}, ".format(
+                        group_size, m.in_features) +
+                    "will quantize the weight per output channel")
+                layer_group_size = 0
+            return _IPEXWoqLinear(m, bits, layer_group_size)
+        return m
+
+    def convert_rec(m):
+        new_m = convert(m)
+        for name, sub_m in m.named_children():
+            setattr(new_m, name, convert_rec(sub_m))
+        return new_m
+
+    return convert_rec(module)
+
 def record_input_shape_for_prepack(module, sample_input):
 
     def hook_function(self, input):
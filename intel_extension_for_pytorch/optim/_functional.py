@@ -34,6 +34,25 @@ def _make_sparse(grad, grad_indices, values):
         return torch.empty_like(grad)
     return torch.sparse_coo_tensor(grad_indices, values, size)
 
+def _can_fuse_sparse_adagrad(param, grad, state_sum, param2):
+    # The fused sparse step reads a grad of the dtype of the weight it updates,
+    # which is BFloat16 when the weight has a BFloat16 trail or copy, and
+    # updates the rows in place
+    if param2.numel() == 0:
+        dtype_match = param.dtype in (torch.float, torch.double) and grad.dtype == param.dtype
+    else:
+        dtype_match = (
+            param.dtype in (torch.bfloat16, torch.float) and
+            param2.dtype == torch.bfloat16 and
+            grad.dtype == torch.bfloat16
+        )
+    return (
+        dtype_match and
+        param.is_contiguous() and
+        state_sum.is_contiguous() and
+        (param2.numel() == 0 or param2.is_contiguous())
+    )
+
 def _single_tensor_adagrad(params: List[Tensor],
                            params2: List[Tensor],
                            grads: List[Tensor],
@@ -53,7 +72,10 @@ def _single_tensor_adagrad(params: List[Tensor],
         step_t += 1
         step = step_t.item()
         grad = grad if not maximize else -grad
-        if not (grad.is_sparse or torch.is_complex(param)):
+        # sparse grads are fused too, the rows of a split master weight are
+        # updated on its top and bottom halves in place
+        if not torch.is_complex(param) and (
+                not grad.is_sparse or _can_fuse_sparse_adagrad(param, grad, state_sum, param2)):
             torch.ops.torch_ipex.adagrad_fused_step(
                 param,
                 grad,
@@ -0,0 +1,66 @@
+import torch
+import intel_extension_for_pytorch as ipex
+import argparse
+import time
+
+try:
+    import torchvision
+    HAS_TORCHVISION = True
+except ImportError:
+    HAS_TORCHVISION = False
+
+def make_inputs(batch_size, num_rois, channels, height, width, dtype, channels_last):
+    x = torch.randn(batch_size, channels, height, width).to(dtype)
+    if channels_last:
+        x = x.to(memory_format=torch.channels_last)
+    # Mask R-CNN style proposals: thousands of boxes spread over every image
+    xy = torch.rand(num_rois, 2) * torch.tensor([width * 0.8, height * 0.8])
+    wh = torch.rand(num_rois, 2) * torch.tensor([width * 0.2, height * 0.2]) + 1
+    idx = torch.randint(0, batch_size, (num_rois, 1)).float()
+    rois = torch.cat([idx, xy, xy + wh], dim=1)
+    return x, rois
+
+def benchmark(fn, x, rois, num_iters):
+    with torch.no_grad():
+        for _ in range(10):
+            fn(x, rois)
+        startT = time.time()
+        for _ in range(num_iters):
+            fn(x, rois)
+        endT = time.time()
+    return (endT - startT) * 1000 / num_iters
+
+def run():
+    parser = argparse.ArgumentParser(
+        description="benchmark for ipex RoIAlign"
+    )
+    parser.add_argument("--batch-size", type=int, default=2)
+    parser.add_argument("--num-rois", type=int, default=2000)
+    parser.add_argument("--channels", type=int, default=256)
+    parser.add_argument("--height", type=int, default=200)
+    parser.add_argument("--width", type=int, default=336)
+    parser.add_argument("--num-iters", type=int, default=100)
+    parser.add_argument("--bf16", action="store_true", default=False)
+    parser.add_argument("--channels-last", action="store_true", default=False)
+    args = parser.parse_args()
+    dtype = torch.bfloat16 if args.bf16 else torch.float32
+    x, rois = make_inputs(args.batch_size, args.num_rois, args.channels,
+                          args.height, args.width, dtype, args.channels_last)
+
+    ipex_roi_align = ipex.nn.modules._roi_align.RoIAlign(
+        (7, 7), spatial_scale=0.25, sampling_ratio=2, aligned=True)
+    avg_elapsed = benchmark(ipex_roi_align, x, rois, args.num_iters)
+    print("Took {} ms on average to run {} FW".format(avg_elapsed, "ipex RoIAlign"))
+
+    if HAS_TORCHVISION:
+        # torchvision::roi_align is overridden by ipex on the autograd key,
+        # dispatch below autograd to reach the stock per-ROI kernel
+        def torchvision_roi_align(x, rois):
+            with torch._C._AutoDispatchBelowADInplaceOrView():
+                return torch.ops.torchvision.roi_align(
+                    x, rois, 0.25, 7, 7, 2, True)
+        avg_elapsed = benchmark(torchvision_roi_align, x, rois, args.num_iters)
+        print("Took {} ms on average to run {} FW".format(avg_elapsed, "torchvision RoIAlign"))
+
+if __name__ == "__main__":
+    run()
@@ -363,6 +363,57 @@ class TestBatchNorm(TestCase):
             bn.bias.data = torch.randn(100)
             self._test_batch_norm(bn, dim = dim)
 
+    def test_batch_norm_train_channels_last(self):
+        for dim, dtype, affine in itertools.product([2, 3], [torch.float32, torch.bfloat16], [True, False]):
+            memory_format = torch.channels_last if dim == 2 else torch.channels_last_3d
+            input_size = [8, 40, 14, 14] if dim == 2 else [4, 40, 6, 7, 5]
+            bn = bn_m[dim](40, affine=affine).train()
+            if affine:
+                bn.weight.data = torch.randn(40)
+                bn.bias.data = torch.randn(40)
+            ref_bn = copy.deepcopy(bn)
+            x = torch.randn(input_size) + 3
+            ref_x = x.clone().to(dtype).float().requires_grad_()
+            x_cl = x.clone().to(dtype).to(memory_format=memory_format).requires_grad_()
+            grad = torch.randn(input_size)
+
+            ref_y = ref_bn(ref_x)
+            ref_y.backward(grad.to(dtype).float())
+            with torch.cpu.amp.autocast():
+                y = bn(x_cl)
+                y.backward(grad.to(dtype).to(memory_format=memory_format))
+            prec = 0.05 if dtype == torch.bfloat16 else 1e-4
+            self.assertEqual(y.dtype, dtype)
+            self.assertTrue(y.is_contiguous(memory_format=memory_format))
+            self.assertTrue(x_cl.grad.is_contiguous(memory_format=memory_format))
+            self.assertEqual(y.float(), ref_y, prec=prec)
+            self.assertEqual(x_cl.grad.float(), ref_x.grad, prec=prec)
+            self.assertEqual(bn.running_mean, ref_bn.running_mean, prec=1e-4)
+            self.assertEqual(bn.running_var, ref_bn.running_var, prec=1e-4)
+            if affine:
+                self.assertEqual(bn.weight.grad, ref_bn.weight.grad, prec=prec * 10)
+                self.assertEqual(bn.bias.grad, ref_bn.bias.grad, prec=prec * 10)
+
+    def test_batch_norm_relu_train(self):
+        bn = nn.BatchNorm2d(32).train()
+        bn.weight.data = torch.randn(32)
+        bn.bias.data = torch.randn(32)
+        ref_bn = copy.deepcopy(bn)
+        x = torch.randn(4, 32, 10, 10).to(memory_format=torch.channels_last)
+        x1 = x.clone().requires_grad_()
+        x2 = x.clone().requires_grad_()
+        y1 = torch.ops.torch_ipex.batch_norm_relu(
+            x1, bn.weight, bn.bias, bn.running_mean, bn.running_var, True, 0.1, 1e-5)
+        y2 = torch.relu(ref_bn(x2))
+        y1.sum().backward()
+        y2.sum().backward()
+        self.assertEqual(y1, y2, prec=1e-4)
+        self.assertEqual(x1.grad, x2.grad, prec=1e-4)
+        self.assertEqual(bn.weight.grad, ref_bn.weight.grad, prec=1e-3)
+        self.assertEqual(bn.bias.grad, ref_bn.bias.grad, prec=1e-3)
+        self.assertEqual(bn.running_mean, ref_bn.running_mean)
+        self.assertEqual(bn.running_var, ref_bn.running_var)
+
 class M(nn.Module):
     def __init__(self, input_size, hidden_size, num_layers, bidirectional, bias, dropout, batch_first):
         super(M, self).__init__()
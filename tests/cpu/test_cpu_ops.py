@@ -553,6 +553,28 @@ class CPUOPsTester(TestCase):
         helper(self, (2, 30, 9, 9), 3, torch.channels_last, torch.double)
         helper(self, (2, 9, 7, 11, 15), 3, torch.channels_last_3d, torch.double)
 
+    def test_groupnorm_contiguous(self):
+        # the N * groups tasks can't keep the threads busy when N is small,
+        # then every group is reduced in chunks
+        for size, groups, affine, dtype in itertools.product(
+                [(4, 8, 10, 10), (1, 64, 96, 96), (2, 32, 7, 5, 3)],
+                [1, 8, 32],
+                [True, False],
+                [torch.float32, torch.bfloat16]):
+            prec = 1e-5 if dtype == torch.float32 else 0.04
+            x = torch.randn(size) * 3 + 1
+            gn = nn.GroupNorm(groups, size[1], affine=affine)
+            if affine:
+                gn.weight.data.uniform_()
+                gn.bias.data.uniform_()
+            ref_gn = copy.deepcopy(gn).double()
+            ref_out = ref_gn(x.double())
+            gn = gn.to(dtype)
+            out = gn(x.to(dtype))
+            self.assertTrue(out.dtype == dtype)
+            self.assertTrue(out.is_contiguous())
+            self.assertEqual(out.double(), ref_out, prec=prec)
+
     def test_groupnorm_nwc(self):
         size = (4, 20, 20)
         channels = size[1]
@@ -760,6 +782,57 @@ class CPUOPsTester(TestCase):
             y2 = torch.mean(x2, dim=(3, 4), keepdim=False, dtype=dtype)
             self.assertEqual(y1, y2)
 
+        # the mean is scaled as the sum is stored, compare with sum / numel
+        for dtype in [torch.float32, torch.double, torch.bfloat16]:
+            x = torch.randn(4, 32, 28, 28).to(dtype)
+            x_cl = x.to(memory_format=torch.channels_last)
+            for dim in [(2, 3), (1,), (0, 2, 3), (0, 1, 2, 3), None]:
+                for keepdim in [True, False]:
+                    if dim is None:
+                        ref = x.double().sum() / x.numel()
+                        y = torch.mean(x)
+                        y_cl = torch.mean(x_cl)
+                    else:
+                        ref = x.double().sum(dim, keepdim=keepdim)
+                        ref = ref / (x.numel() // ref.numel())
+                        y = torch.mean(x, dim, keepdim=keepdim)
+                        y_cl = torch.mean(x_cl, dim, keepdim=keepdim)
+                    prec = 1e-2 if dtype == torch.bfloat16 else 1e-5
+                    self.assertEqual(y.dtype, dtype)
+                    self.assertEqual(y.double(), ref, prec=prec)
+                    self.assertEqual(y_cl.double(), ref, prec=prec)
+
+    def test_var_mean(self):
+        def helper(x, dim, unbiased, keepdim, prec):
+            ref_var, ref_mean = torch.var_mean(x.double(), dim, unbiased=unbiased, keepdim=keepdim)
+            var, mean = torch.var_mean(x, dim, unbiased=unbiased, keepdim=keepdim)
+            std, std_mean = torch.std_mean(x, dim, unbiased=unbiased, keepdim=keepdim)
+            self.assertEqual(var.dtype, x.dtype)
+            self.assertEqual(var.double(), ref_var, prec=prec)
+            self.assertEqual(mean.double(), ref_mean, prec=prec)
+            self.assertEqual(std.double(), ref_var.sqrt(), prec=prec)
+            self.assertEqual(std_mean, mean)
+            self.assertEqual(torch.var(x, dim, unbiased=unbiased, keepdim=keepdim), var)
+            self.assertEqual(torch.std(x, dim, unbiased=unbiased, keepdim=keepdim), std)
+
+        for dtype in [torch.float32, torch.double, torch.bfloat16]:
+            prec = 5e-2 if dtype == torch.bfloat16 else 1e-4
+            # a large offset checks the stability of the single pass
+            offset = 1 if dtype == torch.bfloat16 else 100
+            x = (torch.randn(8, 64, 56, 56) * 2 + offset).to(dtype)
+            x_cl = x.to(memory_format=torch.channels_last)
+            for dim, unbiased, keepdim in itertools.product(
+                    [(2, 3), (1, 2, 3), (0, 2, 3), (0,), (1, 3)], [True, False], [True, False]):
+                helper(x, dim, unbiased, keepdim, prec)
+                helper(x_cl, dim, unbiased, keepdim, prec)
+            # a full reduction split between the threads
+            helper(x.flatten(), 0, True, False, prec)
+            helper(x[:, :, :, :3], (2, 3), True, False, prec)
+
+        # less elements than the correction
+        var = torch.var(torch.randn(4, 1), 1)
+        self.assertTrue(torch.isnan(var).all())
+
     def test_sum(self):
         def helper(self, x1, x2, dim, keepdim, dtype):
             y1 = torch.sum(x1, dim=dim, keepdim=keepdim, dtype=dtype)
@@ -922,6 +995,70 @@ class CPUOPsTester(TestCase):
                 y1_5 = torch.index_select(x1_5, dim, indices, out=torch.empty(0))
                 self.assertTrue(y1_5.dtype == torch.float32)
 
+    def test_index_add(self):
+        # small shapes take the sequential loop, large ones the sorted one,
+        # inner size 1 the vector gathers
+        shapes = [(10, 4), (1000, 1), (1000, 64), (8, 500, 3)]
+        for shape, dim, index_datatype, datatype, alpha in itertools.product(
+                shapes, [0, 1, -1], [torch.int32, torch.int64],
+                [torch.float32, torch.bfloat16], [1, 0.5]):
+            self_ref = torch.randn(shape, dtype=torch.double)
+            num_indices = 3 * shape[dim]
+            index = torch.randint(0, shape[dim], (num_indices,), dtype=index_datatype)
+            source_shape = list(shape)
+            source_shape[dim] = num_indices
+            source_ref = torch.randn(source_shape, dtype=torch.double)
+            ref = self_ref.index_add(dim, index, source_ref, alpha=alpha)
+
+            x = self_ref.to(datatype)
+            source = source_ref.to(datatype)
+            prec = 0.1 if datatype == torch.bfloat16 else 1e-4
+            self.assertEqual(x.index_add(dim, index, source, alpha=alpha), ref.to(datatype), prec=prec)
+            out = torch.empty(0, dtype=datatype)
+            torch.index_add(x, dim, index, source, alpha=alpha, out=out)
+            self.assertEqual(out, ref.to(datatype), prec=prec)
+            x.index_add_(dim, index, source, alpha=alpha)
+            self.assertEqual(x, ref.to(datatype), prec=prec)
+
+        # out of range indices are still reported
+        x = torch.randn(1000, 64)
+        index = torch.randint(0, 1000, (3000,))
+        index[1234] = 1000
+        with self.assertRaises(IndexError):
+            x.index_add_(0, index, torch.randn(3000, 64))
+
+    def test_scatter_add_index_put(self):
+        for datatype in [torch.float32, torch.bfloat16]:
+            prec = 0.1 if datatype == torch.bfloat16 else 1e-4
+            for num_rows, num_features in [(10, 4), (1000, 64), (5000, 1)]:
+                src_ref = torch.randn(3 * num_rows, num_features, dtype=torch.double)
+                index = torch.randint(0, num_rows, (3 * num_rows,))
+                self_ref = torch.randn(num_rows, num_features, dtype=torch.double)
+
+                # the index of a scatter over the rows is broadcast along the
+                # features
+                expanded_index = index.view(-1, 1).expand_as(src_ref)
+                ref = self_ref.scatter_add(0, expanded_index, src_ref)
+                x = self_ref.to(datatype)
+                src = src_ref.to(datatype)
+                self.assertEqual(x.scatter_add(0, expanded_index, src), ref.to(datatype), prec=prec)
+                y = x.clone()
+                y.scatter_add_(0, expanded_index, src)
+                self.assertEqual(y, ref.to(datatype), prec=prec)
+                # a general index
+                general_index = torch.randint(0, num_rows, src_ref.shape)
+                self.assertEqual(
+                    x.scatter_add(0, general_index, src),
+                    self_ref.scatter_add(0, general_index, src_ref).to(datatype),
+                    prec=prec)
+
+                # index_put_ with accumulate, with negative indices
+                neg_index = index - num_rows * (index % 2)
+                ref = self_ref.index_put((neg_index,), src_ref, accumulate=True)
+                y = x.clone()
+                y.index_put_((neg_index,), src, accumulate=True)
+                self.assertEqual(y, ref.to(datatype), prec=prec)
+
     def test_cat(self):
         for datatype in [torch.float32, torch.double, torch.bfloat16]:
             for dim, size in itertools.product([0, 1], [[2, 1], [2, 2], [5, 10]]):
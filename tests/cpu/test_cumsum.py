@@ -56,5 +56,39 @@ class TestCumSum(TestCase):
         # Check that output maintained correct shape
         self.assertEqual(raw_tensor.shape, raw_tensor.grad.shape)
 
+    def test_segment_cumsum(self):
+        def segment_cumsum_ref(x, lengths, exclusive):
+            outs = []
+            for seg in torch.split(x.double(), lengths.tolist()):
+                out = seg.cumsum(0)
+                if exclusive:
+                    out = out - seg
+                outs.append(out)
+            return torch.cat(outs).to(x.dtype)
+
+        # empty segments, many short segments and one segment across chunks
+        for lengths in [torch.tensor([3, 0, 5, 1, 0, 7]),
+                        torch.randint(0, 300, (100,)),
+                        torch.tensor([0, 40000, 3, 0])]:
+            offsets = torch.cat([torch.zeros(1, dtype=torch.long), lengths.cumsum(0)])
+            total = int(offsets[-1])
+            for shape in [(total,), (total, 3), (total, 64)]:
+                for dtype in [torch.float, torch.bfloat16, torch.int, torch.long]:
+                    if dtype.is_floating_point:
+                        x = torch.randn(shape).to(dtype)
+                    else:
+                        x = torch.randint(-100, 100, shape).to(dtype)
+                    for exclusive in [False, True]:
+                        ref = segment_cumsum_ref(x, lengths, exclusive)
+                        res1 = torch.ops.torch_ipex.segment_cumsum(x, offsets=offsets, exclusive=exclusive)
+                        res2 = torch.ops.torch_ipex.segment_cumsum(x, lengths=lengths, exclusive=exclusive)
+                        self.assertEqual(res1, res2)
+                        if dtype == torch.bfloat16:
+                            self.assertEqual(res1, ref, atol=0.5, rtol=2e-2)
+                        elif dtype == torch.float:
+                            self.assertEqual(res1, ref, atol=1e-3, rtol=1e-4)
+                        else:
+                            self.assertEqual(res1, ref)
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -26,5 +26,21 @@ class TestCustomOp(TestCase):
         ipex_result = torch.ops.torch_ipex.add_softmax_(a, b) 
         self.assertEqual(orig_result, ipex_result)
 
+    def test_div_causal_softmax(self):
+        dim_per_head = 8.0
+        # (queries, keys): prefill, decode with a kv cache and a tail which
+        # doesn't fill an AVX512 register
+        for q_len, k_len in [(30, 30), (1, 37), (5, 40), (3, 7)]:
+            a = torch.randn(2, 4, q_len, k_len)
+            causal_mask = torch.ones(q_len, k_len, dtype=torch.bool).triu_(k_len - q_len + 1)
+            orig_result = a.div(dim_per_head).masked_fill(causal_mask, -float("inf")).softmax(-1)
+            ipex_result = torch.ops.torch_ipex.div_causal_softmax(a, dim_per_head)
+            self.assertEqual(orig_result, ipex_result)
+
+            a_bf16 = a.to(torch.bfloat16)
+            ipex_result = torch.ops.torch_ipex.div_causal_softmax(a_bf16, dim_per_head)
+            self.assertEqual(ipex_result.dtype, torch.bfloat16)
+            self.assertEqual(orig_result, ipex_result.float(), prec=2e-2)
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -0,0 +1,107 @@
+import torch
+import intel_extension_for_pytorch as ipex
+import unittest
+from common_utils import TestCase
+
+def jagged_to_padded_dense_ref(values, lengths, max_length, padding_value):
+    dense = values.new_full((lengths.numel(), max_length) + values.shape[1:], padding_value)
+    for b, seg in enumerate(torch.split(values, lengths.tolist())):
+        n = min(seg.size(0), max_length)
+        dense[b, :n] = seg[:n]
+    return dense
+
+def padded_dense_to_jagged_ref(dense, lengths):
+    segs = []
+    for b, n in enumerate(lengths.tolist()):
+        seg = dense.new_zeros((n,) + dense.shape[2:])
+        m = min(n, dense.size(1))
+        seg[:m] = dense[b, :m]
+        segs.append(seg)
+    return torch.cat(segs)
+
+class TestJagged(TestCase):
+    def _lengths_list(self):
+        # empty sequences, sequences longer than max_length and a long batch
+        return [torch.tensor([3, 0, 5, 1, 0, 7]),
+                torch.tensor([0, 0, 0]),
+                torch.randint(0, 40, (257,))]
+
+    def test_jagged_to_padded_dense(self):
+        for lengths in self._lengths_list():
+            offsets = torch.cat([torch.zeros(1, dtype=torch.long), lengths.cumsum(0)])
+            total = int(offsets[-1])
+            for shape in [(total,), (total, 5), (total, 2, 16)]:
+                for dtype in [torch.float, torch.bfloat16, torch.double, torch.long, torch.int]:
+                    values = (torch.randn(shape) * 10).to(dtype)
+                    for max_length in [0, 4, 40]:
+                        for padding_value in [0, -1]:
+                            ref = jagged_to_padded_dense_ref(values, lengths, max_length, padding_value)
+                            res = torch.ops.torch_ipex.jagged_to_padded_dense(
+                                values, offsets, max_length, padding_value)
+                            self.assertEqual(res, ref)
+
+                        dense = (torch.randn((lengths.numel(), max_length) + shape[1:]) * 10).to(dtype)
+                        ref = padded_dense_to_jagged_ref(dense, lengths)
+                        res = torch.ops.torch_ipex.padded_dense_to_jagged(dense, offsets)
+                        self.assertEqual(res, ref)
+                        res = torch.ops.torch_ipex.padded_dense_to_jagged(dense, offsets, total)
+                        self.assertEqual(res, ref)
+
+    def test_jagged_dense_elementwise(self):
+        for lengths in self._lengths_list():
+            offsets = torch.cat([torch.zeros(1, dtype=torch.long), lengths.cumsum(0)])
+            total = int(offsets[-1])
+            for shape in [(total,), (total, 5), (total, 2, 16)]:
+                for dtype in [torch.float, torch.bfloat16, torch.long]:
+                    values = (torch.randn(shape) * 10).to(dtype)
+                    for max_length in [0, 4, 40]:
+                        dense = (torch.randn((lengths.numel(), max_length) + shape[1:]) * 10).to(dtype)
+                        padded = jagged_to_padded_dense_ref(values, lengths, max(max_length, 40), 0)
+                        padded_dense = torch.zeros_like(padded)
+                        padded_dense[:, :max_length] = dense
+                        ref_add = padded_dense_to_jagged_ref(padded + padded_dense, lengths)
+                        ref_mul = padded_dense_to_jagged_ref(padded * padded_dense, lengths)
+                        res_add = torch.ops.torch_ipex.jagged_dense_elementwise_add(values, offsets, dense)
+                        res_mul = torch.ops.torch_ipex.jagged_dense_elementwise_mul(values, offsets, dense)
+                        self.assertEqual(res_add, ref_add)
+                        self.assertEqual(res_mul, ref_mul)
+
+    def test_jagged_int8(self):
+        # single row runs whose 1-byte tails are 32 to 63 bytes long
+        for lengths in [torch.tensor([1, 1, 1]), torch.tensor([3, 0, 5, 1, 0, 7])]:
+            offsets = torch.cat([torch.zeros(1, dtype=torch.long), lengths.cumsum(0)])
+            total = int(offsets[-1])
+            for D in [32, 33, 47, 63]:
+                for dtype in [torch.int8, torch.uint8]:
+                    values = torch.randint(0, 100, (total, D)).to(dtype)
+                    for max_length in [1, 4, 8]:
+                        for padding_value in [0, 3]:
+                            ref = jagged_to_padded_dense_ref(values, lengths, max_length, padding_value)
+                            res = torch.ops.torch_ipex.jagged_to_padded_dense(
+                                values, offsets, max_length, padding_value)
+                            self.assertEqual(res, ref)
+
+                        dense = torch.randint(0, 100, (lengths.numel(), max_length, D)).to(dtype)
+                        ref = padded_dense_to_jagged_ref(dense, lengths)
+                        res = torch.ops.torch_ipex.padded_dense_to_jagged(dense, offsets)
+                        self.assertEqual(res, ref)
+
+                        padded = jagged_to_padded_dense_ref(values, lengths, 8, 0)
+                        padded_dense = torch.zeros_like(padded)
+                        padded_dense[:, :max_length] = dense
+                        ref_add = padded_dense_to_jagged_ref(padded + padded_dense, lengths)
+                        ref_mul = padded_dense_to_jagged_ref(padded * padded_dense, lengths)
+                        res_add = torch.ops.torch_ipex.jagged_dense_elementwise_add(values, offsets, dense)
+                        res_mul = torch.ops.torch_ipex.jagged_dense_elementwise_mul(values, offsets, dense)
+                        self.assertEqual(res_add, ref_add)
+                        self.assertEqual(res_mul, ref_mul)
+
+    def test_jagged_invalid_offsets(self):
+        values = torch.randn(6, 4)
+        with self.assertRaises(RuntimeError):
+            torch.ops.torch_ipex.jagged_to_padded_dense(values, torch.tensor([0, 4, 2, 6]), 4)
+        with self.assertRaises(RuntimeError):
+            torch.ops.torch_ipex.jagged_to_padded_dense(values, torch.tensor([0, 2, 5]), 4)
+
+if __name__ == '__main__':
+    test = unittest.main()
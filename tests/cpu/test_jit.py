@@ -59,6 +59,10 @@ import sys
 import warnings
 import itertools
 import contextlib
+import io
+import os
+import tempfile
+import threading
 import torch
 import torch.nn as nn
 import torch.fx.experimental.optimization as optimization
@@ -968,6 +972,23 @@ class AddLayerNorm_v2(torch.nn.Module):
         z = torch.add(x,y)
         return torch.nn.functional.layer_norm(z, [self.dim,], weight=w)
 
+class GroupNormSilu(torch.nn.Module):
+    def __init__(self, groups, channels, affine=True, inplace=False):
+        super(GroupNormSilu, self).__init__()
+        self.gn = torch.nn.GroupNorm(groups, channels, affine=affine)
+        self.silu = torch.nn.SiLU(inplace=inplace)
+    def forward(self, x):
+        return self.silu(self.gn(x))
+
+class ConvGroupNormSilu(torch.nn.Module):
+    def __init__(self, in_channels, out_channels, groups, inplace=False):
+        super(ConvGroupNormSilu, self).__init__()
+        self.conv = torch.nn.Conv2d(in_channels, out_channels, 3, padding=1)
+        self.gn = torch.nn.GroupNorm(groups, out_channels)
+        self.silu = torch.nn.SiLU(inplace=inplace)
+    def forward(self, x):
+        return self.silu(self.gn(self.conv(x)))
+
 class ConcatBnRelu(torch.nn.Module):
     def __init__(self, dim, cat_dim, in_channels, **kwargs):
         super(ConcatBnRelu, self).__init__()
@@ -1064,6 +1085,13 @@ class EinsumAddInplaceV1(nn.Module):
     def forward(self, input1, input2, bias):
         return bias.add_(torch.einsum(self.equation, input1, input2))
 
+class EinsumMultiOperands(nn.Module):
+    def __init__(self, equation):
+        super(EinsumMultiOperands, self).__init__()
+        self.equation = equation
+    def forward(self, *inputs):
+        return torch.einsum(self.equation, *inputs)
+
 class AddMulDiv(nn.Module):
     def __init__(self):
         super(AddMulDiv, self).__init__()
@@ -1071,6 +1099,84 @@ class AddMulDiv(nn.Module):
     def forward(self, input):
         return torch.div(torch.mul(input, torch.add(input, 3)), 6)
 
+class ConvLinearChain(nn.Module):
+    def __init__(self):
+        super(ConvLinearChain, self).__init__()
+        self.conv1 = nn.Conv2d(3, 16, 3, padding=1)
+        self.conv2 = nn.Conv2d(16, 16, 3, padding=1)
+        self.conv3 = nn.Conv2d(16, 8, 3, padding=1)
+        self.linear1 = nn.Linear(8 * 14 * 14, 64)
+        self.linear2 = nn.Linear(64, 64)
+        self.linear3 = nn.Linear(64, 10)
+
+    def forward(self, x):
+        x = torch.relu(self.conv1(x))
+        x = self.conv2(x)
+        x = torch.relu(self.conv3(x))
+        x = x.flatten(1)
+        x = torch.relu(self.linear1(x))
+        x = self.linear2(x)
+        return self.linear3(x)
+
+class SparseLinearRelu(nn.Module):
+    def __init__(self):
+        super(SparseLinearRelu, self).__init__()
+        self.linear1 = nn.Linear(256, 256)
+        self.linear2 = nn.Linear(256, 64)
+        with torch.no_grad():
+            for linear in [self.linear1, self.linear2]:
+                linear.weight[torch.rand_like(linear.weight) < 0.9] = 0
+
+    def forward(self, x):
+        return self.linear2(F.relu(self.linear1(x)))
+
+class IndependentLinears(nn.Module):
+    def __init__(self):
+        super(IndependentLinears, self).__init__()
+        self.linear1 = nn.Linear(16, 32)
+        self.linear2 = nn.Linear(24, 32, bias=False)
+        self.linear3 = nn.Linear(16, 8)
+
+    def forward(self, x, y, z):
+        return torch.cat([self.linear1(x), self.linear2(y)], dim=1), self.linear3(z)
+
+class DependentSiblingLinears(nn.Module):
+    def __init__(self):
+        super(DependentSiblingLinears, self).__init__()
+        self.linear1 = nn.Linear(16, 32)
+        self.linear2 = nn.Linear(24, 32)
+        self.linear3 = nn.Linear(32, 8)
+
+    def forward(self, x, y):
+        # linear3 is independent of linear1 but depends on its sibling linear2
+        return self.linear1(x), self.linear3(self.linear2(y))
+
+class IndependentBmms(nn.Module):
+    def forward(self, a, b, c, d):
+        return torch.bmm(a, b), torch.bmm(c, d.transpose(1, 2))
+
+class TwoTowers(nn.Module):
+    def __init__(self):
+        super(TwoTowers, self).__init__()
+        self.tower1 = nn.Sequential(nn.Linear(512, 512), nn.ReLU(), nn.Linear(512, 512))
+        self.tower2 = nn.Sequential(nn.Linear(512, 512), nn.ReLU(), nn.Linear(512, 512))
+
+    def forward(self, x, y):
+        return torch.cat((self.tower1(x), self.tower2(y)), dim=1)
+
+class ConvCat(nn.Module):
+    def __init__(self):
+        super(ConvCat, self).__init__()
+        self.conv1 = nn.Conv2d(3, 16, 3, padding=1)
+        self.conv2 = nn.Conv2d(3, 8, 1)
+        self.conv3 = nn.Conv2d(3, 8, 3, padding=1)
+
+    def forward(self, x):
+        y = torch.cat(
+            [torch.relu(self.conv1(x)), self.conv2(x), torch.sigmoid(x)],
+            dim=1)
+        return torch.cat([y, self.conv3(x)], dim=1)
+
 class Tester(TestCase):
     @contextlib.contextmanager
     def _texpr_enable(self, strategy):
@@ -1383,6 +1489,72 @@ class Tester(TestCase):
                 torch._C._jit_set_texpr_fuser_enabled(pre_te_enable_status)
                 self.assertTrue(any(n.kind() == node for n in trace_graph.nodes()))
 
+    def test_group_norm_silu(self):
+        for affine, inplace in itertools.product([True, False], [True, False]):
+            model = GroupNormSilu(8, 64, affine, inplace).eval()
+            x = torch.randn(2, 64, 16, 16)
+            with torch.no_grad():
+                ori_res = model(x)
+                jit_model = torch.jit.freeze(torch.jit.trace(model, x))
+                trace_graph = jit_model.graph_for(x)
+                jit_res = jit_model(x)
+            self.assertEqual(jit_res, ori_res, prec=1e-5)
+            node = "ipex::group_norm_silu"
+            self.assertTrue(any(n.kind() == node for n in trace_graph.nodes()))
+
+            with torch.no_grad():
+                x_bf16 = x.to(torch.bfloat16)
+                model_bf16 = copy.deepcopy(model).to(torch.bfloat16)
+                ori_res = model_bf16(x_bf16)
+                jit_model = torch.jit.freeze(torch.jit.trace(model_bf16, x_bf16))
+                jit_model(x_bf16)
+                jit_res = jit_model(x_bf16)
+            self.assertEqual(jit_res, ori_res, prec=5e-2)
+
+    def test_conv_group_norm_silu(self):
+        x = torch.randn(2, 16, 20, 20)
+        for inplace in [True, False]:
+            self._test_output(
+                ConvGroupNormSilu(16, 64, 8, inplace),
+                x,
+                kind_in_graph="ipex_prepack::convolution_group_norm_silu_run",
+                kind_not_in_graph="ipex::group_norm_silu",
+                prec=1e-4)
+
+            # each sample of the conv output is 576KB, the batch is split into
+            # tiles of 3 and 2 samples
+            self._test_output(
+                ConvGroupNormSilu(16, 64, 8, inplace),
+                torch.randn(5, 16, 48, 48),
+                kind_in_graph="ipex_prepack::convolution_group_norm_silu_run",
+                kind_not_in_graph="ipex::group_norm_silu",
+                prec=1e-4)
+
+            # the conv output has another use, it can't be normalized in place
+            class ConvGroupNormSiluResidual(ConvGroupNormSilu):
+                def forward(self, x):
+                    y = self.conv(x)
+                    return self.silu(self.gn(y)) + y
+            self._test_output(
+                ConvGroupNormSiluResidual(16, 64, 8, inplace),
+                x,
+                kind_in_graph="ipex::group_norm_silu",
+                kind_not_in_graph="ipex_prepack::convolution_group_norm_silu_run",
+                prec=1e-4)
+
+            model = ConvGroupNormSilu(16, 64, 8, inplace).eval().to(torch.bfloat16)
+            model = ipex.optimize(model, dtype=torch.bfloat16)
+            for memory_format in [torch.contiguous_format, torch.channels_last]:
+                x_bf16 = x.to(torch.bfloat16).to(memory_format=memory_format)
+                with torch.no_grad():
+                    ori_res = model(x_bf16)
+                    jit_model = torch.jit.freeze(torch.jit.trace(model, x_bf16))
+                    jit_model(x_bf16)
+                    trace_graph = jit_model.graph_for(x_bf16)
+                    jit_res = jit_model(x_bf16)
+                self.assertEqual(jit_res, ori_res, prec=5e-2)
+                self.assertTrue(any(n.kind() == "ipex_prepack::convolution_group_norm_silu_run" for n in trace_graph.nodes()))
+
     def test_concat_bn_relu(self):
         batch_size = 3
         image_size = 16
@@ -2766,6 +2938,25 @@ class Tester(TestCase):
 # auto_select_kernel is false, we will use mkl linear
                     self.assertTrue(any(n.kind() == 'aten::linear' for n in trace_graph.nodes()))
 
+    def test_linear_mkl_dynamic_batch(self):
+        model = LinearRelu(16, 32, bias=True).eval()
+        ref_model = copy.deepcopy(model)
+        model = ipex.optimize(model, dtype=torch.float32, auto_kernel_selection=True, sample_input=torch.rand(8, 16))
+        with torch.no_grad():
+            traced_model = torch.jit.freeze(torch.jit.trace(model, torch.rand(8, 16)))
+            # the other batch sizes are padded up to a power of two bucket, which
+            # runs unpacked until its weight is packed in the background
+            for batch_size in [8, 1, 3, 100, 64, 1, 3, 100, 64, 8, 7, 200, 2, 5, 9, 17, 33, 65]:
+                for _ in range(3):
+                    x = torch.rand(batch_size, 16)
+                    self.assertEqual(traced_model(x), ref_model(x), rtol=1e-5, atol=1e-5)
+            for _ in range(10):
+                x = torch.rand(3, 5, 16)
+                self.assertEqual(traced_model(x), ref_model(x), rtol=1e-5, atol=1e-5)
+                time.sleep(0.01)
+            trace_graph = traced_model.graph_for(x)
+            self.assertTrue(any(n.kind() == 'ipex_prepack::mkl_sgemm_run' for n in trace_graph.nodes()))
+
     def test_linear_auto_kernel_selection_bf16(self):
         x = torch.rand(32, 3)
         options = itertools.product(['O0', 'O1'], [True, False])
@@ -3493,6 +3684,41 @@ class Tester(TestCase):
         model_from_vit_alphafold2_v3 = EinsumAdd('bsh,bho->bso')
         _test_fp32(model_from_vit_alphafold2_v3, input1, input2, bias)
 
+    def test_einsum_multi_operands(self):
+        def _test(equation, inputs, kind_in_graph='ipex::einsum', prec=1e-3):
+            model = EinsumMultiOperands(equation).eval()
+            with torch.no_grad():
+                tr_model = torch.jit.trace(model, inputs)
+                tr_model = torch.jit.freeze(tr_model)
+                tr_model(*inputs)
+                tr_model(*inputs)
+                trace_graph = tr_model.graph_for(*inputs)
+                res_jit = tr_model(*inputs)
+                res_ref = model(*inputs)
+                self.assertEqual(res_ref, res_jit, prec)
+                self.assertTrue(any(n.kind() == kind_in_graph for n in trace_graph.nodes()))
+
+        # the chain is contracted from the small end whatever the order
+        _test('ij,jk,kl->il', (torch.randn(64, 8), torch.randn(8, 256), torch.randn(256, 4)))
+        _test('ij,jk,kl', (torch.randn(4, 256), torch.randn(256, 8), torch.randn(8, 64)))
+        # batch labels, transposed operands and a label summed out alone
+        _test('bij,bkj,bkl,m->bil',
+              (torch.randn(3, 16, 32),
+               torch.randn(3, 24, 32).transpose(1, 2).contiguous().transpose(1, 2),
+               torch.randn(3, 24, 8),
+               torch.randn(5)))
+        # more operands than the exhaustive search handles
+        inputs = tuple(torch.randn(6, 6) for _ in range(7))
+        _test('ab,bc,cd,de,ef,fg,gh->ah', inputs)
+        # outer product with a scalar
+        _test('i,j,->ij', (torch.randn(4), torch.randn(5), torch.tensor(2.0)))
+        # bf16
+        _test('bij,bjk,bkl->bil',
+              tuple(torch.randn(2, 16, 16).bfloat16() for _ in range(3)), prec=1e-1)
+        # repeated labels and ellipses are left to aten::einsum at runtime
+        _test('ii,ij,jk->k', (torch.randn(8, 8), torch.randn(8, 8), torch.randn(8, 4)))
+        _test('...ij,jk,kl->...il', (torch.randn(2, 4, 8), torch.randn(8, 8), torch.randn(8, 4)))
+
 
     def test_ipex_softmax(self):
         self._test_output(
@@ -3527,14 +3753,79 @@ class Tester(TestCase):
                 return self.pool(x)
 
         model = Model().eval()
-        x = torch.randn(1, 3, 24, 24)
-        with torch.no_grad():
-            ref_out = model(x)
-            traced_model = torch.jit.trace(model, x)
-            traced_out = traced_model(x)
-            self.assertEqual(ref_out, traced_out)
-            trace_graph = traced_model.graph_for(x)
-            self.assertTrue(any(n.kind() == "aten::max_pool2d" for n in trace_graph.nodes()))
+        for memory_format in [torch.contiguous_format, torch.channels_last]:
+            x = torch.randn(1, 3, 24, 24).to(memory_format=memory_format)
+            with torch.no_grad():
+                ref_out = model(x)
+                traced_model = torch.jit.trace(model, x)
+                traced_model(x)
+                traced_out = traced_model(x)
+                self.assertEqual(ref_out, traced_out)
+                trace_graph = traced_model.graph_for(x)
+                self.assertTrue(any(n.kind() == "ipex::max_pool2d" for n in trace_graph.nodes()))
+
+    def test_max_pool2d_channels_last(self):
+        class Model(nn.Module):
+            def __init__(self, ceil_mode, dilation):
+                super(Model, self).__init__()
+                self.pool = torch.nn.MaxPool2d(
+                    3, stride=2, padding=1, dilation=dilation, ceil_mode=ceil_mode)
+
+            def forward(self, x):
+                return self.pool(x)
+
+        class ReluModel(Model):
+            def forward(self, x):
+                return self.pool(torch.relu(x))
+
+        class QuantizeModel(Model):
+            def forward(self, x):
+                x = torch.quantize_per_tensor(self.pool(x), 0.05, 10, torch.quint8)
+                return x.int_repr()
+
+        x = torch.randn(2, 35, 17, 17)
+        for ceil_mode, dilation in itertools.product([False, True], [1, 2]):
+            self._test_output(
+                Model(ceil_mode, dilation),
+                x,
+                kind_in_graph="ipex::max_pool2d",
+                kind_not_in_graph="aten::max_pool2d",
+                use_channels_last=[True])
+            self._test_output_bf16(
+                Model(ceil_mode, dilation),
+                x.to(torch.bfloat16),
+                kind_in_graph="ipex::max_pool2d",
+                use_channels_last=[True])
+            self._test_output(
+                ReluModel(ceil_mode, dilation),
+                x,
+                kind_in_graph="ipex::max_pool2d_relu",
+                kind_not_in_graph="aten::relu",
+                use_channels_last=[True])
+            # the NCHW inputs are not sent to oneDNN
+            self._test_output(
+                Model(ceil_mode, dilation),
+                x,
+                kind_in_graph="aten::max_pool2d",
+                kind_not_in_graph="ipex::max_pool2d",
+                use_channels_last=[False])
+            self._test_output_bf16(
+                Model(ceil_mode, dilation),
+                x.to(torch.bfloat16),
+                kind_in_graph="aten::max_pool2d",
+                kind_not_in_graph="ipex::max_pool2d",
+                use_channels_last=[False])
+            model = QuantizeModel(ceil_mode, dilation).eval()
+            x_channels_last = x.to(memory_format=torch.channels_last)
+            with torch.no_grad():
+                ref_out = model(x_channels_last)
+                traced_model = torch.jit.trace(model, x_channels_last)
+                traced_model(x_channels_last)
+                traced_out = traced_model(x_channels_last)
+                trace_graph = traced_model.graph_for(x_channels_last)
+            # may differ by one on the rounding ties
+            self.assertEqual(ref_out.float(), traced_out.float(), prec=1)
+            self.assertTrue(any(n.kind() == "ipex::max_pool2d_quantize" for n in trace_graph.nodes()))
 
     def test_restore_inplace(self):
         class M(nn.Module):
@@ -3697,6 +3988,267 @@ class Tester(TestCase):
             result = model(input)
             self.assertEqual(tresult, result)
 
+    def test_static_memory_planning(self):
+        def count_kind(graph, kind):
+            return sum(n.kind() == kind for n in graph.nodes())
+
+        ipex._C.enable_jit_static_memory_plan()
+        try:
+            for use_channels_last in [True, False]:
+                model = ConvLinearChain().eval()
+                x = torch.randn(2, 3, 14, 14)
+                if use_channels_last:
+                    model = model.to(memory_format=torch.channels_last)
+                    x = x.to(memory_format=torch.channels_last)
+                ref = model(x)
+                model = ipex.optimize(model, dtype=torch.float32)
+                with torch.no_grad():
+                    traced_model = torch.jit.freeze(torch.jit.trace(model, x))
+                    for _ in range(3):
+                        traced_model(x)
+                    graph = traced_model.graph_for(x)
+                    # the arena is reused across invocations, results must not
+                    # depend on the previous run
+                    for _ in range(3):
+                        self.assertEqual(traced_model(x), ref, prec=1e-4)
+                        self.assertEqual(traced_model(x * 2), model(x * 2), prec=1e-4)
+                    # each thread gets its own arena
+                    results = []
+                    thread = threading.Thread(target=lambda: results.append(traced_model(x)))
+                    thread.start()
+                    thread.join()
+                    self.assertEqual(results[0], ref, prec=1e-4)
+                    # the planned outputs only fit the profiled shapes
+                    with self.assertRaisesRegex(RuntimeError, "static memory plan"):
+                        traced_model(torch.randn(3, 3, 14, 14))
+                self.assertEqual(count_kind(graph, "ipex::static_arena"), 1)
+                # all the intermediates are planned, the graph output is not
+                self.assertEqual(count_kind(graph, "ipex::arena_view"), 5)
+        finally:
+            ipex._C.disable_jit_static_memory_plan()
+
+        # the planning is opt-in
+        self.assertFalse(ipex._C.get_jit_static_memory_plan())
+        model = ipex.optimize(ConvLinearChain().eval(), dtype=torch.float32)
+        x = torch.randn(2, 3, 14, 14)
+        with torch.no_grad():
+            traced_model = torch.jit.freeze(torch.jit.trace(model, x))
+            for _ in range(3):
+                traced_model(x)
+            graph = traced_model.graph_for(x)
+        self.assertEqual(count_kind(graph, "ipex::arena_view"), 0)
+
+    def test_cat_elimination(self):
+        def count_kind(graph, kind):
+            return sum(n.kind() == kind for n in graph.nodes())
+
+        model = ConvCat().eval()
+        # the channel slices of a single NCHW image are dense
+        x = torch.randn(1, 3, 14, 14)
+        ref = model(x)
+        model = ipex.optimize(model, dtype=torch.float32)
+
+        # the pass is opt-in
+        self.assertFalse(ipex._C.get_jit_cat_elimination())
+        with torch.no_grad():
+            traced_model = torch.jit.freeze(torch.jit.trace(model, x))
+            for _ in range(3):
+                traced_model(x)
+            graph = traced_model.graph_for(x)
+        self.assertEqual(count_kind(graph, "aten::cat"), 2)
+
+        ipex._C.enable_jit_cat_elimination()
+        try:
+            with torch.no_grad():
+                traced_model = torch.jit.freeze(torch.jit.trace(model, x))
+                for _ in range(3):
+                    traced_model(x)
+                graph = traced_model.graph_for(x)
+                for _ in range(3):
+                    self.assertEqual(traced_model(x), ref, prec=1e-4)
+                # another batch size falls back to at::cat
+                x2 = torch.randn(2, 3, 14, 14)
+                self.assertEqual(traced_model(x2), model(x2), prec=1e-4)
+        finally:
+            ipex._C.disable_jit_cat_elimination()
+        self.assertEqual(count_kind(graph, "aten::cat"), 0)
+        self.assertEqual(count_kind(graph, "ipex::cat_from_slices"), 2)
+        # each cat writes into its own buffer
+        self.assertEqual(count_kind(graph, "ipex::cat_buffer"), 2)
+
+    def test_horizontal_fusion(self):
+        def count_kind(graph, kind):
+            return sum(n.kind() == kind for n in graph.nodes())
+
+        # the pass is opt-in
+        self.assertFalse(ipex._C.get_jit_horizontal_fusion())
+        model = IndependentLinears().eval()
+        inputs = (torch.randn(4, 16), torch.randn(4, 24), torch.randn(7, 16))
+        with torch.no_grad():
+            traced_model = torch.jit.freeze(torch.jit.trace(model, inputs))
+            for _ in range(3):
+                traced_model(*inputs)
+            graph = traced_model.graph_for(*inputs)
+        self.assertEqual(count_kind(graph, "ipex_prepack::grouped_linear_run"), 0)
+
+        ipex._C.enable_jit_horizontal_fusion()
+        try:
+            ref = model(*inputs)
+            with torch.no_grad():
+                traced_model = torch.jit.freeze(torch.jit.trace(model, inputs))
+                for _ in range(3):
+                    traced_model(*inputs)
+                graph = traced_model.graph_for(*inputs)
+                self.assertEqual(traced_model(*inputs), ref, prec=1e-4)
+                # the batch size of each input may change between invocations
+                inputs = (torch.randn(9, 16), torch.randn(9, 24), torch.randn(2, 16))
+                self.assertEqual(traced_model(*inputs), model(*inputs), prec=1e-4)
+            self.assertEqual(count_kind(graph, "ipex_prepack::grouped_linear_run"), 1)
+            self.assertEqual(count_kind(graph, "aten::linear"), 0)
+
+            # only linear1 and linear2 are grouped, linear3 stays after them
+            model = DependentSiblingLinears().eval()
+            inputs = (torch.randn(4, 16), torch.randn(5, 24))
+            ref = model(*inputs)
+            with torch.no_grad():
+                traced_model = torch.jit.freeze(torch.jit.trace(model, inputs))
+                for _ in range(3):
+                    traced_model(*inputs)
+                graph = traced_model.graph_for(*inputs)
+                graph.lint()
+                self.assertEqual(traced_model(*inputs), ref, prec=1e-4)
+            self.assertEqual(count_kind(graph, "ipex_prepack::grouped_linear_run"), 1)
+
+            model = IndependentBmms().eval()
+            inputs = (torch.randn(3, 5, 8), torch.randn(3, 8, 6),
+                      torch.randn(2, 4, 8), torch.randn(2, 7, 8))
+            ref = model(*inputs)
+            with torch.no_grad():
+                traced_model = torch.jit.freeze(torch.jit.trace(model, inputs))
+                for _ in range(3):
+                    traced_model(*inputs)
+                graph = traced_model.graph_for(*inputs)
+                self.assertEqual(traced_model(*inputs), ref, prec=1e-4)
+            self.assertEqual(count_kind(graph, "ipex::grouped_bmm"), 1)
+            self.assertEqual(count_kind(graph, "aten::bmm"), 0)
+        finally:
+            ipex._C.disable_jit_horizontal_fusion()
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_inter_op_parallel(self):
+        def count_kind(graph, kind):
+            return sum(n.kind() == kind for n in graph.nodes())
+
+        model = TwoTowers().eval()
+        inputs = (torch.randn(64, 512), torch.randn(64, 512))
+        ref = model(*inputs)
+        ipex._C.enable_jit_inter_op_parallel()
+        try:
+            with torch.no_grad():
+                traced_model = torch.jit.freeze(torch.jit.trace(model, inputs))
+                for _ in range(3):
+                    traced_model(*inputs)
+                graph = traced_model.graph_for(*inputs)
+                for _ in range(3):
+                    self.assertEqual(traced_model(*inputs), ref, prec=1e-4)
+        finally:
+            ipex._C.disable_jit_inter_op_parallel()
+        if torch.get_num_threads() >= 2:
+            self.assertEqual(count_kind(graph, "ipex::InterOpParallelGroup"), 1)
+
+    def test_packed_weight_serialization(self):
+        def save_and_load(model):
+            buffer = io.BytesIO()
+            torch.jit.save(model, buffer)
+            buffer.seek(0)
+            return torch.jit.load(buffer)
+
+        for dtype in [torch.float32, torch.bfloat16]:
+            model = ConvLinearChain().eval()
+            x = torch.randn(2, 3, 14, 14)
+            model = ipex.optimize(model, dtype=dtype)
+            with torch.cpu.amp.autocast(enabled=(dtype == torch.bfloat16)), torch.no_grad():
+                traced_model = torch.jit.freeze(torch.jit.trace(model, x))
+                ref = traced_model(x)
+                # the default format keeps the public weight layout
+                self.assertEqual(save_and_load(traced_model)(x), ref)
+                ipex._C.set_packed_weight_serialization_enabled(True)
+                try:
+                    loaded_model = save_and_load(traced_model)
+                finally:
+                    ipex._C.set_packed_weight_serialization_enabled(False)
+                for _ in range(2):
+                    self.assertEqual(loaded_model(x), ref)
+
+    def test_sparse_linear(self):
+        def prune(weight, two_four):
+            weight = weight.clone()
+            if two_four:
+                # keeps the 2 largest weights of every group of 4
+                groups = weight.view(-1, 4)
+                groups.scatter_(1, groups.abs().argsort(dim=1)[:, :2], 0)
+            else:
+                weight[torch.rand_like(weight) < 0.9] = 0
+            return weight
+
+        options = itertools.product([False, True], [1, 7, 40, 128], [64, 66], [True, False])
+        for two_four, batch_size, in_features, use_bias in options:
+            if two_four and in_features % 4 != 0:
+                continue
+            weight = prune(torch.randn(48, in_features), two_four)
+            bias = torch.randn(48) if use_bias else None
+            x = torch.randn(batch_size, in_features)
+            ref = F.linear(x, weight, bias)
+            ctx = torch.ops.ipex_prepack.sparse_linear_prepack(weight, bias)
+            self.assertEqual(torch.ops.ipex_prepack.sparse_linear_run(x, ctx), ref, prec=1e-4)
+            self.assertEqual(torch.ops.ipex_prepack.sparse_linear_relu_run(x, ctx), F.relu(ref), prec=1e-4)
+            self.assertEqual(torch.ops.ipex_prepack.sparse_linear_gelu_run(x, ctx), F.gelu(ref), prec=1e-4)
+
+        # the pass is opt-in
+        model = SparseLinearRelu().eval()
+        x = torch.randn(64, 256)
+        ref = model(x)
+        self.assertFalse(ipex._C.get_jit_sparse_linear())
+        with torch.no_grad():
+            traced_model = torch.jit.freeze(torch.jit.trace(ipex.optimize(model), x))
+            for _ in range(2):
+                traced_model(x)
+            graph = traced_model.graph_for(x)
+            self.assertEqual(traced_model(x), ref, prec=1e-4)
+        self.assertFalse(any(n.kind() == "ipex_prepack::sparse_linear_run" for n in graph.nodes()))
+
+        # the sparse path is only taken when it measures faster, so only the
+        # results are checked
+        ipex._C.enable_jit_sparse_linear()
+        try:
+            with torch.no_grad():
+                traced_model = torch.jit.freeze(torch.jit.trace(ipex.optimize(model), x))
+                for _ in range(3):
+                    self.assertEqual(traced_model(x), ref, prec=1e-4)
+        finally:
+            ipex._C.disable_jit_sparse_linear()
+
+    def test_weight_sharing(self):
+        model = ConvLinearChain().eval()
+        x = torch.randn(2, 3, 14, 14)
+        ref = model(x)
+        with tempfile.TemporaryDirectory() as weight_dir:
+            ipex._C.set_weight_sharing_dir(weight_dir)
+            try:
+                with torch.no_grad():
+                    # the second model maps the files written by the first one
+                    outputs = []
+                    for _ in range(2):
+                        optimized_model = ipex.optimize(copy.deepcopy(model))
+                        traced_model = torch.jit.freeze(torch.jit.trace(optimized_model, x))
+                        outputs.append([traced_model(x) for _ in range(2)])
+                    num_files = len(os.listdir(weight_dir))
+            finally:
+                ipex._C.set_weight_sharing_dir("")
+        for output in itertools.chain(*outputs):
+            self.assertEqual(output, ref, prec=1e-4)
+        self.assertGreater(num_files, 0)
+
 if __name__ == '__main__':
     torch.manual_seed(2020)
     test = unittest.main()
@@ -1,5 +1,6 @@
 import os
 import subprocess
+import tempfile
 import unittest
 import itertools
 import torch
@@ -319,6 +320,84 @@ class TestOp(JitLlgaTestCase):
                 self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
                 self.assertFused(graph, ['aten::linear'])
 
+    @llga_fp32_bf16_test_env
+    def test_linear_dynamic_shape(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = nn.Linear(32, 64)
+
+            def forward(self, x):
+                return F.relu(self.linear(x))
+
+        ipex._C.set_llga_dynamic_shape_enabled(True)
+        try:
+            m = M()
+            graph, traced = self.checkTrace(m, [torch.randn(2, 8, 32)])
+            self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
+            self.assertFused(graph, ['aten::linear', 'aten::relu'])
+            # new batch sizes and sequence lengths are compiled on the fly
+            with torch.no_grad():
+                for batch, seq in [(3, 5), (1, 8), (4, 17), (3, 5)]:
+                    x = torch.randn(batch, seq, 32)
+                    self.assertEqual(traced(x), m(x))
+        finally:
+            ipex._C.set_llga_dynamic_shape_enabled(False)
+
+    @llga_fp32_bf16_test_env
+    def test_linear_dynamic_shape_chained(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear1 = nn.Linear(32, 64)
+                self.linear2 = nn.Linear(64, 16)
+
+            def forward(self, x):
+                x = F.relu(self.linear1(x))
+                return F.relu(self.linear2(x))
+
+        ipex._C.set_llga_dynamic_shape_enabled(True)
+        try:
+            m = M()
+            graph, traced = self.checkTrace(m, [torch.randn(2, 8, 32)])
+            # the partition of linear2 is fed by the one of linear1 and both
+            # get compiled per input shape
+            self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 2)
+            self.assertFused(graph, ['aten::linear', 'aten::relu'])
+            with torch.no_grad():
+                for batch, seq in [(3, 5), (1, 8), (4, 17), (3, 5)]:
+                    x = torch.randn(batch, seq, 32)
+                    self.assertEqual(traced(x), m(x))
+        finally:
+            ipex._C.set_llga_dynamic_shape_enabled(False)
+
+    @llga_fp32_bf16_test_env
+    def test_linear_dynamic_shape_static_consumer(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear1 = nn.Linear(32, 64)
+                self.linear2 = nn.Linear(64, 8)
+
+            def forward(self, x, y):
+                x = F.relu(self.linear1(x))
+                return self.linear2(x) + y
+
+        ipex._C.set_llga_dynamic_shape_enabled(True)
+        try:
+            m = M()
+            # the non contiguous y keeps the partition of linear2 on the
+            # profiled shapes, so the one of linear1 feeding it must be too
+            y = torch.randn(8, 8).t()
+            graph, traced = self.checkTrace(m, [torch.randn(2, 8, 32), y])
+            self.assertFused(graph, ['aten::linear', 'aten::relu'])
+            with torch.no_grad():
+                for batch in [3, 1, 2]:
+                    x = torch.randn(batch, 8, 32)
+                    self.assertEqual(traced(x, y), m(x, y))
+        finally:
+            ipex._C.set_llga_dynamic_shape_enabled(False)
+
     @llga_fp32_bf16_test_env
     def test_bmm(self):
         class M(nn.Module):
@@ -801,6 +880,49 @@ class TestAPI(JitLlgaTestCase):
         # set the value back to the default one
         ipex._C._jit_set_llga_weight_cache_enabled(weight_cache_enabled_default_value)
 
+    def test_auto_partition(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv = nn.Conv2d(16, 32, 3, padding=1)
+
+            def forward(self, x):
+                return F.relu(self.conv(x))
+
+        torch._C._jit_set_profiling_mode(True)
+        torch._C._jit_set_profiling_executor(True)
+        m = M().eval()
+        x = torch.rand(2, 16, 14, 14)
+        # the region is FP32 and only gets partitioned by the auto partition
+        self.assertFalse(ipex._C.is_llga_fp32_bf16_enabled())
+        with tempfile.TemporaryDirectory() as tmp:
+            cache_file = os.path.join(tmp, 'auto_partition.txt')
+            ipex._C.set_llga_auto_partition_cache_file(cache_file)
+            ipex._C.set_llga_auto_partition_enabled(True)
+            try:
+                with torch.no_grad():
+                    traced = torch.jit.freeze(torch.jit.trace(m, x))
+                    # the warm-up alternates between the LLGA and the IPEX path
+                    for _ in range(20):
+                        self.assertEqual(traced(x), m(x))
+                    graph = traced.graph_for(x)
+                    # a shape that does not match the profiled one
+                    y = torch.rand(1, 16, 7, 7)
+                    self.assertEqual(traced(y), m(y))
+            finally:
+                ipex._C.set_llga_auto_partition_enabled(False)
+                ipex._C.set_llga_auto_partition_cache_file('')
+            self.assertGraphContainsExactly(graph, 'ipex::LlgaAutoPartitionGroup', 1)
+            self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 0)
+            with open(cache_file) as f:
+                decisions = [line.split() for line in f]
+            self.assertEqual(len(decisions), 1)
+            key, choice, llga_us, ipex_us = decisions[0]
+            self.assertIn(choice, ['llga', 'ipex'])
+            # both paths of the FP32 region have been timed
+            self.assertGreater(float(llga_us), 0)
+            self.assertGreater(float(ipex_us), 0)
+
 class TestDebugLog(JitLlgaTestCase):
     def test_fusion_group_name(self):
         num = 0
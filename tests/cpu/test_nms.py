@@ -10,6 +10,7 @@ import os
 def nms(dets, scores, threshold, sorted=False):
     return torch.ops.torch_ipex.nms(dets, scores, threshold, sorted)
 batch_score_nms = torch.ops.torch_ipex.batch_score_nms
+batch_decode_score_nms = torch.ops.torch_ipex.batch_decode_score_nms
 parallel_scale_back_batch = torch.ops.torch_ipex.parallel_scale_back_batch
 rpn_nms = torch.ops.torch_ipex.rpn_nms
 box_head_nms = torch.ops.torch_ipex.box_head_nms
@@ -186,6 +187,34 @@ class TestNMS(TestCase):
         self.assertEqual(output2_raw_double, output2_raw)
         self.assertTrue(output2_raw_double[0].dtype == torch.float64)
 
+    def test_batch_decode_score_nms_result(self):
+        scale_xy = 0.1
+        scale_wh = 0.2
+        criteria = 0.50
+        max_output = 200
+        predicted_loc = torch.load(os.path.join(os.path.dirname(__file__), "data/nms_ploc.pt")) # sizes: [1, 15130, 4]
+        predicted_score = torch.load(os.path.join(os.path.dirname(__file__), "data/nms_plabel.pt")) # sizes: [1, 15130, 81]
+        dboxes_xywh = torch.load(os.path.join(os.path.dirname(__file__), "data/nms_dboxes_xywh.pt"))
+        # batch of 2 images
+        predicted_loc = torch.cat([predicted_loc, predicted_loc.flip(1)], 0)
+        predicted_score = torch.cat([predicted_score, predicted_score.flip(1)], 0)
+
+        bboxes, probs = parallel_scale_back_batch(predicted_loc, predicted_score, dboxes_xywh, scale_xy, scale_wh)
+        output_ref = batch_score_nms(bboxes, probs, criteria, max_output)
+        output = batch_decode_score_nms(
+            predicted_loc.clone(), predicted_score.clone(), dboxes_xywh, scale_xy, scale_wh, 0.05, criteria, max_output)
+        self.assertEqual(output[3], output_ref[3])
+        self.assertTrue(torch.allclose(output[0], output_ref[0], rtol=1e-4, atol=1e-4))
+        self.assertEqual(output[1], output_ref[1])
+        self.assertTrue(torch.allclose(output[2], output_ref[2], rtol=1e-4, atol=1e-4))
+
+        # test autocast
+        with torch.cpu.amp.autocast():
+            output_autocast = batch_decode_score_nms(
+                predicted_loc.bfloat16(), predicted_score.bfloat16(), dboxes_xywh, scale_xy, scale_wh, 0.05, criteria, max_output)
+            for i in range(3):
+                self.assertTrue(output_autocast[i].dtype == torch.float32)
+
     def test_jit_trace_batch_nms(self):
         class Batch_NMS(nn.Module):
             def __init__(self, criteria, max_output):
@@ -283,6 +312,43 @@ class TestNMS(TestCase):
                 result_double = nms(loc.clone().double(), score.clone().double(), criteria, False)
                 self.assertEqual(result_double, result_ref)
 
+    def test_nms_large_candidate_set(self):
+        def nms_reference(dets, scores, threshold):
+            order = torch.sort(scores, descending=True)[1]
+            areas = (dets[:, 2] - dets[:, 0] + 1) * (dets[:, 3] - dets[:, 1] + 1)
+            suppressed = torch.zeros(dets.size(0), dtype=torch.bool)
+            for i in order.tolist():
+                if suppressed[i]:
+                    continue
+                lt = torch.max(dets[i, :2], dets[:, :2])
+                rb = torch.min(dets[i, 2:], dets[:, 2:])
+                wh = (rb - lt + 1).clamp(min=0)
+                inter = wh[:, 0] * wh[:, 1]
+                iou = inter / (areas[i] + areas - inter)
+                later = torch.zeros(dets.size(0), dtype=torch.bool)
+                later[order[(order == i).nonzero()[0, 0] + 1:]] = True
+                suppressed |= (iou >= threshold) & later
+            return torch.nonzero(~suppressed).squeeze(1)
+
+        # few classes with thousands of candidates, the count is not a multiple
+        # of the 64 boxes in one word of the suppression bitmask
+        for ndets in [1, 63, 64, 3001]:
+            xy = torch.rand(ndets, 2) * 500
+            wh = torch.rand(ndets, 2) * 100
+            dets = torch.cat([xy, xy + wh], dim=1)
+            scores = torch.rand(ndets)
+            for threshold in [0.3, 0.7]:
+                result_ref = nms_reference(dets.double(), scores.double(), threshold)
+                result = nms(dets, scores, threshold, False)
+                self.assertEqual(result, result_ref)
+                result_double = nms(dets.double(), scores.double(), threshold, False)
+                self.assertEqual(result_double, result_ref)
+
+                scores_sorted, indices = torch.sort(scores, descending=True)
+                dets_sorted = dets.index_select(0, indices)
+                result_sorted = nms(dets_sorted, scores_sorted, threshold, True)
+                self.assertEqual(torch.sort(indices[result_sorted])[0], result_ref)
+
     def test_rpn_nms_result(self):
         image_shapes = [(800, 824), (800, 1199)]
         min_size = 0
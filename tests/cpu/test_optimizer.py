@@ -486,6 +486,103 @@ class TestFusedSteps(TestCase):
         self.assertEqual(param, param2)
         self.assertEqual(state_sum, state_sum2)
 
+    def test_adagrad_sparse_step(self):
+        fused = torch.ops.torch_ipex.adagrad_fused_step
+        step = 10
+        learning_rate = 0.1
+        lr_decay = 0.01
+        eps = 0.001
+        clr = learning_rate / (1 + (step - 1) * lr_decay)
+
+        # uncoalesced rows of an embedding table, row 3 is hit twice
+        indices = torch.tensor([[3, 0, 17, 3, 30]])
+        values = torch.randn(5, 33)
+        grad = torch.sparse_coo_tensor(indices, values, (31, 33))
+
+        # reference: torch.optim.Adagrad on sparse grads, in fp32
+        param = torch.randn(31, 33)
+        state_sum = torch.randn(31, 33).abs()
+        ref_param = param.clone()
+        ref_state_sum = state_sum.clone()
+        coalesced = grad.coalesce()
+        rows = coalesced._indices()[0]
+        ref_state_sum[rows] += coalesced._values().pow(2)
+        ref_param[rows] -= clr * coalesced._values() / (ref_state_sum[rows].sqrt() + eps)
+
+        # fused fp32
+        param1 = param.clone()
+        state_sum1 = state_sum.clone()
+        fused(param1, grad, state_sum1, torch.Tensor(), step, learning_rate, 0, lr_decay, eps)
+        self.assertEqual(param1, ref_param)
+        self.assertEqual(state_sum1, ref_state_sum)
+
+        # fused bf16 ( master weight split ), both halves are updated
+        param2, trail2 = torch.ops.torch_ipex.split_float_bfloat16(param)
+        state_sum2 = state_sum.clone()
+        grad2 = torch.sparse_coo_tensor(indices, values.bfloat16(), (31, 33))
+        fused(param2, grad2, state_sum2, trail2, step, learning_rate, 0, lr_decay, eps)
+        param2_fp32 = torch.ops.torch_ipex.cat_bfloat16_float(param2, trail2)
+        self.assertEqual(param2_fp32, ref_param, rtol=1e-4, atol=1e-2)
+        self.assertEqual(state_sum2, ref_state_sum, rtol=1e-4, atol=1e-1)
+        # the rows without gradient are untouched
+        untouched = [i for i in range(31) if i not in (0, 3, 17, 30)]
+        self.assertEqual(param2_fp32[untouched], param[untouched])
+
+        # fused bf16 ( master weight )
+        param3 = param.clone()
+        state_sum3 = state_sum.clone()
+        bf16_param = param3.bfloat16()
+        fused(param3, grad2, state_sum3, bf16_param, step, learning_rate, 0, lr_decay, eps)
+        self.assertEqual(param3, param2_fp32, rtol=1e-4, atol=1e-2)
+        self.assertEqual(bf16_param, param3.bfloat16())
+
+        with self.assertRaisesRegex(RuntimeError, "not compatible with sparse gradients"):
+            fused(param1, grad, state_sum1, torch.Tensor(), step, learning_rate, 0.1, lr_decay, eps)
+
+    def test_adagrad_sparse_step_fallback(self):
+        from intel_extension_for_pytorch.optim._functional import _single_tensor_adagrad
+        learning_rate = 0.1
+        lr_decay = 0.01
+        eps = 0.001
+        clr = learning_rate / (1 + (10 - 1) * lr_decay)
+        indices = torch.tensor([[3, 0, 17, 3, 30]])
+        values = torch.randn(5, 33)
+
+        def reference(param, state_sum, grad):
+            param = param.clone()
+            state_sum = state_sum.clone()
+            coalesced = grad.coalesce()
+            rows = coalesced._indices()[0]
+            grad_values = coalesced._values().to(param.dtype)
+            state_sum[rows] += grad_values.pow(2)
+            param[rows] -= clr * grad_values / (state_sum[rows].sqrt() + eps)
+            return param, state_sum
+
+        def step(param, state_sum, grad):
+            _single_tensor_adagrad(
+                [param], [torch.Tensor()], [grad], [state_sum], [torch.tensor(9.)],
+                lr=learning_rate, weight_decay=0, lr_decay=lr_decay, eps=eps,
+                has_sparse_grad=True, maximize=False, fused=True)
+
+        # a BFloat16 grad of an fp32 weight without BFloat16 copy
+        param = torch.randn(31, 33)
+        state_sum = torch.randn(31, 33).abs()
+        grad = torch.sparse_coo_tensor(indices, values.bfloat16(), (31, 33))
+        ref_param, ref_state_sum = reference(param, state_sum, grad)
+        step(param, state_sum, grad)
+        self.assertEqual(param, ref_param)
+        self.assertEqual(state_sum, ref_state_sum)
+
+        # a non contiguous weight
+        param = torch.randn(33, 31).t()
+        state_sum = torch.randn(31, 33).abs()
+        grad = torch.sparse_coo_tensor(indices, values, (31, 33))
+        ref_param, ref_state_sum = reference(param, state_sum, grad)
+        step(param, state_sum, grad)
+        self.assertFalse(param.is_contiguous())
+        self.assertEqual(param, ref_param)
+        self.assertEqual(state_sum, ref_state_sum)
+
     def test_sgd_step(self):
         fused = torch.ops.torch_ipex.sgd_fused_step
         non_fused = bench.custom_op_bench.optimizer.non_fused_sgd
@@ -155,6 +155,35 @@ class RoIAlignTester(TestCase):
             self.assertTrue(x4.grad.dtype == torch.bfloat16)
             self.assertTrue(torch.allclose(gt_x.grad.to(x4.dtype), x4.grad, rtol=1e-5, atol=1e-5))
 
+    def test_roialign_batched(self):
+        # multi-image batch with a big feature map, so that ROIs are reordered
+        # and channels are tiled into several blocks inside the kernel
+        pool_size = 5
+        n_channels = 40
+        x = torch.rand(3, n_channels, 300, 300)
+        rois = []
+        for i in range(24):
+            x1, y1 = torch.randint(0, 250, (2,)).tolist()
+            w, h = torch.randint(1, 50, (2,)).tolist()
+            rois.append([2 - i % 3, x1, y1, x1 + w, y1 + h])
+        rois = torch.tensor(rois, dtype=torch.float)
+
+        gt_y = expected_fn(x, rois, pool_size, pool_size, spatial_scale=0.5, sampling_ratio=2, aligned=True)
+        for datatype in [torch.float32, torch.bfloat16]:
+            for memory_format in [torch.contiguous_format, torch.channels_last]:
+                x0 = x.clone().to(datatype).to(memory_format=memory_format)
+                with torch.no_grad():
+                    y0 = fn(x0, rois, pool_size, pool_size, spatial_scale=0.5, sampling_ratio=2, aligned=True)
+                self.assertTrue(y0.dtype == datatype)
+                self.assertTrue(y0.is_contiguous(memory_format=memory_format))
+                self.assertTrue(torch.allclose(gt_y.to(y0.dtype), y0, rtol=1e-2, atol=1e-2))
+
+                # output order follows the ROI order, not the internal one
+                perm = torch.randperm(rois.size(0))
+                with torch.no_grad():
+                    y1 = fn(x0, rois[perm], pool_size, pool_size, spatial_scale=0.5, sampling_ratio=2, aligned=True)
+                self.assertEqual(y0[perm], y1)
+
     @skipIfNoTorchVision
     def test_torchvision_roialign(self):
         pool_size = 5
@@ -473,6 +473,55 @@ class TestPrepackCases(TestCase):
                 y2 = ipex_model(x2)
             self.assertEqual(y1, y2.float(), rtol=1e-2, atol=1e-3)
 
+    def test_linear_weight_only_quant(self):
+        class L(torch.nn.Module):
+            def __init__(self, in_f, out_f, bias):
+                super(L, self).__init__()
+                self.linear = torch.nn.Linear(in_f, out_f, bias=bias)
+
+            def forward(self, x):
+                return self.linear(x)
+
+        def dequantize(weight, bits, group_size):
+            qmax = 127 if bits == 8 else 7
+            w = weight.float().view(weight.size(0), -1, group_size)
+            scales = w.abs().amax(-1, keepdim=True) / qmax
+            q = (w / scales.masked_fill(scales == 0, 1)).round().clamp(-qmax, qmax)
+            return (q * scales).view(weight.shape)
+
+        in_features = 64
+        test_dtypes = [torch.float]
+        if core.onednn_has_bf16_support():
+            test_dtypes.append(torch.bfloat16)
+        # 1 and 4 rows run the decoding kernel, 32 rows the dense GEMM
+        options = itertools.product(
+            ["int8", "int4"], [None, 16, 24], [True, False], [(1, in_features), (4, in_features), (2, 16, in_features)],
+            test_dtypes)
+        for woq, group_size, bias, x_shape, dtype in options:
+            model = L(in_features, 33, bias).eval()
+            x = torch.randn(x_shape).to(dtype)
+            with torch.no_grad():
+                ipex_model = ipex.optimize(
+                    copy.deepcopy(model).to(dtype), dtype=dtype, weight_only_quant=woq,
+                    weight_only_quant_group_size=group_size)
+                self.assertTrue(module_found(ipex_model, ipex.nn.utils._weight_prepack._IPEXWoqLinear))
+                # 24 doesn't divide in_features, it falls back to per-channel
+                ref_group_size = in_features if group_size is None or in_features % group_size != 0 else group_size
+                bits = 8 if woq == "int8" else 4
+                ref_model = copy.deepcopy(model).to(dtype)
+                ref_model.linear.weight.copy_(dequantize(ref_model.linear.weight, bits, ref_group_size))
+                y_ref = ref_model.float()(x.float())
+                y = ipex_model(x)
+                self.assertEqual(y.dtype, dtype)
+                tol = 1e-2 if dtype == torch.bfloat16 else 1e-4
+                self.assertEqual(y.float(), y_ref, rtol=tol, atol=tol)
+                traced_model = torch.jit.freeze(torch.jit.trace(ipex_model, x))
+                traced_model(x)
+                y_traced = traced_model(x)
+                self.assertEqual(y_traced, y, rtol=tol, atol=tol)
+                graph = traced_model.graph_for(x)
+                self.assertTrue(any(n.kind() == "ipex_prepack::woq_linear_run" for n in graph.nodes()))
+
     @unittest.skipIf(not core.onednn_has_bf16_support(), "ipex linear bf16 is not supported on this CPU device")
     def test_linear_training(self):
         linear_module = torch.nn.Linear